@@ -208,6 +208,7 @@ struct etlsf_private_t
     uint16_t num_ranges;
     uint16_t next_unused_trailing_index;
     uint16_t first_free_storage_index;
+    uint16_t first_phys_index;
     struct etlsf_range_t storage[1];
 };
 
@@ -224,6 +225,7 @@ static uint32_t calc_range_size     (etlsf_t arena, uint16_t index);
 static void     create_initial_range(etlsf_t arena);
 static uint32_t split_range         (etlsf_t arena, uint16_t index, uint32_t size);
 static void     merge_ranges        (etlsf_t arena, uint16_t target_index, uint16_t source_index);
+static void     swap_ranges         (etlsf_t arena, uint16_t index_a, uint16_t index_b);
 
 static void     freelist_insert_range(etlsf_t arena, uint16_t index);
 static void     freelist_remove_range(etlsf_t arena, uint16_t index);
@@ -337,6 +339,113 @@ int etlsf_alloc_is_valid(etlsf_t arena, etlsf_alloc_t id)
     return arena && (index != 0) && (index <= arena->next_unused_trailing_index) && !ETLSF_range(index).is_free;
 }
 
+void etlsf_walk_ranges(etlsf_t arena, etlsf_walker walker, void* user)
+{
+    if (arena && walker)
+    {
+        for (uint16_t index = arena->first_phys_index; index; index = ETLSF_range(index).next_phys_index)
+        {
+            etlsf_alloc_t id = { index };
+            const int used = !ETLSF_range(index).is_free;
+            walker(used ? id : ETLSF_INVALID_ID, ETLSF_range(index).offset, calc_range_size(arena, index), used, user);
+        }
+    }
+}
+
+uint32_t etlsf_slide_range(etlsf_t arena, etlsf_alloc_t id)
+{
+    if (!arena || !etlsf_alloc_is_valid(arena, id))
+    {
+        return 0;
+    }
+
+    uint16_t index = id.value;
+    uint16_t prev_index = ETLSF_range(index).prev_phys_index;
+    if (!prev_index || !ETLSF_range(prev_index).is_free)
+    {
+        return ETLSF_range(index).offset;
+    }
+
+    uint16_t prev_prev_index = ETLSF_range(prev_index).prev_phys_index;
+    uint16_t next_index = ETLSF_range(index).next_phys_index;
+    uint32_t size = calc_range_size(arena, index);
+
+    freelist_remove_range(arena, prev_index);
+
+    // Swap physical order, so the free range follows the allocation.
+    if (prev_prev_index)
+    {
+        ETLSF_range(prev_prev_index).next_phys_index = index;
+    }
+    else
+    {
+        arena->first_phys_index = index;
+    }
+    ETLSF_range(index).prev_phys_index = prev_prev_index;
+    ETLSF_range(index).next_phys_index = prev_index;
+    ETLSF_range(prev_index).prev_phys_index = index;
+    ETLSF_range(prev_index).next_phys_index = next_index;
+    ETLSF_range(next_index).prev_phys_index = prev_index;
+
+    ETLSF_range(index).offset = ETLSF_range(prev_index).offset;
+    ETLSF_range(prev_index).offset = ETLSF_range(index).offset + size;
+
+    //Merge next block if free
+    if (next_index && ETLSF_range(next_index).is_free)
+    {
+        freelist_remove_range(arena, next_index);
+        merge_ranges(arena, prev_index, next_index);
+    }
+
+    freelist_insert_range(arena, prev_index);
+
+    return ETLSF_range(index).offset;
+}
+
+uint32_t etlsf_move_range(etlsf_t arena, etlsf_alloc_t id, uint32_t offset)
+{
+    if (!arena || !etlsf_alloc_is_valid(arena, id))
+    {
+        return 0;
+    }
+
+    uint16_t index = id.value;
+    uint16_t prev_index = ETLSF_range(index).prev_phys_index;
+    if (prev_index && ETLSF_range(prev_index).is_free && ETLSF_range(prev_index).offset == offset)
+    {
+        return etlsf_slide_range(arena, id);
+    }
+
+    uint16_t dst_index = arena->first_phys_index;
+    while (dst_index && ETLSF_range(dst_index).offset < offset)
+    {
+        dst_index = ETLSF_range(dst_index).next_phys_index;
+    }
+
+    uint32_t size = calc_range_size(arena, index);
+    if (!dst_index || ETLSF_range(dst_index).offset != offset || !ETLSF_range(dst_index).is_free ||
+        calc_range_size(arena, dst_index) < size)
+    {
+        return ETLSF_range(index).offset;
+    }
+
+    // Allocate the destination, then give it the allocation's id and free the source in its place.
+    freelist_remove_range(arena, dst_index);
+
+    uint16_t remainder_index = split_range(arena, dst_index, size);
+    if (remainder_index)
+    {
+        freelist_insert_range(arena, remainder_index);
+    }
+
+    swap_ranges(arena, index, dst_index);
+
+    etlsf_alloc_t src_id = { dst_index };
+    etlsf_free_range(arena, src_id);
+
+    return ETLSF_range(index).offset;
+}
+
 //------------------------------  Arena utils  --------------------------------//
 
 static size_t arena_total_size(size_t max_allocs)
@@ -411,6 +520,7 @@ static void create_initial_range(etlsf_t arena)
     ETLSF_range(index).prev_phys_index = 0;
     ETLSF_range(index).next_phys_index = 0;
     ETLSF_range(index).offset = 0;
+    arena->first_phys_index = index;
     freelist_insert_range(arena, index);
 }
 
@@ -457,6 +567,51 @@ static void merge_ranges(etlsf_t arena, uint16_t target_index, uint16_t source_i
     storage_free_range_data(arena, source_index);
 }
 
+// swaps physical position of two used ranges, so their ids refer to each other's range
+static void swap_ranges(etlsf_t arena, uint16_t index_a, uint16_t index_b)
+{
+    ETLSF_assert(arena);
+    ETLSF_validate_index(index_a);
+    ETLSF_validate_index(index_b);
+    ETLSF_assert(!ETLSF_range(index_a).is_free && !ETLSF_range(index_b).is_free);
+
+    struct etlsf_range_t range = ETLSF_range(index_a);
+    ETLSF_range(index_a) = ETLSF_range(index_b);
+    ETLSF_range(index_b) = range;
+
+    // Links may refer to either range when they are adjacent, and neighbours still refer to the old indices.
+    uint16_t indices[2] = { index_a, index_b };
+    for (int i = 0; i < 2; ++i)
+    {
+        uint16_t index = indices[i];
+        uint16_t prev_index = ETLSF_range(index).prev_phys_index;
+        uint16_t next_index = ETLSF_range(index).next_phys_index;
+        prev_index = prev_index == index_a ? index_b : prev_index == index_b ? index_a : prev_index;
+        next_index = next_index == index_a ? index_b : next_index == index_b ? index_a : next_index;
+        ETLSF_range(index).prev_phys_index = prev_index;
+        ETLSF_range(index).next_phys_index = next_index;
+    }
+
+    for (int i = 0; i < 2; ++i)
+    {
+        uint16_t index = indices[i];
+        uint16_t prev_index = ETLSF_range(index).prev_phys_index;
+        uint16_t next_index = ETLSF_range(index).next_phys_index;
+        if (prev_index)
+        {
+            ETLSF_range(prev_index).next_phys_index = index;
+        }
+        else
+        {
+            arena->first_phys_index = index;
+        }
+        if (next_index)
+        {
+            ETLSF_range(next_index).prev_phys_index = index;
+        }
+    }
+}
+
 
 //------------------------------  Size utils  -------------------------------//
 
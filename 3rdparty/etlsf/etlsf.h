@@ -58,6 +58,19 @@ uint32_t etlsf_alloc_offset(etlsf_t arena, etlsf_alloc_t id);
 
 int etlsf_alloc_is_valid(etlsf_t arena, etlsf_alloc_t id);
 
+/* Visits all ranges in address order, id is only valid for used ranges */
+typedef void (*etlsf_walker)(etlsf_alloc_t id, uint32_t offset, uint32_t size, int used, void* user);
+void etlsf_walk_ranges(etlsf_t arena, etlsf_walker walker, void* user);
+
+/* Moves allocation down into the free range directly before it, keeping its id.
+** Returns new offset, or previous offset if there is no free range before it */
+uint32_t etlsf_slide_range(etlsf_t arena, etlsf_alloc_t id);
+
+/* Moves allocation to the start of the free range at offset, keeping its id. The free range must be
+** directly before the allocation, or large enough to hold it.
+** Returns new offset, or previous offset if the allocation can't be moved there */
+uint32_t etlsf_move_range(etlsf_t arena, etlsf_alloc_t id, uint32_t offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,400 @@
+#include "core/command_line.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+#include "core/string.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/manager.h"
+#include "job/parallel_for.h"
+
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Job system benchmark.
+ * Runs each benchmark at 1..N workers and reports the results as JSON, to track scheduler
+ * performance over time and to choose worker and fiber counts.
+ *
+ * Usage: job_benchmark [-w max workers] [-f fibers] [-s fiber stack size] [-r repeats]
+ *                      [-b benchmark name filter] [-o output json path]
+ *
+ * Fibers are raised to the minimum the benchmarks need to avoid deadlocking.
+ */
+
+namespace
+{
+	static const i32 DEFAULT_NUM_FIBERS = 256;
+	static const i32 DEFAULT_FIBER_STACK_SIZE = 64 * 1024;
+	static const i32 DEFAULT_NUM_REPEATS = 5;
+
+	struct BenchmarkSettings
+	{
+		i32 maxWorkers_ = 1;
+		i32 numFibers_ = DEFAULT_NUM_FIBERS;
+		i32 fiberStackSize_ = DEFAULT_FIBER_STACK_SIZE;
+		i32 numRepeats_ = DEFAULT_NUM_REPEATS;
+		Core::String filter_;
+		Core::String outputPath_;
+	};
+
+	/**
+	 * Benchmark to run. Returns the amount of work done, in units of @a unit_.
+	 */
+	struct Benchmark
+	{
+		const char* name_ = nullptr;
+		const char* unit_ = nullptr;
+		i64 (*func_)() = nullptr;
+	};
+
+	struct BenchmarkResult
+	{
+		const char* name_ = nullptr;
+		const char* unit_ = nullptr;
+		i32 numWorkers_ = 0;
+		i64 workDone_ = 0;
+		f64 bestTime_ = 0.0;
+		f64 meanTime_ = 0.0;
+	};
+
+	void EmptyJob(i32 param, void* data) {}
+
+	/**
+	 * Scheduling throughput of jobs that do nothing.
+	 */
+	i64 BenchmarkEmptyJobs()
+	{
+		static const i32 NUM_JOBS = 64 * 1024;
+		static const i32 BATCH_SIZE = 1024;
+
+		Core::Vector<Job::JobDesc> jobDescs;
+		jobDescs.resize(BATCH_SIZE);
+
+		Core::Vector<Job::Counter*> counters;
+		counters.reserve(NUM_JOBS / BATCH_SIZE);
+		for(i32 batch = 0; batch < NUM_JOBS / BATCH_SIZE; ++batch)
+		{
+			for(auto& jobDesc : jobDescs)
+			{
+				jobDesc = Job::JobDesc();
+				jobDesc.func_ = EmptyJob;
+				jobDesc.name_ = "emptyJob";
+			}
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+			counters.push_back(counter);
+		}
+
+		for(auto* counter : counters)
+			Job::Manager::WaitForCounter(counter, 0);
+		return NUM_JOBS;
+	}
+
+	/// Below this, fib is computed serially within the job.
+	static const i32 FIB_SERIAL_CUTOFF = 8;
+	/// Every waiting job holds a fiber, and new jobs are started in preference to resuming waiting
+	/// ones, so this is kept small enough for all non-leaf jobs (143) to fit in the default fibers.
+	static const i32 FIB_N = 18;
+	static const i32 NUM_FIB_RUNS = 16;
+
+	i64 FibSerial(i32 n) { return n < 2 ? n : FibSerial(n - 1) + FibSerial(n - 2); }
+
+	/// @return Number of non-leaf jobs computing fib(n), which may all be waiting at once.
+	i32 GetNumFibWaitingJobs(i32 n)
+	{
+		return n <= FIB_SERIAL_CUTOFF ? 0 : 1 + GetNumFibWaitingJobs(n - 1) + GetNumFibWaitingJobs(n - 2);
+	}
+
+	struct FibData
+	{
+		i64 result_ = 0;
+		volatile i32* numJobs_ = nullptr;
+	};
+
+	void FibJob(i32 n, void* data)
+	{
+		auto* fibData = static_cast<FibData*>(data);
+		Core::AtomicInc(fibData->numJobs_);
+		if(n <= FIB_SERIAL_CUTOFF)
+		{
+			fibData->result_ = FibSerial(n);
+			return;
+		}
+
+		FibData childData[2];
+		Job::JobDesc jobDescs[2];
+		for(i32 i = 0; i < 2; ++i)
+		{
+			childData[i].numJobs_ = fibData->numJobs_;
+			jobDescs[i].func_ = FibJob;
+			jobDescs[i].param_ = n - 1 - i;
+			jobDescs[i].data_ = &childData[i];
+			jobDescs[i].name_ = "fibJob";
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs, 2, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		fibData->result_ = childData[0].result_ + childData[1].result_;
+	}
+
+	/**
+	 * Fork-join recursion, each job waiting on its children.
+	 */
+	i64 BenchmarkFib()
+	{
+		volatile i32 numJobs = 0;
+		for(i32 run = 0; run < NUM_FIB_RUNS; ++run)
+		{
+			FibData fibData;
+			fibData.numJobs_ = &numJobs;
+
+			Job::JobDesc jobDesc;
+			jobDesc.func_ = FibJob;
+			jobDesc.param_ = FIB_N;
+			jobDesc.data_ = &fibData;
+			jobDesc.name_ = "fibJob";
+
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(&jobDesc, 1, &counter);
+			Job::Manager::WaitForCounter(counter, 0);
+			DBG_ASSERT(fibData.result_ == FibSerial(FIB_N));
+		}
+		return numJobs;
+	}
+
+	static const i32 NUM_WAIT_ROUND_TRIPS = 4096;
+
+	void WaitLatencyJob(i32 param, void* data)
+	{
+		for(i32 i = 0; i < NUM_WAIT_ROUND_TRIPS; ++i)
+		{
+			Job::JobDesc jobDesc;
+			jobDesc.func_ = EmptyJob;
+			jobDesc.name_ = "emptyJob";
+
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(&jobDesc, 1, &counter);
+			Job::Manager::WaitForCounter(counter, 0);
+		}
+	}
+
+	/**
+	 * Round trip of running a single job and waiting for it from another job.
+	 */
+	i64 BenchmarkWaitLatency()
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = WaitLatencyJob;
+		jobDesc.name_ = "waitLatencyJob";
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		return NUM_WAIT_ROUND_TRIPS;
+	}
+
+	static const i32 NUM_PRODUCERS = 64;
+	static const i32 NUM_CONSUMERS_PER_PRODUCER = 256;
+	static const i32 CONSUMER_WORK = 256;
+
+	void ConsumerJob(i32 param, void* data)
+	{
+		// Small amount of ALU work per job.
+		u32 value = (u32)param;
+		for(i32 i = 0; i < CONSUMER_WORK; ++i)
+			value = value * 1664525u + 1013904223u;
+		static_cast<u32*>(data)[param] = value;
+	}
+
+	void ProducerJob(i32 param, void* data)
+	{
+		Core::Vector<u32> results;
+		results.resize(NUM_CONSUMERS_PER_PRODUCER, 0);
+
+		Core::Vector<Job::JobDesc> jobDescs;
+		jobDescs.resize(NUM_CONSUMERS_PER_PRODUCER);
+		for(i32 i = 0; i < NUM_CONSUMERS_PER_PRODUCER; ++i)
+		{
+			jobDescs[i].func_ = ConsumerJob;
+			jobDescs[i].param_ = i;
+			jobDescs[i].data_ = results.data();
+			jobDescs[i].name_ = "consumerJob";
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+	}
+
+	/**
+	 * Producer jobs each fanning out to many small consumer jobs.
+	 */
+	i64 BenchmarkFanOut()
+	{
+		Core::Vector<Job::JobDesc> jobDescs;
+		jobDescs.resize(NUM_PRODUCERS);
+		for(i32 i = 0; i < NUM_PRODUCERS; ++i)
+		{
+			jobDescs[i].func_ = ProducerJob;
+			jobDescs[i].param_ = i;
+			jobDescs[i].name_ = "producerJob";
+		}
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		return NUM_PRODUCERS * (NUM_CONSUMERS_PER_PRODUCER + 1);
+	}
+
+	/// 3 arrays of 4M elements, large enough to not fit in cache.
+	static const i32 NUM_TRIAD_ELEMENTS = 4 * 1024 * 1024;
+	static const i32 TRIAD_MIN_GRAIN = 16 * 1024;
+	Core::Vector<f32> triadA_;
+	Core::Vector<f32> triadB_;
+	Core::Vector<f32> triadC_;
+
+	/**
+	 * Memory bound parallel for (STREAM triad: a = b + s * c).
+	 */
+	i64 BenchmarkParallelFor()
+	{
+		if(triadA_.size() != NUM_TRIAD_ELEMENTS)
+		{
+			triadA_.resize(NUM_TRIAD_ELEMENTS, 0.0f);
+			triadB_.resize(NUM_TRIAD_ELEMENTS, 1.0f);
+			triadC_.resize(NUM_TRIAD_ELEMENTS, 2.0f);
+		}
+
+		f32* outA = triadA_.data();
+		const f32* inB = triadB_.data();
+		const f32* inC = triadC_.data();
+		Job::ParallelFor(0, NUM_TRIAD_ELEMENTS, TRIAD_MIN_GRAIN, [outA, inB, inC](i32 begin, i32 end) {
+			for(i32 i = begin; i < end; ++i)
+				outA[i] = inB[i] + 3.0f * inC[i];
+		});
+		return (i64)NUM_TRIAD_ELEMENTS * sizeof(f32) * 3;
+	}
+
+	static const Benchmark BENCHMARKS[] = {
+	    {"empty_jobs", "jobs", BenchmarkEmptyJobs},
+	    {"fib", "jobs", BenchmarkFib},
+	    {"wait_latency", "round_trips", BenchmarkWaitLatency},
+	    {"fan_out", "jobs", BenchmarkFanOut},
+	    {"parallel_for_triad", "bytes", BenchmarkParallelFor},
+	};
+
+	BenchmarkResult RunBenchmark(const Benchmark& benchmark, i32 numWorkers, i32 numRepeats)
+	{
+		BenchmarkResult result;
+		result.name_ = benchmark.name_;
+		result.unit_ = benchmark.unit_;
+		result.numWorkers_ = numWorkers;
+
+		// Warm up, so fibers, counters and memory are touched before timing.
+		benchmark.func_();
+
+		f64 totalTime = 0.0;
+		result.bestTime_ = 1.0e30;
+		for(i32 repeat = 0; repeat < numRepeats; ++repeat)
+		{
+			Core::Timer timer;
+			timer.Mark();
+			result.workDone_ = benchmark.func_();
+			const f64 time = timer.GetTime();
+			totalTime += time;
+			result.bestTime_ = Core::Min(result.bestTime_, time);
+		}
+		result.meanTime_ = totalTime / (f64)numRepeats;
+		return result;
+	}
+
+	void WriteJson(Core::String& outJson, const BenchmarkSettings& settings, const Core::Vector<BenchmarkResult>& results)
+	{
+		outJson.Printf("{\n\t\"numLogicalCores\": %i,\n\t\"numPhysicalCores\": %i,\n\t\"numFibers\": %i,\n"
+		               "\t\"fiberStackSize\": %i,\n\t\"numRepeats\": %i,\n\t\"results\": [",
+		    Core::GetNumLogicalCores(), Core::GetNumPhysicalCores(), settings.numFibers_, settings.fiberStackSize_,
+		    settings.numRepeats_);
+
+		for(i32 i = 0; i < results.size(); ++i)
+		{
+			const auto& result = results[i];
+			outJson.Appendf("%s\n\t\t{\"benchmark\": \"%s\", \"numWorkers\": %i, \"unit\": \"%s\", \"workDone\": %lld, "
+			                "\"bestMs\": %.4f, \"meanMs\": %.4f, \"perSecond\": %.1f}",
+			    i > 0 ? "," : "", result.name_, result.numWorkers_, result.unit_, (long long)result.workDone_,
+			    result.bestTime_ * 1000.0, result.meanTime_ * 1000.0, (f64)result.workDone_ / result.bestTime_);
+		}
+		outJson.Append("\n\t]\n}\n");
+	}
+
+	i32 GetIntArg(const Core::CommandLine& cmdLine, const char s, const char* l, i32 defaultValue)
+	{
+		Core::String arg;
+		if(cmdLine.GetArg(s, l, arg))
+			return atoi(arg.c_str());
+		return defaultValue;
+	}
+}
+
+int main(int argc, char* const argv[])
+{
+	Core::CommandLine cmdLine(argc, argv);
+
+	BenchmarkSettings settings;
+	settings.maxWorkers_ = Core::Max(1, GetIntArg(cmdLine, 'w', "workers", Core::GetNumLogicalCores()));
+	settings.numFibers_ = Core::Max(1, GetIntArg(cmdLine, 'f', "fibers", DEFAULT_NUM_FIBERS));
+	settings.fiberStackSize_ = Core::Max(4096, GetIntArg(cmdLine, 's', "stack-size", DEFAULT_FIBER_STACK_SIZE));
+	settings.numRepeats_ = Core::Max(1, GetIntArg(cmdLine, 'r', "repeats", DEFAULT_NUM_REPEATS));
+	cmdLine.GetArg('b', "benchmark", settings.filter_);
+	cmdLine.GetArg('o', "output", settings.outputPath_);
+
+	// Waiting jobs hold onto their fibers, so there must be at least one more fiber than can be waiting at once.
+	// Rounded up to a power of 2, as that's what the job manager's queues are sized to anyway.
+	const i32 minFibers = (i32)Core::PotNext((u32)Core::Max(GetNumFibWaitingJobs(FIB_N), NUM_PRODUCERS) + 1);
+	if(settings.numFibers_ < minFibers)
+	{
+		Core::Log("%i fibers would deadlock, using the minimum of %i instead.\n", settings.numFibers_, minFibers);
+		settings.numFibers_ = minFibers;
+	}
+
+	Core::Vector<BenchmarkResult> results;
+	for(i32 numWorkers = 1; numWorkers <= settings.maxWorkers_; ++numWorkers)
+	{
+		Job::Manager::Scoped manager(numWorkers, settings.numFibers_, settings.fiberStackSize_);
+		for(const auto& benchmark : BENCHMARKS)
+		{
+			if(settings.filter_.size() > 0 && strstr(benchmark.name_, settings.filter_.c_str()) == nullptr)
+				continue;
+
+			results.push_back(RunBenchmark(benchmark, numWorkers, settings.numRepeats_));
+			const auto& result = results.back();
+			Core::Log("%-20s workers: %2i  best: %10.4f ms  mean: %10.4f ms  %14.1f %s/s\n", result.name_,
+			    result.numWorkers_, result.bestTime_ * 1000.0, result.meanTime_ * 1000.0,
+			    (f64)result.workDone_ / result.bestTime_, result.unit_);
+		}
+	}
+
+	Core::Vector<f32>().swap(triadA_);
+	Core::Vector<f32>().swap(triadB_);
+	Core::Vector<f32>().swap(triadC_);
+
+	Core::String json;
+	WriteJson(json, settings, results);
+	if(settings.outputPath_.size() > 0)
+	{
+		Core::File file(settings.outputPath_.c_str(), Core::FileFlags::DEFAULT_WRITE);
+		if(!file || file.Write(json.c_str(), json.size()) != json.size())
+		{
+			Core::Log("Failed to write \"%s\"\n", settings.outputPath_.c_str());
+			return 1;
+		}
+	}
+	else
+	{
+		Core::Log("%s", json.c_str());
+	}
+
+	return 0;
+}
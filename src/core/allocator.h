@@ -10,6 +10,7 @@
 namespace Core
 {
 	class IAllocator;
+	class File;
 }
 
 namespace Core
@@ -33,8 +34,16 @@ namespace Core
 	 * Create allocation tracker.
 	 * @param Allocator to use.
 	 * @param name Name to assign to the tracker.
+	 * @param sampleInterval Mean bytes between sampled allocations, 0 to track all allocations.
 	 */
-	CORE_DLL IAllocator& CreateAllocationTracker(IAllocator& allocator, const char* name);
+	CORE_DLL IAllocator& CreateAllocationTracker(IAllocator& allocator, const char* name, i64 sampleInterval = 0);
+
+	/**
+	 * Write heap profiles for all allocation trackers.
+	 * @param file File to write to.
+	 * @return false if write failed.
+	 */
+	CORE_DLL bool WriteHeapProfiles(File& file);
 
 	/**
 	 * Allocator stats.
@@ -85,6 +94,7 @@ namespace Core
 
 	/**
 	 * Allocator for use with containers.
+	 * Container allocators that compare equal can free each other's allocations.
 	 */
 	class CORE_DLL ContainerAllocator
 	{
@@ -95,6 +105,9 @@ namespace Core
 
 		void* Allocate(i64 size, i64 align) { return GeneralAllocator().Allocate(size, align); }
 		void Deallocate(void* mem) { GeneralAllocator().Deallocate(mem); }
+
+		bool operator==(const ContainerAllocator& other) const { return true; }
+		bool operator!=(const ContainerAllocator& other) const { return false; }
 	};
 
 } // namespace Core
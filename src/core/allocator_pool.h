@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Fixed size pool allocator.
+	 * Objects are carved from slabs allocated from the parent allocator, and freed objects go
+	 * onto a lock-free free list. Each thread has a small magazine of free objects in front of
+	 * the free list, so most allocations and frees touch no shared state. Slabs are only
+	 * returned to the parent on destruction.
+	 * Threads may outlive the allocator, and objects can be freed on any thread.
+	 */
+	class CORE_DLL AllocatorPool : public IAllocator
+	{
+	public:
+		/**
+		 * @param objectSize Size of each object.
+		 * @param objectAlign Alignment of each object, must be a power of 2.
+		 * @param slabSize Size of each slab allocated from @a parent, rounded up to a power of 2.
+		 * @param parent Thread safe parent allocator to allocate slabs from.
+		 */
+		AllocatorPool(i64 objectSize, i64 objectAlign, i64 slabSize = 64 * 1024, IAllocator& parent = GeneralAllocator());
+		~AllocatorPool();
+
+		/// @pre @a bytes and @a align must fit within the object size and alignment.
+		void* Allocate(i64 bytes, i64 align) override;
+		void Deallocate(void* mem) override;
+		bool OwnAllocation(void* mem) override;
+		i64 GetAllocationSize(void* mem) override;
+		/// Peak usage is tracked at the granularity of magazine refills.
+		AllocatorStats GetStats() const override;
+		void LogStats() const override;
+
+		/**
+		 * Flush the calling thread's magazine back to the shared free list.
+		 */
+		void FlushThreadMagazine();
+
+	private:
+		AllocatorPool(const AllocatorPool&) = delete;
+		AllocatorPool& operator=(const AllocatorPool&) = delete;
+
+		struct AllocatorPoolImpl* impl_ = nullptr;
+	};
+
+	/**
+	 * Typed pool allocator for objects of @a TYPE.
+	 */
+	template<typename TYPE>
+	class PoolAllocator
+	{
+	public:
+		/**
+		 * @param slabSize Size of each slab allocated from @a parent.
+		 * @param parent Thread safe parent allocator to allocate slabs from.
+		 */
+		PoolAllocator(i64 slabSize = 64 * 1024, IAllocator& parent = GeneralAllocator())
+		    : allocator_(sizeof(TYPE), alignof(TYPE), slabSize, parent)
+		{
+		}
+
+		template<typename... ARGS>
+		TYPE* New(ARGS&&... args)
+		{
+			void* mem = allocator_.Allocate(sizeof(TYPE), alignof(TYPE));
+			return mem ? new(mem) TYPE(std::forward<ARGS>(args)...) : nullptr;
+		}
+
+		void Delete(TYPE* obj)
+		{
+			if(obj)
+			{
+				obj->~TYPE();
+				allocator_.Deallocate(obj);
+			}
+		}
+
+		AllocatorPool& GetAllocator() { return allocator_; }
+		AllocatorStats GetStats() const { return allocator_.GetStats(); }
+
+	private:
+		AllocatorPool allocator_;
+	};
+
+} // namespace Core
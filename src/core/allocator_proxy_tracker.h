@@ -5,14 +5,25 @@
 
 namespace Core
 {
+
 	/**
 	 * Tracker allocator proxy.
 	 * This is used to track allocations and their callstacks.
+	 * By default every allocation is tracked under a lock, which is thorough but slow. In sampling
+	 * mode allocations are instead sampled on average every @a sampleInterval bytes, and only sampled
+	 * allocations have their callstacks recorded. These are aggregated by call site and weighted to
+	 * estimate the whole heap, cheaply enough to leave enabled. Stats are then estimates too, as
+	 * unsampled allocations aren't counted.
 	 */
 	class CORE_DLL AllocatorProxyTracker final : public IAllocator
 	{
 	public:
-		AllocatorProxyTracker(IAllocator& allocator, const char* name);
+		/**
+		 * @param allocator Allocator to track.
+		 * @param name Name of tracker for logging.
+		 * @param sampleInterval Mean number of bytes between sampled allocations, 0 to track all allocations.
+		 */
+		AllocatorProxyTracker(IAllocator& allocator, const char* name, i64 sampleInterval = 0);
 		~AllocatorProxyTracker();
 
 		void* Allocate(i64 bytes, i64 align) override;
@@ -23,6 +34,15 @@ namespace Core
 		void LogStats() const override;
 		void LogAllocs() const override;
 
+		/**
+		 * Write heap profile of live allocations by call site, largest first.
+		 * Each line is "live_bytes live_objects alloc_bytes alloc_objects: callstack", with symbol
+		 * names rather than addresses so profiles from different runs can be diffed.
+		 * In sampling mode values are estimates scaled up from the samples. Otherwise only live
+		 * allocations are known, so the alloc columns match the live ones.
+		 */
+		bool WriteHeapProfile(File& file) const;
+
 	private:
 		struct AllocatorProxyTrackerImpl* impl_;
 	};
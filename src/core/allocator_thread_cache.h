@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Thread caching allocator proxy.
+	 * Small allocations are served from per-thread size class free lists, so the common case
+	 * takes no locks. Thread caches refill from and flush to shared per size class lists of
+	 * spans in batches. Spans are reserved from the parent allocator in larger regions, and are
+	 * returned to their region once all of their blocks are freed. Regions are returned to the
+	 * parent once empty, bar one kept spare.
+	 * Memory freed on a different thread to the one that allocated it goes into the freeing
+	 * thread's cache, so no cross-thread synchronisation is needed. Large or over-aligned
+	 * allocations are passed straight through to the parent.
+	 * The parent allocator must be thread safe. Threads that have used this allocator must
+	 * have exited before it is destroyed, other than the one destroying it. This is asserted.
+	 */
+	class CORE_DLL AllocatorThreadCache : public IAllocator
+	{
+	public:
+		/// Largest allocation size served from thread caches.
+		static const i64 MAX_SMALL_SIZE = 2048;
+		/// Largest alignment served from thread caches.
+		static const i64 MAX_SMALL_ALIGN = 16;
+
+		/**
+		 * @param parent Thread safe parent allocator to allocate spans and large allocations from.
+		 */
+		AllocatorThreadCache(IAllocator& parent);
+		~AllocatorThreadCache();
+
+		void* Allocate(i64 bytes, i64 align) override;
+		void Deallocate(void* mem) override;
+		bool OwnAllocation(void* mem) override;
+		i64 GetAllocationSize(void* mem) override;
+		AllocatorStats GetStats() const override;
+		void LogStats() const override;
+		void LogAllocs() const override;
+
+		/**
+		 * Flush the calling thread's cached memory back to the shared lists.
+		 */
+		void FlushThreadCache();
+
+	private:
+		AllocatorThreadCache(const AllocatorThreadCache&) = delete;
+		AllocatorThreadCache& operator=(const AllocatorThreadCache&) = delete;
+
+		struct AllocatorThreadCacheImpl* impl_ = nullptr;
+	};
+
+} // namespace Core
@@ -9,16 +9,23 @@ namespace Core
 	/**
 	 * Virtual memory allocator.
 	 * Will allocate/deallocate virtual memory directly from the operating system.
+	 * Address space is reserved inaccessible, and only the requested bytes are committed.
 	 * This is not considered to be a cheap or general purpose allocator.
 	 * It is thread safe.
 	 */
 	class CORE_DLL AllocatorVirtual : public IAllocator
 	{
 	public:
+		/// Allocations of at least this size are eligible for huge pages.
+		static const i64 HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
 		/**
 		 * @param enableGuardPages Enable guard pages around allocations.
+		 * @param enableHugePages Align allocations of HUGE_PAGE_SIZE or larger to it, and advise the
+		 * OS to back them with transparent huge pages. Ignored on platforms without transparent huge
+		 * pages (currently all but Linux).
 		 */
-		AllocatorVirtual(bool enableGuardPages);
+		AllocatorVirtual(bool enableGuardPages, bool enableHugePages = true);
 		~AllocatorVirtual();
 
 		void* Allocate(i64 bytes, i64 align) override;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/allocator.h"
+
+namespace Core
+{
+	/**
+	 * Scoped arena.
+	 * Allocates linearly from chunks taken from the parent allocator, individual allocations are
+	 * never freed. Everything is released at once when the arena goes out of scope, or on Reset.
+	 * Not thread safe, intended for temporary allocations made by a single thread.
+	 */
+	class CORE_DLL ScopedArena
+	{
+	public:
+		/**
+		 * @param chunkSize Size of each chunk allocated from @a allocator.
+		 * @param allocator Allocator to allocate chunks from.
+		 */
+		ScopedArena(i32 chunkSize = 64 * 1024, IAllocator& allocator = GeneralAllocator());
+		~ScopedArena();
+
+		/**
+		 * Release all allocations.
+		 * The first chunk is kept for reuse, all others are freed.
+		 */
+		void Reset();
+
+		/**
+		 * Allocate.
+		 * @param bytes Number of bytes to allocate.
+		 * @param align Alignment, must be a power of 2.
+		 * @return Valid pointer if allocation was successful, nullptr if it wasn't.
+		 */
+		void* Allocate(i64 bytes, i64 align = PLATFORM_ALIGNMENT)
+		{
+			u8* mem = reinterpret_cast<u8*>(((i64)curr_ + (align - 1)) & ~(align - 1));
+			if(curr_ != nullptr && mem + bytes <= end_)
+			{
+				curr_ = mem + bytes;
+				return mem;
+			}
+			return AllocateSlow(bytes, align);
+		}
+
+		/**
+		 * @return Total number of bytes allocated from the arena.
+		 */
+		i64 GetUsedBytes() const { return usedBytes_ + (curr_ - begin_); }
+
+		/**
+		 * @return Number of chunks allocated from the parent allocator.
+		 */
+		i32 GetNumChunks() const { return numChunks_; }
+
+	private:
+		ScopedArena(const ScopedArena&) = delete;
+		ScopedArena& operator=(const ScopedArena&) = delete;
+
+		struct Chunk;
+		void* AllocateSlow(i64 bytes, i64 align);
+
+		IAllocator& allocator_;
+		i32 chunkSize_ = 0;
+		Chunk* chunks_ = nullptr;
+		i32 numChunks_ = 0;
+		/// Bytes used in all chunks before the current one.
+		i64 usedBytes_ = 0;
+		u8* begin_ = nullptr;
+		u8* curr_ = nullptr;
+		u8* end_ = nullptr;
+	};
+
+	/**
+	 * Allocator for use with containers, allocating from a ScopedArena.
+	 * Deallocate is a no-op, memory is released when the arena goes out of scope. Containers
+	 * using it must not outlive their arena.
+	 * A default constructed allocator has no arena and behaves as ContainerAllocator.
+	 */
+	class ArenaAllocator
+	{
+	public:
+		ArenaAllocator() = default;
+		ArenaAllocator(ScopedArena& arena)
+		    : arena_(&arena)
+		{
+		}
+		ArenaAllocator(const ArenaAllocator&) = default;
+		~ArenaAllocator() = default;
+
+		void* Allocate(i64 size, i64 align)
+		{
+			return arena_ ? arena_->Allocate(size, align) : GeneralAllocator().Allocate(size, align);
+		}
+
+		void Deallocate(void* mem)
+		{
+			if(arena_ == nullptr)
+				GeneralAllocator().Deallocate(mem);
+		}
+
+		ScopedArena* GetArena() const { return arena_; }
+
+		bool operator==(const ArenaAllocator& other) const { return arena_ == other.arena_; }
+		bool operator!=(const ArenaAllocator& other) const { return arena_ != other.arena_; }
+
+	private:
+		ScopedArena* arena_ = nullptr;
+	};
+
+} // namespace Core
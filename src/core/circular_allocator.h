@@ -1,26 +1,37 @@
 #pragma once
 
 #include "core/types.h"
-#include "core/concurrency.h"
-#include "core/vector.h"
+#include "core/allocator.h"
+#include "core/portability.h"
 
 namespace Core
 {
+	/**
+	 * Lock-free circular allocator, intended for streaming data such as per-frame uploads.
+	 * Any number of threads can allocate concurrently, reserving space by advancing a shared head.
+	 * Allocations that would straddle the end of the buffer skip the remaining bytes as padding
+	 * and wrap around to the start.
+	 * Allocations are not released individually. Instead a marker is taken at the end of a frame,
+	 * and once that frame's work has completed (i.e. its fence has been signalled) everything
+	 * allocated before the marker is released at once.
+	 */
 	class CORE_DLL CircularAllocator
 	{
 	public:
-		CircularAllocator(i32 size, i32 alignment = PLATFORM_ALIGNMENT);
-		~CircularAllocator();
+		/// Position in the allocator. Releasing it releases everything allocated before it.
+		using Marker = i64;
 
 		/**
-		 * Release a number of bytes.
-		 * @param bytes Number of bytes to release.
+		 * @param size Size of buffer, must be a power of 2.
+		 * @param alignment Alignment of all allocations, must be a power of 2.
+		 * @param allocator Allocator to allocate buffer from.
 		 */
-		void Release(i32 bytes);
+		CircularAllocator(i32 size, i32 alignment = PLATFORM_ALIGNMENT, IAllocator& allocator = GeneralAllocator());
+		~CircularAllocator();
 
 		/**
 		 * Allocate.
-		 * @return Valid pointer if allocation was successful, nullptr if it wasn't.
+		 * @return Valid pointer if allocation was successful, nullptr if there isn't enough space.
 		 */
 		void* Allocate(i32 bytes);
 
@@ -34,16 +45,44 @@ namespace Core
 			return reinterpret_cast<TYPE*>(Allocate(count * sizeof(TYPE)));
 		}
 
+		/**
+		 * @return Marker for everything allocated so far.
+		 * Allocations still in progress on other threads may or may not be included, so this should
+		 * be taken once all allocations for the frame are complete.
+		 */
+		Marker GetMarker() const { return head_; }
+
+		/**
+		 * Release everything allocated before @a marker.
+		 * Markers may be released out of order, older ones are ignored.
+		 */
+		void Release(Marker marker);
+
+		/**
+		 * @return Number of bytes allocated and not yet released, including padding.
+		 */
+		i32 GetUsedBytes() const { return (i32)(head_ - tail_); }
+
+		/**
+		 * @return Size of buffer.
+		 */
+		i32 GetSize() const { return size_; }
+
 	private:
 		CircularAllocator(const CircularAllocator&) = delete;
+		CircularAllocator& operator=(const CircularAllocator&) = delete;
 
-		Core::Vector<u8> base_;
-		i32 size_;
-		i32 mask_;
-		i32 alignment_;
+		IAllocator& allocator_;
+		u8* base_ = nullptr;
+		i32 size_ = 0;
+		i32 mask_ = 0;
+		i32 alignment_ = 0;
 
-		Core::SpinLock spinLock_;
-		volatile u64 offset_;
-		volatile u64 released_;
+		/// Total bytes reserved, only ever increases.
+		volatile i64 head_ = 0;
+		/// Keep releasing off the cache line that allocating threads contend on.
+		u8 pad_[CACHE_LINE_SIZE - sizeof(i64)];
+		/// Total bytes released, only ever increases.
+		volatile i64 tail_ = 0;
 	};
 } // namespace Core
@@ -171,6 +171,7 @@ namespace Core
 
 		/**
 		 * Create fiber.
+		 * Stack is reserved up front with a guard page below it, but only committed as it is used.
 		 * @param entryPointFunc Entry point for thread to call.
 		 * @param userData User data to pass to thread.
 		 * @param stackSize Size of stack for thread.
@@ -206,6 +207,14 @@ namespace Core
 		 */
 		static Fiber* GetCurrentFiber();
 
+		/**
+		 * Get peak stack usage in bytes.
+		 * Stack memory is zero filled by the OS when committed, so this scans committed pages for the
+		 * deepest non-zero word. Only intended for telemetry to size stacks, as it is not cheap.
+		 * @return Peak stack usage. 0 if the fiber was created from a thread.
+		 */
+		i32 GetPeakStackUsage() const;
+
 		/**
 		 * @return Is thread valid?
 		 */
@@ -252,13 +261,65 @@ namespace Core
 		Semaphore(const Semaphore&) = delete;
 
 		struct SemaphoreImpl* Get();
-		u8 implData_[32];
+		u8 implData_[40];
 
 #if !defined(_RELEASE)
 		const char* debugName_ = nullptr;
 #endif
 	};
 
+	/**
+	 * Event count.
+	 * Lets threads sleep until a condition changes without lost wakeups, and without notifiers
+	 * paying for a kernel call when nobody is sleeping.
+	 *
+	 * Waiter:
+	 *   ec.PrepareWait();
+	 *   if(condition) ec.CancelWait(); else ec.Wait();
+	 *
+	 * Notifier:
+	 *   (make condition true)
+	 *   ec.Notify(1);
+	 */
+	class CORE_DLL EventCount final
+	{
+	public:
+		EventCount(const char* debugName = nullptr);
+		~EventCount();
+
+		/**
+		 * Register as a waiter. Must be followed by rechecking the condition, then either CancelWait or Wait.
+		 */
+		void PrepareWait();
+
+		/**
+		 * Cancel wait after PrepareWait, if condition was met.
+		 */
+		void CancelWait();
+
+		/**
+		 * Wait after PrepareWait until notified.
+		 */
+		void Wait();
+
+		/**
+		 * Wake up to @a count waiters.
+		 */
+		void Notify(i32 count);
+
+		/**
+		 * Wake all waiters.
+		 */
+		void NotifyAll();
+
+	private:
+		EventCount(const EventCount&) = delete;
+
+		/// Number of registered waiters that have not yet been notified.
+		volatile i32 numWaiters_ = 0;
+		Semaphore sem_;
+	};
+
 	/**
 	 * Simple spin lock that'll yield.
 	 */
@@ -89,7 +89,7 @@ namespace Core
 #define DBG_ASSERT_MSG(Condition, Message, ...)                                                                        \
 	if(!(Condition))                                                                                                   \
 	{                                                                                                                  \
-		if(Core::AssertInternal(Message, __FILE__, __LINE__, __VA_ARGS__))                                             \
+		if(Core::AssertInternal(Message, __FILE__, __LINE__, ##__VA_ARGS__))                                           \
 			DBG_BREAK;                                                                                                 \
 	}
 #define DBG_ASSERT(Condition)                                                                                          \
@@ -2,6 +2,7 @@
 
 #include "core/dll.h"
 #include "core/types.h"
+#include "core/vector.h"
 
 // Forward declarations.
 extern "C" {
@@ -21,6 +22,28 @@ namespace Core
 		explicit operator bool() const { return offset_ >= 0 && size_ > 0; }
 	};
 
+	/// Allocator stats.
+	struct ExternalAllocatorStats
+	{
+		i32 size_ = 0;
+		i32 usedSize_ = 0;
+		i32 freeSize_ = 0;
+		i32 largestFreeRange_ = 0;
+		i32 numAllocs_ = 0;
+		i32 numFreeRanges_ = 0;
+		/// 0 when free space is contiguous, approaching 1 as it is split into smaller ranges.
+		f32 fragmentation_ = 0.0f;
+	};
+
+	/// Move of an allocation's data, planned by ExternalAllocator::PlanCompaction.
+	struct ExternalMove
+	{
+		u16 id_ = 0;
+		i32 srcOffset_ = -1;
+		i32 dstOffset_ = -1;
+		i32 size_ = -1;
+	};
+
 	/**
 	 * External allocator where metadata should not be stored within target memory.
 	 * This uses Mykhailo Parfeniuk's external TLSF implementation.
@@ -60,6 +83,30 @@ namespace Core
 		 */
 		ExternalAlloc GetAlloc(u16 id) const;
 
+		/**
+		 * Get stats, including fragmentation of free space.
+		 * Walks all ranges, so not intended to be called every allocation.
+		 */
+		ExternalAllocatorStats GetStats() const;
+
+		/**
+		 * Plan compaction, sliding allocations down in address order to merge free ranges.
+		 * Allocations already in place are not moved.
+		 * With a required size, moving the allocations out of the cheapest window of ranges that large into
+		 * free ranges elsewhere is planned instead when that copies fewer bytes.
+		 * @param requiredSize Stop once a free range of this size would exist, 0 to compact fully.
+		 * If there isn't enough free space in total, compaction is planned fully.
+		 * @return Moves, in the order they must be applied. Source and destination may overlap, so
+		 * copies must be done in order and behave like memmove.
+		 */
+		Core::Vector<ExternalMove> PlanCompaction(i32 requiredSize = 0) const;
+
+		/**
+		 * Apply moves from PlanCompaction, with no allocations or frees since planning.
+		 * Allocation ids are unchanged, only their offsets, so callers just need to copy data.
+		 */
+		void ApplyCompaction(const Core::Vector<ExternalMove>& moves);
+
 	private:
 		ExternalAllocator(const ExternalAllocator&) = delete;
 		ExternalAllocator& operator=(const ExternalAllocator&) = delete;
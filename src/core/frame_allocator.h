@@ -0,0 +1,81 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/allocator.h"
+#include "core/concurrency.h"
+
+namespace Core
+{
+	/**
+	 * Multithreaded per-frame linear allocator.
+	 * Each thread allocates linearly from its own chunk without any synchronisation, taking a
+	 * new chunk from a shared pool when it runs out, so there is no fixed upper bound.
+	 * Allocations are never freed individually, instead Reset releases everything at once and
+	 * returns chunks to the pool for reuse next frame.
+	 * Allocations larger than half a chunk get a dedicated chunk which is freed on Reset.
+	 */
+	class CORE_DLL FrameAllocator
+	{
+	public:
+		/**
+		 * @param chunkSize Size of each chunk handed out to threads.
+		 * @param allocator Allocator to allocate chunks from.
+		 */
+		FrameAllocator(i32 chunkSize = 256 * 1024, IAllocator& allocator = GeneralAllocator());
+		~FrameAllocator();
+
+		/**
+		 * Release all allocations, returning chunks to the pool.
+		 * Must not be called whilst any thread is allocating.
+		 */
+		void Reset();
+
+		/**
+		 * Allocate.
+		 * @param bytes Number of bytes to allocate.
+		 * @param align Alignment, must be a power of 2.
+		 * @return Valid pointer if allocation was successful, nullptr if it wasn't.
+		 */
+		void* Allocate(i32 bytes, i32 align = PLATFORM_ALIGNMENT);
+
+		/**
+		 * Allocate enough memory for @a count objects of @a TYPE
+		 * @return Enough memory for objects, non-constructed. nullptr if unable to allocate.
+		 */
+		template<typename TYPE>
+		TYPE* Allocate(i32 count)
+		{
+			return reinterpret_cast<TYPE*>(Allocate(count * sizeof(TYPE), alignof(TYPE)));
+		}
+
+		/**
+		 * @return Number of chunks in use this frame.
+		 */
+		i32 GetNumUsedChunks() const { return numUsedChunks_; }
+
+		/**
+		 * @return Number of chunks allocated in total, including those in the pool.
+		 */
+		i32 GetNumChunks() const { return numChunks_; }
+
+	private:
+		FrameAllocator(const FrameAllocator&) = delete;
+		FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+		struct Chunk;
+		void* AllocateSlow(i32 bytes, i32 align);
+		Chunk* AllocateChunk(i64 size);
+
+		IAllocator& allocator_;
+		i32 chunkSize_ = 0;
+		/// Unique per allocator, so stale thread chunks can be told apart from current ones.
+		u32 id_ = 0;
+		volatile i32 frame_ = 0;
+
+		Core::SpinLock lock_;
+		Chunk* usedChunks_ = nullptr;
+		Chunk* freeChunks_ = nullptr;
+		volatile i32 numUsedChunks_ = 0;
+		i32 numChunks_ = 0;
+	};
+} // namespace Core
@@ -3,6 +3,12 @@
 #include "core/dll.h"
 #include "core/types.h"
 
+#include <cstring>
+
+#if COMPILER_MSVC && ARCH_X86_64
+#include <intrin.h>
+#endif
+
 namespace Core
 {
 	/**
@@ -40,11 +46,75 @@ namespace Core
 	CORE_DLL u32 HashCRC32(u32 Input, const void* pInData, size_t Size);
 	CORE_DLL u32 HashSDBM(u32 Input, const void* pInData, size_t Size);
 
+	/**
+	 * CRC-32C (Castagnoli).
+	 * Uses the SSE4.2 crc32 instruction when the CPU supports it, otherwise a slice-by-8 table
+	 * implementation. Both produce the same result. Not compatible with HashCRC32.
+	 */
+	CORE_DLL u32 HashCRC32C(u32 input, const void* pInData, size_t size);
+
+	namespace Detail
+	{
+		/// HashCRC32C implementations, exposed so both can be tested on CPUs with SSE4.2.
+		CORE_DLL u32 HashCRC32CSoftware(u32 input, const void* pInData, size_t size);
+		CORE_DLL bool HasHashCRC32CHardware();
+		/// @pre HasHashCRC32CHardware().
+		CORE_DLL u32 HashCRC32CHardware(u32 input, const void* pInData, size_t size);
+	} // namespace Detail
+
 	/**
 	 * 64-bit hashing algorithms.
 	 */
 	CORE_DLL u64 HashFNV1a(u64 input, const void* pInData, size_t size);
 
+	/**
+	 * wyhash (final version 4).
+	 * Processes up to 48 bytes per step using 64x64->128-bit multiplies, and is much faster than
+	 * HashFNV1a beyond a few bytes. Prefer it for in-memory hashing, but avoid it for hashes that are
+	 * stored in files, as existing data uses HashFNV1a/HashCRC32.
+	 */
+	CORE_DLL u64 HashWyhash(u64 input, const void* pInData, size_t size);
+
+	namespace Detail
+	{
+		/// 64x64->128-bit multiply, low half returned in a, high half in b.
+		inline void HashMul128(u64& a, u64& b)
+		{
+#if defined(__SIZEOF_INT128__)
+			__uint128_t r = a;
+			r *= b;
+			a = (u64)r;
+			b = (u64)(r >> 64);
+#elif COMPILER_MSVC && ARCH_X86_64
+			a = _umul128(a, b, &b);
+#else
+			const u64 ha = a >> 32, hb = b >> 32, la = (u32)a, lb = (u32)b;
+			const u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			const u64 t = rl + (rm0 << 32);
+			u64 c = t < rl;
+			const u64 lo = t + (rm1 << 32);
+			c += lo < t;
+			a = lo;
+			b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+		}
+
+		inline u64 HashMix(u64 a, u64 b)
+		{
+			HashMul128(a, b);
+			return a ^ b;
+		}
+	} // namespace Detail
+
+	/**
+	 * Mix a 64-bit value into hash @a input.
+	 * Much cheaper than hashing the value's bytes, for use with integer, pointer and handle keys.
+	 */
+	inline u64 HashMix64(u64 input, u64 value)
+	{
+		return Detail::HashMix(value ^ 0x2d358dccaa6c78a5ull, input ^ 0x8bb84b93962eacc9ull);
+	}
+
 	/**
 	 * Templated hash function to ensure users define their own.
 	 */
@@ -78,4 +148,71 @@ namespace Core
 		u64 operator()(u64 input, const TYPE& data) const { return Hash(input, data); }
 	};
 
+	/**
+	 * Hasher for integer keys, mixing the value rather than hashing its bytes.
+	 * Containers only keep hashes in memory, so don't need to match Hash.
+	 */
+	template<typename TYPE>
+	class IntegerHasher
+	{
+	public:
+		u64 operator()(u64 input, TYPE data) const { return HashMix64(input, (u64)data); }
+	};
+
+	template<>
+	class Hasher<u8> : public IntegerHasher<u8>
+	{
+	};
+	template<>
+	class Hasher<u16> : public IntegerHasher<u16>
+	{
+	};
+	template<>
+	class Hasher<u32> : public IntegerHasher<u32>
+	{
+	};
+	template<>
+	class Hasher<u64> : public IntegerHasher<u64>
+	{
+	};
+	template<>
+	class Hasher<i8> : public IntegerHasher<i8>
+	{
+	};
+	template<>
+	class Hasher<i16> : public IntegerHasher<i16>
+	{
+	};
+	template<>
+	class Hasher<i32> : public IntegerHasher<i32>
+	{
+	};
+	template<>
+	class Hasher<i64> : public IntegerHasher<i64>
+	{
+	};
+
+	/**
+	 * Hasher for pointer keys, hashing the address.
+	 */
+	template<typename TYPE>
+	class Hasher<TYPE*>
+	{
+	public:
+		u64 operator()(u64 input, const TYPE* data) const { return HashMix64(input, (u64)(uintptr_t)data); }
+	};
+
+	/// C strings hash their contents.
+	template<>
+	class Hasher<const char*>
+	{
+	public:
+		u64 operator()(u64 input, const char* data) const { return HashWyhash(input, data, strlen(data)); }
+	};
+
+	template<>
+	class Hasher<char*> : public Hasher<const char*>
+	{
+	};
+
 } // namespace Core
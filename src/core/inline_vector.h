@@ -0,0 +1,358 @@
+#pragma once
+
+#include "core/types.h"
+#include "core/allocator.h"
+#include "core/array_view.h"
+#include "core/debug.h"
+
+#include <cstring>
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Vector of elements with inline storage.
+	 * Up to INLINE_SIZE elements are stored within the vector itself, beyond that it falls back to
+	 * allocating from ALLOCATOR like Vector. Intended for short lived temporaries on the stack, where
+	 * the typical number of elements is small and known.
+	 * As data can point into the vector itself it is not trivially relocatable, moving it will
+	 * move the inline elements one by one.
+	 */
+	template<typename TYPE, i32 INLINE_SIZE, typename ALLOCATOR = ContainerAllocator>
+	class InlineVector
+	{
+	public:
+		static_assert(INLINE_SIZE > 0, "INLINE_SIZE must be greater than 0. Use Vector instead.");
+
+		using index_type = i32;
+		using value_type = TYPE;
+		using iterator = value_type*;
+		using const_iterator = const value_type*;
+
+		InlineVector() = default;
+
+		InlineVector(const ALLOCATOR& allocator)
+		    : allocator_(allocator)
+		{
+		}
+
+		InlineVector(const InlineVector& other)
+		    : allocator_(other.allocator_)
+		{
+			reserve(other.size_);
+			for(index_type idx = 0; idx < other.size_; ++idx)
+				new(data_ + idx) TYPE(other.data_[idx]);
+			size_ = other.size_;
+		}
+
+		InlineVector(InlineVector&& other)
+		    : allocator_(other.allocator_)
+		{
+			internalMove(other);
+		}
+
+		InlineVector(index_type size, const TYPE& value = TYPE()) { resize(size, value); }
+
+		~InlineVector()
+		{
+			clear();
+			internalFree();
+		}
+
+		InlineVector& operator=(const InlineVector& other)
+		{
+			if(this == &other)
+				return *this;
+
+			// destruct, freeing with the allocator the data came from.
+			clear();
+			internalFree();
+
+			allocator_ = other.allocator_;
+			reserve(other.size_);
+			for(index_type idx = 0; idx < other.size_; ++idx)
+				new(data_ + idx) TYPE(other.data_[idx]);
+			size_ = other.size_;
+			return *this;
+		}
+
+		InlineVector& operator=(InlineVector&& other)
+		{
+			if(this == &other)
+				return *this;
+
+			clear();
+			internalFree();
+
+			allocator_ = other.allocator_;
+			internalMove(other);
+			return *this;
+		}
+
+		operator ArrayView<TYPE>() { return ArrayView<TYPE>(data_, size_); }
+		operator ArrayView<const TYPE>() const { return ArrayView<const TYPE>(data_, size_); }
+
+		TYPE& operator[](index_type idx)
+		{
+			DBG_ASSERT_MSG(idx >= 0 && idx < size_, "Index out of bounds. (index %u, size %u)", idx, size_);
+			return data_[idx];
+		}
+
+		const TYPE& operator[](index_type idx) const
+		{
+			DBG_ASSERT_MSG(idx >= 0 && idx < size_, "Index out of bounds. (%u, size %u)", idx, size_);
+			return data_[idx];
+		}
+
+		void clear()
+		{
+			destruct(data_, data_ + size_);
+			size_ = 0;
+		}
+
+		void fill(const TYPE& value)
+		{
+			destruct(data_, data_ + size_);
+			for(index_type idx = 0; idx < size_; ++idx)
+				new(data_ + idx) TYPE(value);
+		}
+
+		iterator erase(iterator it)
+		{
+			DBG_ASSERT_MSG(it >= begin() && it < end(), "Invalid iterator.");
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				destruct(it);
+				memmove((void*)it, (const void*)(it + 1), (end() - (it + 1)) * sizeof(TYPE));
+				--size_;
+			}
+			else
+			{
+				for(iterator dstIt = it, srcIt = it + 1; srcIt != end(); ++dstIt, ++srcIt)
+					*dstIt = std::move(*srcIt);
+				--size_;
+				destruct(data_ + size_);
+			}
+			return it;
+		}
+
+		iterator push_back(const TYPE& value) { return emplace_back(value); }
+		iterator push_back(TYPE&& value) { return emplace_back(std::move(value)); }
+
+		template<class... VAL_TYPE>
+		iterator emplace_back(VAL_TYPE&&... value)
+		{
+			if(capacity_ < (size_ + 1))
+				internalGrow(getGrowCapacity(capacity_));
+			new(data_ + size_) TYPE(std::forward<VAL_TYPE>(value)...);
+			return (data_ + size_++);
+		}
+
+		template<class... VAL_TYPE>
+		iterator emplace(const_iterator pos, VAL_TYPE&&... value)
+		{
+			DBG_ASSERT_MSG(pos >= begin() && pos <= end(), "Invalid iterator.");
+			const index_type idx = (index_type)(pos - begin());
+			if(idx == size_)
+				return emplace_back(std::forward<VAL_TYPE>(value)...);
+
+			// Construct first, value may reference an element that is about to move.
+			TYPE newValue(std::forward<VAL_TYPE>(value)...);
+			if(capacity_ < (size_ + 1))
+				internalGrow(getGrowCapacity(capacity_));
+
+			iterator it = data_ + idx;
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				memmove((void*)(it + 1), (const void*)it, (size_ - idx) * sizeof(TYPE));
+				new(it) TYPE(std::move(newValue));
+			}
+			else
+			{
+				new(data_ + size_) TYPE(std::move(data_[size_ - 1]));
+				for(iterator dstIt = data_ + size_ - 1; dstIt != it; --dstIt)
+					*dstIt = std::move(*(dstIt - 1));
+				*it = std::move(newValue);
+			}
+			++size_;
+			return it;
+		}
+
+		iterator insert(const_iterator pos, const TYPE& value) { return emplace(pos, value); }
+		iterator insert(const_iterator pos, TYPE&& value) { return emplace(pos, std::move(value)); }
+
+		iterator insert(const_iterator begin, const_iterator end)
+		{
+			i32 numValues = (i32)(end - begin);
+			if(capacity_ < (size_ + numValues))
+				internalGrow(size_ + numValues);
+			for(const_iterator it = begin; it != end; ++it)
+			{
+				new(data_ + size_) TYPE(*it);
+				++size_;
+			}
+			return (data_ + size_ - 1);
+		}
+
+		void pop_back()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			--size_;
+			destruct(data_ + size_);
+		}
+
+		void reserve(index_type capacity)
+		{
+			if(capacity_ < capacity)
+				internalGrow(capacity);
+		}
+
+		void resize(index_type size)
+		{
+			DBG_ASSERT(size >= 0);
+			reserve(size);
+			if(size < size_)
+				destruct(data_ + size, data_ + size_);
+			for(index_type idx = size_; idx < size; ++idx)
+				new(data_ + idx) TYPE();
+			size_ = size;
+		}
+
+		void resize(index_type size, const TYPE& value)
+		{
+			DBG_ASSERT(size >= 0);
+			reserve(size);
+			if(size < size_)
+				destruct(data_ + size, data_ + size_);
+			for(index_type idx = size_; idx < size; ++idx)
+				new(data_ + idx) TYPE(value);
+			size_ = size;
+		}
+
+		TYPE& front()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[0];
+		}
+
+		const TYPE& front() const
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[0];
+		}
+
+		TYPE& back()
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[size_ - 1];
+		}
+
+		const TYPE& back() const
+		{
+			DBG_ASSERT_MSG(size_ > 0, "No elements in vector.");
+			return data_[size_ - 1];
+		}
+
+		iterator begin() noexcept { return data_; }
+		const_iterator begin() const noexcept { return data_; }
+		iterator end() noexcept { return data_ + size_; }
+		const_iterator end() const noexcept { return data_ + size_; }
+
+		TYPE* data() noexcept { return data_; }
+		const TYPE* data() const noexcept { return data_; }
+		index_type size() const noexcept { return size_; }
+		index_type capacity() const noexcept { return capacity_; }
+		bool empty() const noexcept { return size_ == 0; }
+
+		/**
+		 * @return true if elements are still stored inline, and not allocated.
+		 */
+		bool isInline() const noexcept { return data_ == getInlineData(); }
+
+	private:
+		TYPE* getInlineData() noexcept { return reinterpret_cast<TYPE*>(inlineData_); }
+		const TYPE* getInlineData() const noexcept { return reinterpret_cast<const TYPE*>(inlineData_); }
+
+		static index_type getGrowCapacity(index_type currCapacity) { return currCapacity + ((currCapacity + 1) / 2); }
+
+		static iterator uninitialized_move(iterator first, iterator last, iterator dest)
+		{
+			for(; first != last; ++dest, ++first)
+				new(dest) TYPE(std::move(*first));
+			return dest;
+		}
+
+		/// Move [first, last) into uninitialized memory at dest, leaving the source destructed.
+		static void relocate(iterator first, iterator last, iterator dest)
+		{
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				if(first != last)
+					memcpy((void*)dest, (const void*)first, (last - first) * sizeof(TYPE));
+			}
+			else
+			{
+				uninitialized_move(first, last, dest);
+				destruct(first, last);
+			}
+		}
+
+		static void destruct(iterator first) { first->~TYPE(); }
+
+		static void destruct(iterator first, iterator last)
+		{
+			for(; first != last; ++first)
+				destruct(first);
+		}
+
+		/// Move elements onto the heap with at least newCapacity.
+		void internalGrow(index_type newCapacity)
+		{
+			DBG_ASSERT(newCapacity > capacity_);
+			TYPE* newData = static_cast<TYPE*>(allocator_.Allocate(newCapacity * sizeof(TYPE), alignof(TYPE)));
+			DBG_ASSERT_MSG(newData, "Unable to allocate for resize.");
+			relocate(data_, data_ + size_, newData);
+			internalFree();
+
+			data_ = newData;
+			capacity_ = newCapacity;
+		}
+
+		/// Free heap allocation, returning to inline storage. Elements must already be destructed or moved.
+		void internalFree()
+		{
+			if(!isInline())
+				allocator_.Deallocate(data_);
+			data_ = getInlineData();
+			capacity_ = INLINE_SIZE;
+		}
+
+		/// Take elements from other, which must be empty and inline. Other is left empty.
+		void internalMove(InlineVector& other)
+		{
+			DBG_ASSERT(size_ == 0 && isInline());
+			if(other.isInline())
+			{
+				relocate(other.data_, other.data_ + other.size_, data_);
+			}
+			else
+			{
+				data_ = other.data_;
+				capacity_ = other.capacity_;
+				other.data_ = other.getInlineData();
+				other.capacity_ = INLINE_SIZE;
+			}
+			size_ = other.size_;
+			other.size_ = 0;
+		}
+
+	private:
+		TYPE* data_ = getInlineData();
+		index_type size_ = 0;
+		index_type capacity_ = INLINE_SIZE;
+
+		ALLOCATOR allocator_;
+
+		alignas(TYPE) u8 inlineData_[INLINE_SIZE * sizeof(TYPE)];
+	};
+} // namespace Core
@@ -1,16 +1,84 @@
 #pragma once
 
 #include "core/hash.h"
+#include "core/misc.h"
 #include "core/pair.h"
 #include "core/vector.h"
 
 #include <utility>
 
+#if ARCH_X86_64 || ARCH_X86
+#include <emmintrin.h>
+#endif
+
 namespace Core
 {
+	namespace Detail
+	{
+		/// Control byte for slots that have never been used. Ends probing.
+		static const i8 MAP_CTRL_EMPTY = -128;
+		/// Control byte for erased slots. Probing continues past these.
+		static const i8 MAP_CTRL_DELETED = -2;
+
+		/**
+		 * Group of control bytes, matched a group at a time.
+		 * Full slots store the low 7 bits of the hash, so have the top bit clear.
+		 * Each match returns a bitmask with one bit per slot.
+		 */
+		struct MapGroup
+		{
+			static const i32 SIZE = 16;
+
+#if ARCH_X86_64 || ARCH_X86
+			MapGroup(const i8* ctrl)
+			    : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+			{
+			}
+
+			u32 Match(i8 h2) const { return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_)); }
+			u32 MatchEmpty() const { return Match(MAP_CTRL_EMPTY); }
+			u32 MatchEmptyOrDeleted() const { return (u32)_mm_movemask_epi8(ctrl_); }
+			u32 MatchFull() const { return ~MatchEmptyOrDeleted() & 0xffff; }
+
+			__m128i ctrl_;
+#else
+			MapGroup(const i8* ctrl)
+			    : ctrl_(ctrl)
+			{
+			}
+
+			u32 Match(i8 h2) const
+			{
+				u32 mask = 0;
+				for(i32 i = 0; i < SIZE; ++i)
+					mask |= (u32)(ctrl_[i] == h2) << i;
+				return mask;
+			}
+
+			u32 MatchEmpty() const { return Match(MAP_CTRL_EMPTY); }
+
+			u32 MatchEmptyOrDeleted() const
+			{
+				u32 mask = 0;
+				for(i32 i = 0; i < SIZE; ++i)
+					mask |= (u32)(ctrl_[i] < 0) << i;
+				return mask;
+			}
+
+			u32 MatchFull() const { return ~MatchEmptyOrDeleted() & 0xffff; }
+
+			const i8* ctrl_;
+#endif
+		};
+	} // namespace Detail
+
 	/**
 	 * Hash map.
-	 * https://www.sebastiansylvan.com/post/robin-hood-hashing-should-be-your-default-hash-table-implementation/
+	 * Open addressing with one control byte per slot, in the style of Swiss tables:
+	 * https://abseil.io/about/design/swisstables
+	 * Control bytes hold 7 bits of each key's hash, so a group of 16 slots is checked for
+	 * candidates in a few instructions before any keys are compared. Keys and values are stored
+	 * together, so a lookup typically touches the control bytes and a single slot.
 	 */
 	template<typename KEY_TYPE, typename VALUE_TYPE, typename HASHER = Hasher<KEY_TYPE>,
 	    typename ALLOCATOR = ContainerAllocator>
@@ -21,9 +89,8 @@ namespace Core
 		using this_type = Map<KEY_TYPE, VALUE_TYPE, HASHER, ALLOCATOR>;
 
 		static const index_type INITIAL_SIZE = 16;
-		static const index_type LOAD_FACTOR_PERCENT = 75;
-		static const u32 HASH_MSB_MASK = 0x7fffffff;
-		static const u32 HASH_MSB = 0x80000000;
+		static const index_type LOAD_FACTOR_PERCENT = 87;
+		static const index_type GROUP_SIZE = Detail::MapGroup::SIZE;
 
 		struct key_value_pair
 		{
@@ -77,7 +144,11 @@ namespace Core
 			{
 			}
 
-			key_value_pair operator*() { return key_value_pair{parent_->keys_[pos_], parent_->values_[pos_]}; }
+			key_value_pair operator*()
+			{
+				auto& slot = this->parent_->slots_[this->pos_];
+				return key_value_pair{slot.key_, slot.value_};
+			}
 		};
 
 		struct const_iterator : iterator_base
@@ -89,22 +160,18 @@ namespace Core
 
 			const_key_value_pair operator*()
 			{
-				return const_key_value_pair{parent_->keys_[pos_], parent_->values_[pos_]};
+				const auto& slot = this->parent_->slots_[this->pos_];
+				return const_key_value_pair{slot.key_, slot.value_};
 			}
 		};
 
 
-		Map(ALLOCATOR& allocator, i32 initialSize = INITIAL_SIZE)
+		Map(const ALLOCATOR& allocator, i32 initialSize = INITIAL_SIZE)
 		    : allocator_(allocator)
 		{
-			capacity_ = initialSize;
-			Alloc();
-		}
-		Map(i32 initialSize = INITIAL_SIZE)
-		{
-			capacity_ = initialSize;
-			Alloc(); 
+			Alloc(initialSize);
 		}
+		Map(i32 initialSize = INITIAL_SIZE) { Alloc(initialSize); }
 
 		Map(const Map& other)
 		    : allocator_(other.allocator_)
@@ -115,21 +182,8 @@ namespace Core
 		Map(Map&& other) { swap(other); }
 		~Map()
 		{
-			if(hashes_)
-			{
-				for(index_type i = 0; i < capacity_; ++i)
-				{
-					if(hashes_[i] != 0)
-					{
-						keys_[i].~KEY_TYPE();
-						values_[i].~VALUE_TYPE();
-					}
-				}
-			}
-
-			allocator_.Deallocate(keys_);
-			allocator_.Deallocate(values_);
-			allocator_.Deallocate(hashes_);
+			Destruct();
+			allocator_.Deallocate(ctrl_);
 		}
 
 		Map& operator=(const Map& other)
@@ -147,35 +201,32 @@ namespace Core
 		void swap(Map& other)
 		{
 			std::swap(allocator_, other.allocator_);
-			std::swap(keys_, other.keys_);
-			std::swap(values_, other.values_);
-			std::swap(hashes_, other.hashes_);
+			std::swap(ctrl_, other.ctrl_);
+			std::swap(slots_, other.slots_);
 			std::swap(capacity_, other.capacity_);
 			std::swap(mask_, other.mask_);
 			std::swap(numElements_, other.numElements_);
-			std::swap(resizeThreshold_, other.resizeThreshold_);
+			std::swap(growthLeft_, other.growthLeft_);
 		}
 
 		void copy(const Map& other)
 		{
-			allocator_.Deallocate(keys_);
-			allocator_.Deallocate(values_);
-			allocator_.Deallocate(hashes_);
+			if(this == &other)
+				return;
+
+			Destruct();
+			allocator_.Deallocate(ctrl_);
 			allocator_ = other.allocator_;
-			keys_ = nullptr;
-			values_ = nullptr;
-			hashes_ = nullptr;
+			ctrl_ = nullptr;
+			slots_ = nullptr;
+			numElements_ = 0;
 
-			capacity_ = other.capacity_;
-			Alloc();
+			Alloc(other.capacity_);
 
-			for(index_type i = 0; i < other.capacity_; ++i)
+			for(index_type i = other.LookupIndex(0); i != -1; i = other.LookupIndex(i + 1))
 			{
-				auto& k = other.keys_[i];
-				auto& v = other.values_[i];
-				u32 h = other.hashes_[i];
-				if(h != 0 && !IsDeleted(h))
-					InsertHelper(h, std::move(KEY_TYPE(k)), std::move(VALUE_TYPE(v)));
+				const auto& slot = other.slots_[i];
+				InsertHelper(HashKey(slot.key_), KEY_TYPE(slot.key_), VALUE_TYPE(slot.value_));
 			}
 		}
 
@@ -192,76 +243,78 @@ namespace Core
 
 		const VALUE_TYPE& operator[](const KEY_TYPE& key) const
 		{
-			VALUE_TYPE* foundValue = find(key);
+			const VALUE_TYPE* foundValue = find(key);
 			DBG_ASSERT_MSG(foundValue != nullptr, "key does not exist in map.");
 			return *foundValue;
 		}
 
 		void clear()
 		{
-			for(index_type i = 0; i < capacity_; ++i)
-			{
-				if(hashes_[i] != 0)
-				{
-					keys_[i].~KEY_TYPE();
-					values_[i].~VALUE_TYPE();
-					hashes_[i] = 0;
-				}
-			}
+			if(ctrl_ == nullptr)
+				return;
+
+			Destruct();
+			for(index_type i = 0; i < (capacity_ + GROUP_SIZE); ++i)
+				ctrl_[i] = Detail::MAP_CTRL_EMPTY;
 			numElements_ = 0;
+			growthLeft_ = MaxElements(capacity_);
 		}
 
 		VALUE_TYPE* insert(KEY_TYPE key, VALUE_TYPE value)
 		{
-			if(auto* found = find(key))
+			const u64 hash = HashKey(key);
+			const index_type i = LookupIndexByKey(key, hash);
+			if(i != -1)
 			{
-				*found = value;
-				return found;
+				slots_[i].value_ = std::move(value);
+				return &slots_[i].value_;
 			}
 
-			if(++numElements_ >= resizeThreshold_)
-				Grow();
-			return InsertHelper(HashKey(key), std::move(key), std::move(value));
+			return InsertHelper(hash, std::move(key), std::move(value));
 		}
 
 
 		bool erase(const KEY_TYPE& key)
 		{
-			const index_type i = LookupIndexByKey(key);
+			const index_type i = LookupIndexByKey(key, HashKey(key));
 
 			if(i == -1)
 				return false;
-			keys_[i].~KEY_TYPE();
-			values_[i].~VALUE_TYPE();
-			hashes_[i] |= HASH_MSB;
+			slots_[i].key_.~KEY_TYPE();
+			slots_[i].value_.~VALUE_TYPE();
+			SetCtrl(i, Detail::MAP_CTRL_DELETED);
 			--numElements_;
 			return true;
 		}
 
 		VALUE_TYPE* find(const KEY_TYPE& key)
 		{
-			const index_type i = LookupIndexByKey(key);
-			return i != -1 ? &values_[i] : nullptr;
+			const index_type i = LookupIndexByKey(key, HashKey(key));
+			return i != -1 ? &slots_[i].value_ : nullptr;
 		}
 
 		const VALUE_TYPE* find(const KEY_TYPE& key) const
 		{
-			const index_type i = LookupIndexByKey(key);
-			return i != -1 ? &values_[i] : nullptr;
+			const index_type i = LookupIndexByKey(key, HashKey(key));
+			return i != -1 ? &slots_[i].value_ : nullptr;
 		}
 
 		index_type size() const { return numElements_; }
 		bool empty() const { return numElements_ == 0; }
 
+		/**
+		 * @return Average number of groups probed to find each element.
+		 */
 		f32 AverageProbeCount() const
 		{
 			f32 probeTotal = 0.0f;
-			for(index_type i = 0; i < capacity_; ++i)
+			for(index_type i = LookupIndex(0); i != -1; i = LookupIndex(i + 1))
 			{
-				u32 hash = hashes_[i];
-				if(hash != 0 && !IsDeleted(hash))
+				index_type pos = H1(HashKey(slots_[i].key_)) & mask_;
+				for(index_type stride = GROUP_SIZE; ((i - pos) & mask_) >= GROUP_SIZE; stride += GROUP_SIZE)
 				{
-					probeTotal += ProbeDistance(hash, i);
+					pos = (pos + stride) & mask_;
+					probeTotal += 1.0f;
 				}
 			}
 			return probeTotal / size() + 1.0f;
@@ -273,141 +326,188 @@ namespace Core
 		const_iterator end() const { return const_iterator{this, -1}; }
 
 	private:
-		void Alloc()
+		struct Slot
 		{
-			DBG_ASSERT(keys_ == nullptr && values_ == nullptr && hashes_ == nullptr);
-			keys_ = reinterpret_cast<KEY_TYPE*>(allocator_.Allocate(capacity_ * sizeof(KEY_TYPE), alignof(KEY_TYPE)));
-			values_ =
-			    reinterpret_cast<VALUE_TYPE*>(allocator_.Allocate(capacity_ * sizeof(VALUE_TYPE), alignof(VALUE_TYPE)));
-			hashes_ = reinterpret_cast<u32*>(allocator_.Allocate(capacity_ * sizeof(u32), alignof(u32)));
-			for(index_type i = 0; i < capacity_; ++i)
-				hashes_[i] = 0;
-			resizeThreshold_ = (capacity_ * LOAD_FACTOR_PERCENT) / 100;
+			KEY_TYPE key_;
+			VALUE_TYPE value_;
+		};
+
+		static index_type MaxElements(index_type capacity) { return (capacity * LOAD_FACTOR_PERCENT) / 100; }
+
+		/**
+		 * Allocate control bytes and slots together.
+		 * Control bytes for the first group are mirrored after the last, so a group can be loaded
+		 * from any position without wrapping.
+		 */
+		void Alloc(index_type capacity)
+		{
+			DBG_ASSERT(ctrl_ == nullptr && slots_ == nullptr);
+			capacity_ = GROUP_SIZE;
+			while(capacity_ < capacity)
+				capacity_ *= 2;
 			mask_ = capacity_ - 1;
+
+			const i64 ctrlSize = Core::PotRoundUp(capacity_ + GROUP_SIZE, alignof(Slot));
+			const i64 align = Core::Max((i64)alignof(Slot), (i64)GROUP_SIZE);
+			ctrl_ = reinterpret_cast<i8*>(allocator_.Allocate(ctrlSize + capacity_ * sizeof(Slot), align));
+			slots_ = reinterpret_cast<Slot*>(ctrl_ + ctrlSize);
+			for(index_type i = 0; i < (capacity_ + GROUP_SIZE); ++i)
+				ctrl_[i] = Detail::MAP_CTRL_EMPTY;
+			growthLeft_ = MaxElements(capacity_);
 		}
 
-		void Grow()
+		void Destruct()
+		{
+			if(ctrl_)
+			{
+				for(index_type i = LookupIndex(0); i != -1; i = LookupIndex(i + 1))
+				{
+					slots_[i].key_.~KEY_TYPE();
+					slots_[i].value_.~VALUE_TYPE();
+				}
+			}
+		}
+
+		/**
+		 * Reallocate and reinsert all elements.
+		 * If the map is mostly erased slots, it's rehashed at the same size to reclaim them.
+		 */
+		void Rehash()
 		{
 			const index_type oldCapacity = capacity_;
-			auto oldKeys = keys_;
-			auto oldValues = values_;
-			auto oldHashes = hashes_;
-			keys_ = nullptr;
-			values_ = nullptr;
-			hashes_ = nullptr;
-			capacity_ *= 2;
+			i8* oldCtrl = ctrl_;
+			Slot* oldSlots = slots_;
+			ctrl_ = nullptr;
+			slots_ = nullptr;
 
-			Alloc();
+			const bool grow = (numElements_ * 2) >= MaxElements(oldCapacity);
+			Alloc(grow ? oldCapacity * 2 : oldCapacity);
 
 			for(index_type i = 0; i < oldCapacity; ++i)
 			{
-				auto& k = oldKeys[i];
-				auto& v = oldValues[i];
-				u32 h = oldHashes[i];
-				if(h != 0 && !IsDeleted(h))
-					InsertHelper(h, std::move(k), std::move(v));
+				if(oldCtrl[i] >= 0)
+				{
+					Slot& slot = oldSlots[i];
+					const u64 hash = HashKey(slot.key_);
+					Construct(FindInsertIndex(hash), hash, std::move(slot.key_), std::move(slot.value_));
+					slot.key_.~KEY_TYPE();
+					slot.value_.~VALUE_TYPE();
+				}
 			}
 
-			allocator_.Deallocate(oldKeys);
-			allocator_.Deallocate(oldValues);
-			allocator_.Deallocate(oldHashes);
+			allocator_.Deallocate(oldCtrl);
 		}
 
-		u32 HashKey(const KEY_TYPE& key) const
-		{
-			u64 h = hasher_(0, key);
-			h &= HASH_MSB_MASK;
-			h |= h == 0;
-			return (u32)h;
-		}
-
-		bool IsDeleted(u32 h) const { return (h & HASH_MSB) != 0; }
+		u64 HashKey(const KEY_TYPE& key) const { return hasher_(0, key); }
 
-		index_type DesiredPos(u32 h) const { return h & mask_; }
+		static index_type H1(u64 hash) { return (index_type)(hash >> 7); }
+		static i8 H2(u64 hash) { return (i8)(hash & 0x7f); }
 
-		index_type ProbeDistance(u32 h, index_type idx) const { return (idx + capacity_ - DesiredPos(h)) & mask_; }
+		void SetCtrl(index_type i, i8 ctrl)
+		{
+			ctrl_[i] = ctrl;
+			if(i < GROUP_SIZE)
+				ctrl_[capacity_ + i] = ctrl;
+		}
 
-		void Construct(index_type i, u32 hash, KEY_TYPE&& key, VALUE_TYPE&& val)
+		void Construct(index_type i, u64 hash, KEY_TYPE&& key, VALUE_TYPE&& val)
 		{
-			new(&keys_[i]) KEY_TYPE(std::move(key));
-			new(&values_[i]) VALUE_TYPE(std::move(val));
-			hashes_[i] = hash;
+			new(&slots_[i].key_) KEY_TYPE(std::move(key));
+			new(&slots_[i].value_) VALUE_TYPE(std::move(val));
+			if(ctrl_[i] == Detail::MAP_CTRL_EMPTY)
+				--growthLeft_;
+			SetCtrl(i, H2(hash));
 		}
 
-		VALUE_TYPE* InsertHelper(u32 hash, KEY_TYPE&& key, VALUE_TYPE&& val)
+		/**
+		 * @return Index of first empty or erased slot in @a hash's probe sequence.
+		 */
+		index_type FindInsertIndex(u64 hash) const
 		{
-			index_type pos = DesiredPos(hash);
-			index_type dist = 0;
-			VALUE_TYPE* retVal = nullptr;
-			for(;;)
+			index_type pos = H1(hash) & mask_;
+			for(index_type stride = GROUP_SIZE;; stride += GROUP_SIZE)
 			{
-				if(hashes_[pos] == 0 || IsDeleted(hashes_[pos]))
-				{
-					Construct(pos, hash, std::move(key), std::move(val));
-					if(retVal == nullptr)
-						retVal = &values_[pos];
-					return retVal;
-				}
+				const Detail::MapGroup group(&ctrl_[pos]);
+				if(const u32 match = group.MatchEmptyOrDeleted())
+					return (pos + Core::CountTrailingZeros(match)) & mask_;
+				pos = (pos + stride) & mask_;
+			}
+		}
 
-				// If the existing elem has probed less than us, then swap places with existing
-				// elem, and keep going to find another slot for that elem.
-				index_type existingElemProbeDist = ProbeDistance(hashes_[pos], pos);
-				if(existingElemProbeDist < dist)
-				{
-					std::swap(hash, hashes_[pos]);
-					std::swap(key, keys_[pos]);
-					std::swap(val, values_[pos]);
-					dist = existingElemProbeDist;
+		/**
+		 * Insert key known not to be in the map.
+		 */
+		VALUE_TYPE* InsertHelper(u64 hash, KEY_TYPE&& key, VALUE_TYPE&& val)
+		{
+			// Moved from maps have no storage.
+			if(ctrl_ == nullptr)
+				Alloc(INITIAL_SIZE);
 
-					if(retVal == nullptr)
-						retVal = &values_[pos];
-				}
+			index_type i = FindInsertIndex(hash);
 
-				pos = (pos + 1) & mask_;
-				++dist;
+			// Reusing an erased slot doesn't reduce the number of empty slots left.
+			if(growthLeft_ == 0 && ctrl_[i] == Detail::MAP_CTRL_EMPTY)
+			{
+				Rehash();
+				i = FindInsertIndex(hash);
 			}
+
+			Construct(i, hash, std::move(key), std::move(val));
+			++numElements_;
+			return &slots_[i].value_;
 		}
 
-		index_type LookupIndexByKey(const KEY_TYPE& key) const
+		index_type LookupIndexByKey(const KEY_TYPE& key, u64 hash) const
 		{
-			const u32 hash = HashKey(key);
-			index_type pos = DesiredPos(hash);
-			index_type dist = 0;
-			for(;;)
+			if(ctrl_ == nullptr)
+				return -1;
+
+			const i8 h2 = H2(hash);
+			index_type pos = H1(hash) & mask_;
+			for(index_type stride = GROUP_SIZE; stride <= capacity_; stride += GROUP_SIZE)
 			{
-				if(hashes_[pos] == 0)
-					return -1;
-				else if(dist > capacity_)
-					return -1;
-				else if(hashes_[pos] == hash && keys_[pos] == key)
-					return pos;
+				const Detail::MapGroup group(&ctrl_[pos]);
+				for(u32 match = group.Match(h2); match != 0; match &= match - 1)
+				{
+					const index_type i = (pos + Core::CountTrailingZeros(match)) & mask_;
+					if(slots_[i].key_ == key)
+						return i;
+				}
 
-				pos = (pos + 1) & mask_;
-				++dist;
+				// An empty slot means the key would have been inserted here.
+				if(group.MatchEmpty())
+					return -1;
+				pos = (pos + stride) & mask_;
 			}
+			return -1;
 		}
 
+		/**
+		 * @return Index of first full slot at or after @a i, -1 if there are none.
+		 */
 		index_type LookupIndex(index_type i) const
 		{
-			while(i < capacity_)
+			// Most maps are dense enough that the next slot is often full.
+			if(i < capacity_ && ctrl_[i] >= 0)
+				return i;
+
+			for(; i < capacity_; i += GROUP_SIZE)
 			{
-				u32 h = hashes_[i];
-				if(h != 0 && !IsDeleted(h))
-				{
-					return i;
-				}
-				++i;
+				// Mirrored control bytes are masked off, as they have been visited already.
+				const u32 valid = (capacity_ - i) >= GROUP_SIZE ? 0xffff : ((1u << (capacity_ - i)) - 1);
+				if(const u32 match = Detail::MapGroup(&ctrl_[i]).MatchFull() & valid)
+					return i + Core::CountTrailingZeros(match);
 			}
 			return -1;
 		}
 
-		KEY_TYPE* keys_ = nullptr;
-		VALUE_TYPE* values_ = nullptr;
-		u32* hashes_ = nullptr;
+		i8* ctrl_ = nullptr;
+		Slot* slots_ = nullptr;
 
 		index_type numElements_ = 0;
-		index_type resizeThreshold_ = 0;
-		index_type capacity_ = INITIAL_SIZE;
+		/// Number of elements that can be inserted into empty slots before rehashing.
+		index_type growthLeft_ = 0;
+		index_type capacity_ = 0;
 		u32 mask_ = 0;
 
 		ALLOCATOR allocator_;
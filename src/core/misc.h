@@ -44,6 +44,20 @@ namespace Core
 		return value & ~((TYPE)roundDownTo - 1);
 	}
 
+	/**
+	 * @return Smallest power of 2 greater than or equal to @a value.
+	 */
+	constexpr inline u32 PotNext(u32 value)
+	{
+		value--;
+		value |= value >> 1;
+		value |= value >> 2;
+		value |= value >> 4;
+		value |= value >> 8;
+		value |= value >> 16;
+		return value + 1;
+	}
+
 	constexpr inline i32 BitsSet(u32 value)
 	{
 		value = (value & 0x55555555U) + ((value & 0xAAAAAAAAU) >> 1);
@@ -73,6 +87,8 @@ namespace Core
 
 	CORE_DLL_INLINE i32 CountLeadingZeros(u32 mask);
 	CORE_DLL_INLINE i32 CountLeadingZeros(u64 mask);
+	CORE_DLL_INLINE i32 CountTrailingZeros(u32 mask);
+	CORE_DLL_INLINE i32 CountTrailingZeros(u64 mask);
 } // namespace Core
 #if CODE_INLINE
 #include "core/private/misc.inl"
@@ -118,6 +118,103 @@ namespace Core
 			return true;
 		}
 
+		/**
+		 * Enqueue multiple items.
+		 * Claims a contiguous run of free cells with a single exchange, so fewer than @a num items
+		 * may be queued if the queue is almost full.
+		 * @param data Items to queue.
+		 * @param num Number of items to queue.
+		 * @return Number of items queued, from the start of @a data.
+		 * @pre num > 0.
+		 */
+		i32 EnqueueBulk(const TYPE* data, i32 num)
+		{
+			DBG_ASSERT(data);
+			DBG_ASSERT(num > 0);
+			i32 pos = Core::AtomicCmpExchg(&enqueuePos_, 0, 0);
+			i32 numClaimed = 0;
+			for(;;)
+			{
+				// Count free cells following pos. A cell is free for position p when its sequence is p.
+				// Plain reads are enough here, as the exchange that claims them is a full barrier.
+				numClaimed = 0;
+				i32 dif = 0;
+				for(; numClaimed < num && numClaimed <= bufferMask_; ++numClaimed)
+				{
+					const i32 cellPos = pos + numClaimed;
+					dif = buffer_[cellPos & bufferMask_].sequence_ - cellPos;
+					if(dif != 0)
+						break;
+				}
+
+				if(numClaimed > 0)
+				{
+					if(Core::AtomicCmpExchg(&enqueuePos_, pos + numClaimed, pos) == pos)
+						break;
+					pos = Core::AtomicCmpExchg(&enqueuePos_, 0, 0);
+				}
+				else if(dif < 0)
+					return 0;
+				else
+					pos = Core::AtomicCmpExchg(&enqueuePos_, 0, 0);
+			}
+
+			for(i32 idx = 0; idx < numClaimed; ++idx)
+				buffer_[(pos + idx) & bufferMask_].data_ = data[idx];
+			Core::Barrier();
+			for(i32 idx = 0; idx < numClaimed; ++idx)
+				buffer_[(pos + idx) & bufferMask_].sequence_ = pos + idx + 1;
+			return numClaimed;
+		}
+
+		/**
+		 * Dequeue multiple items.
+		 * Claims a contiguous run of filled cells with a single exchange.
+		 * @param data Output items.
+		 * @param maxNum Maximum number of items to dequeue.
+		 * @return Number of items dequeued.
+		 * @pre maxNum > 0.
+		 */
+		i32 DequeueBulk(TYPE* data, i32 maxNum)
+		{
+			DBG_ASSERT(data);
+			DBG_ASSERT(maxNum > 0);
+			i32 pos = Core::AtomicCmpExchg(&dequeuePos_, 0, 0);
+			i32 numClaimed = 0;
+			for(;;)
+			{
+				// Count filled cells following pos. A cell is filled for position p when its sequence is p + 1.
+				// Plain reads are enough here, as the exchange that claims them is a full barrier.
+				numClaimed = 0;
+				i32 dif = 0;
+				for(; numClaimed < maxNum && numClaimed <= bufferMask_; ++numClaimed)
+				{
+					const i32 cellPos = pos + numClaimed;
+					dif = buffer_[cellPos & bufferMask_].sequence_ - (cellPos + 1);
+					if(dif != 0)
+						break;
+				}
+
+				if(numClaimed > 0)
+				{
+					if(Core::AtomicCmpExchg(&dequeuePos_, pos + numClaimed, pos) == pos)
+						break;
+					pos = Core::AtomicCmpExchg(&dequeuePos_, 0, 0);
+				}
+				else if(dif < 0)
+					return 0;
+				else
+					pos = Core::AtomicCmpExchg(&dequeuePos_, 0, 0);
+			}
+
+			for(i32 idx = 0; idx < numClaimed; ++idx)
+				data[idx] = buffer_[(pos + idx) & bufferMask_].data_;
+			Core::Barrier();
+			for(i32 idx = 0; idx < numClaimed; ++idx)
+				buffer_[(pos + idx) & bufferMask_].sequence_ = pos + idx + bufferMask_ + 1;
+			return numClaimed;
+		}
+
 	private:
 		struct Cell
 		{
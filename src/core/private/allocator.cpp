@@ -6,12 +6,16 @@
 
 #define ENABLE_GUARD_PAGES (1)
 #define ENABLE_DEFAULT_ALLOCATION_TRACKER !defined(_RELEASE)
+#define ENABLE_DEFAULT_ALLOCATION_SAMPLING (1)
+#define DEFAULT_ALLOCATION_SAMPLE_INTERVAL (512 * 1024)
+#define ENABLE_THREAD_CACHE (1)
 
 #define GENERAL_PURPOSE_MIN_POOL_SIZE (8 * 1024 * 1024)
 #define GENERAL_PURPOSE_MAX_ALIGN (64 * 1024)
 
 #include "core/allocator_proxy_tracker.h"
 #include "core/allocator_proxy_thread_safe.h"
+#include "core/allocator_thread_cache.h"
 #include "core/allocator_virtual.h"
 #include "core/allocator_tlsf.h"
 
@@ -28,7 +32,7 @@ namespace Core
 			struct Entry
 			{
 				Entry* next_ = nullptr;
-				IAllocator* allocator_ = nullptr;
+				AllocatorProxyTracker* allocator_ = nullptr;
 			};
 
 			Entry* entry_ = nullptr;
@@ -46,10 +50,11 @@ namespace Core
 				}
 			}
 
-			IAllocator& Add(IAllocator& allocator, const char* name)
+			IAllocator& Add(IAllocator& allocator, const char* name, i64 sampleInterval)
 			{
 				Entry* entry = UntrackedVirtualAllocator().New<Entry>();
-				entry->allocator_ = UntrackedVirtualAllocator().New<AllocatorProxyTracker>(allocator, name);
+				entry->allocator_ =
+				    UntrackedVirtualAllocator().New<AllocatorProxyTracker>(allocator, name, sampleInterval);
 
 				for(;;)
 				{
@@ -83,7 +88,7 @@ namespace Core
 		static IAllocator& proxy = CreateAllocationTracker(UntrackedVirtualAllocator(), "Virtual");
 		return proxy;
 #else
-		return virtAlloc;
+		return UntrackedVirtualAllocator();
 #endif // ENABLE_DEFAULT_ALLOCATION_TRACKER
 	}
 
@@ -91,17 +96,36 @@ namespace Core
 	{
 		static AllocatorTLSF tlsfAlloc(VirtualAllocator(), GENERAL_PURPOSE_MIN_POOL_SIZE);
 		static AllocatorProxyThreadSafe tsProxy(tlsfAlloc);
+#if ENABLE_THREAD_CACHE
+		// Small allocations are served per-thread, only spans and large allocations take the lock.
+		static AllocatorThreadCache tcAlloc(tsProxy);
+		IAllocator& baseAlloc = tcAlloc;
+#else
+		IAllocator& baseAlloc = tsProxy;
+#endif // ENABLE_THREAD_CACHE
 #if ENABLE_DEFAULT_ALLOCATION_TRACKER
-		static IAllocator& proxy = CreateAllocationTracker(tsProxy, "General");
+		static IAllocator& proxy = CreateAllocationTracker(baseAlloc, "General");
+		return proxy;
+#elif ENABLE_DEFAULT_ALLOCATION_SAMPLING
+		// Sampling is cheap enough to leave enabled, so heap profiles are available in release.
+		static IAllocator& proxy = CreateAllocationTracker(baseAlloc, "General", DEFAULT_ALLOCATION_SAMPLE_INTERVAL);
 		return proxy;
 #else
-		return tsProxy;
+		return baseAlloc;
 #endif // ENABLE_DEFAULT_ALLOCATION_TRACKER
 	}
 
-	IAllocator& CreateAllocationTracker(IAllocator& allocator, const char* name)
+	IAllocator& CreateAllocationTracker(IAllocator& allocator, const char* name, i64 sampleInterval)
+	{
+		return GetAllocatorList().Add(allocator, name, sampleInterval);
+	}
+
+	bool WriteHeapProfiles(File& file)
 	{
-		return GetAllocatorList().Add(allocator, name);
+		for(auto* entry = GetAllocatorList().entry_; entry != nullptr; entry = entry->next_)
+			if(!entry->allocator_->WriteHeapProfile(file))
+				return false;
+		return true;
 	}
 
 } // namespace Core
@@ -0,0 +1,403 @@
+#include "core/allocator_pool.h"
+#include "core/array.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+
+namespace Core
+{
+	namespace
+	{
+		/// Number of free objects each thread can hold per pool.
+		static const i32 MAGAZINE_SIZE = 64;
+		/// Maximum number of threads with magazines at once, others use the shared free list directly.
+		static const i32 MAX_MAGAZINES = 64;
+		static const i32 MAX_SLABS = 4096;
+
+		struct SlabHeader
+		{
+			struct AllocatorPoolImpl* owner_;
+			i32 baseIdx_;
+		};
+
+		/// Bit set for each magazine index in use by a thread.
+		volatile i64 usedMagazineIdxMask_ = 0;
+
+		/// Magazine index for the current thread, shared by all pools.
+		thread_local i32 threadMagazineIdx_ = -1;
+		/// Set once the current thread's magazine index has been released on thread exit.
+		thread_local bool threadMagazineIdxReleased_ = false;
+
+		/// Releases the current thread's magazine index on thread exit, so it can be reused.
+		struct MagazineIdxReleaser
+		{
+			~MagazineIdxReleaser()
+			{
+				threadMagazineIdxReleased_ = true;
+				if(threadMagazineIdx_ >= 0)
+				{
+					const i64 bit = 1LL << threadMagazineIdx_;
+					i64 mask = Core::AtomicCmpExchgAcq(&usedMagazineIdxMask_, 0, 0);
+					for(;;)
+					{
+						const i64 oldMask = Core::AtomicCmpExchgRel(&usedMagazineIdxMask_, mask & ~bit, mask);
+						if(oldMask == mask)
+							break;
+						mask = oldMask;
+					}
+					threadMagazineIdx_ = -1;
+				}
+			}
+			void Register() {}
+		};
+		thread_local MagazineIdxReleaser magazineIdxReleaser_;
+
+		/**
+		 * @return Calling thread's magazine index, -1 if there are none free.
+		 */
+		i32 GetThreadMagazineIdx()
+		{
+			if(threadMagazineIdx_ >= 0 || threadMagazineIdxReleased_)
+				return threadMagazineIdx_;
+
+			i64 mask = Core::AtomicCmpExchgAcq(&usedMagazineIdxMask_, 0, 0);
+			for(;;)
+			{
+				i32 idx = 0;
+				while(idx < MAX_MAGAZINES && (mask & (1LL << idx)) != 0)
+					++idx;
+				if(idx == MAX_MAGAZINES)
+					return -1;
+
+				const i64 oldMask = Core::AtomicCmpExchgAcq(&usedMagazineIdxMask_, mask | (1LL << idx), mask);
+				if(oldMask == mask)
+				{
+					threadMagazineIdx_ = idx;
+					magazineIdxReleaser_.Register();
+					return idx;
+				}
+				mask = oldMask;
+			}
+		}
+	}
+
+	struct AllocatorPoolImpl
+	{
+		/// Free objects for a single thread. Only accessed by the thread owning its index.
+		struct Magazine
+		{
+			i32 count_ = 0;
+			Core::Array<i32, MAGAZINE_SIZE> objects_;
+			/// Written by the owning thread only, read by GetStats.
+			volatile i64 numAllocs_ = 0;
+			volatile i64 numFrees_ = 0;
+			char pad_[CACHE_LINE_SIZE];
+		};
+
+		AllocatorPoolImpl(i64 objectSize, i64 objectAlign, i64 slabSize, IAllocator& parent)
+		    : parent_(parent)
+		    , objectSize_(objectSize)
+		{
+			DBG_ASSERT(objectSize > 0);
+			DBG_ASSERT(Core::Pot(objectAlign));
+
+			// Free objects hold the index of the next free object.
+			const i64 slotAlign = Core::Max(objectAlign, (i64)sizeof(i32));
+			slotSize_ = Core::PotRoundUp(Core::Max(objectSize, (i64)sizeof(i32)), slotAlign);
+			firstSlotOffset_ = Core::PotRoundUp((i64)sizeof(SlabHeader), slotAlign);
+
+			// Slabs are aligned to their size so objects can find their slab header.
+			slabSize_ = PLATFORM_ALIGNMENT;
+			while(slabSize_ < slabSize || slabSize_ < firstSlotOffset_ + slotSize_)
+				slabSize_ *= 2;
+			slotsPerSlab_ = (i32)((slabSize_ - firstSlotOffset_) / slotSize_);
+		}
+
+		~AllocatorPoolImpl()
+		{
+			for(i32 idx = 0; idx < numSlabs_; ++idx)
+				parent_.Deallocate(slabs_[idx]);
+		}
+
+		u8* GetSlot(i32 idx) const
+		{
+			return slabs_[idx / slotsPerSlab_] + firstSlotOffset_ + (idx % slotsPerSlab_) * slotSize_;
+		}
+
+		i32 GetSlotIdx(void* mem) const
+		{
+			auto* slab = reinterpret_cast<SlabHeader*>((i64)mem & ~(slabSize_ - 1));
+			DBG_ASSERT_MSG(slab->owner_ == this, "Object was not allocated from this pool.");
+			const i64 offset = (u8*)mem - ((u8*)slab + firstSlotOffset_);
+			DBG_ASSERT(offset >= 0 && (offset % slotSize_) == 0);
+			return slab->baseIdx_ + (i32)(offset / slotSize_);
+		}
+
+		/**
+		 * Pop up to @a maxObjects from the shared free list, growing the pool if it's empty.
+		 * @return Number of objects popped into @a outObjects, 0 if out of memory.
+		 */
+		i32 PopFree(i32* outObjects, i32 maxObjects)
+		{
+			i64 head = Core::AtomicCmpExchgAcq(&freeHead_, 0, 0);
+			for(;;)
+			{
+				const i32 first = (i32)(head & 0xffffffff) - 1;
+				if(first < 0)
+				{
+					if(!Grow())
+						return 0;
+					head = Core::AtomicCmpExchgAcq(&freeHead_, 0, 0);
+					continue;
+				}
+
+				// Walk the chain to take. If another thread modifies the list whilst walking the links may be
+				// stale, but slabs are never freed so they're safe to read, and the tag will cause the exchange to fail.
+				i32 numObjects = 0;
+				i32 next = first + 1;
+				while(next != 0 && numObjects < maxObjects)
+				{
+					outObjects[numObjects++] = next - 1;
+					next = *reinterpret_cast<volatile i32*>(GetSlot(next - 1));
+					if(next < 0 || next > numSlabs_ * slotsPerSlab_)
+						break;
+				}
+
+				const i64 newHead = (((head >> 32) + 1) << 32) | (i64)(u32)next;
+				const i64 oldHead = Core::AtomicCmpExchgAcq(&freeHead_, newHead, head);
+				if(oldHead == head)
+					return numObjects;
+				head = oldHead;
+			}
+		}
+
+		/**
+		 * Push a chain of objects onto the shared free list.
+		 * @param first First object index, which must be linked through to @a last.
+		 */
+		void PushFree(i32 first, i32 last)
+		{
+			i64 head = Core::AtomicCmpExchgAcq(&freeHead_, 0, 0);
+			for(;;)
+			{
+				*reinterpret_cast<volatile i32*>(GetSlot(last)) = (i32)(head & 0xffffffff);
+				const i64 newHead = (((head >> 32) + 1) << 32) | (i64)(first + 1);
+				const i64 oldHead = Core::AtomicCmpExchgRel(&freeHead_, newHead, head);
+				if(oldHead == head)
+					break;
+				head = oldHead;
+			}
+		}
+
+		/**
+		 * Allocate a new slab and push its objects onto the shared free list.
+		 * @return false if out of memory.
+		 */
+		bool Grow()
+		{
+			Core::ScopedSpinLock lock(slabsLock_);
+
+			// Another thread may have already grown the pool.
+			if((Core::AtomicCmpExchgAcq(&freeHead_, 0, 0) & 0xffffffff) != 0)
+				return true;
+
+			if(numSlabs_ >= MAX_SLABS)
+			{
+				DBG_ASSERT_MSG(false, "Pool allocator has run out of slabs.");
+				return false;
+			}
+
+			u8* mem = (u8*)parent_.Allocate(slabSize_, slabSize_);
+			if(mem == nullptr)
+				return false;
+
+			const i32 baseIdx = numSlabs_ * slotsPerSlab_;
+			auto* slab = reinterpret_cast<SlabHeader*>(mem);
+			slab->owner_ = this;
+			slab->baseIdx_ = baseIdx;
+			slabs_[numSlabs_] = mem;
+			Core::AtomicInc(&numSlabs_);
+
+			for(i32 idx = 0; idx < slotsPerSlab_ - 1; ++idx)
+				*reinterpret_cast<i32*>(GetSlot(baseIdx + idx)) = baseIdx + idx + 2;
+			PushFree(baseIdx, baseIdx + slotsPerSlab_ - 1);
+			return true;
+		}
+
+		/**
+		 * @return Calling thread's magazine, nullptr if it doesn't have one.
+		 */
+		Magazine* GetMagazine()
+		{
+			const i32 idx = GetThreadMagazineIdx();
+			return idx >= 0 ? &magazines_[idx] : nullptr;
+		}
+
+		/**
+		 * Refill half a magazine from the shared free list.
+		 * @return false if out of memory.
+		 */
+		bool Refill(Magazine* magazine)
+		{
+			DBG_ASSERT(magazine->count_ == 0);
+			magazine->count_ = PopFree(magazine->objects_.data(), MAGAZINE_SIZE / 2);
+			AddOutstanding(magazine->count_);
+			return magazine->count_ > 0;
+		}
+
+		/**
+		 * Flush up to @a maxObjects from a magazine to the shared free list as a single chain.
+		 */
+		void Flush(Magazine* magazine, i32 maxObjects)
+		{
+			const i32 numObjects = Core::Min(magazine->count_, maxObjects);
+			if(numObjects == 0)
+				return;
+
+			const i32 base = magazine->count_ - numObjects;
+			for(i32 idx = base; idx < magazine->count_ - 1; ++idx)
+				*reinterpret_cast<i32*>(GetSlot(magazine->objects_[idx])) = magazine->objects_[idx + 1] + 1;
+			PushFree(magazine->objects_[base], magazine->objects_[magazine->count_ - 1]);
+			magazine->count_ = base;
+			AddOutstanding(-numObjects);
+		}
+
+		/// Track number of objects taken from the shared free list, for peak usage.
+		void AddOutstanding(i64 numObjects)
+		{
+			const i64 outstanding = Core::AtomicAdd(&numOutstanding_, numObjects);
+			i64 peak = peakOutstanding_;
+			while(outstanding > peak)
+			{
+				const i64 oldPeak = Core::AtomicCmpExchg(&peakOutstanding_, outstanding, peak);
+				if(oldPeak == peak)
+					break;
+				peak = oldPeak;
+			}
+		}
+
+		IAllocator& parent_;
+		i64 objectSize_ = 0;
+		i64 slotSize_ = 0;
+		i64 firstSlotOffset_ = 0;
+		i64 slabSize_ = 0;
+		i32 slotsPerSlab_ = 0;
+
+		Core::SpinLock slabsLock_;
+		Core::Array<u8*, MAX_SLABS> slabs_ = {};
+		volatile i32 numSlabs_ = 0;
+
+		/// Shared free list head. Upper 32 bits are a tag to avoid ABA, lower 32 bits are object index + 1.
+		volatile i64 freeHead_ = 0;
+
+		Core::Array<Magazine, MAX_MAGAZINES> magazines_;
+
+		/// Stats for threads without a magazine.
+		volatile i64 numAllocs_ = 0;
+		volatile i64 numFrees_ = 0;
+		volatile i64 numOutstanding_ = 0;
+		volatile i64 peakOutstanding_ = 0;
+	};
+
+	AllocatorPool::AllocatorPool(i64 objectSize, i64 objectAlign, i64 slabSize, IAllocator& parent)
+	{
+		impl_ = parent.New<AllocatorPoolImpl>(objectSize, objectAlign, slabSize, parent);
+	}
+
+	AllocatorPool::~AllocatorPool()
+	{
+		IAllocator& parent = impl_->parent_;
+		parent.Delete(impl_);
+	}
+
+	void* AllocatorPool::Allocate(i64 bytes, i64 align)
+	{
+		DBG_ASSERT(bytes <= impl_->objectSize_);
+		DBG_ASSERT(((impl_->slotSize_ | impl_->firstSlotOffset_) & (align - 1)) == 0);
+
+		auto* magazine = impl_->GetMagazine();
+		if(magazine == nullptr)
+		{
+			i32 idx = 0;
+			if(impl_->PopFree(&idx, 1) == 0)
+				return nullptr;
+			impl_->AddOutstanding(1);
+			Core::AtomicInc(&impl_->numAllocs_);
+			return impl_->GetSlot(idx);
+		}
+
+		if(magazine->count_ == 0 && !impl_->Refill(magazine))
+			return nullptr;
+		magazine->numAllocs_ = magazine->numAllocs_ + 1;
+		return impl_->GetSlot(magazine->objects_[--magazine->count_]);
+	}
+
+	void AllocatorPool::Deallocate(void* mem)
+	{
+		if(mem == nullptr)
+			return;
+
+		const i32 idx = impl_->GetSlotIdx(mem);
+		auto* magazine = impl_->GetMagazine();
+		if(magazine == nullptr)
+		{
+			impl_->PushFree(idx, idx);
+			impl_->AddOutstanding(-1);
+			Core::AtomicInc(&impl_->numFrees_);
+			return;
+		}
+
+		if(magazine->count_ == MAGAZINE_SIZE)
+			impl_->Flush(magazine, MAGAZINE_SIZE / 2);
+		magazine->objects_[magazine->count_++] = idx;
+		magazine->numFrees_ = magazine->numFrees_ + 1;
+	}
+
+	bool AllocatorPool::OwnAllocation(void* mem)
+	{
+		const i32 numSlabs = impl_->numSlabs_;
+		for(i32 idx = 0; idx < numSlabs; ++idx)
+		{
+			const u8* slab = impl_->slabs_[idx];
+			if(mem >= slab && mem < slab + impl_->slabSize_)
+				return true;
+		}
+		return false;
+	}
+
+	i64 AllocatorPool::GetAllocationSize(void* mem) { return mem ? impl_->objectSize_ : 0; }
+
+	AllocatorStats AllocatorPool::GetStats() const
+	{
+		i64 numAllocs = impl_->numAllocs_;
+		i64 numFrees = impl_->numFrees_;
+		for(const auto& magazine : impl_->magazines_)
+		{
+			numAllocs += magazine.numAllocs_;
+			numFrees += magazine.numFrees_;
+		}
+
+		AllocatorStats retVal;
+		retVal.numAllocations_ = numAllocs;
+		retVal.usage_ = (numAllocs - numFrees) * impl_->slotSize_;
+		retVal.peakUsage_ = Core::Max(impl_->peakOutstanding_ * impl_->slotSize_, retVal.usage_);
+		return retVal;
+	}
+
+	void AllocatorPool::LogStats() const
+	{
+		const AllocatorStats stats = GetStats();
+		Core::Log("Pool Allocator:\n");
+		Core::Log(" - Object Size: %lld (%lld slot)\n", impl_->objectSize_, impl_->slotSize_);
+		Core::Log(" - Slabs: %i x %lld bytes\n", impl_->numSlabs_, impl_->slabSize_);
+		Core::Log(" - Allocations: %lld\n", stats.numAllocations_);
+		Core::Log(" - Usage: %lld\n", stats.usage_);
+		Core::Log(" - Peak Usage: %lld\n", stats.peakUsage_);
+	}
+
+	void AllocatorPool::FlushThreadMagazine()
+	{
+		if(auto* magazine = impl_->GetMagazine())
+			impl_->Flush(magazine, MAGAZINE_SIZE);
+	}
+} // namespace Core
@@ -2,13 +2,47 @@
 #include "core/array.h"
 #include "core/concurrency.h"
 #include "core/debug.h"
+#include "core/file.h"
 #include "core/map.h"
+#include "core/misc.h"
+#include "core/random.h"
+#include "core/vector.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 
 namespace Core
 {
+	namespace
+	{
+		static const i32 MAX_CALLSTACK_FRAMES = 32;
+
+		/// Number of stripes of per-thread counters and sample buffers, threads are assigned round robin.
+		static const i32 NUM_STRIPES = 16;
+		static const i32 SAMPLE_BUFFER_SIZE = 16;
+
+		/// Number of counters used to quickly reject frees of allocations that weren't sampled.
+		static const i32 SAMPLE_FILTER_SIZE = 16384;
+
+		/// Bytes left to allocate on this thread before the next sample. Shared by all trackers.
+		thread_local i64 bytesUntilSample_ = 0;
+		thread_local bool sampleRandomInit_ = false;
+		thread_local Core::Random sampleRandom_;
+		thread_local i32 stripeIdx_ = -1;
+		volatile i32 nextStripeIdx_ = 0;
+
+		i32 GetStripeIdx()
+		{
+			if(stripeIdx_ < 0)
+				stripeIdx_ = (Core::AtomicInc(&nextStripeIdx_) - 1) % NUM_STRIPES;
+			return stripeIdx_;
+		}
+	}
+
 	struct PointerHasher
 	{
-		u64 operator()(u64 input, const void* data) const { return HashFNV1a(input, &data, sizeof(void*)); }
+		u64 operator()(u64 input, const void* data) const { return HashMix64(input, (u64)(uintptr_t)data); }
 	};
 
 	struct AllocInfo
@@ -17,23 +51,73 @@ namespace Core
 		i64 requestSize_ = 0;
 		i64 allocSize_ = 0;
 		i64 numFrames_ = 0;
-		Core::Array<void*, 32> callstack_ = {};
+		Core::Array<void*, MAX_CALLSTACK_FRAMES> callstack_ = {};
+	};
+
+	/// Allocations aggregated by callstack.
+	struct CallSite
+	{
+		i32 numFrames_ = 0;
+		Core::Array<void*, MAX_CALLSTACK_FRAMES> callstack_ = {};
+		i64 liveBytes_ = 0;
+		i64 liveObjects_ = 0;
+		i64 allocBytes_ = 0;
+		i64 allocObjects_ = 0;
+	};
+
+	/// Sampled allocation or free, waiting to be aggregated into its call site.
+	struct SampleRecord
+	{
+		u64 siteHash_ = 0;
+		i64 bytes_ = 0;
+		i64 objects_ = 0;
+		/// 0 for frees, as the call site will already have its callstack.
+		i32 numFrames_ = 0;
+		Core::Array<void*, MAX_CALLSTACK_FRAMES> callstack_;
+	};
+
+	struct SampleBuffer
+	{
+		Core::SpinLock lock_;
+		i32 numRecords_ = 0;
+		Core::Array<SampleRecord, SAMPLE_BUFFER_SIZE> records_;
+		char pad_[CACHE_LINE_SIZE];
+	};
+
+	/// Call counters for a stripe of threads, so counting doesn't contend on a single cache line.
+	/// Only used when tracking all allocations, sampling keeps no per-call shared state.
+	struct CounterStripe
+	{
+		volatile i64 allocs_ = 0;
+		volatile i64 deallocs_ = 0;
+		volatile i64 ownAllocs_ = 0;
+		volatile i64 getAllocSizes_ = 0;
+		/// Allocations minus deallocations, which may be negative for a single stripe.
+		volatile i64 allocated_ = 0;
+		char pad_[CACHE_LINE_SIZE];
+	};
+
+	/// Live sampled allocation, with weights to scale up to an estimate of all allocations.
+	struct SampledAlloc
+	{
+		u64 siteHash_ = 0;
+		i64 bytes_ = 0;
+		i64 objects_ = 0;
 	};
 
 	struct AllocatorProxyTrackerImpl
 	{
-		AllocatorProxyTrackerImpl(IAllocator& allocator)
+		AllocatorProxyTrackerImpl(IAllocator& allocator, i64 sampleInterval)
 		    : allocator_(allocator)
-		    , allocInfos_(UntrackedVirtualAllocator(), 4096)
+		    , allocInfos_(UntrackedVirtualAllocator(), sampleInterval > 0 ? 16 : 4096)
+		    , sampleInterval_(sampleInterval)
+		    , sites_(UntrackedVirtualAllocator(), 1024)
+		    , sampledAllocs_(UntrackedVirtualAllocator(), 1024)
 		{
 		}
 
 		void AddAlloc(void* mem, i64 size)
 		{
-			const i64 totalAllocated = Core::AtomicIncAcq(&totalAllocated_);
-			//DBG_LOG("%s %p Alloc (%lld) : %p\n", impl_->name_, impl_, totalAllocated, mem);
-			DBG_ASSERT(totalAllocated > 0);
-
 			AllocInfo allocInfo;
 			allocInfo.mem_ = mem;
 			allocInfo.requestSize_ = size;
@@ -66,41 +150,270 @@ namespace Core
 
 		void RemoveAlloc(void* mem)
 		{
-			const i64 totalAllocated = Core::AtomicDecAcq(&totalAllocated_);
-			//DBG_LOG("%s %p Dealloc (%lld): %p\n", impl_->name_, impl_, totalAllocated, mem);
-			DBG_ASSERT(totalAllocated >= 0);
+			Core::ScopedWriteLock lock(rwLock_);
+			auto oldAllocs = allocInfos_.size();
+			auto* allocInfo = allocInfos_.find(mem);
+			DBG_ASSERT(allocInfo);
 
+			Core::AtomicAdd(&usage_, -allocInfo->allocSize_);
+			memset(mem, 0xfe, allocInfo->requestSize_);
+			allocInfos_.erase(mem);
+
+			DBG_ASSERT(allocInfos_.size() == (oldAllocs - 1));
+		}
+
+		/**
+		 * @return Number of bytes to allocate before taking the next sample.
+		 * Exponentially distributed, so samples are a Poisson process over allocated bytes.
+		 */
+		i64 NextSampleDistance()
+		{
+			if(!sampleRandomInit_)
 			{
-				Core::ScopedWriteLock lock(rwLock_);
-				auto oldAllocs = allocInfos_.size();
-				auto* allocInfo = allocInfos_.find(mem);
-				DBG_ASSERT(allocInfo);
+				sampleRandom_ = Core::Random((u32)(((i64)&sampleRandom_ >> 4) | 1));
+				sampleRandomInit_ = true;
+			}
+			const f64 u = (f64)(((u32)sampleRandom_.Generate() & 0xffffff) + 1) / (f64)0x1000000;
+			return (i64)(-std::log(u) * (f64)sampleInterval_) + 1;
+		}
+
+		/**
+		 * Sample allocation if this thread is due one.
+		 */
+		void SampleAlloc(void* mem, i64 size)
+		{
+			bytesUntilSample_ -= size;
+			if(bytesUntilSample_ >= 0)
+				return;
+
+			// New threads haven't drawn their first sample point yet.
+			if(!sampleRandomInit_)
+			{
+				bytesUntilSample_ += NextSampleDistance();
+				if(bytesUntilSample_ >= 0)
+					return;
+			}
+			bytesUntilSample_ = NextSampleDistance();
+
+			// Weight by the inverse of the probability this allocation would be sampled.
+			const f64 probability = 1.0 - std::exp(-(f64)size / (f64)sampleInterval_);
+			SampledAlloc sampledAlloc;
+			sampledAlloc.bytes_ = (i64)((f64)size / probability);
+			sampledAlloc.objects_ = Core::Max((i64)(1.0 / probability + 0.5), (i64)1);
+
+			SampleRecord record;
+			record.numFrames_ = Core::GetCallstack(3, record.callstack_.data(), record.callstack_.size());
+			record.siteHash_ = HashWyhash(0, record.callstack_.data(), record.numFrames_ * sizeof(void*));
+			record.bytes_ = sampledAlloc.bytes_;
+			record.objects_ = sampledAlloc.objects_;
+			sampledAlloc.siteHash_ = record.siteHash_;
+
+			{
+				Core::ScopedSpinLock lock(sampledAllocsLock_);
+				sampledAllocs_.insert(mem, sampledAlloc);
+				const i32 filterIdx = GetSampleFilterIdx(mem);
+				if(sampleFilterCounts_[filterIdx]++ == 0)
+					Core::AtomicOr(&sampleFilter_[filterIdx / 32], GetSampleFilterBit(filterIdx));
+			}
+
+			AddSampleRecord(record);
+		}
+
+		/**
+		 * Remove sampled allocation, if @a mem was sampled.
+		 */
+		void SampleFree(void* mem)
+		{
+			const i32 filterIdx = GetSampleFilterIdx(mem);
+			if((sampleFilter_[filterIdx / 32] & GetSampleFilterBit(filterIdx)) == 0)
+				return;
+
+			SampleRecord record;
+			{
+				Core::ScopedSpinLock lock(sampledAllocsLock_);
+				auto* sampledAlloc = sampledAllocs_.find(mem);
+				if(sampledAlloc == nullptr)
+					return;
+				record.siteHash_ = sampledAlloc->siteHash_;
+				record.bytes_ = -sampledAlloc->bytes_;
+				record.objects_ = -sampledAlloc->objects_;
+				sampledAllocs_.erase(mem);
+				if(--sampleFilterCounts_[filterIdx] == 0)
+					Core::AtomicAnd(&sampleFilter_[filterIdx / 32], ~GetSampleFilterBit(filterIdx));
+			}
+
+			AddSampleRecord(record);
+		}
+
+		i32 GetSampleFilterIdx(void* mem) const
+		{
+			return (i32)(PointerHasher()(0, mem) & (SAMPLE_FILTER_SIZE - 1));
+		}
+
+		static i32 GetSampleFilterBit(i32 filterIdx) { return (i32)(1u << (filterIdx % 32)); }
+
+		/**
+		 * Add record to calling thread's buffer, aggregating the buffer into call sites when full.
+		 */
+		void AddSampleRecord(const SampleRecord& record)
+		{
+			auto& buffer = sampleBuffers_[GetStripeIdx()];
+			Core::ScopedSpinLock lock(buffer.lock_);
+			if(buffer.numRecords_ == SAMPLE_BUFFER_SIZE)
+			{
+				AddRecords(buffer.records_.data(), buffer.numRecords_);
+				buffer.numRecords_ = 0;
+			}
+			buffer.records_[buffer.numRecords_++] = record;
+		}
 
-				Core::AtomicAdd(&usage_, -allocInfo->allocSize_);
-				memset(mem, 0xfe, allocInfo->requestSize_);
-				allocInfos_.erase(mem);
+		/**
+		 * Aggregate all sample buffers into call sites.
+		 */
+		void FlushSampleBuffers()
+		{
+			for(auto& buffer : sampleBuffers_)
+			{
+				Core::ScopedSpinLock lock(buffer.lock_);
+				AddRecords(buffer.records_.data(), buffer.numRecords_);
+				buffer.numRecords_ = 0;
+			}
+		}
+
+		/**
+		 * Aggregate sample records into call sites, and update usage estimates from them.
+		 */
+		void AddRecords(const SampleRecord* records, i32 numRecords)
+		{
+			DBG_ASSERT(IsSampling());
+			Core::ScopedSpinLock lock(sitesLock_);
+			for(i32 idx = 0; idx < numRecords; ++idx)
+			{
+				const auto& record = records[idx];
+				CallSite* site = sites_.find(record.siteHash_);
+				if(site == nullptr)
+					site = sites_.insert(record.siteHash_, CallSite());
+
+				// Frees can be aggregated before their allocation if recorded on another thread.
+				if(record.numFrames_ > 0 && site->numFrames_ == 0)
+				{
+					site->numFrames_ = record.numFrames_;
+					site->callstack_ = record.callstack_;
+				}
 
-				DBG_ASSERT(allocInfos_.size() == (oldAllocs - 1));
+				site->liveBytes_ += record.bytes_;
+				site->liveObjects_ += record.objects_;
+				if(record.objects_ > 0)
+				{
+					site->allocBytes_ += record.bytes_;
+					site->allocObjects_ += record.objects_;
+				}
+				sampledUsage_ += record.bytes_;
+				sampledObjects_ += record.objects_;
 			}
+
+			usage_ = sampledUsage_;
+			peakUsage_ = Core::Max(peakUsage_, sampledUsage_);
+		}
+
+		/**
+		 * Aggregate live allocations into call sites.
+		 * Only used when tracking all allocations, as call sites aren't maintained per allocation.
+		 */
+		void GetLiveSites(Core::Vector<CallSite, IAllocator&>& outSites)
+		{
+			DBG_ASSERT(!IsSampling());
+			Core::Map<u64, CallSite, Hasher<u64>, IAllocator&> liveSites(UntrackedVirtualAllocator(), 1024);
+			{
+				Core::ScopedReadLock lock(rwLock_);
+				for(auto it : allocInfos_)
+				{
+					const AllocInfo& allocInfo = it.value;
+					const u64 siteHash =
+					    HashWyhash(0, allocInfo.callstack_.data(), allocInfo.numFrames_ * sizeof(void*));
+					CallSite* site = liveSites.find(siteHash);
+					if(site == nullptr)
+					{
+						site = liveSites.insert(siteHash, CallSite());
+						site->numFrames_ = (i32)allocInfo.numFrames_;
+						site->callstack_ = allocInfo.callstack_;
+					}
+					site->liveBytes_ += allocInfo.requestSize_;
+					site->liveObjects_++;
+				}
+			}
+
+			// Freed allocations aren't kept, so only live ones contribute to the allocated totals.
+			outSites.reserve(liveSites.size());
+			for(auto it : liveSites)
+			{
+				CallSite site = it.value;
+				site.allocBytes_ = site.liveBytes_;
+				site.allocObjects_ = site.liveObjects_;
+				outSites.push_back(site);
+			}
+		}
+
+		bool IsSampling() const { return sampleInterval_ > 0; }
+
+		CounterStripe& GetCounters() { return counters_[GetStripeIdx()]; }
+
+		/**
+		 * @return Number of live allocations, estimated from the samples when sampling.
+		 */
+		i64 GetNumAllocations()
+		{
+			if(IsSampling())
+			{
+				FlushSampleBuffers();
+				Core::ScopedSpinLock lock(sitesLock_);
+				return sampledObjects_;
+			}
+			return SumCounters(&CounterStripe::allocated_);
+		}
+
+		/**
+		 * @return Sum of @a counter over all stripes.
+		 */
+		i64 SumCounters(volatile i64 CounterStripe::*counter) const
+		{
+			i64 sum = 0;
+			for(const auto& stripe : counters_)
+				sum += stripe.*counter;
+			return sum;
 		}
 
 		IAllocator& allocator_;
 		Core::Array<char, 64> name_;
 		Core::RWLock rwLock_;
 		Core::Map<void*, AllocInfo, PointerHasher, IAllocator&> allocInfos_;
-		volatile i64 totalAllocs_ = 0;
-		volatile i64 totalDeallocs_ = 0;
-		volatile i64 totalOwnAlloc_ = 0;
-		volatile i64 totalGetAllocSize_ = 0;
-		volatile i64 totalAllocated_ = 0;
+		Core::Array<CounterStripe, NUM_STRIPES> counters_;
 
 		volatile i64 usage_ = 0;
 		volatile i64 peakUsage_ = 0;
+
+		/// Mean bytes between samples, 0 if tracking all allocations.
+		i64 sampleInterval_ = 0;
+
+		/// Call sites, keyed by callstack hash. Only maintained when sampling.
+		Core::SpinLock sitesLock_;
+		Core::Map<u64, CallSite, Hasher<u64>, IAllocator&> sites_;
+		i64 sampledUsage_ = 0;
+		i64 sampledObjects_ = 0;
+
+		Core::SpinLock sampledAllocsLock_;
+		Core::Map<void*, SampledAlloc, PointerHasher, IAllocator&> sampledAllocs_;
+		/// Number of live sampled allocations for each filter index.
+		Core::Array<i32, SAMPLE_FILTER_SIZE> sampleFilterCounts_ = {};
+		/// Bit set for each filter index with live sampled allocations, small enough to stay in cache when freeing.
+		Core::Array<volatile i32, SAMPLE_FILTER_SIZE / 32> sampleFilter_ = {};
+
+		Core::Array<SampleBuffer, NUM_STRIPES> sampleBuffers_;
 	};
 
-	AllocatorProxyTracker::AllocatorProxyTracker(IAllocator& allocator, const char* name)
+	AllocatorProxyTracker::AllocatorProxyTracker(IAllocator& allocator, const char* name, i64 sampleInterval)
 	{
-		impl_ = UntrackedVirtualAllocator().New<AllocatorProxyTrackerImpl>(allocator);
+		impl_ = UntrackedVirtualAllocator().New<AllocatorProxyTrackerImpl>(allocator, sampleInterval);
 		strcpy_s(impl_->name_.data(), impl_->name_.size(), name);
 	}
 
@@ -109,7 +422,8 @@ namespace Core
 		{
 			Core::ScopedReadLock lock(impl_->rwLock_);
 
-			if(impl_->totalAllocated_ > 0)
+			const i64 totalAllocated = impl_->GetNumAllocations();
+			if(totalAllocated > 0)
 			{
 				Core::Log("=====================================================\n");
 				LogAllocs();
@@ -118,7 +432,7 @@ namespace Core
 			Core::Log("=====================================================\n");
 			LogStats();
 
-			DBG_ASSERT_MSG(impl_->totalAllocated_ == 0, "Memory leaks detected in %s allocator!", impl_->name_);
+			DBG_ASSERT_MSG(totalAllocated == 0, "Memory leaks detected in %s allocator!", impl_->name_);
 		}
 
 		UntrackedVirtualAllocator().Delete(impl_);
@@ -126,10 +440,20 @@ namespace Core
 
 	void* AllocatorProxyTracker::Allocate(i64 bytes, i64 align)
 	{
-		Core::AtomicIncAcq(&impl_->totalAllocs_);
 		auto mem = impl_->allocator_.Allocate(bytes, align);
+		if(impl_->IsSampling())
+		{
+			// Only the thread's sample countdown is touched, so there are no shared writes until a sample is taken.
+			if(mem)
+				impl_->SampleAlloc(mem, bytes);
+			return mem;
+		}
+
+		auto& counters = impl_->GetCounters();
+		Core::AtomicInc(&counters.allocs_);
 		if(mem)
 		{
+			Core::AtomicInc(&counters.allocated_);
 			impl_->AddAlloc(mem, bytes);
 		}
 		return mem;
@@ -137,9 +461,20 @@ namespace Core
 
 	void AllocatorProxyTracker::Deallocate(void* mem)
 	{
-		Core::AtomicIncAcq(&impl_->totalDeallocs_);
+		if(impl_->IsSampling())
+		{
+			// Must be removed before deallocating, in case another thread reuses and samples the memory.
+			if(mem)
+				impl_->SampleFree(mem);
+			impl_->allocator_.Deallocate(mem);
+			return;
+		}
+
+		auto& counters = impl_->GetCounters();
+		Core::AtomicInc(&counters.deallocs_);
 		if(mem)
 		{
+			Core::AtomicDec(&counters.allocated_);
 			DBG_ASSERT(OwnAllocation(mem));
 			impl_->RemoveAlloc(mem);
 			impl_->allocator_.Deallocate(mem);
@@ -148,21 +483,23 @@ namespace Core
 
 	bool AllocatorProxyTracker::OwnAllocation(void* mem)
 	{
-		Core::AtomicIncAcq(&impl_->totalOwnAlloc_);
+		if(!impl_->IsSampling())
+			Core::AtomicInc(&impl_->GetCounters().ownAllocs_);
 		return impl_->allocator_.OwnAllocation(mem);
 	}
 
 	i64 AllocatorProxyTracker::GetAllocationSize(void* mem)
 	{
-		Core::AtomicIncAcq(&impl_->totalGetAllocSize_);
-		DBG_ASSERT(impl_->allocInfos_.find(mem) != nullptr);
+		if(!impl_->IsSampling())
+			Core::AtomicInc(&impl_->GetCounters().getAllocSizes_);
+		DBG_ASSERT(impl_->IsSampling() || impl_->allocInfos_.find(mem) != nullptr);
 		return impl_->allocator_.GetAllocationSize(mem);
 	}
 
 	AllocatorStats AllocatorProxyTracker::GetStats() const
 	{
 		AllocatorStats retVal;
-		retVal.numAllocations_ = impl_->totalAllocated_;
+		retVal.numAllocations_ = impl_->GetNumAllocations();
 		retVal.peakUsage_ = impl_->peakUsage_;
 		retVal.usage_ = impl_->usage_;
 		return retVal;
@@ -170,13 +507,24 @@ namespace Core
 
 	void AllocatorProxyTracker::LogStats() const
 	{
+		if(impl_->IsSampling())
+			impl_->FlushSampleBuffers();
+
 		Core::Log("%s Allocation Tracker:\n", impl_->name_.data());
 		Core::Log(" - Proxy Stats:\n");
-		Core::Log(" - - Allocate calls: %lld:\n", impl_->totalAllocs_);
-		Core::Log(" - - Deallocate calls: %lld:\n", impl_->totalDeallocs_);
-		Core::Log(" - - OwnAllocation calls: %lld:\n", impl_->totalOwnAlloc_);
-		Core::Log(" - - GetAllocationSize calls: %lld:\n", impl_->totalGetAllocSize_);
-		Core::Log(" - - Total Allocated: %lld:\n", impl_->totalAllocated_);
+		if(impl_->IsSampling())
+		{
+			Core::Log(" - - Sample Interval: %lld:\n", impl_->sampleInterval_);
+			Core::Log(" - - Estimated Allocated: %lld:\n", impl_->GetNumAllocations());
+		}
+		else
+		{
+			Core::Log(" - - Allocate calls: %lld:\n", impl_->SumCounters(&CounterStripe::allocs_));
+			Core::Log(" - - Deallocate calls: %lld:\n", impl_->SumCounters(&CounterStripe::deallocs_));
+			Core::Log(" - - OwnAllocation calls: %lld:\n", impl_->SumCounters(&CounterStripe::ownAllocs_));
+			Core::Log(" - - GetAllocationSize calls: %lld:\n", impl_->SumCounters(&CounterStripe::getAllocSizes_));
+			Core::Log(" - - Total Allocated: %lld:\n", impl_->SumCounters(&CounterStripe::allocated_));
+		}
 		Core::Log(" - - Usage: %lld:\n", impl_->usage_);
 		Core::Log(" - - Peak Usage: %lld:\n", impl_->peakUsage_);
 	}
@@ -185,6 +533,26 @@ namespace Core
 	{
 		Core::Log("%s Leaks:\n", impl_->name_.data());
 
+		// Only sampled allocations are known, so log estimates for their call sites.
+		if(impl_->IsSampling())
+		{
+			impl_->FlushSampleBuffers();
+			Core::ScopedSpinLock lock(impl_->sitesLock_);
+			for(auto it : impl_->sites_)
+			{
+				const CallSite& site = it.value;
+				if(site.liveObjects_ <= 0)
+					continue;
+				Core::Log(" - Site: ~%lld allocs, ~%lld bytes\n", site.liveObjects_, site.liveBytes_);
+				for(i32 i = 0; i < site.numFrames_; ++i)
+				{
+					SymbolInfo sym = Core::GetSymbolInfo(site.callstack_[i]);
+					Core::Log(" - - %p - %s\n", site.callstack_[i], sym.name_);
+				}
+			}
+			return;
+		}
+
 		for(auto it : impl_->allocInfos_)
 		{
 			const AllocInfo& allocInfo = it.value;
@@ -196,4 +564,56 @@ namespace Core
 			}
 		}
 	}
+
+	bool AllocatorProxyTracker::WriteHeapProfile(File& file) const
+	{
+		// Copy out sites so no locks are held whilst resolving symbols and writing.
+		Core::Vector<CallSite, IAllocator&> sites(UntrackedVirtualAllocator());
+		if(impl_->IsSampling())
+		{
+			impl_->FlushSampleBuffers();
+			Core::ScopedSpinLock lock(impl_->sitesLock_);
+			sites.reserve(impl_->sites_.size());
+			for(auto it : impl_->sites_)
+				if(it.value.liveObjects_ > 0 || it.value.allocObjects_ > 0)
+					sites.push_back(it.value);
+		}
+		else
+		{
+			impl_->GetLiveSites(sites);
+		}
+
+		std::sort(sites.begin(), sites.end(), [](const CallSite& a, const CallSite& b) {
+			if(a.liveBytes_ != b.liveBytes_)
+				return a.liveBytes_ > b.liveBytes_;
+			return a.allocBytes_ > b.allocBytes_;
+		});
+
+		Core::Array<char, 8192> line;
+		i32 length = snprintf(line.data(), line.size(), "# Heap profile: %s, sample interval %lld bytes\n",
+		    impl_->name_.data(), impl_->sampleInterval_);
+		length += snprintf(line.data() + length, line.size() - length,
+		    "# live_bytes live_objects alloc_bytes alloc_objects: callstack\n");
+		if(file.Write(line.data(), length) != length)
+			return false;
+
+		for(const auto& site : sites)
+		{
+			length = snprintf(line.data(), line.size(), "%lld %lld %lld %lld:", site.liveBytes_, site.liveObjects_,
+			    site.allocBytes_, site.allocObjects_);
+			for(i32 i = 0; i < site.numFrames_ && length < line.size(); ++i)
+			{
+				SymbolInfo sym = Core::GetSymbolInfo(site.callstack_[i]);
+				if(sym.name_[0] != '\0')
+					length += snprintf(line.data() + length, line.size() - length, " %s", sym.name_);
+				else
+					length += snprintf(line.data() + length, line.size() - length, " %p", site.callstack_[i]);
+			}
+			length = Core::Min(length, line.size() - 2);
+			line[length++] = '\n';
+			if(file.Write(line.data(), length) != length)
+				return false;
+		}
+		return true;
+	}
 } // namespace Core
@@ -0,0 +1,675 @@
+#include "core/allocator_thread_cache.h"
+#include "core/array.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+
+#include <cstring>
+
+namespace Core
+{
+	struct AllocatorThreadCacheImpl;
+
+	namespace
+	{
+		/// Spans are carved into blocks of a single size class, and are aligned to their size.
+		static const i32 SPAN_SHIFT = 16;
+		static const i64 SPAN_SIZE = 1LL << SPAN_SHIFT;
+		/// Space at the start of each span for its header, keeps blocks 16 byte aligned.
+		static const i64 SPAN_HEADER_SIZE = 64;
+
+		/// Spans are reserved from the parent in regions, so it isn't asked for span alignment on every span.
+		static const i32 SPANS_PER_REGION = 16;
+		static const i64 REGION_SIZE = SPAN_SIZE * SPANS_PER_REGION;
+		static const u32 REGION_ALL_SPANS_FREE = (1U << SPANS_PER_REGION) - 1;
+
+		/// Number of address bits covered by the span map.
+		static const i32 ADDRESS_BITS = 48;
+		static const i32 SPAN_MAP_LEAF_BITS = 16;
+		static const i64 SPAN_MAP_LEAF_SIZE = 1LL << SPAN_MAP_LEAF_BITS;
+		static const i64 SPAN_MAP_ROOT_SIZE = 1LL << (ADDRESS_BITS - SPAN_SHIFT - SPAN_MAP_LEAF_BITS);
+
+		/// 16 byte steps up to 128, then 4 classes per power of 2 up to MAX_SMALL_SIZE.
+		static const i32 NUM_SIZE_CLASSES = 24;
+		static const i32 SIZE_CLASS_GRANULARITY = 16;
+
+		/// Target number of bytes moved between a thread cache and the shared lists at once.
+		static const i64 BATCH_BYTES = 16 * 1024;
+		static const i32 MIN_BATCH_SIZE = 4;
+		static const i32 MAX_BATCH_SIZE = 64;
+
+		/// Maximum number of allocators a thread can have caches for at once.
+		static const i32 MAX_THREAD_CACHES = 4;
+
+		/// Free block. Chains of blocks are moved between thread caches and the shared lists.
+		struct Block
+		{
+			/// Next block in this chain.
+			Block* next_;
+		};
+
+		struct Region
+		{
+			Region* next_ = nullptr;
+			Region* prev_ = nullptr;
+			/// First span, aligned to SPAN_SIZE.
+			u8* base_ = nullptr;
+			/// Bit per span, set if free.
+			u32 freeSpans_ = REGION_ALL_SPANS_FREE;
+		};
+
+		struct SpanHeader
+		{
+			/// Links within the size class list of spans with free blocks.
+			SpanHeader* next_;
+			SpanHeader* prev_;
+			Region* region_;
+			/// Blocks that have been freed back to this span.
+			Block* freeBlocks_;
+			/// Blocks at the end of the span that have never been handed out.
+			i32 numUncarved_;
+			/// Total free blocks, including uncarved.
+			i32 numFree_;
+			i32 numBlocks_;
+		};
+
+		static_assert(sizeof(Block) <= SIZE_CLASS_GRANULARITY, "Smallest size class must fit a Block.");
+		static_assert(sizeof(SpanHeader) <= SPAN_HEADER_SIZE, "SpanHeader must fit in SPAN_HEADER_SIZE.");
+		static_assert(SPANS_PER_REGION <= 32, "Region free spans must fit in a u32.");
+
+		template<typename TYPE>
+		void ListPushFront(TYPE*& head, TYPE* item)
+		{
+			item->prev_ = nullptr;
+			item->next_ = head;
+			if(head)
+				head->prev_ = item;
+			head = item;
+		}
+
+		template<typename TYPE>
+		void ListRemove(TYPE*& head, TYPE* item)
+		{
+			if(item->prev_)
+				item->prev_->next_ = item->next_;
+			else
+				head = item->next_;
+			if(item->next_)
+				item->next_->prev_ = item->prev_;
+			item->next_ = nullptr;
+			item->prev_ = nullptr;
+		}
+
+		SpanHeader* GetSpan(const void* mem) { return reinterpret_cast<SpanHeader*>((u64)mem & ~(u64)(SPAN_SIZE - 1)); }
+
+		struct ThreadCache
+		{
+			struct FreeList
+			{
+				Block* head_ = nullptr;
+				i32 count_ = 0;
+			};
+
+			AllocatorThreadCacheImpl* owner_ = nullptr;
+			ThreadCache* next_ = nullptr;
+			Core::Array<FreeList, NUM_SIZE_CLASSES> freeLists_;
+		};
+
+		/// Caches for the current thread. Trivially destructible, so it's still safe to use during thread exit.
+		thread_local Core::Array<ThreadCache*, MAX_THREAD_CACHES> threadCaches_ = {};
+		/// Set once the current thread's caches have been released on thread exit.
+		thread_local bool threadCachesReleased_ = false;
+
+		/// Releases the current thread's caches on thread exit.
+		struct ThreadCacheReleaser
+		{
+			~ThreadCacheReleaser();
+			void Register() {}
+		};
+		thread_local ThreadCacheReleaser threadCacheReleaser_;
+	}
+
+	struct AllocatorThreadCacheImpl
+	{
+		struct CentralList
+		{
+			Core::SpinLock lock_;
+			/// Spans with free blocks.
+			SpanHeader* spans_ = nullptr;
+			i32 numSpans_ = 0;
+		};
+
+		AllocatorThreadCacheImpl(IAllocator& parent)
+		    : parent_(parent)
+		{
+			i32 numClasses = 0;
+			for(i64 size = SIZE_CLASS_GRANULARITY; size <= 128; size += SIZE_CLASS_GRANULARITY)
+				classSizes_[numClasses++] = size;
+			for(i64 base = 128; base < AllocatorThreadCache::MAX_SMALL_SIZE; base *= 2)
+				for(i64 step = 1; step <= 4; ++step)
+					classSizes_[numClasses++] = base + (base / 4) * step;
+			DBG_ASSERT(numClasses == NUM_SIZE_CLASSES);
+
+			i32 sizeClass = 0;
+			for(i32 idx = 0; idx < sizeToClass_.size(); ++idx)
+			{
+				const i64 size = (idx + 1) * SIZE_CLASS_GRANULARITY;
+				while(classSizes_[sizeClass] < size)
+					++sizeClass;
+				sizeToClass_[idx] = (u8)sizeClass;
+			}
+
+			for(i32 idx = 0; idx < NUM_SIZE_CLASSES; ++idx)
+				batchSizes_[idx] = (i32)Core::Clamp(BATCH_BYTES / classSizes_[idx], (i64)MIN_BATCH_SIZE, (i64)MAX_BATCH_SIZE);
+
+			spanMap_ = (u8**)parent_.Allocate(SPAN_MAP_ROOT_SIZE * sizeof(u8*), PLATFORM_ALIGNMENT);
+			DBG_ASSERT(spanMap_);
+			memset(spanMap_, 0, SPAN_MAP_ROOT_SIZE * sizeof(u8*));
+		}
+
+		~AllocatorThreadCacheImpl()
+		{
+			// Caches of other threads can't be released from here, as they still reference them.
+			for(auto& threadCache : threadCaches_)
+			{
+				if(threadCache && threadCache->owner_ == this)
+				{
+					ReleaseThreadCache(threadCache);
+					threadCache = nullptr;
+				}
+			}
+			DBG_ASSERT_MSG(caches_ == nullptr, "Threads still have caches for this allocator.");
+
+			// Any allocations still live are released along with their regions.
+			ReleaseRegions(partialRegions_);
+			ReleaseRegions(fullRegions_);
+
+			for(i64 idx = 0; idx < SPAN_MAP_ROOT_SIZE; ++idx)
+				parent_.Deallocate(spanMap_[idx]);
+			parent_.Deallocate(spanMap_);
+		}
+
+		i32 GetSizeClass(i64 bytes) const
+		{
+			return sizeToClass_[(i32)((Core::Max(bytes, (i64)1) - 1) / SIZE_CLASS_GRANULARITY)];
+		}
+
+		/**
+		 * @return Size class of span @a mem is in, -1 if not in a span.
+		 */
+		i32 LookupSizeClass(const void* mem) const
+		{
+			const u64 span = (u64)mem >> SPAN_SHIFT;
+			const u64 rootIdx = span >> SPAN_MAP_LEAF_BITS;
+			if(rootIdx >= (u64)SPAN_MAP_ROOT_SIZE)
+				return -1;
+			const u8* leaf = spanMap_[rootIdx];
+			if(leaf == nullptr)
+				return -1;
+			return (i32)leaf[span & (SPAN_MAP_LEAF_SIZE - 1)] - 1;
+		}
+
+		/**
+		 * Set size class of span @a mem is in, -1 if it's no longer a span.
+		 */
+		bool SetSpanSizeClass(const void* mem, i32 sizeClass)
+		{
+			const u64 span = (u64)mem >> SPAN_SHIFT;
+			const u64 rootIdx = span >> SPAN_MAP_LEAF_BITS;
+			if(rootIdx >= (u64)SPAN_MAP_ROOT_SIZE)
+				return false;
+
+			u8* leaf = spanMap_[rootIdx];
+			if(leaf == nullptr)
+			{
+				u8* newLeaf = (u8*)parent_.Allocate(SPAN_MAP_LEAF_SIZE, PLATFORM_ALIGNMENT);
+				if(newLeaf == nullptr)
+					return false;
+				memset(newLeaf, 0, SPAN_MAP_LEAF_SIZE);
+
+				leaf = Core::AtomicCmpExchgPtr(&spanMap_[rootIdx], newLeaf, (u8*)nullptr);
+				if(leaf == nullptr)
+					leaf = newLeaf;
+				else
+					parent_.Deallocate(newLeaf);
+			}
+			leaf[span & (SPAN_MAP_LEAF_SIZE - 1)] = (u8)(sizeClass + 1);
+			return true;
+		}
+
+		/**
+		 * Take a free span from a region, reserving a new region if there are none.
+		 * @return Span, nullptr if out of memory.
+		 */
+		u8* AllocateRegionSpan(Region*& outRegion)
+		{
+			Core::ScopedSpinLock lock(regionsLock_);
+			Region* region = partialRegions_;
+			if(region == nullptr)
+			{
+				region = parent_.New<Region>();
+				if(region == nullptr)
+					return nullptr;
+				region->base_ = (u8*)parent_.Allocate(REGION_SIZE, SPAN_SIZE);
+				if(region->base_ == nullptr)
+				{
+					parent_.Delete(region);
+					return nullptr;
+				}
+				ListPushFront(partialRegions_, region);
+			}
+
+			if(region == spareRegion_)
+				spareRegion_ = nullptr;
+			const i32 spanIdx = Core::CountTrailingZeros(region->freeSpans_);
+			region->freeSpans_ &= ~(1U << spanIdx);
+			if(region->freeSpans_ == 0)
+			{
+				ListRemove(partialRegions_, region);
+				ListPushFront(fullRegions_, region);
+			}
+			outRegion = region;
+			return region->base_ + spanIdx * SPAN_SIZE;
+		}
+
+		/**
+		 * Return a span to its region.
+		 * One empty region is kept spare so a span being freed and reallocated doesn't go to the parent each time.
+		 */
+		void DeallocateRegionSpan(Region* region, u8* mem)
+		{
+			Region* releaseRegion = nullptr;
+			{
+				Core::ScopedSpinLock lock(regionsLock_);
+				if(region->freeSpans_ == 0)
+				{
+					ListRemove(fullRegions_, region);
+					ListPushFront(partialRegions_, region);
+				}
+				region->freeSpans_ |= 1U << (i32)((mem - region->base_) >> SPAN_SHIFT);
+				if(region->freeSpans_ == REGION_ALL_SPANS_FREE)
+				{
+					if(spareRegion_ == nullptr)
+					{
+						spareRegion_ = region;
+					}
+					else
+					{
+						ListRemove(partialRegions_, region);
+						releaseRegion = region;
+					}
+				}
+			}
+
+			if(releaseRegion)
+			{
+				parent_.Deallocate(releaseRegion->base_);
+				parent_.Delete(releaseRegion);
+			}
+		}
+
+		void ReleaseRegions(Region*& regions)
+		{
+			while(Region* region = regions)
+			{
+				regions = region->next_;
+				parent_.Deallocate(region->base_);
+				parent_.Delete(region);
+			}
+		}
+
+		/**
+		 * Allocate a new span for a size class. Blocks are carved from it lazily.
+		 * @return Span, nullptr if out of memory.
+		 */
+		SpanHeader* AllocateSpan(i32 sizeClass)
+		{
+			Region* region = nullptr;
+			u8* mem = AllocateRegionSpan(region);
+			if(mem == nullptr)
+				return nullptr;
+			if(!SetSpanSizeClass(mem, sizeClass))
+			{
+				DeallocateRegionSpan(region, mem);
+				return nullptr;
+			}
+
+			auto* span = reinterpret_cast<SpanHeader*>(mem);
+			span->next_ = nullptr;
+			span->prev_ = nullptr;
+			span->region_ = region;
+			span->freeBlocks_ = nullptr;
+			span->numBlocks_ = (i32)((SPAN_SIZE - SPAN_HEADER_SIZE) / classSizes_[sizeClass]);
+			span->numUncarved_ = span->numBlocks_;
+			span->numFree_ = span->numBlocks_;
+			return span;
+		}
+
+		/**
+		 * Return an empty span to its region.
+		 */
+		void DeallocateSpan(SpanHeader* span)
+		{
+			SetSpanSizeClass(span, -1);
+			DeallocateRegionSpan(span->region_, reinterpret_cast<u8*>(span));
+		}
+
+		/**
+		 * Take a chain of up to @a maxBlocks blocks from the shared list, allocating a new span if it's empty.
+		 * @return First block in chain, nullptr if out of memory.
+		 */
+		Block* PopChain(i32 sizeClass, i32 maxBlocks)
+		{
+			auto& centralList = centralLists_[sizeClass];
+			const i64 size = classSizes_[sizeClass];
+			Block* chain = nullptr;
+			i32 numBlocks = 0;
+			SpanHeader* newSpan = nullptr;
+			for(;;)
+			{
+				{
+					Core::ScopedSpinLock lock(centralList.lock_);
+					if(newSpan)
+					{
+						ListPushFront(centralList.spans_, newSpan);
+						centralList.numSpans_++;
+					}
+
+					while(numBlocks < maxBlocks && centralList.spans_)
+					{
+						SpanHeader* span = centralList.spans_;
+						while(numBlocks < maxBlocks && span->numFree_ > 0)
+						{
+							Block* block = span->freeBlocks_;
+							if(block)
+							{
+								span->freeBlocks_ = block->next_;
+							}
+							else
+							{
+								const i32 idx = span->numBlocks_ - span->numUncarved_--;
+								block = reinterpret_cast<Block*>(reinterpret_cast<u8*>(span) + SPAN_HEADER_SIZE + idx * size);
+							}
+							span->numFree_--;
+							block->next_ = chain;
+							chain = block;
+							++numBlocks;
+						}
+						if(span->numFree_ == 0)
+							ListRemove(centralList.spans_, span);
+					}
+				}
+
+				// Allocate outside of the lock, only if there was nothing to take.
+				if(chain || newSpan)
+					break;
+				newSpan = AllocateSpan(sizeClass);
+				if(newSpan == nullptr)
+					break;
+			}
+			return chain;
+		}
+
+		/**
+		 * Return a chain of blocks to their spans, releasing any spans that become empty.
+		 */
+		void PushChain(i32 sizeClass, Block* chain)
+		{
+			auto& centralList = centralLists_[sizeClass];
+			SpanHeader* emptySpans = nullptr;
+			{
+				Core::ScopedSpinLock lock(centralList.lock_);
+				while(Block* block = chain)
+				{
+					chain = block->next_;
+					SpanHeader* span = GetSpan(block);
+					block->next_ = span->freeBlocks_;
+					span->freeBlocks_ = block;
+					if(span->numFree_++ == 0)
+						ListPushFront(centralList.spans_, span);
+					if(span->numFree_ == span->numBlocks_)
+					{
+						ListRemove(centralList.spans_, span);
+						centralList.numSpans_--;
+						span->next_ = emptySpans;
+						emptySpans = span;
+					}
+				}
+			}
+
+			while(SpanHeader* span = emptySpans)
+			{
+				emptySpans = span->next_;
+				DeallocateSpan(span);
+			}
+		}
+
+		/**
+		 * Move up to @a maxBlocks blocks from a thread cache free list back to the shared list.
+		 */
+		void Flush(ThreadCache* threadCache, i32 sizeClass, i32 maxBlocks)
+		{
+			auto& freeList = threadCache->freeLists_[sizeClass];
+			Block* chain = freeList.head_;
+			if(chain == nullptr)
+				return;
+
+			Block* lastBlock = chain;
+			i32 numBlocks = 1;
+			while(numBlocks < maxBlocks && lastBlock->next_)
+			{
+				lastBlock = lastBlock->next_;
+				++numBlocks;
+			}
+
+			freeList.head_ = lastBlock->next_;
+			freeList.count_ -= numBlocks;
+			lastBlock->next_ = nullptr;
+			PushChain(sizeClass, chain);
+		}
+
+		/**
+		 * Get calling thread's cache, creating it if need be.
+		 * @return Thread cache, nullptr if thread can't have one.
+		 */
+		ThreadCache* GetThreadCache()
+		{
+			for(auto* threadCache : threadCaches_)
+				if(threadCache && threadCache->owner_ == this)
+					return threadCache;
+
+			// Thread is exiting, or has too many thread caching allocators in use.
+			if(threadCachesReleased_)
+				return nullptr;
+			for(auto& threadCache : threadCaches_)
+			{
+				if(threadCache == nullptr)
+				{
+					threadCache = parent_.New<ThreadCache>();
+					if(threadCache == nullptr)
+						return nullptr;
+					threadCache->owner_ = this;
+					{
+						Core::ScopedSpinLock lock(cachesLock_);
+						threadCache->next_ = caches_;
+						caches_ = threadCache;
+					}
+					threadCacheReleaser_.Register();
+					return threadCache;
+				}
+			}
+			return nullptr;
+		}
+
+		void ReleaseThreadCache(ThreadCache* threadCache)
+		{
+			for(i32 sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+			{
+				auto& freeList = threadCache->freeLists_[sizeClass];
+				while(freeList.head_)
+					Flush(threadCache, sizeClass, batchSizes_[sizeClass]);
+			}
+
+			{
+				Core::ScopedSpinLock lock(cachesLock_);
+				ThreadCache** prevNext = &caches_;
+				while(*prevNext != threadCache)
+					prevNext = &(*prevNext)->next_;
+				*prevNext = threadCache->next_;
+			}
+			parent_.Delete(threadCache);
+		}
+
+		IAllocator& parent_;
+		Core::Array<i64, NUM_SIZE_CLASSES> classSizes_;
+		Core::Array<i32, NUM_SIZE_CLASSES> batchSizes_;
+		Core::Array<u8, AllocatorThreadCache::MAX_SMALL_SIZE / SIZE_CLASS_GRANULARITY> sizeToClass_;
+		Core::Array<CentralList, NUM_SIZE_CLASSES> centralLists_;
+
+		/// Span map root, indexed by upper address bits. Leaves hold size class + 1 per span, 0 if not a span.
+		u8** spanMap_ = nullptr;
+
+		/// Regions with free spans, and regions without.
+		Core::SpinLock regionsLock_;
+		Region* partialRegions_ = nullptr;
+		Region* fullRegions_ = nullptr;
+		/// Empty region kept rather than released to the parent.
+		Region* spareRegion_ = nullptr;
+
+		/// All thread caches for this allocator.
+		Core::SpinLock cachesLock_;
+		ThreadCache* caches_ = nullptr;
+	};
+
+	namespace
+	{
+		ThreadCacheReleaser::~ThreadCacheReleaser()
+		{
+			threadCachesReleased_ = true;
+			for(auto& threadCache : threadCaches_)
+			{
+				if(threadCache)
+				{
+					threadCache->owner_->ReleaseThreadCache(threadCache);
+					threadCache = nullptr;
+				}
+			}
+		}
+	}
+
+	AllocatorThreadCache::AllocatorThreadCache(IAllocator& parent)
+	{
+		impl_ = parent.New<AllocatorThreadCacheImpl>(parent);
+	}
+
+	AllocatorThreadCache::~AllocatorThreadCache()
+	{
+		IAllocator& parent = impl_->parent_;
+		parent.Delete(impl_);
+	}
+
+	void* AllocatorThreadCache::Allocate(i64 bytes, i64 align)
+	{
+		if(bytes > MAX_SMALL_SIZE || align > MAX_SMALL_ALIGN)
+			return impl_->parent_.Allocate(bytes, align);
+
+		const i32 sizeClass = impl_->GetSizeClass(bytes);
+		ThreadCache* threadCache = impl_->GetThreadCache();
+		if(threadCache == nullptr)
+			return impl_->PopChain(sizeClass, 1);
+
+		auto& freeList = threadCache->freeLists_[sizeClass];
+		if(freeList.head_ == nullptr)
+		{
+			Block* chain = impl_->PopChain(sizeClass, impl_->batchSizes_[sizeClass]);
+			if(chain == nullptr)
+				return nullptr;
+
+			i32 numBlocks = 0;
+			for(Block* block = chain; block; block = block->next_)
+				++numBlocks;
+			freeList.head_ = chain;
+			freeList.count_ = numBlocks;
+		}
+
+		Block* block = freeList.head_;
+		freeList.head_ = block->next_;
+		freeList.count_--;
+		return block;
+	}
+
+	void AllocatorThreadCache::Deallocate(void* mem)
+	{
+		if(mem == nullptr)
+			return;
+
+		const i32 sizeClass = impl_->LookupSizeClass(mem);
+		if(sizeClass < 0)
+		{
+			impl_->parent_.Deallocate(mem);
+			return;
+		}
+
+		auto* block = static_cast<Block*>(mem);
+		ThreadCache* threadCache = impl_->GetThreadCache();
+		if(threadCache == nullptr)
+		{
+			block->next_ = nullptr;
+			impl_->PushChain(sizeClass, block);
+			return;
+		}
+
+		auto& freeList = threadCache->freeLists_[sizeClass];
+		block->next_ = freeList.head_;
+		freeList.head_ = block;
+		freeList.count_++;
+
+		// Keep up to 2 batches cached, so alternating alloc/free doesn't thrash the shared list.
+		const i32 batchSize = impl_->batchSizes_[sizeClass];
+		if(freeList.count_ > batchSize * 2)
+			impl_->Flush(threadCache, sizeClass, batchSize);
+	}
+
+	bool AllocatorThreadCache::OwnAllocation(void* mem)
+	{
+		return impl_->LookupSizeClass(mem) >= 0 || impl_->parent_.OwnAllocation(mem);
+	}
+
+	i64 AllocatorThreadCache::GetAllocationSize(void* mem)
+	{
+		const i32 sizeClass = impl_->LookupSizeClass(mem);
+		if(sizeClass >= 0)
+			return impl_->classSizes_[sizeClass];
+		return impl_->parent_.GetAllocationSize(mem);
+	}
+
+	AllocatorStats AllocatorThreadCache::GetStats() const { return impl_->parent_.GetStats(); }
+
+	void AllocatorThreadCache::LogStats() const
+	{
+		Core::Log("Thread Cache Allocator:\n");
+		for(i32 sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+		{
+			const auto& centralList = impl_->centralLists_[sizeClass];
+			if(centralList.numSpans_ > 0)
+				Core::Log(" - Size %lld: %i spans\n", impl_->classSizes_[sizeClass], centralList.numSpans_);
+		}
+		impl_->parent_.LogStats();
+	}
+
+	void AllocatorThreadCache::LogAllocs() const { impl_->parent_.LogAllocs(); }
+
+	void AllocatorThreadCache::FlushThreadCache()
+	{
+		for(auto* threadCache : threadCaches_)
+		{
+			if(threadCache && threadCache->owner_ == impl_)
+			{
+				for(i32 sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+					while(threadCache->freeLists_[sizeClass].head_)
+						impl_->Flush(threadCache, sizeClass, impl_->batchSizes_[sizeClass]);
+			}
+		}
+	}
+
+} // namespace Core
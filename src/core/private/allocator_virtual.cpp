@@ -3,7 +3,12 @@
 #include "core/misc.h"
 #include "core/set.h"
 
+#if PLATFORM_WINDOWS
 #include <Windows.h>
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 
 #include <cstdio>
 #include <cstdlib>
@@ -24,22 +29,86 @@ namespace Core
 
 		void* VirtualAllocate(i64 size) { return ::VirtualAlloc(nullptr, size, MEM_COMMIT, PAGE_READWRITE); }
 
-		void VirtualDeallocate(void* mem) { ::VirtualFree(mem, 0, MEM_RELEASE); }
+		void VirtualDeallocate(void* mem, i64 size) { ::VirtualFree(mem, 0, MEM_RELEASE); }
 
 		void* VirtualReserve(i64 size) { return ::VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS); }
 
 		void* VirtualCommit(void* mem, i64 size) { return ::VirtualAlloc(mem, size, MEM_COMMIT, PAGE_READWRITE); }
 
+		bool VirtualHasHugePages() { return false; }
+
+		void VirtualAdviseHugePages(void* mem, i64 size) {}
+
+#elif PLATFORM_LINUX || PLATFORM_ANDROID
+		void VirtualGetInfo(i64& pageSize, i64& granularity)
+		{
+			pageSize = ::sysconf(_SC_PAGESIZE);
+			granularity = pageSize;
+		}
+
+		void* VirtualAllocate(i64 size)
+		{
+			void* mem = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			return mem != MAP_FAILED ? mem : nullptr;
+		}
+
+		void VirtualDeallocate(void* mem, i64 size) { ::munmap(mem, size); }
+
+		void* VirtualReserve(i64 size)
+		{
+			void* mem = ::mmap(nullptr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			return mem != MAP_FAILED ? mem : nullptr;
+		}
+
+		void* VirtualCommit(void* mem, i64 size)
+		{
+			return ::mprotect(mem, size, PROT_READ | PROT_WRITE) == 0 ? mem : nullptr;
+		}
+
+		bool VirtualHasHugePages()
+		{
+#if defined(MADV_HUGEPAGE)
+			return true;
+#else
+			return false;
+#endif
+		}
+
+		void VirtualAdviseHugePages(void* mem, i64 size)
+		{
+#if defined(MADV_HUGEPAGE)
+			// Advisory only, kernels without transparent huge pages will fall back to normal pages.
+			::madvise(mem, size, MADV_HUGEPAGE);
+#endif
+		}
+
 #endif
 
 		/**
 		 * Callbacks for use with containers.
+		 * Size is stored ahead of each allocation, as it's needed to release it on some platforms.
 		 */
 		struct AllocatorCallbacks
 		{
-			void* Allocate(i64 size, i64 align) { return VirtualAllocate(size); }
+			void* Allocate(i64 size, i64 align)
+			{
+				DBG_ASSERT(align <= PLATFORM_ALIGNMENT);
+				size += PLATFORM_ALIGNMENT;
+				auto* mem = (u8*)VirtualAllocate(size);
+				if(mem == nullptr)
+					return nullptr;
+				*reinterpret_cast<i64*>(mem) = size;
+				return mem + PLATFORM_ALIGNMENT;
+			}
 
-			void Deallocate(void* mem) { VirtualDeallocate(mem); }
+			void Deallocate(void* mem)
+			{
+				if(mem)
+				{
+					auto* base = (u8*)mem - PLATFORM_ALIGNMENT;
+					VirtualDeallocate(base, *reinterpret_cast<i64*>(base));
+				}
+			}
 		};
 	}
 
@@ -47,7 +116,12 @@ namespace Core
 	{
 		struct AllocInfo
 		{
+			/// Memory returned to the user, used as the key.
 			void* mem_ = nullptr;
+			/// Base and size of the whole reservation, including guard pages and alignment padding.
+			void* base_ = nullptr;
+			i64 reservedSize_ = 0;
+			/// Committed size.
 			i64 size_ = 0;
 
 			bool operator==(const AllocInfo& a) const { return mem_ == a.mem_; }
@@ -57,7 +131,7 @@ namespace Core
 		{
 			u64 operator()(u64 input, const AllocInfo& data) const
 			{
-				return HashFNV1a(input, &data.mem_, sizeof(void*));
+				return HashMix64(input, (u64)(uintptr_t)data.mem_);
 			}
 		};
 
@@ -65,30 +139,34 @@ namespace Core
 		i64 pageSize_ = 0;
 		i64 granularity_ = 0;
 		bool enableGuardPages_ = false;
+		bool enableHugePages_ = false;
 
 		Core::RWLock rwLock_;
 		Core::Set<AllocInfo, AllocInfoHasher, AllocatorCallbacks> allocInfos_;
 
-		void AddAlloc(void* mem, i64 size)
+		void AddAlloc(const AllocInfo& allocInfo)
 		{
-			DBG_ASSERT(mem != nullptr);
-			DBG_ASSERT(size > 0);
+			DBG_ASSERT(allocInfo.mem_ != nullptr);
+			DBG_ASSERT(allocInfo.reservedSize_ > 0);
 
 			Core::ScopedWriteLock lock(rwLock_);
-			DBG_ASSERT(!allocInfos_.find(AllocInfo{mem, 0}));
-			allocInfos_.insert(AllocInfo{mem, size});
-			Core::AtomicAddRel(&reservedBytes_, size);
+			DBG_ASSERT(!allocInfos_.find(AllocInfo{allocInfo.mem_}));
+			allocInfos_.insert(allocInfo);
+			Core::AtomicAddRel(&reservedBytes_, allocInfo.reservedSize_);
 		}
 
-		void RemoveAlloc(void* mem)
+		bool RemoveAlloc(void* mem, AllocInfo& outAllocInfo)
 		{
 			DBG_ASSERT(mem != nullptr);
 
 			Core::ScopedWriteLock lock(rwLock_);
-			auto* alloc = allocInfos_.find(AllocInfo{mem, 0});
-			DBG_ASSERT(alloc);
-			allocInfos_.erase(AllocInfo{mem, 0});
-			Core::AtomicAddRel(&reservedBytes_, -alloc->size_);
+			auto* alloc = allocInfos_.find(AllocInfo{mem});
+			if(alloc == nullptr)
+				return false;
+			outAllocInfo = *alloc;
+			allocInfos_.erase(AllocInfo{mem});
+			Core::AtomicAddRel(&reservedBytes_, -outAllocInfo.reservedSize_);
+			return true;
 		}
 
 		i64 AllocSize(void* mem)
@@ -96,18 +174,20 @@ namespace Core
 			DBG_ASSERT(mem != nullptr);
 
 			Core::ScopedReadLock lock(rwLock_);
-			if(auto* alloc = allocInfos_.find(AllocInfo{mem, 0}))
+			if(auto* alloc = allocInfos_.find(AllocInfo{mem}))
 				return alloc->size_;
 			return -1;
 		}
 	};
 
-	AllocatorVirtual::AllocatorVirtual(bool enableGuardPages)
+	AllocatorVirtual::AllocatorVirtual(bool enableGuardPages, bool enableHugePages)
 	{
 		auto* implMem = VirtualAllocate(sizeof(AllocatorVirtualImpl));
 		impl_ = new(implMem) AllocatorVirtualImpl;
 
-		impl_->enableGuardPages_ = true;
+		impl_->enableGuardPages_ = enableGuardPages;
+		// Aligning for huge pages only wastes address space where they can't be advised.
+		impl_->enableHugePages_ = enableHugePages && VirtualHasHugePages();
 
 		VirtualGetInfo(impl_->pageSize_, impl_->granularity_);
 	}
@@ -118,37 +198,55 @@ namespace Core
 		DBG_ASSERT(impl_->reservedBytes_ == 0);
 
 		impl_->~AllocatorVirtualImpl();
-		VirtualDeallocate(impl_);
+		VirtualDeallocate(impl_, sizeof(AllocatorVirtualImpl));
 		impl_ = nullptr;
 	}
 
 	void* AllocatorVirtual::Allocate(i64 bytes, i64 align)
 	{
-		void* retVal = nullptr;
 		bytes = Core::PotRoundUp(bytes, impl_->granularity_);
-		i64 reserveBytes = bytes;
+
+		// Large allocations are aligned so they can be backed by huge pages.
+		const bool useHugePages = impl_->enableHugePages_ && bytes >= HUGE_PAGE_SIZE;
+		if(useHugePages)
+			align = Core::Max(align, HUGE_PAGE_SIZE);
+
+		// Reservations are already aligned to granularity, anything beyond needs padding.
+		const i64 alignPadding = Core::Max(align - impl_->granularity_, (i64)0);
+		const i64 guardBytes = impl_->enableGuardPages_ ? impl_->granularity_ : 0;
 
 		// Add 2 extra pages to allocate.
-		if(impl_->enableGuardPages_)
-			reserveBytes += (impl_->granularity_ * 2);
+		i64 reserveBytes = bytes + alignPadding + (guardBytes * 2);
 
 		// Round up to required granularity.
 		reserveBytes = Core::PotRoundUp(reserveBytes, impl_->granularity_);
 
 		// Reserve.
-		retVal = VirtualReserve(reserveBytes);
+		u8* base = (u8*)VirtualReserve(reserveBytes);
+		if(base == nullptr)
+			return nullptr;
+
+		// Offset into initial guard page, then align. Anything left uncommitted is inaccessible.
+		u8* retVal = base + guardBytes;
+		if(align > impl_->granularity_)
+			retVal = (u8*)Core::PotRoundUp((i64)retVal, align);
 
-		// If successful, add allocation and offset into initial guard page.
-		if(retVal)
+		// Commit & readwrite access.
+		if(VirtualCommit(retVal, bytes) == nullptr)
 		{
-			impl_->AddAlloc(retVal, reserveBytes);
+			VirtualDeallocate(base, reserveBytes);
+			return nullptr;
+		}
 
-			if(impl_->enableGuardPages_)
-				retVal = (u8*)retVal + impl_->granularity_;
+		if(useHugePages)
+			VirtualAdviseHugePages(retVal, bytes);
 
-			// Commit & readwrite access.
-			DBG_VERIFY(VirtualCommit(retVal, bytes));
-		}
+		AllocatorVirtualImpl::AllocInfo allocInfo;
+		allocInfo.mem_ = retVal;
+		allocInfo.base_ = base;
+		allocInfo.reservedSize_ = reserveBytes;
+		allocInfo.size_ = bytes;
+		impl_->AddAlloc(allocInfo);
 		return retVal;
 	}
 
@@ -156,33 +254,16 @@ namespace Core
 	{
 		if(mem)
 		{
-			if(impl_->enableGuardPages_)
-				mem = (u8*)mem - impl_->granularity_;
-
-			i64 size = impl_->AllocSize(mem);
-			DBG_ASSERT(size >= 0)
-			if(size >= 0)
-			{
-				impl_->RemoveAlloc(mem);
-				VirtualDeallocate(mem);
-			}
+			AllocatorVirtualImpl::AllocInfo allocInfo;
+			const bool found = impl_->RemoveAlloc(mem, allocInfo);
+			DBG_ASSERT(found);
+			if(found)
+				VirtualDeallocate(allocInfo.base_, allocInfo.reservedSize_);
 		}
 	}
 
-	bool AllocatorVirtual::OwnAllocation(void* mem)
-	{
-		if(impl_->enableGuardPages_)
-			mem = (u8*)mem - impl_->granularity_;
+	bool AllocatorVirtual::OwnAllocation(void* mem) { return impl_->AllocSize(mem) >= 0; }
 
-		return impl_->AllocSize(mem) >= 0;
-	}
-
-	i64 AllocatorVirtual::GetAllocationSize(void* mem)
-	{
-		if(impl_->enableGuardPages_)
-			mem = (u8*)mem - impl_->granularity_;
-
-		return impl_->AllocSize(mem);
-	}
+	i64 AllocatorVirtual::GetAllocationSize(void* mem) { return impl_->AllocSize(mem); }
 
 } // namespace Core
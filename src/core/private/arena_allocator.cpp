@@ -0,0 +1,100 @@
+#include "core/arena_allocator.h"
+#include "core/debug.h"
+#include "core/misc.h"
+
+namespace Core
+{
+	struct ScopedArena::Chunk
+	{
+		Chunk* next_ = nullptr;
+		i64 size_ = 0;
+
+		u8* begin() { return reinterpret_cast<u8*>(this) + PotRoundUp((i64)sizeof(Chunk), PLATFORM_ALIGNMENT); }
+		u8* end() { return reinterpret_cast<u8*>(this) + size_; }
+	};
+
+	ScopedArena::ScopedArena(i32 chunkSize, IAllocator& allocator)
+	    : allocator_(allocator)
+	    , chunkSize_(chunkSize)
+	{
+		DBG_ASSERT(chunkSize_ > (i32)sizeof(Chunk));
+	}
+
+	ScopedArena::~ScopedArena()
+	{
+		while(Chunk* chunk = chunks_)
+		{
+			chunks_ = chunk->next_;
+			allocator_.Deallocate(chunk);
+		}
+	}
+
+	void ScopedArena::Reset()
+	{
+		// Keep a single standard sized chunk around to reuse.
+		Chunk* keepChunk = nullptr;
+		while(Chunk* chunk = chunks_)
+		{
+			chunks_ = chunk->next_;
+			if(keepChunk == nullptr && chunk->size_ == chunkSize_)
+				keepChunk = chunk;
+			else
+				allocator_.Deallocate(chunk);
+		}
+
+		chunks_ = keepChunk;
+		numChunks_ = 0;
+		usedBytes_ = 0;
+		begin_ = curr_ = end_ = nullptr;
+		if(keepChunk)
+		{
+			keepChunk->next_ = nullptr;
+			numChunks_ = 1;
+			begin_ = curr_ = keepChunk->begin();
+			end_ = keepChunk->end();
+		}
+	}
+
+	void* ScopedArena::AllocateSlow(i64 bytes, i64 align)
+	{
+		DBG_ASSERT(align > 0 && Core::Pot(align));
+		const i64 headerSize = PotRoundUp((i64)sizeof(Chunk), PLATFORM_ALIGNMENT);
+		const i64 requiredSize = headerSize + bytes + Core::Max(align - PLATFORM_ALIGNMENT, (i64)0);
+
+		// Large allocations get their own chunk, so they don't waste the rest of the current one.
+		const bool isDedicated = requiredSize > chunkSize_ / 2;
+		const i64 size = isDedicated ? requiredSize : chunkSize_;
+
+		void* mem = allocator_.Allocate(size, PLATFORM_ALIGNMENT);
+		if(mem == nullptr)
+			return nullptr;
+		Chunk* chunk = new(mem) Chunk();
+		chunk->size_ = size;
+		++numChunks_;
+
+		u8* alignedMem = reinterpret_cast<u8*>(PotRoundUp((i64)chunk->begin(), align));
+		if(isDedicated)
+		{
+			// Insert behind the current chunk so it remains in use.
+			if(chunks_)
+			{
+				chunk->next_ = chunks_->next_;
+				chunks_->next_ = chunk;
+			}
+			else
+			{
+				chunks_ = chunk;
+			}
+			usedBytes_ += bytes;
+			return alignedMem;
+		}
+
+		usedBytes_ += curr_ - begin_;
+		chunk->next_ = chunks_;
+		chunks_ = chunk;
+		begin_ = chunk->begin();
+		curr_ = alignedMem + bytes;
+		end_ = chunk->end();
+		return alignedMem;
+	}
+} // namespace Core
@@ -1,57 +1,62 @@
 #include "core/circular_allocator.h"
 #include "core/concurrency.h"
+#include "core/debug.h"
 #include "core/misc.h"
 
 namespace Core
 {
-	CircularAllocator::CircularAllocator(i32 size, i32 alignment)
-	    : size_(size)
+	CircularAllocator::CircularAllocator(i32 size, i32 alignment, IAllocator& allocator)
+	    : allocator_(allocator)
+	    , size_(size)
 	    , mask_(size - 1)
 	    , alignment_(alignment)
-	    , offset_(0)
-	    , released_(0)
 	{
 		DBG_ASSERT(Pot(size));
-		base_.resize(size);
+		DBG_ASSERT(Pot(alignment) && alignment <= size);
+		base_ = (u8*)allocator_.Allocate(size, alignment);
 	}
 
-	CircularAllocator::~CircularAllocator() {}
+	CircularAllocator::~CircularAllocator() { allocator_.Deallocate(base_); }
 
-	void CircularAllocator::Release(i32 bytes)
+	void CircularAllocator::Release(Marker marker)
 	{
-		ScopedSpinLock lock(spinLock_);
+		DBG_ASSERT(marker <= head_);
 
-		Core::AtomicAdd((i64*)&released_, bytes);
+		// Only move the tail forward, in case markers are released out of order.
+		i64 tail = tail_;
+		while(tail < marker)
+		{
+			const i64 oldTail = Core::AtomicCmpExchg(&tail_, marker, tail);
+			if(oldTail == tail)
+				break;
+			tail = oldTail;
+		}
 	}
 
 	void* CircularAllocator::Allocate(i32 bytes)
 	{
 		bytes = PotRoundUp(bytes, alignment_);
 
-		ScopedSpinLock lock(spinLock_);
-
 		// Can't allocate more than we have.
-		if(bytes > size_)
+		if(bytes <= 0 || bytes > size_)
 			return nullptr;
 
-		// Loop until we have a valid offset.
-		// NOTE: This could potentially enter into an infinite loop if
-		// a large size is being allocated. To mitigate this there is a maximum
-		// number of tries imposed to help catch when this occurs.
-		i32 maskedOffset = 0;
-		i32 numTries = 0;
-		do
+		i64 head = head_;
+		for(;;)
 		{
-			maskedOffset = (Core::AtomicAdd((i64*)&offset_, bytes) - bytes) & mask_;
-			++numTries;
-		} while((maskedOffset + bytes) > size_ || numTries < 3);
-
-		DBG_ASSERT((maskedOffset + bytes) <= size_);
-		if((maskedOffset + bytes) > size_)
-		{
-			return nullptr;
+			// Skip to the start of the buffer rather than straddle the end.
+			const i64 offset = head & mask_;
+			const i64 padding = (offset + bytes) > size_ ? (size_ - offset) : 0;
+			const i64 newHead = head + padding + bytes;
+
+			// Full until enough is released.
+			if((newHead - tail_) > size_)
+				return nullptr;
+
+			const i64 oldHead = Core::AtomicCmpExchg(&head_, newHead, head);
+			if(oldHead == head)
+				return base_ + ((head + padding) & mask_);
+			head = oldHead;
 		}
-
-		return &base_[maskedOffset - bytes];
 	}
 } // namespace Core
@@ -8,6 +8,94 @@
 #include "core/private/concurrency.inl"
 #endif
 
+namespace Core
+{
+	SpinLock::SpinLock() {}
+
+	SpinLock::~SpinLock() { DBG_ASSERT(count_ == 0); }
+
+	void SpinLock::Lock()
+	{
+		while(Core::AtomicCmpExchgAcq(&count_, 1, 0) == 1)
+		{
+			Core::YieldCPU();
+		}
+	}
+
+	bool SpinLock::TryLock() { return (Core::AtomicCmpExchgAcq(&count_, 1, 0) == 0); }
+
+	void SpinLock::Unlock()
+	{
+		i32 count = Core::AtomicExchg(&count_, 0);
+		DBG_ASSERT(count == 1);
+	}
+
+	EventCount::EventCount(const char* debugName)
+	    : sem_(0, 0x7fffffff, debugName)
+	{
+	}
+
+	EventCount::~EventCount() { DBG_ASSERT(numWaiters_ == 0); }
+
+	void EventCount::PrepareWait()
+	{
+		// Full barrier, so the caller's recheck of the condition can't be reordered before registering.
+		Core::AtomicInc(&numWaiters_);
+	}
+
+	void EventCount::CancelWait()
+	{
+		i32 numWaiters = Core::AtomicCmpExchg(&numWaiters_, 0, 0);
+		for(;;)
+		{
+			// All waiters have been claimed by notifiers, so there is a signal on its way for us to consume.
+			if(numWaiters == 0)
+			{
+				Wait();
+				return;
+			}
+
+			const i32 oldNumWaiters = Core::AtomicCmpExchg(&numWaiters_, numWaiters - 1, numWaiters);
+			if(oldNumWaiters == numWaiters)
+				return;
+			numWaiters = oldNumWaiters;
+		}
+	}
+
+	void EventCount::Wait()
+	{
+		while(!sem_.Wait())
+		{
+		}
+	}
+
+	void EventCount::Notify(i32 count)
+	{
+		DBG_ASSERT(count > 0);
+
+		// Full barrier, pairs with PrepareWait.
+		i32 numWaiters = Core::AtomicCmpExchg(&numWaiters_, 0, 0);
+		while(numWaiters > 0)
+		{
+			const i32 numToWake = numWaiters < count ? numWaiters : count;
+			const i32 oldNumWaiters = Core::AtomicCmpExchg(&numWaiters_, numWaiters - numToWake, numWaiters);
+			if(oldNumWaiters == numWaiters)
+			{
+				sem_.Signal(numToWake);
+				return;
+			}
+			numWaiters = oldNumWaiters;
+		}
+	}
+
+	void EventCount::NotifyAll()
+	{
+		const i32 numWaiters = Core::AtomicExchg(&numWaiters_, 0);
+		if(numWaiters > 0)
+			sem_.Signal(numWaiters);
+	}
+} // namespace Core
+
 #if PLATFORM_WINDOWS
 #include "core/os.h"
 
@@ -179,6 +267,8 @@ namespace Core
 		void* exitFiber_ = nullptr;
 		Fiber::EntryPointFunc entryPointFunc_ = nullptr;
 		void* userData_ = nullptr;
+		/// Top of stack, recorded when fiber first runs.
+		u8* stackBase_ = nullptr;
 #if !defined(_RELEASE)
 		Core::String debugName_;
 #endif
@@ -188,6 +278,7 @@ namespace Core
 	{
 		auto* impl = reinterpret_cast<FiberImpl*>(lpParameter);
 		thisFiber_.Set(impl);
+		impl->stackBase_ = reinterpret_cast<u8*>(reinterpret_cast<NT_TIB*>(::NtCurrentTeb())->StackBase);
 
 		impl->entryPointFunc_(impl->userData_);
 		DBG_ASSERT(impl->exitFiber_);
@@ -201,7 +292,8 @@ namespace Core
 		impl_->parent_ = this;
 		impl_->entryPointFunc_ = entryPointFunc;
 		impl_->userData_ = userData;
-		impl_->fiber_ = ::CreateFiber(stackSize, FiberEntryPoint, impl_);
+		// Reserve the full stack size, but let the OS commit it through its guard page as it grows.
+		impl_->fiber_ = ::CreateFiberEx(0, stackSize, FIBER_FLAG_FLOAT_SWITCH, FiberEntryPoint, impl_);
 #if !defined(_RELEASE)
 		impl_->debugName_ = debugName_;
 		debugName_ = impl_->debugName_.c_str();
@@ -302,6 +394,30 @@ namespace Core
 		return nullptr;
 	}
 
+	i32 Fiber::GetPeakStackUsage() const
+	{
+		DBG_ASSERT(impl_);
+		u8* stackBase = impl_->stackBase_;
+		if(stackBase == nullptr)
+			return 0;
+
+		// Walk down the committed regions from the top of the stack, stopping at the guard page.
+		u8* committed = stackBase;
+		MEMORY_BASIC_INFORMATION info;
+		while(::VirtualQuery(committed - 1, &info, sizeof(info)) == sizeof(info) && info.State == MEM_COMMIT &&
+		      (info.Protect & PAGE_GUARD) == 0)
+		{
+			committed = reinterpret_cast<u8*>(info.BaseAddress);
+		}
+
+		// Find deepest word that has been written to.
+		const u64* word = reinterpret_cast<const u64*>(committed);
+		const u64* end = reinterpret_cast<const u64*>(stackBase);
+		while(word < end && *word == 0)
+			++word;
+		return (i32)(stackBase - reinterpret_cast<const u8*>(word));
+	}
+
 	struct SemaphoreImpl
 	{
 		HANDLE handle_;
@@ -354,26 +470,6 @@ namespace Core
 		return !!::ReleaseSemaphore(Get()->handle_, count, nullptr);
 	}
 
-	SpinLock::SpinLock() {}
-
-	SpinLock::~SpinLock() { DBG_ASSERT(count_ == 0); }
-
-	void SpinLock::Lock()
-	{
-		while(Core::AtomicCmpExchgAcq(&count_, 1, 0) == 1)
-		{
-			Core::YieldCPU();
-		}
-	}
-
-	bool SpinLock::TryLock() { return (Core::AtomicCmpExchgAcq(&count_, 1, 0) == 0); }
-
-	void SpinLock::Unlock()
-	{
-		i32 count = Core::AtomicExchg(&count_, 0);
-		DBG_ASSERT(count == 1);
-	}
-
 	struct MutexImpl
 	{
 		CRITICAL_SECTION critSec_;
@@ -524,6 +620,1006 @@ namespace Core
 		return ::FlsGetValue(handle_);
 	}
 
+} // namespace Core
+#elif PLATFORM_LINUX
+#include "core/array.h"
+#include "core/misc.h"
+
+#include "Remotery.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits.h>
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#if !ARCH_X86_64
+#error "Fiber context switch not implemented for architecture!"
+#endif
+
+/**
+ * Fiber context switch.
+ * Only the registers the System V x86-64 ABI defines as callee-saved (rbx, rbp, r12-r15) and the
+ * MXCSR/x87 control words are preserved. Everything else is already spilled by the caller as
+ * CoreFiberSwitchContext is an ordinary function call. No signal mask is saved, which is what
+ * makes this considerably cheaper than swapcontext.
+ * @param fromSp Where to store stack pointer of the fiber being switched from.
+ * @param toSp Stack pointer of the fiber to switch to.
+ */
+extern "C" void CoreFiberSwitchContext(void** fromSp, void* toSp);
+
+/**
+ * Fiber trampoline.
+ * Entry for new fibers, first switched to via the return address placed on the initial stack.
+ * r12 holds the FiberImpl, r13 holds the function to call with it.
+ */
+extern "C" void CoreFiberTrampoline();
+
+// clang-format off
+__asm__(
+	".text\n"
+	".p2align 4\n"
+	".globl CoreFiberSwitchContext\n"
+	".hidden CoreFiberSwitchContext\n"
+	".type CoreFiberSwitchContext, @function\n"
+	"CoreFiberSwitchContext:\n"
+	"	pushq %rbp\n"
+	"	pushq %rbx\n"
+	"	pushq %r12\n"
+	"	pushq %r13\n"
+	"	pushq %r14\n"
+	"	pushq %r15\n"
+	"	subq $8, %rsp\n"
+	"	stmxcsr (%rsp)\n"
+	"	fnstcw 4(%rsp)\n"
+	"	movq %rsp, (%rdi)\n"
+	"	movq %rsi, %rsp\n"
+	"	ldmxcsr (%rsp)\n"
+	"	fldcw 4(%rsp)\n"
+	"	addq $8, %rsp\n"
+	"	popq %r15\n"
+	"	popq %r14\n"
+	"	popq %r13\n"
+	"	popq %r12\n"
+	"	popq %rbx\n"
+	"	popq %rbp\n"
+	"	ret\n"
+	".size CoreFiberSwitchContext, .-CoreFiberSwitchContext\n"
+
+	".p2align 4\n"
+	".globl CoreFiberTrampoline\n"
+	".hidden CoreFiberTrampoline\n"
+	".type CoreFiberTrampoline, @function\n"
+	"CoreFiberTrampoline:\n"
+	"	movq %r12, %rdi\n"
+	"	callq *%r13\n"
+	"	ud2\n"
+	".size CoreFiberTrampoline, .-CoreFiberTrampoline\n"
+);
+// clang-format on
+
+namespace Core
+{
+	namespace
+	{
+		struct CPUTopology
+		{
+			i32 numLogical_ = 0;
+			i32 numPhysical_ = 0;
+			/// Logical core mask for each physical core.
+			Core::Array<u64, 64> physicalMasks_ = {};
+		};
+
+		i32 ReadCPUTopologyValue(i32 cpu, const char* name)
+		{
+			Core::Array<char, 128> path = {};
+			snprintf(path.data(), path.size(), "/sys/devices/system/cpu/cpu%i/topology/%s", cpu, name);
+			i32 value = -1;
+			if(FILE* file = fopen(path.data(), "r"))
+			{
+				if(fscanf(file, "%i", &value) != 1)
+					value = -1;
+				fclose(file);
+			}
+			return value;
+		}
+
+		CPUTopology GetCPUTopology()
+		{
+			CPUTopology topology;
+			topology.numLogical_ = (i32)::sysconf(_SC_NPROCESSORS_ONLN);
+
+			// Group logical cores by (package, core) pair to find physical cores.
+			Core::Array<i32, 64> coreKeys = {};
+			const i32 numCPUs = topology.numLogical_ < 64 ? topology.numLogical_ : 64;
+			for(i32 cpu = 0; cpu < numCPUs; ++cpu)
+			{
+				const i32 packageId = ReadCPUTopologyValue(cpu, "physical_package_id");
+				const i32 coreId = ReadCPUTopologyValue(cpu, "core_id");
+				const i32 key = (packageId >= 0 && coreId >= 0) ? ((packageId << 16) | coreId) : -(cpu + 1);
+
+				i32 physIdx = 0;
+				while(physIdx < topology.numPhysical_ && coreKeys[physIdx] != key)
+					++physIdx;
+				if(physIdx == topology.numPhysical_)
+				{
+					coreKeys[physIdx] = key;
+					topology.numPhysical_++;
+				}
+				topology.physicalMasks_[physIdx] |= (1ULL << cpu);
+			}
+			return topology;
+		}
+	}
+
+	i32 GetNumLogicalCores() { return (i32)::sysconf(_SC_NPROCESSORS_ONLN); }
+
+	i32 GetNumPhysicalCores() { return GetCPUTopology().numPhysical_; }
+
+	u64 GetPhysicalCoreAffinityMask(i32 core)
+	{
+		const CPUTopology topology = GetCPUTopology();
+		if(core >= 0 && core < topology.numPhysical_)
+			return topology.physicalMasks_[core];
+		return 0;
+	}
+
+	struct ThreadImpl
+	{
+		pthread_t thread_ = {};
+		Thread::EntryPointFunc entryPointFunc_ = nullptr;
+		void* userData_ = nullptr;
+		i32 exitCode_ = 0;
+#if !defined(_RELEASE)
+		Core::String debugName_;
+#endif
+	};
+
+	static void* ThreadEntryPoint(void* param)
+	{
+		auto* impl = reinterpret_cast<ThreadImpl*>(param);
+
+#if !defined(_RELEASE)
+		if(impl->debugName_.size() > 0)
+		{
+			// Thread names are limited to 16 characters including null terminator.
+			Core::Array<char, 16> name = {};
+			strncpy(name.data(), impl->debugName_.c_str(), name.size() - 1);
+			::pthread_setname_np(::pthread_self(), name.data());
+
+			rmt_SetCurrentThreadName(impl->debugName_.c_str());
+			rmt_ScopedCPUSample(ThreadBegin, RMTSF_None);
+		}
+#endif
+		impl->exitCode_ = impl->entryPointFunc_(impl->userData_);
+		return nullptr;
+	}
+
+	Thread::Thread(EntryPointFunc entryPointFunc, void* userData, i32 stackSize, const char* debugName)
+	{
+		DBG_ASSERT(entryPointFunc);
+		impl_ = new ThreadImpl();
+		impl_->entryPointFunc_ = entryPointFunc;
+		impl_->userData_ = userData;
+#if !defined(_RELEASE)
+		impl_->debugName_ = debugName;
+		debugName_ = impl_->debugName_.c_str();
+#endif
+
+		// Windows treats stack size as the initial commit within a 1MB reservation.
+		// Pages are only committed when touched here, so reserve at least as much.
+		const size_t MIN_RESERVE_SIZE = 1024 * 1024;
+		size_t reserveSize = stackSize > 0 ? (size_t)stackSize : 0;
+		if(reserveSize < MIN_RESERVE_SIZE)
+			reserveSize = MIN_RESERVE_SIZE;
+		if(reserveSize < (size_t)PTHREAD_STACK_MIN)
+			reserveSize = (size_t)PTHREAD_STACK_MIN;
+
+		pthread_attr_t attr;
+		::pthread_attr_init(&attr);
+		::pthread_attr_setstacksize(&attr, reserveSize);
+		int retVal = ::pthread_create(&impl_->thread_, &attr, ThreadEntryPoint, impl_);
+		::pthread_attr_destroy(&attr);
+
+		DBG_ASSERT_MSG(retVal == 0, "Unable to create thread.");
+		if(retVal != 0)
+		{
+			delete impl_;
+			impl_ = nullptr;
+		}
+	}
+
+	Thread::~Thread()
+	{
+		if(impl_)
+		{
+			Join();
+		}
+	}
+
+	Thread::Thread(Thread&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#if !defined(_RELEASE)
+		swap(debugName_, other.debugName_);
+#endif
+	}
+
+	Thread& Thread::operator=(Thread&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#if !defined(_RELEASE)
+		swap(debugName_, other.debugName_);
+#endif
+		return *this;
+	}
+
+	u64 Thread::SetAffinity(u64 mask)
+	{
+		DBG_ASSERT(impl_);
+		cpu_set_t oldSet;
+		CPU_ZERO(&oldSet);
+		::pthread_getaffinity_np(impl_->thread_, sizeof(oldSet), &oldSet);
+
+		u64 oldMask = 0;
+		cpu_set_t newSet;
+		CPU_ZERO(&newSet);
+		for(i32 cpu = 0; cpu < 64; ++cpu)
+		{
+			if(CPU_ISSET(cpu, &oldSet))
+				oldMask |= (1ULL << cpu);
+			if(mask & (1ULL << cpu))
+				CPU_SET(cpu, &newSet);
+		}
+
+		if(::pthread_setaffinity_np(impl_->thread_, sizeof(newSet), &newSet) != 0)
+			return 0;
+		return oldMask;
+	}
+
+	i32 Thread::Join()
+	{
+		if(impl_)
+		{
+			int retVal = ::pthread_join(impl_->thread_, nullptr);
+			DBG_ASSERT(retVal == 0);
+			i32 exitCode = impl_->exitCode_;
+			delete impl_;
+			impl_ = nullptr;
+			return exitCode;
+		}
+		return 0;
+	}
+
+	/// Maximum number of fiber local storage slots. Must fit in the used slot mask.
+	static const i32 MAX_FLS_SLOTS = 64;
+
+	/// FLS handles hold the slot in the low bits, and the slot's generation above.
+	static const i32 FLS_SLOT_BITS = 8;
+	static const i32 FLS_SLOT_MASK = (1 << FLS_SLOT_BITS) - 1;
+	static const i32 FLS_MAX_GENERATION = 0x7fffff;
+
+	/**
+	 * Value stored in a fiber local storage slot.
+	 * Tagged with the slot's generation when set, so values left behind by a freed FLS read as
+	 * nullptr once the slot is reused, without having to visit every fiber when freeing.
+	 */
+	struct FlsValue
+	{
+		void* data_ = nullptr;
+		i32 gen_ = 0;
+	};
+
+	struct FiberImpl
+	{
+		static const u64 SENTINAL = 0x11207CE82F00AA5ALL;
+		u64 sentinal_ = SENTINAL;
+		Fiber* parent_ = nullptr;
+		/// Saved stack pointer whilst not running.
+		void* sp_ = nullptr;
+		/// Base of stack allocation, including guard page.
+		u8* stack_ = nullptr;
+		size_t stackAllocSize_ = 0;
+		FiberImpl* exitFiber_ = nullptr;
+		Fiber::EntryPointFunc entryPointFunc_ = nullptr;
+		void* userData_ = nullptr;
+		Core::Array<FlsValue, MAX_FLS_SLOTS> flsData_ = {};
+#if !defined(_RELEASE)
+		Core::String debugName_;
+#endif
+	};
+
+	namespace
+	{
+		/// Fiber currently running on this thread.
+		thread_local FiberImpl* threadFiber_ = nullptr;
+
+		/// Fiber local storage for threads that aren't running a fiber.
+		thread_local Core::Array<FlsValue, MAX_FLS_SLOTS> threadFlsData_ = {};
+
+		/// Mask of fiber local storage slots in use.
+		volatile i64 usedFlsSlots_ = 0;
+
+		/// Generation of each fiber local storage slot, incremented each time it's allocated.
+		volatile i32 flsSlotGens_[MAX_FLS_SLOTS] = {};
+
+		// Fibers can resume on a different thread to the one they were suspended on, so the
+		// address of thread locals must never be cached across a switch. Keeping access
+		// behind non-inlined functions guarantees it is recomputed each time.
+		__attribute__((noinline)) FiberImpl* GetThreadFiber() { return threadFiber_; }
+
+		__attribute__((noinline)) void SetThreadFiber(FiberImpl* impl) { threadFiber_ = impl; }
+
+		__attribute__((noinline)) FlsValue* GetFlsData()
+		{
+			if(FiberImpl* impl = threadFiber_)
+				return impl->flsData_.data();
+			return threadFlsData_.data();
+		}
+
+		void SwitchFiber(FiberImpl* from, FiberImpl* to)
+		{
+			SetThreadFiber(to);
+			CoreFiberSwitchContext(&from->sp_, to->sp_);
+		}
+
+		void FiberEntryPoint(void* param)
+		{
+			auto* impl = reinterpret_cast<FiberImpl*>(param);
+			DBG_ASSERT(impl->sentinal_ == FiberImpl::SENTINAL);
+
+			impl->entryPointFunc_(impl->userData_);
+			DBG_ASSERT(impl->exitFiber_);
+			SwitchFiber(impl, impl->exitFiber_);
+		}
+	}
+
+	Fiber::Fiber(EntryPointFunc entryPointFunc, void* userData, i32 stackSize, const char* debugName)
+	{
+		DBG_ASSERT(entryPointFunc);
+		DBG_ASSERT(stackSize > 0);
+		impl_ = new FiberImpl();
+		impl_->parent_ = this;
+		impl_->entryPointFunc_ = entryPointFunc;
+		impl_->userData_ = userData;
+#if !defined(_RELEASE)
+		impl_->debugName_ = debugName;
+		debugName_ = impl_->debugName_.c_str();
+#endif
+
+		// Allocate stack with a guard page at the bottom to catch overflow.
+		const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+		const size_t stackAllocSize = (((size_t)stackSize + pageSize - 1) & ~(pageSize - 1)) + pageSize;
+		// Pages aren't backed until touched, and MAP_NORESERVE avoids charging the full size against commit.
+		void* stack = ::mmap(nullptr, stackAllocSize, PROT_READ | PROT_WRITE,
+		    MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK | MAP_NORESERVE, -1, 0);
+		DBG_ASSERT_MSG(stack != MAP_FAILED, "Unable to create fiber.");
+		if(stack == MAP_FAILED)
+		{
+			delete impl_;
+			impl_ = nullptr;
+			return;
+		}
+		// The fiber still works without its guard page, but stack overflow would silently corrupt memory.
+		if(::mprotect(stack, pageSize, PROT_NONE) != 0)
+		{
+			DBG_ASSERT_MSG(false, "Unable to protect fiber stack guard page. (errno: %i)", errno);
+		}
+		impl_->stack_ = reinterpret_cast<u8*>(stack);
+		impl_->stackAllocSize_ = stackAllocSize;
+
+		// Setup initial stack to match what CoreFiberSwitchContext expects to pop.
+		const u64 MXCSR_DEFAULT = 0x1f80;
+		const u64 FPUCW_DEFAULT = 0x037f;
+		void** sp = reinterpret_cast<void**>(impl_->stack_ + stackAllocSize);
+		*--sp = reinterpret_cast<void*>(&CoreFiberTrampoline); // return address
+		*--sp = nullptr;                                         // rbp
+		*--sp = nullptr;                                         // rbx
+		*--sp = impl_;                                           // r12
+		*--sp = reinterpret_cast<void*>(&FiberEntryPoint);       // r13
+		*--sp = nullptr;                                         // r14
+		*--sp = nullptr;                                         // r15
+		*--sp = reinterpret_cast<void*>(MXCSR_DEFAULT | (FPUCW_DEFAULT << 32));
+		impl_->sp_ = sp;
+	}
+
+	Fiber::Fiber(ThisThread, const char* debugName)
+#if !defined(_RELEASE)
+	    : debugName_(debugName)
+#endif
+	{
+		DBG_ASSERT_MSG(GetThreadFiber() == nullptr, "Unable to create fiber. Is there already one for this thread?");
+		if(GetThreadFiber() != nullptr)
+			return;
+
+		impl_ = new FiberImpl();
+		impl_->parent_ = this;
+		impl_->entryPointFunc_ = nullptr;
+		impl_->userData_ = nullptr;
+#if !defined(_RELEASE)
+		impl_->debugName_ = debugName_;
+#endif
+		SetThreadFiber(impl_);
+	}
+
+	Fiber::~Fiber()
+	{
+		if(impl_)
+		{
+			if(impl_->entryPointFunc_)
+			{
+				DBG_ASSERT(GetThreadFiber() != impl_);
+				::munmap(impl_->stack_, impl_->stackAllocSize_);
+			}
+			else if(GetThreadFiber() == impl_)
+			{
+				SetThreadFiber(nullptr);
+			}
+			delete impl_;
+		}
+	}
+
+	Fiber::Fiber(Fiber&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#if !defined(_RELEASE)
+		swap(debugName_, other.debugName_);
+#endif
+		if(impl_)
+			impl_->parent_ = this;
+	}
+
+	Fiber& Fiber::operator=(Fiber&& other)
+	{
+		using std::swap;
+		swap(impl_, other.impl_);
+#if !defined(_RELEASE)
+		swap(debugName_, other.debugName_);
+#endif
+		if(impl_)
+			impl_->parent_ = this;
+		if(other.impl_)
+			other.impl_->parent_ = &other;
+		return *this;
+	}
+
+	void Fiber::SwitchTo()
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(impl_->parent_ == this);
+		FiberImpl* currImpl = GetThreadFiber();
+		DBG_ASSERT(currImpl != nullptr);
+		if(impl_ && currImpl)
+		{
+			DBG_ASSERT(currImpl != impl_);
+			FiberImpl* lastExitFiber = impl_->exitFiber_;
+			impl_->exitFiber_ = impl_->entryPointFunc_ ? currImpl : nullptr;
+			SwitchFiber(currImpl, impl_);
+			impl_->exitFiber_ = lastExitFiber;
+		}
+	}
+
+	void* Fiber::GetUserData() const
+	{
+		DBG_ASSERT(impl_);
+		DBG_ASSERT(impl_->parent_ == this);
+		return impl_->userData_;
+	}
+
+	Fiber* Fiber::GetCurrentFiber()
+	{
+		// Matches Windows behavior, where only fibers created with an entry point are tracked.
+		auto* impl = GetThreadFiber();
+		if(impl && impl->entryPointFunc_)
+			return impl->parent_;
+		return nullptr;
+	}
+
+	i32 Fiber::GetPeakStackUsage() const
+	{
+		DBG_ASSERT(impl_);
+		if(impl_->stack_ == nullptr)
+			return 0;
+
+		// Skip pages that have never been touched, they are known to be zero without faulting them in.
+		const size_t pageSize = (size_t)::sysconf(_SC_PAGESIZE);
+		const size_t numPages = impl_->stackAllocSize_ / pageSize;
+		u8* stackTop = impl_->stack_ + impl_->stackAllocSize_;
+		size_t page = 1;
+		for(; page < numPages; ++page)
+		{
+			unsigned char resident = 0;
+			if(::mincore(impl_->stack_ + page * pageSize, pageSize, &resident) == 0 && (resident & 1) != 0)
+				break;
+		}
+
+		// Find deepest word that has been written to.
+		const u64* word = reinterpret_cast<const u64*>(impl_->stack_ + page * pageSize);
+		const u64* end = reinterpret_cast<const u64*>(stackTop);
+		while(word < end && *word == 0)
+			++word;
+		return (i32)(stackTop - reinterpret_cast<const u8*>(word));
+	}
+
+	namespace
+	{
+		/// Number of times to spin before parking a thread in the kernel.
+		static const i32 FUTEX_SPIN_COUNT = 128;
+
+		i32 FutexWait(volatile i32* addr, i32 value, const timespec* timeout = nullptr)
+		{
+			return (i32)::syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, value, timeout, nullptr, 0);
+		}
+
+		void FutexWake(volatile i32* addr, i32 count)
+		{
+			::syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+		}
+
+		f64 GetMonotonicTime()
+		{
+			timespec time;
+			::clock_gettime(CLOCK_MONOTONIC, &time);
+			return (f64)time.tv_sec + ((f64)time.tv_nsec / 1000000000.0);
+		}
+	}
+
+	struct SemaphoreImpl
+	{
+		/// Available count. Doubles as the futex word.
+		volatile i32 count_ = 0;
+		/// Number of threads parked, or about to park, in the kernel.
+		volatile i32 waiters_ = 0;
+		i32 maximumCount_ = 0;
+#if !defined(_RELEASE)
+		Core::String debugName_;
+#endif
+
+		bool TryAcquire()
+		{
+			i32 count = AtomicCmpExchgAcq(&count_, 0, 0);
+			while(count > 0)
+			{
+				const i32 oldCount = AtomicCmpExchgAcq(&count_, count - 1, count);
+				if(oldCount == count)
+					return true;
+				count = oldCount;
+			}
+			return false;
+		}
+	};
+
+	struct SemaphoreImpl* Semaphore::Get() { return reinterpret_cast<SemaphoreImpl*>(&implData_[0]); }
+
+	Semaphore::Semaphore(i32 initialCount, i32 maximumCount, const char* debugName)
+	{
+		static_assert(sizeof(SemaphoreImpl) <= sizeof(implData_), "implData_ too small for SemaphoreImpl!");
+		DBG_ASSERT(initialCount >= 0);
+		DBG_ASSERT(maximumCount >= 0);
+
+		new(implData_) SemaphoreImpl();
+		Get()->count_ = initialCount;
+		Get()->maximumCount_ = maximumCount;
+#if !defined(_RELEASE)
+		Get()->debugName_ = debugName;
+		debugName_ = Get()->debugName_.c_str();
+#endif
+	}
+
+	Semaphore::~Semaphore()
+	{
+		DBG_ASSERT(Get()->waiters_ == 0);
+		Get()->~SemaphoreImpl();
+	}
+
+	Semaphore::Semaphore(Semaphore&& other)
+	{
+		using std::swap;
+		new(implData_) SemaphoreImpl();
+		swap(implData_, other.implData_);
+#if !defined(_RELEASE)
+		swap(debugName_, other.debugName_);
+#endif
+	}
+
+	bool Semaphore::Wait(i32 timeout)
+	{
+		DBG_ASSERT(Get());
+		SemaphoreImpl* impl = Get();
+
+		// Fast path, and a short spin in case a signal is imminent.
+		for(i32 spin = 0; spin < FUTEX_SPIN_COUNT; ++spin)
+		{
+			if(impl->TryAcquire())
+				return true;
+			if(timeout == 0)
+				return false;
+			YieldCPU();
+		}
+
+		const f64 endTime = GetMonotonicTime() + ((f64)timeout / 1000.0);
+
+		// Register as a waiter before the final check, so Signal knows to wake us.
+		AtomicInc(&impl->waiters_);
+		bool acquired = false;
+		for(;;)
+		{
+			if(impl->TryAcquire())
+			{
+				acquired = true;
+				break;
+			}
+
+			if(timeout < 0)
+			{
+				FutexWait(&impl->count_, 0);
+			}
+			else
+			{
+				const f64 remaining = endTime - GetMonotonicTime();
+				if(remaining <= 0.0)
+					break;
+
+				timespec remainingTime;
+				remainingTime.tv_sec = (time_t)remaining;
+				remainingTime.tv_nsec = (long)((remaining - (f64)remainingTime.tv_sec) * 1000000000.0);
+				FutexWait(&impl->count_, 0, &remainingTime);
+			}
+		}
+		AtomicDec(&impl->waiters_);
+		return acquired;
+	}
+
+	bool Semaphore::Signal(i32 count)
+	{
+		DBG_ASSERT(Get());
+		DBG_ASSERT(count > 0);
+		SemaphoreImpl* impl = Get();
+
+		i32 oldCount = AtomicCmpExchg(&impl->count_, 0, 0);
+		for(;;)
+		{
+			if((oldCount + count) > impl->maximumCount_)
+				return false;
+
+			const i32 currCount = AtomicCmpExchg(&impl->count_, oldCount + count, oldCount);
+			if(currCount == oldCount)
+				break;
+			oldCount = currCount;
+		}
+
+		if(AtomicCmpExchg(&impl->waiters_, 0, 0) > 0)
+			FutexWake(&impl->count_, count);
+		return true;
+	}
+
+	struct MutexImpl
+	{
+		/// 0 = unlocked, 1 = locked, 2 = locked with waiters.
+		volatile i32 state_ = 0;
+		/// Recursion depth, only touched by owning thread.
+		i32 lockCount_ = 0;
+		/// Owning thread.
+		volatile u64 lockThread_ = 0;
+	};
+
+	namespace
+	{
+		u64 GetMutexThreadId() { return (u64)::pthread_self(); }
+
+		u64 GetMutexOwner(MutexImpl* impl) { return __atomic_load_n(&impl->lockThread_, __ATOMIC_RELAXED); }
+
+		void SetMutexOwner(MutexImpl* impl, u64 owner)
+		{
+			__atomic_store_n(&impl->lockThread_, owner, __ATOMIC_RELAXED);
+		}
+	}
+
+	struct MutexImpl* Mutex::Get() { return reinterpret_cast<MutexImpl*>(&implData_[0]); }
+
+	Mutex::Mutex()
+	{
+		static_assert(sizeof(MutexImpl) <= sizeof(implData_), "implData_ too small for MutexImpl!");
+		new(implData_) MutexImpl();
+	}
+
+	Mutex::~Mutex()
+	{
+		DBG_ASSERT(Get()->state_ == 0);
+		Get()->~MutexImpl();
+	}
+
+	Mutex::Mutex(Mutex&& other)
+	{
+		using std::swap;
+		DBG_ASSERT(other.Get()->state_ == 0);
+		new(implData_) MutexImpl();
+		swap(implData_, other.implData_);
+	}
+
+	Mutex& Mutex::operator=(Mutex&& other)
+	{
+		using std::swap;
+		DBG_ASSERT(Get()->state_ == 0);
+		DBG_ASSERT(other.Get()->state_ == 0);
+		swap(implData_, other.implData_);
+		return *this;
+	}
+
+	void Mutex::Lock()
+	{
+		DBG_ASSERT(Get());
+		MutexImpl* impl = Get();
+		const u64 thisThread = GetMutexThreadId();
+		if(GetMutexOwner(impl) == thisThread)
+		{
+			++impl->lockCount_;
+			return;
+		}
+
+		i32 state = AtomicCmpExchgAcq(&impl->state_, 1, 0);
+		if(state != 0)
+		{
+			// Spin a little in case the owner is about to release.
+			for(i32 spin = 0; spin < FUTEX_SPIN_COUNT && state != 0; ++spin)
+			{
+				YieldCPU();
+				if(impl->state_ == 0)
+					state = AtomicCmpExchgAcq(&impl->state_, 1, 0);
+			}
+
+			// Mark as contended and park until released.
+			if(state != 0)
+			{
+				if(state != 2)
+					state = AtomicExchgAcq(&impl->state_, 2);
+				while(state != 0)
+				{
+					FutexWait(&impl->state_, 2);
+					state = AtomicExchgAcq(&impl->state_, 2);
+				}
+			}
+		}
+
+		SetMutexOwner(impl, thisThread);
+		impl->lockCount_ = 1;
+	}
+
+	bool Mutex::TryLock()
+	{
+		DBG_ASSERT(Get());
+		MutexImpl* impl = Get();
+		const u64 thisThread = GetMutexThreadId();
+		if(GetMutexOwner(impl) == thisThread)
+		{
+			++impl->lockCount_;
+			return true;
+		}
+
+		if(AtomicCmpExchgAcq(&impl->state_, 1, 0) == 0)
+		{
+			SetMutexOwner(impl, thisThread);
+			impl->lockCount_ = 1;
+			return true;
+		}
+		return false;
+	}
+
+	void Mutex::Unlock()
+	{
+		DBG_ASSERT(Get());
+		MutexImpl* impl = Get();
+		DBG_ASSERT(GetMutexOwner(impl) == GetMutexThreadId());
+		if(--impl->lockCount_ > 0)
+			return;
+
+		SetMutexOwner(impl, 0);
+		if(AtomicExchg(&impl->state_, 0) == 2)
+			FutexWake(&impl->state_, 1);
+	}
+
+	struct RWLockImpl
+	{
+		static const i32 READER_MASK = 0x1fffffff;
+		static const i32 WAITING = 0x20000000;
+		static const i32 WRITE_LOCKED = 0x40000000;
+
+		/// Reader count, write locked and waiting flags.
+		volatile i32 state_ = 0;
+		/// Futex word for parked threads. Bumped whenever they need to recheck state.
+		volatile i32 wakeSeq_ = 0;
+
+		template<typename CAN_ACQUIRE_FUNC, typename ACQUIRED_STATE_FUNC>
+		void Acquire(CAN_ACQUIRE_FUNC canAcquire, ACQUIRED_STATE_FUNC acquiredState)
+		{
+			i32 spin = 0;
+			for(;;)
+			{
+				// Sample sequence before state. Any release that happens after the state is read bumps the
+				// sequence after this, causing FutexWait to return immediately.
+				const i32 wakeSeq = AtomicCmpExchgAcq(&wakeSeq_, 0, 0);
+				const i32 state = AtomicCmpExchgAcq(&state_, 0, 0);
+				if(canAcquire(state))
+				{
+					if(AtomicCmpExchgAcq(&state_, acquiredState(state), state) == state)
+						return;
+					continue;
+				}
+
+				if(spin < FUTEX_SPIN_COUNT)
+				{
+					++spin;
+					YieldCPU();
+					continue;
+				}
+
+				// Flag as waiting even if already flagged, as this also checks the state hasn't changed.
+				// If it has, the lock may have become available so go around again.
+				if(AtomicCmpExchg(&state_, state | WAITING, state) == state)
+					FutexWait(&wakeSeq_, wakeSeq);
+			}
+		}
+
+		void WakeAll()
+		{
+			AtomicIncRel(&wakeSeq_);
+			FutexWake(&wakeSeq_, INT_MAX);
+		}
+	};
+
+	struct RWLockImpl* RWLock::Get() { return reinterpret_cast<RWLockImpl*>(&implData_[0]); }
+	struct RWLockImpl* RWLock::Get() const { return reinterpret_cast<RWLockImpl*>(&implData_[0]); }
+
+	RWLock::RWLock()
+	{
+		static_assert(sizeof(RWLockImpl) <= sizeof(implData_), "implData_ too small for RWLockImpl!");
+		new(implData_) RWLockImpl;
+	}
+
+	RWLock::~RWLock()
+	{
+		DBG_ASSERT((Get()->state_ & ~RWLockImpl::WAITING) == 0);
+		Get()->~RWLockImpl();
+	}
+
+	RWLock::RWLock(RWLock&& other)
+	{
+		using std::swap;
+		new(implData_) RWLockImpl;
+		std::swap(implData_, other.implData_);
+	}
+
+	RWLock& RWLock::operator=(RWLock&& other)
+	{
+		using std::swap;
+		std::swap(implData_, other.implData_);
+		return *this;
+	}
+
+	void RWLock::BeginRead() const
+	{
+		Get()->Acquire([](i32 state) { return (state & RWLockImpl::WRITE_LOCKED) == 0; },
+		    [](i32 state) { return state + 1; });
+	}
+
+	void RWLock::EndRead() const
+	{
+		RWLockImpl* impl = Get();
+		i32 state = AtomicDecRel(&impl->state_);
+		DBG_ASSERT((state & RWLockImpl::READER_MASK) != RWLockImpl::READER_MASK);
+
+		// Last reader out wakes any waiting writers.
+		while((state & RWLockImpl::READER_MASK) == 0 && (state & RWLockImpl::WAITING) != 0)
+		{
+			if(AtomicCmpExchg(&impl->state_, state & ~RWLockImpl::WAITING, state) == state)
+			{
+				impl->WakeAll();
+				break;
+			}
+			state = AtomicCmpExchg(&impl->state_, 0, 0);
+		}
+	}
+
+	void RWLock::BeginWrite()
+	{
+		Get()->Acquire([](i32 state) { return (state & ~RWLockImpl::WAITING) == 0; },
+		    [](i32 state) { return state | RWLockImpl::WRITE_LOCKED; });
+	}
+
+	void RWLock::EndWrite()
+	{
+		RWLockImpl* impl = Get();
+		const i32 state = AtomicExchg(&impl->state_, 0);
+		DBG_ASSERT(state & RWLockImpl::WRITE_LOCKED);
+		if(state & RWLockImpl::WAITING)
+			impl->WakeAll();
+	}
+
+	TLS::TLS()
+	{
+		pthread_key_t key;
+		if(::pthread_key_create(&key, nullptr) == 0)
+			handle_ = (i32)key;
+	}
+
+	TLS::~TLS()
+	{
+		if(handle_ >= 0)
+			::pthread_key_delete((pthread_key_t)handle_);
+	}
+
+	bool TLS::Set(void* data)
+	{
+		DBG_ASSERT(handle_ >= 0);
+		return ::pthread_setspecific((pthread_key_t)handle_, data) == 0;
+	}
+
+	void* TLS::Get() const
+	{
+		DBG_ASSERT(handle_ >= 0);
+		return ::pthread_getspecific((pthread_key_t)handle_);
+	}
+
+
+	FLS::FLS()
+	{
+		i64 used = usedFlsSlots_;
+		for(;;)
+		{
+			if(~used == 0)
+			{
+				DBG_ASSERT_MSG(false, "Out of fiber local storage slots.");
+				return;
+			}
+
+			const i32 slot = CountTrailingZeros((u64)~used);
+			const i64 prevUsed = AtomicCmpExchgAcq(&usedFlsSlots_, used | (1ll << slot), used);
+			if(prevUsed == used)
+			{
+				// Generations start at 1, so zero initialised values never match.
+				const i32 gen = ((AtomicInc(&flsSlotGens_[slot]) - 1) % FLS_MAX_GENERATION) + 1;
+				handle_ = slot | (gen << FLS_SLOT_BITS);
+				return;
+			}
+			used = prevUsed;
+		}
+	}
+
+	FLS::~FLS()
+	{
+		if(handle_ >= 0)
+			AtomicAndRel(&usedFlsSlots_, ~(1ll << (handle_ & FLS_SLOT_MASK)));
+	}
+
+	bool FLS::Set(void* data)
+	{
+		DBG_ASSERT(handle_ >= 0);
+		if(handle_ < 0)
+			return false;
+		FlsValue& value = GetFlsData()[handle_ & FLS_SLOT_MASK];
+		value.data_ = data;
+		value.gen_ = handle_ >> FLS_SLOT_BITS;
+		return true;
+	}
+
+	void* FLS::Get() const
+	{
+		DBG_ASSERT(handle_ >= 0);
+		if(handle_ < 0)
+			return nullptr;
+		const FlsValue& value = GetFlsData()[handle_ & FLS_SLOT_MASK];
+		return value.gen_ == (handle_ >> FLS_SLOT_BITS) ? value.data_ : nullptr;
+	}
+
 } // namespace Core
 #else
 #error "Not implemented for platform!""
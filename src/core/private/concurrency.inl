@@ -78,5 +78,84 @@ namespace Core
 	// clang-format on
 } // namespace Core
 
+#elif PLATFORM_LINUX
+#include <sched.h>
+#include <time.h>
+
+namespace Core
+{
+	// clang-format off
+	CORE_DLL_INLINE i32 AtomicInc(volatile i32* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicIncAcq(volatile i32* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicIncRel(volatile i32* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicDec(volatile i32* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicDecAcq(volatile i32* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicDecRel(volatile i32* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicAdd(volatile i32* dest, i32 value) { return __atomic_add_fetch(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicAddAcq(volatile i32* dest, i32 value) { return __atomic_add_fetch(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicAddRel(volatile i32* dest, i32 value) { return __atomic_add_fetch(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicAnd(volatile i32* dest, i32 value) { return __atomic_fetch_and(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicAndAcq(volatile i32* dest, i32 value) { return __atomic_fetch_and(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicAndRel(volatile i32* dest, i32 value) { return __atomic_fetch_and(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicOr(volatile i32* dest, i32 value) { return __atomic_fetch_or(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicOrAcq(volatile i32* dest, i32 value) { return __atomic_fetch_or(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicOrRel(volatile i32* dest, i32 value) { return __atomic_fetch_or(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicXor(volatile i32* dest, i32 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicXorAcq(volatile i32* dest, i32 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i32 AtomicXorRel(volatile i32* dest, i32 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i32 AtomicExchg(volatile i32* dest, i32 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i32 AtomicExchgAcq(volatile i32* dest, i32 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_ACQUIRE); }
+
+	CORE_DLL_INLINE i32 AtomicCmpExchg(volatile i32* dest, i32 exchg, i32 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comp; }
+	CORE_DLL_INLINE i32 AtomicCmpExchgAcq(volatile i32* dest, i32 exchg, i32 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return comp; }
+	CORE_DLL_INLINE i32 AtomicCmpExchgRel(volatile i32* dest, i32 exchg, i32 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return comp; }
+
+	CORE_DLL_INLINE i64 AtomicInc(volatile i64* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicIncAcq(volatile i64* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicIncRel(volatile i64* dest) { return __atomic_add_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicDec(volatile i64* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicDecAcq(volatile i64* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicDecRel(volatile i64* dest) { return __atomic_sub_fetch(dest, 1, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicAdd(volatile i64* dest, i64 value) { return __atomic_add_fetch(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicAddAcq(volatile i64* dest, i64 value) { return __atomic_add_fetch(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicAddRel(volatile i64* dest, i64 value) { return __atomic_add_fetch(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicAnd(volatile i64* dest, i64 value) { return __atomic_fetch_and(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicAndAcq(volatile i64* dest, i64 value) { return __atomic_fetch_and(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicAndRel(volatile i64* dest, i64 value) { return __atomic_fetch_and(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicOr(volatile i64* dest, i64 value) { return __atomic_fetch_or(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicOrAcq(volatile i64* dest, i64 value) { return __atomic_fetch_or(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicOrRel(volatile i64* dest, i64 value) { return __atomic_fetch_or(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicXor(volatile i64* dest, i64 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicXorAcq(volatile i64* dest, i64 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_ACQUIRE); }
+	CORE_DLL_INLINE i64 AtomicXorRel(volatile i64* dest, i64 value) { return __atomic_fetch_xor(dest, value, __ATOMIC_RELEASE); }
+
+	CORE_DLL_INLINE i64 AtomicExchg(volatile i64* dest, i64 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE i64 AtomicExchgAcq(volatile i64* dest, i64 exchg) { return __atomic_exchange_n(dest, exchg, __ATOMIC_ACQUIRE); }
+
+	CORE_DLL_INLINE i64 AtomicCmpExchg(volatile i64* dest, i64 exchg, i64 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST); return comp; }
+	CORE_DLL_INLINE i64 AtomicCmpExchgAcq(volatile i64* dest, i64 exchg, i64 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE); return comp; }
+	CORE_DLL_INLINE i64 AtomicCmpExchgRel(volatile i64* dest, i64 exchg, i64 comp) { __atomic_compare_exchange_n(dest, &comp, exchg, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED); return comp; }
+
+#if ARCH_X86_64 || ARCH_X86
+	CORE_DLL_INLINE void YieldCPU() { __builtin_ia32_pause(); }
+#else
+	CORE_DLL_INLINE void YieldCPU() { __asm__ __volatile__("" ::: "memory"); }
+#endif
+	CORE_DLL_INLINE void Sleep(double seconds) { timespec ts; ts.tv_sec = (time_t)seconds; ts.tv_nsec = (long)((seconds - (double)ts.tv_sec) * 1000000000.0); ::nanosleep(&ts, nullptr); }
+	CORE_DLL_INLINE void Barrier() { __atomic_thread_fence(__ATOMIC_SEQ_CST); }
+	CORE_DLL_INLINE void SwitchThread() { ::sched_yield(); };
+	// clang-format on
+} // namespace Core
 
 #endif
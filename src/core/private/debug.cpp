@@ -1,5 +1,7 @@
 #include "core/debug.h"
 #include "core/concurrency.h"
+#include "core/hash.h"
+#include "core/misc.h"
 #include "core/os.h"
 #include "core/string.h"
 #include "core/vector.h"
@@ -7,10 +9,14 @@
 #include "Remotery.h"
 
 #include <cstdio>
+#include <cstring>
 
 #if PLATFORM_WINDOWS
 #include <DbgHelp.h>
 #include <Psapi.h>
+#elif PLATFORM_LINUX
+#include <dlfcn.h>
+#include <execinfo.h>
 #endif
 
 namespace Core
@@ -165,6 +171,15 @@ namespace Core
 	{
 #if PLATFORM_WINDOWS
 		return ::CaptureStackBackTrace(skipFrames + 1, maxAddresses, addresses, (DWORD*)stackHash);
+#elif PLATFORM_LINUX
+		static const i32 MAX_FRAMES = 128;
+		void* frames[MAX_FRAMES];
+		const i32 numFrames = ::backtrace(frames, Core::Min(skipFrames + 1 + maxAddresses, MAX_FRAMES));
+		const i32 numAddresses = Core::Max(numFrames - (skipFrames + 1), 0);
+		memcpy(addresses, frames + skipFrames + 1, numAddresses * sizeof(void*));
+		if(stackHash)
+			*stackHash = (i32)HashFNV1a(0, addresses, numAddresses * sizeof(void*));
+		return numAddresses;
 #else
 		return 0;
 #endif
@@ -227,6 +242,10 @@ namespace Core
 					memcpy(info.name_, sym->Name, sizeof(info.name_) - 1);
 			}
 		}
+#elif PLATFORM_LINUX
+		Dl_info dlInfo;
+		if(::dladdr(address, &dlInfo) && dlInfo.dli_sname)
+			strncpy(info.name_, dlInfo.dli_sname, sizeof(info.name_) - 1);
 #endif // PLATFORM_WINDOWS
 
 		return info;
@@ -8,10 +8,166 @@
 #include "core/debug.h"
 #include "etlsf.h"
 
+#include <algorithm>
 #include <utility>
 
 namespace Core
 {
+	namespace
+	{
+		/// Free or used range, in address order.
+		struct CompactionRange
+		{
+			u16 id_;
+			i32 offset_;
+			i32 size_;
+		};
+
+		/**
+		 * Plan sliding allocations down in address order, so free space merges into one range behind them.
+		 * @param requiredSize Stop once a free range of this size would exist, 0 to slide everything.
+		 */
+		void PlanSlides(
+		    const Core::Vector<CompactionRange>& ranges, i32 requiredSize, Core::Vector<ExternalMove>& moves)
+		{
+			// Each allocation slides down by the free space before it.
+			i32 freeBefore = 0;
+			for(i32 idx = 0; idx < ranges.size(); ++idx)
+			{
+				const auto& range = ranges[idx];
+				if(range.id_ == 0)
+				{
+					freeBefore += range.size_;
+					continue;
+				}
+
+				if(freeBefore > 0)
+				{
+					ExternalMove move;
+					move.id_ = range.id_;
+					move.srcOffset_ = range.offset_;
+					move.dstOffset_ = range.offset_ - freeBefore;
+					move.size_ = range.size_;
+					moves.push_back(move);
+
+					const i32 freeAfter =
+					    (idx + 1) < ranges.size() && ranges[idx + 1].id_ == 0 ? ranges[idx + 1].size_ : 0;
+					if(requiredSize > 0 && (freeBefore + freeAfter) >= requiredSize)
+						break;
+				}
+			}
+		}
+
+		/**
+		 * Plan emptying a window of consecutive ranges of at least @a requiredSize, by moving the allocations
+		 * within it into free ranges elsewhere. Windows are tried cheapest first, by bytes then allocations moved.
+		 * @return false if no window's allocations fit elsewhere.
+		 */
+		bool PlanEviction(
+		    const Core::Vector<CompactionRange>& ranges, i32 requiredSize, Core::Vector<ExternalMove>& moves)
+		{
+			struct Window
+			{
+				i32 begin_;
+				i32 end_;
+				i64 bytes_;
+				i32 numAllocs_;
+			};
+
+			// Shortest window starting at each range, as extending one only adds to its cost.
+			Core::Vector<Window> windows;
+			Window window = {0, 0, 0, 0};
+			i64 windowSize = 0;
+			for(; window.begin_ < ranges.size(); ++window.begin_)
+			{
+				for(; window.end_ < ranges.size() && windowSize < requiredSize; ++window.end_)
+				{
+					const auto& range = ranges[window.end_];
+					windowSize += range.size_;
+					if(range.id_ != 0)
+					{
+						window.bytes_ += range.size_;
+						window.numAllocs_++;
+					}
+				}
+				if(windowSize < requiredSize)
+					break;
+				windows.push_back(window);
+
+				const auto& range = ranges[window.begin_];
+				windowSize -= range.size_;
+				if(range.id_ != 0)
+				{
+					window.bytes_ -= range.size_;
+					window.numAllocs_--;
+				}
+			}
+
+			std::sort(windows.begin(), windows.end(), [](const Window& a, const Window& b) {
+				return a.bytes_ != b.bytes_ ? a.bytes_ < b.bytes_ : a.numAllocs_ < b.numAllocs_;
+			});
+
+			Core::Vector<CompactionRange> allocs;
+			Core::Vector<CompactionRange> freeRanges;
+			for(const auto& candidate : windows)
+			{
+				// Largest first, into the first free range that fits.
+				allocs.clear();
+				for(i32 idx = candidate.begin_; idx < candidate.end_; ++idx)
+					if(ranges[idx].id_ != 0)
+						allocs.push_back(ranges[idx]);
+				std::sort(allocs.begin(), allocs.end(),
+				    [](const CompactionRange& a, const CompactionRange& b) { return a.size_ > b.size_; });
+
+				// The free range after the window merges with it as it empties, which would move its start.
+				freeRanges.clear();
+				for(i32 idx = 0; idx < ranges.size(); ++idx)
+					if(ranges[idx].id_ == 0 && (idx < candidate.begin_ || idx > candidate.end_))
+						freeRanges.push_back(ranges[idx]);
+
+				moves.clear();
+				for(const auto& alloc : allocs)
+				{
+					for(auto& freeRange : freeRanges)
+					{
+						if(freeRange.size_ >= alloc.size_)
+						{
+							ExternalMove move;
+							move.id_ = alloc.id_;
+							move.srcOffset_ = alloc.offset_;
+							move.dstOffset_ = freeRange.offset_;
+							move.size_ = alloc.size_;
+							moves.push_back(move);
+
+							freeRange.offset_ += alloc.size_;
+							freeRange.size_ -= alloc.size_;
+							break;
+						}
+					}
+				}
+
+				if(moves.size() == allocs.size())
+					return true;
+			}
+			moves.clear();
+			return false;
+		}
+
+		/**
+		 * @return true if @a moves copy fewer bytes than @a otherMoves, or as many in fewer moves.
+		 */
+		bool IsCheaper(const Core::Vector<ExternalMove>& moves, const Core::Vector<ExternalMove>& otherMoves)
+		{
+			i64 bytes = 0;
+			for(const auto& move : moves)
+				bytes += move.size_;
+			i64 otherBytes = 0;
+			for(const auto& move : otherMoves)
+				otherBytes += move.size_;
+			return bytes != otherBytes ? bytes < otherBytes : moves.size() < otherMoves.size();
+		}
+	}
+
 	ExternalAllocator::ExternalAllocator(i32 size, i32 maxAllocations)
 	{
 		DBG_ASSERT(size > 0);
@@ -56,4 +212,72 @@ namespace Core
 		}
 		return retVal;
 	}
+
+	ExternalAllocatorStats ExternalAllocator::GetStats() const
+	{
+		ExternalAllocatorStats stats;
+		etlsf_walk_ranges(arena_,
+		    [](etlsf_alloc_t id, u32 offset, u32 size, int used, void* user) {
+			    auto& stats = *static_cast<ExternalAllocatorStats*>(user);
+			    stats.size_ += (i32)size;
+			    if(used)
+			    {
+				    stats.usedSize_ += (i32)size;
+				    stats.numAllocs_++;
+			    }
+			    else
+			    {
+				    stats.freeSize_ += (i32)size;
+				    stats.largestFreeRange_ = Core::Max(stats.largestFreeRange_, (i32)size);
+				    stats.numFreeRanges_++;
+			    }
+		    },
+		    &stats);
+
+		if(stats.freeSize_ > 0)
+			stats.fragmentation_ = 1.0f - ((f32)stats.largestFreeRange_ / (f32)stats.freeSize_);
+		return stats;
+	}
+
+	Core::Vector<ExternalMove> ExternalAllocator::PlanCompaction(i32 requiredSize) const
+	{
+		Core::Vector<CompactionRange> ranges;
+		etlsf_walk_ranges(arena_,
+		    [](etlsf_alloc_t id, u32 offset, u32 size, int used, void* user) {
+			    auto& ranges = *static_cast<Core::Vector<CompactionRange>*>(user);
+			    ranges.push_back({used ? id.value : (u16)0, (i32)offset, (i32)size});
+		    },
+		    &ranges);
+
+		Core::Vector<ExternalMove> moves;
+		if(requiredSize > 0)
+		{
+			// Nothing to do if there is already room.
+			for(const auto& range : ranges)
+				if(range.id_ == 0 && range.size_ >= requiredSize)
+					return moves;
+		}
+
+		PlanSlides(ranges, requiredSize, moves);
+
+		// Moving a few allocations out of the way can be much cheaper than sliding everything below them.
+		if(requiredSize > 0)
+		{
+			Core::Vector<ExternalMove> evictMoves;
+			if(PlanEviction(ranges, requiredSize, evictMoves) && IsCheaper(evictMoves, moves))
+				return evictMoves;
+		}
+		return moves;
+	}
+
+	void ExternalAllocator::ApplyCompaction(const Core::Vector<ExternalMove>& moves)
+	{
+		for(const auto& move : moves)
+		{
+			const etlsf_alloc_t alloc = {move.id_};
+			DBG_ASSERT((i32)etlsf_alloc_offset(arena_, alloc) == move.srcOffset_);
+			const i32 offset = (i32)etlsf_move_range(arena_, alloc, (u32)move.dstOffset_);
+			DBG_ASSERT(offset == move.dstOffset_);
+		}
+	}
 }
@@ -0,0 +1,169 @@
+#include "core/frame_allocator.h"
+#include "core/array.h"
+#include "core/misc.h"
+
+namespace Core
+{
+	namespace
+	{
+		/// Maximum number of frame allocators a thread can hold chunks from at once.
+		static const i32 MAX_THREAD_CHUNKS = 4;
+
+		/// Next allocator ID, 0 is never used so empty thread chunks never match.
+		volatile i32 nextFrameAllocatorId_ = 0;
+
+		/// Chunk the current thread is allocating from.
+		struct ThreadChunk
+		{
+			/// Allocator ID in upper 32 bits, frame in lower 32 bits.
+			u64 key_;
+			u8* curr_;
+			u8* end_;
+		};
+
+		/// Trivially constructed & destructed, so usable at any point during thread lifetime.
+		thread_local Core::Array<ThreadChunk, MAX_THREAD_CHUNKS> threadChunks_ = {};
+		thread_local u32 threadChunkEvictIdx_ = 0;
+
+		u8* AlignPtr(u8* ptr, i32 align) { return (u8*)PotRoundUp((u64)ptr, (u64)align); }
+	}
+
+	struct FrameAllocator::Chunk
+	{
+		Chunk* next_ = nullptr;
+		i64 size_ = 0;
+
+		u8* begin() { return reinterpret_cast<u8*>(this) + PotRoundUp((i64)sizeof(Chunk), PLATFORM_ALIGNMENT); }
+		u8* end() { return reinterpret_cast<u8*>(this) + size_; }
+	};
+
+	FrameAllocator::FrameAllocator(i32 chunkSize, IAllocator& allocator)
+	    : allocator_(allocator)
+	    , chunkSize_(chunkSize)
+	{
+		DBG_ASSERT(chunkSize_ > (i32)sizeof(Chunk));
+		id_ = (u32)Core::AtomicInc(&nextFrameAllocatorId_);
+	}
+
+	FrameAllocator::~FrameAllocator()
+	{
+		Reset();
+		while(Chunk* chunk = freeChunks_)
+		{
+			freeChunks_ = chunk->next_;
+			allocator_.Deallocate(chunk);
+		}
+	}
+
+	void FrameAllocator::Reset()
+	{
+		Core::ScopedSpinLock lock(lock_);
+		while(Chunk* chunk = usedChunks_)
+		{
+			usedChunks_ = chunk->next_;
+			if(chunk->size_ == chunkSize_)
+			{
+				chunk->next_ = freeChunks_;
+				freeChunks_ = chunk;
+			}
+			else
+			{
+				allocator_.Deallocate(chunk);
+				--numChunks_;
+			}
+		}
+		numUsedChunks_ = 0;
+
+		// Invalidates every thread's current chunk.
+		Core::AtomicInc(&frame_);
+	}
+
+	void* FrameAllocator::Allocate(i32 bytes, i32 align)
+	{
+		DBG_ASSERT(align > 0 && (align & (align - 1)) == 0);
+		const u64 key = ((u64)id_ << 32) | (u32)frame_;
+		for(auto& threadChunk : threadChunks_)
+		{
+			if(threadChunk.key_ == key)
+			{
+				u8* mem = AlignPtr(threadChunk.curr_, align);
+				if(mem + bytes <= threadChunk.end_)
+				{
+					threadChunk.curr_ = mem + bytes;
+					return mem;
+				}
+				break;
+			}
+		}
+		return AllocateSlow(bytes, align);
+	}
+
+	void* FrameAllocator::AllocateSlow(i32 bytes, i32 align)
+	{
+		const i64 headerSize = PotRoundUp((i64)sizeof(Chunk), PLATFORM_ALIGNMENT);
+		const i64 requiredSize = headerSize + bytes + Core::Max(align - PLATFORM_ALIGNMENT, 0);
+
+		// Large allocations get their own chunk, so they don't waste the rest of the current one.
+		if(requiredSize > chunkSize_ / 2)
+		{
+			Chunk* chunk = AllocateChunk(requiredSize);
+			return chunk ? AlignPtr(chunk->begin(), align) : nullptr;
+		}
+
+		Chunk* chunk = AllocateChunk(chunkSize_);
+		if(chunk == nullptr)
+			return nullptr;
+
+		// Replace this allocator's old chunk, otherwise an empty or round robin slot.
+		const u64 key = ((u64)id_ << 32) | (u32)frame_;
+		ThreadChunk* threadChunk = nullptr;
+		for(auto& candidate : threadChunks_)
+		{
+			if((candidate.key_ >> 32) == id_ || candidate.key_ == 0)
+			{
+				threadChunk = &candidate;
+				break;
+			}
+		}
+		if(threadChunk == nullptr)
+			threadChunk = &threadChunks_[(threadChunkEvictIdx_++) % MAX_THREAD_CHUNKS];
+
+		u8* mem = AlignPtr(chunk->begin(), align);
+		threadChunk->key_ = key;
+		threadChunk->curr_ = mem + bytes;
+		threadChunk->end_ = chunk->end();
+		return mem;
+	}
+
+	FrameAllocator::Chunk* FrameAllocator::AllocateChunk(i64 size)
+	{
+		Chunk* chunk = nullptr;
+		bool isNewChunk = false;
+		{
+			Core::ScopedSpinLock lock(lock_);
+			if(size == chunkSize_ && freeChunks_)
+			{
+				chunk = freeChunks_;
+				freeChunks_ = chunk->next_;
+			}
+		}
+
+		if(chunk == nullptr)
+		{
+			void* mem = allocator_.Allocate(size, PLATFORM_ALIGNMENT);
+			if(mem == nullptr)
+				return nullptr;
+			chunk = new(mem) Chunk();
+			chunk->size_ = size;
+			isNewChunk = true;
+		}
+
+		Core::ScopedSpinLock lock(lock_);
+		if(isNewChunk)
+			++numChunks_;
+		chunk->next_ = usedChunks_;
+		usedChunks_ = chunk;
+		++numUsedChunks_;
+		return chunk;
+	}
+} // namespace Core
@@ -1,7 +1,19 @@
 #include "core/hash.h"
+#include "core/debug.h"
 
 #include <cstring>
 
+#if ARCH_X86_64
+#include <nmmintrin.h>
+#if COMPILER_MSVC
+#include <intrin.h>
+#define HASH_TARGET_SSE42
+#else
+#include <cpuid.h>
+#define HASH_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+#endif // ARCH_X86_64
+
 namespace Core
 {
 // MD5: https://github.com/B-Con/crypto-algorithms
@@ -471,6 +483,133 @@ namespace Core
 		return ~Hash;
 	}
 
+	namespace
+	{
+		/// Reflected Castagnoli polynomial.
+		static const u32 CRC32C_POLY = 0x82f63b78;
+
+		struct CRC32CTables
+		{
+			u32 table_[8][256] = {};
+
+			constexpr CRC32CTables()
+			{
+				for(u32 i = 0; i < 256; ++i)
+				{
+					u32 crc = i;
+					for(i32 bit = 0; bit < 8; ++bit)
+						crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+					table_[0][i] = crc;
+				}
+				for(u32 i = 0; i < 256; ++i)
+					for(i32 slice = 1; slice < 8; ++slice)
+						table_[slice][i] = (table_[slice - 1][i] >> 8) ^ table_[0][table_[slice - 1][i] & 0xff];
+			}
+		};
+
+		/// Constant initialised, so it can be used by other static initialisers.
+		constexpr CRC32CTables gCRC32CTables_;
+
+		u64 ReadU64(const u8* data)
+		{
+			u64 value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		u64 ReadU32(const u8* data)
+		{
+			u32 value;
+			memcpy(&value, data, sizeof(value));
+			return value;
+		}
+
+		/// Slice-by-8, processing 8 bytes per step. Assumes little endian.
+		u32 CRC32CSoftware(u32 crc, const u8* data, size_t size)
+		{
+			const auto& t = gCRC32CTables_.table_;
+			for(; size >= 8; size -= 8, data += 8)
+			{
+				const u64 v = ReadU64(data) ^ crc;
+				crc = t[7][v & 0xff] ^ t[6][(v >> 8) & 0xff] ^ t[5][(v >> 16) & 0xff] ^ t[4][(v >> 24) & 0xff] ^
+				      t[3][(v >> 32) & 0xff] ^ t[2][(v >> 40) & 0xff] ^ t[1][(v >> 48) & 0xff] ^ t[0][v >> 56];
+			}
+			while(size--)
+				crc = t[0][(crc ^ *data++) & 0xff] ^ (crc >> 8);
+			return crc;
+		}
+
+#if ARCH_X86_64
+		bool HasSSE42()
+		{
+#if COMPILER_MSVC
+			int info[4];
+			__cpuid(info, 1);
+			return (info[2] & (1 << 20)) != 0;
+#else
+			u32 eax, ebx, ecx, edx;
+			if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+				return false;
+			return (ecx & bit_SSE4_2) != 0;
+#endif
+		}
+
+		/// Until this is initialised the software path is used, which gives the same result.
+		const bool gHasSSE42_ = HasSSE42();
+
+		HASH_TARGET_SSE42 u32 CRC32CHardware(u32 crc, const u8* data, size_t size)
+		{
+			u64 crc64 = crc;
+			for(; size >= 8; size -= 8, data += 8)
+				crc64 = _mm_crc32_u64(crc64, ReadU64(data));
+			crc = (u32)crc64;
+			while(size--)
+				crc = _mm_crc32_u8(crc, *data++);
+			return crc;
+		}
+#endif // ARCH_X86_64
+	} // namespace
+
+	u32 HashCRC32C(u32 input, const void* pInData, size_t size)
+	{
+		const u8* data = reinterpret_cast<const u8*>(pInData);
+		u32 crc = ~input;
+#if ARCH_X86_64
+		if(gHasSSE42_)
+			crc = CRC32CHardware(crc, data, size);
+		else
+#endif // ARCH_X86_64
+			crc = CRC32CSoftware(crc, data, size);
+		return ~crc;
+	}
+
+	namespace Detail
+	{
+		u32 HashCRC32CSoftware(u32 input, const void* pInData, size_t size)
+		{
+			return ~CRC32CSoftware(~input, reinterpret_cast<const u8*>(pInData), size);
+		}
+
+		bool HasHashCRC32CHardware()
+		{
+#if ARCH_X86_64
+			return gHasSSE42_;
+#else
+			return false;
+#endif // ARCH_X86_64
+		}
+
+		u32 HashCRC32CHardware(u32 input, const void* pInData, size_t size)
+		{
+			DBG_ASSERT(HasHashCRC32CHardware());
+#if ARCH_X86_64
+			return ~CRC32CHardware(~input, reinterpret_cast<const u8*>(pInData), size);
+#else
+			return HashCRC32CSoftware(input, pInData, size);
+#endif // ARCH_X86_64
+		}
+	} // namespace Detail
+
 	u32 HashSDBM(u32 Input, const void* pInData, size_t Size)
 	{
 		const u8* Data = reinterpret_cast<const u8*>(pInData);
@@ -857,6 +996,78 @@ namespace Core
 
 	u64 HashFNV1a(u64 input, const void* pInData, size_t size) { return fnv_64a_buf(pInData, size, input); }
 
+	namespace
+	{
+		// wyhash final version 4: https://github.com/wangyi-fudan/wyhash (public domain)
+		const u64 WYHASH_SECRET[4] = {
+		    0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+		/// 1 to 3 bytes.
+		u64 ReadU24(const u8* data, size_t size)
+		{
+			return (((u64)data[0]) << 16) | (((u64)data[size >> 1]) << 8) | data[size - 1];
+		}
+	} // namespace
+
+	u64 HashWyhash(u64 input, const void* pInData, size_t size)
+	{
+		using Detail::HashMix;
+		using Detail::HashMul128;
+		const u64* secret = WYHASH_SECRET;
+		const u8* data = reinterpret_cast<const u8*>(pInData);
+
+		u64 seed = input ^ HashMix(input ^ secret[0], secret[1]);
+		u64 a, b;
+		if(size <= 16)
+		{
+			if(size >= 4)
+			{
+				a = (ReadU32(data) << 32) | ReadU32(data + ((size >> 3) << 2));
+				b = (ReadU32(data + size - 4) << 32) | ReadU32(data + size - 4 - ((size >> 3) << 2));
+			}
+			else if(size > 0)
+			{
+				a = ReadU24(data, size);
+				b = 0;
+			}
+			else
+			{
+				a = b = 0;
+			}
+		}
+		else
+		{
+			size_t remaining = size;
+			if(remaining > 48)
+			{
+				// 3 independent lanes to hide multiply latency.
+				u64 seed1 = seed, seed2 = seed;
+				do
+				{
+					seed = HashMix(ReadU64(data) ^ secret[1], ReadU64(data + 8) ^ seed);
+					seed1 = HashMix(ReadU64(data + 16) ^ secret[2], ReadU64(data + 24) ^ seed1);
+					seed2 = HashMix(ReadU64(data + 32) ^ secret[3], ReadU64(data + 40) ^ seed2);
+					data += 48;
+					remaining -= 48;
+				} while(remaining > 48);
+				seed ^= seed1 ^ seed2;
+			}
+			while(remaining > 16)
+			{
+				seed = HashMix(ReadU64(data) ^ secret[1], ReadU64(data + 8) ^ seed);
+				data += 16;
+				remaining -= 16;
+			}
+			a = ReadU64(data + remaining - 16);
+			b = ReadU64(data + remaining - 8);
+		}
+
+		a ^= secret[1];
+		b ^= seed;
+		HashMul128(a, b);
+		return HashMix(a ^ secret[0] ^ size, b ^ secret[1]);
+	}
+
 	u64 Hash(u64 Input, const char* Data)
 	{ //
 		return fnv_64a_str(Data, Input);
@@ -14,7 +14,7 @@ namespace Core
 		auto ret = _BitScanReverse(&index, mask);
 		return ret ? 31 - index : 32;
 #elif COMPILER_GCC || COMPILER_CLANG
-		return __builtin_clz(mask);
+		return mask ? __builtin_clz(mask) : 32;
 #else
 #error "No BSR implementation."
 #endif
@@ -27,9 +27,35 @@ namespace Core
 		auto ret = _BitScanReverse64(&index, mask);
 		return ret ? 63 - index : 64;
 #elif COMPILER_GCC || COMPILER_CLANG
-		return __builtin_clzll(Mask);
+		return mask ? __builtin_clzll(mask) : 64;
 #else
 #error "No BSR implementation."
+#endif
+	}
+
+	CORE_DLL_INLINE i32 CountTrailingZeros(u32 mask)
+	{
+#if COMPILER_MSVC
+		unsigned long index;
+		auto ret = _BitScanForward(&index, mask);
+		return ret ? index : 32;
+#elif COMPILER_GCC || COMPILER_CLANG
+		return mask ? __builtin_ctz(mask) : 32;
+#else
+#error "No BSF implementation."
+#endif
+	}
+
+	CORE_DLL_INLINE i32 CountTrailingZeros(u64 mask)
+	{
+#if COMPILER_MSVC
+		unsigned long index;
+		auto ret = _BitScanForward64(&index, mask);
+		return ret ? index : 64;
+#elif COMPILER_GCC || COMPILER_CLANG
+		return mask ? __builtin_ctzll(mask) : 64;
+#else
+#error "No BSF implementation."
 #endif
 	}
 }
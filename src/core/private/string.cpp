@@ -103,11 +103,59 @@ namespace Core
 		return *this;
 	}
 
-	String& String::internalRemoveNullTerminator(bool forceRemove)
+	void String::reserve(index_type capacity)
 	{
-		if(data_.size() > (forceRemove ? 0 : 1))
-			data_.pop_back();
-		return *this;
+		if(capacity > this->capacity())
+		{
+			const index_type oldSize = size();
+			char* newData = (char*)StringAllocator().Allocate(capacity + 1, 1);
+			memcpy(newData, data(), oldSize + 1);
+			internalFree();
+			heap_.data_ = newData;
+			heap_.size_ = oldSize;
+			heap_.capacity_ = capacity;
+			local_[STORAGE_SIZE - 1] = (char)HEAP_FLAG;
+		}
+	}
+
+	void String::resize(index_type size)
+	{
+		DBG_ASSERT(size >= 0);
+		const index_type oldSize = this->size();
+		reserve(size);
+		if(size > oldSize)
+			memset(data() + oldSize, 0, size - oldSize);
+		internalSetSize(size);
+	}
+
+	void String::shrink_to_fit()
+	{
+		if(isLocal())
+			return;
+
+		const index_type oldSize = size();
+		char* oldData = heap_.data_;
+		if(oldSize <= LOCAL_CAPACITY)
+		{
+			internalInit();
+			memcpy(local_, oldData, oldSize);
+			internalSetSize(oldSize);
+			StringAllocator().Deallocate(oldData);
+		}
+		else if(heap_.capacity_ > oldSize)
+		{
+			heap_.data_ = (char*)StringAllocator().Allocate(oldSize + 1, 1);
+			heap_.capacity_ = oldSize;
+			memcpy(heap_.data_, oldData, oldSize + 1);
+			StringAllocator().Deallocate(oldData);
+		}
+	}
+
+	void String::internalFree()
+	{
+		if(!isLocal())
+			StringAllocator().Deallocate(heap_.data_);
+		internalInit();
 	}
 
 	String& String::internalSet(const char* begin, const char* end)
@@ -115,22 +163,12 @@ namespace Core
 		if(begin)
 		{
 			if(!end)
-			{
-				i32 len = (i32)strlen(begin) + 1;
-				data_.reserve(len);
-				data_.clear();
-				data_.insert(begin, begin + len);
-			}
-			else
-			{
-				data_.clear();
-				data_.insert(begin, end);
-				data_.emplace_back('\0');
-			}
+				end = begin + strlen(begin);
+			internalReplace(0, begin, (index_type)(end - begin));
 		}
 		else
 		{
-			data_.clear();
+			clear();
 		}
 		return *this;
 	}
@@ -143,33 +181,54 @@ namespace Core
 			if(subLen == npos)
 				subLen = strLen;
 			DBG_ASSERT((subPos + subLen) <= strLen);
-			internalRemoveNullTerminator(true);
-			data_.insert(str + subPos, str + subPos + subLen);
-			data_.emplace_back('\0');
+			internalReplace(size(), str + subPos, subLen);
 		}
 
 		return *this;
 	}
 
+	String& String::internalReplace(index_type pos, const char* str, index_type len)
+	{
+		DBG_ASSERT(pos >= 0 && pos <= size());
+		const index_type newSize = pos + len;
+		if(newSize > capacity())
+		{
+			// Grow geometrically when appending, but fit exactly when setting.
+			const index_type newCapacity = pos > 0 ? Core::Max(newSize, capacity() + (capacity() / 2)) : newSize;
+
+			// str may point into this string, so copy before freeing the old storage.
+			char* newData = (char*)StringAllocator().Allocate(newCapacity + 1, 1);
+			DBG_ASSERT_MSG(newData, "Unable to allocate for string.");
+			memcpy(newData, data(), pos);
+			memcpy(newData + pos, str, len);
+			internalFree();
+			heap_.data_ = newData;
+			heap_.capacity_ = newCapacity;
+			local_[STORAGE_SIZE - 1] = (char)HEAP_FLAG;
+		}
+		else
+		{
+			memmove(data() + pos, str, len);
+		}
+		internalSetSize(newSize);
+		return *this;
+	}
+
 	int String::internalCompare(const char* str) const
 	{
 		if(!str)
 			str = "";
-		if(data_.size() > 0)
-		{
-			return strcmp(data_.data(), str);
-		}
-		return strcmp("", str);
+		return strcmp(data(), str);
 	}
 
 	String::index_type String::find(const char* str, index_type subPos) const
 	{
 		if(!str || size() == 0)
 			return npos;
-		auto found = strstr(&data_[subPos], str);
+		auto found = strstr(data() + subPos, str);
 		if(found == nullptr)
 			return npos;
-		return (index_type)(found - &data_[0]);
+		return (index_type)(found - data());
 	}
 
 	String String::substr(index_type start, index_type len) const
@@ -200,7 +259,7 @@ namespace Core
 			lastPos = foundPos + searchLen;
 		}
 
-		outString.append(&data_[lastPos]);
+		outString.append(data() + lastPos);
 
 		return outString;
 	}
@@ -0,0 +1,175 @@
+#include "core/string_id.h"
+#include "core/allocator.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+#include "core/misc.h"
+
+#include <cstddef>
+#include <cstring>
+
+namespace Core
+{
+	namespace
+	{
+		using Entry = StringID::Entry;
+
+		/**
+		 * Intern table. Fixed number of buckets, each a singly linked list of entries that is only ever
+		 * pushed to with a CAS on its head, so lookups never block. Entries are bump allocated from
+		 * chunks that are only freed at exit, so a found entry remains valid for the lifetime of the
+		 * process. All state is zero initialised so it can be used during static initialisation.
+		 */
+		static const i32 NUM_BUCKETS = 16 * 1024;
+		static const i64 CHUNK_SIZE = 64 * 1024;
+
+		struct Chunk
+		{
+			Chunk* next_;
+			volatile i64 used_;
+			i64 size_;
+		};
+
+		Entry* buckets_[NUM_BUCKETS];
+		Chunk* currentChunk_;
+
+		u8* GetChunkData(Chunk* chunk) { return (u8*)(chunk + 1); }
+
+		/**
+		 * Owns the chunks, freeing them at exit.
+		 * Chunks come from the untracked allocator so they aren't reported as leaks by the general
+		 * allocator's tracker. Constructed after that allocator, so it is destroyed before it.
+		 */
+		struct ChunkOwner
+		{
+			ChunkOwner()
+			    : allocator_(UntrackedVirtualAllocator())
+			{
+			}
+
+			~ChunkOwner()
+			{
+				memset(buckets_, 0, sizeof(buckets_));
+				Chunk* chunk = currentChunk_;
+				currentChunk_ = nullptr;
+				while(chunk)
+				{
+					Chunk* next = chunk->next_;
+					allocator_.Deallocate(chunk);
+					chunk = next;
+				}
+			}
+
+			IAllocator& allocator_;
+		};
+
+		IAllocator& GetChunkAllocator()
+		{
+			static ChunkOwner chunkOwner;
+			return chunkOwner.allocator_;
+		}
+
+		void* AllocateEntry(i64 bytes)
+		{
+			bytes = PotRoundUp(bytes, (i64)alignof(Entry));
+			for(;;)
+			{
+				Chunk* chunk = *(Chunk* volatile*)&currentChunk_;
+				if(chunk)
+				{
+					const i64 end = AtomicAdd(&chunk->used_, bytes);
+					if(end <= chunk->size_)
+						return GetChunkData(chunk) + end - bytes;
+				}
+
+				// Current chunk is full, try to replace it. Losing the race just means trying the winner's chunk.
+				const i64 chunkSize = Max(CHUNK_SIZE, bytes);
+				Chunk* newChunk = (Chunk*)GetChunkAllocator().Allocate(sizeof(Chunk) + chunkSize, alignof(Chunk));
+				DBG_ASSERT_MSG(newChunk, "Unable to allocate for string intern table.");
+				newChunk->next_ = chunk;
+				newChunk->used_ = bytes;
+				newChunk->size_ = chunkSize;
+				if(AtomicCmpExchgPtr(&currentChunk_, newChunk, chunk) == chunk)
+					return GetChunkData(newChunk);
+				GetChunkAllocator().Deallocate(newChunk);
+			}
+		}
+
+		const Entry* FindEntry(const Entry* begin, const Entry* end, u64 hash, const char* str, i32 size)
+		{
+			for(const Entry* entry = begin; entry != end; entry = entry->next_)
+				if(entry->hash_ == hash && entry->size_ == size && memcmp(entry->str_, str, size) == 0)
+					return entry;
+			return nullptr;
+		}
+
+		const Entry* InternEntry(const char* begin, const char* end, bool insert)
+		{
+			const i32 size = (i32)(end - begin);
+			if(size <= 0)
+				return nullptr;
+
+			const u64 hash = HashWyhash(0, begin, size);
+			Entry** bucket = &buckets_[hash & (NUM_BUCKETS - 1)];
+
+			Entry* head = *(Entry* volatile*)bucket;
+			const Entry* searchEnd = nullptr;
+			Entry* newEntry = nullptr;
+			for(;;)
+			{
+				// Only entries pushed since the last search need checking.
+				if(const Entry* found = FindEntry(head, searchEnd, hash, begin, size))
+					return found;
+
+				if(!insert)
+					return nullptr;
+
+				// If another thread interns the same string first this entry is wasted, but that is rare.
+				if(newEntry == nullptr)
+				{
+					newEntry = (Entry*)AllocateEntry(offsetof(Entry, str_) + size + 1);
+					newEntry->hash_ = hash;
+					newEntry->size_ = size;
+					memcpy(newEntry->str_, begin, size);
+					newEntry->str_[size] = '\0';
+				}
+
+				newEntry->next_ = head;
+				Entry* prevHead = AtomicCmpExchgPtr(bucket, newEntry, head);
+				if(prevHead == head)
+					return newEntry;
+
+				searchEnd = head;
+				head = prevHead;
+			}
+		}
+	}
+
+	StringID::StringID(const char* str)
+	{
+		if(str)
+			entry_ = InternEntry(str, str + strlen(str), true);
+	}
+
+	StringID::StringID(const char* begin, const char* end)
+	{
+		if(begin)
+			entry_ = InternEntry(begin, end ? end : begin + strlen(begin), true);
+	}
+
+	StringID StringID::Find(const char* str)
+	{
+		StringID id;
+		if(str)
+			id.entry_ = InternEntry(str, str + strlen(str), false);
+		return id;
+	}
+
+	StringID StringID::Find(const char* begin, const char* end)
+	{
+		StringID id;
+		if(begin)
+			id.entry_ = InternEntry(begin, end ? end : begin + strlen(begin), false);
+		return id;
+	}
+
+} // namespace Core
@@ -6,7 +6,12 @@
 #define USE_QUERY_PERF_COUNTER 1
 #endif
 
-#if PLATFORM_LINUX || PLATFORM_OSX || PLATFORM_ANDROID
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+#include <time.h>
+#define USE_CLOCK_GETTIME 1
+#endif
+
+#if PLATFORM_OSX
 #include <sys/time.h>
 #define USE_GET_TIME_OF_DAY 1
 #endif
@@ -25,10 +30,14 @@ namespace Core
 		::QueryPerformanceCounter(&time);
 		::QueryPerformanceFrequency(&freq);
 		return (f64)time.QuadPart / (f64)freq.QuadPart;
+#elif USE_CLOCK_GETTIME
+		timespec time;
+		::clock_gettime(CLOCK_MONOTONIC, &time);
+		return (f64)time.tv_sec + ((f64)time.tv_nsec / 1000000000.0);
 #elif USE_GET_TIME_OF_DAY
 		timeval time;
-		::gettimeofday(&MarkedTime_, nullptr);
-		return (f64)(time.tv_sec * 1000000 + time.tv_usec);
+		::gettimeofday(&time, nullptr);
+		return (f64)time.tv_sec + ((f64)time.tv_usec / 1000000.0);
 #elif PLATFORM_HTML5
 		return emscripten_get_now();
 #else
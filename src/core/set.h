@@ -67,7 +67,7 @@ namespace Core
 			const KEY_TYPE& operator*() { return parent_->keys_[pos_]; }
 		};
 
-		Set(ALLOCATOR& allocator)
+		Set(const ALLOCATOR& allocator)
 		    : allocator_(allocator)
 		{
 			Alloc();
@@ -119,9 +119,9 @@ namespace Core
 
 		void copy(const Set& other)
 		{
-			allocator_ = other.allocator_;
 			allocator_.Deallocate(keys_);
 			allocator_.Deallocate(hashes_);
+			allocator_ = other.allocator_;
 			keys_ = nullptr;
 			hashes_ = nullptr;
 
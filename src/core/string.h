@@ -3,8 +3,11 @@
 #include "core/dll.h"
 #include "core/types.h"
 #include "core/array.h"
+#include "core/debug.h"
+#include "core/hash.h"
 #include "core/vector.h"
 
+#include <cstring>
 #include <utility>
 
 namespace Core
@@ -53,23 +56,45 @@ namespace Core
 
 	/**
 	 * String class.
+	 * Strings of up to LOCAL_CAPACITY characters are stored inline without allocating, longer
+	 * strings are allocated with StringAllocator. Always null terminated.
 	 */
 	class CORE_DLL String
 	{
 	public:
-		using storage_type = Core::Vector<char, StringAllocator>;
-		using index_type = storage_type::index_type;
-		using iterator = storage_type::iterator;
-		using const_iterator = storage_type::const_iterator;
+		using index_type = i32;
+		using iterator = char*;
+		using const_iterator = const char*;
 		static const index_type npos = -1;
 
-		String() {}
-		String(const char* str) { internalSet(str); }
-		String(const char* begin, const char* end) { internalSet(begin, end); }
-		String(const String& str) { internalSet(str.c_str()); }
-		String(String&& str) { swap(str); }
+		/// Size of storage within the string, for both inline characters and the heap pointer.
+		static const index_type STORAGE_SIZE = 24;
+		/// Maximum number of characters stored inline, excluding null terminator.
+		static const index_type LOCAL_CAPACITY = STORAGE_SIZE - 2;
 
-		~String() {}
+		String() { internalInit(); }
+		String(const char* str)
+		{
+			internalInit();
+			internalSet(str);
+		}
+		String(const char* begin, const char* end)
+		{
+			internalInit();
+			internalSet(begin, end);
+		}
+		String(const String& str)
+		{
+			internalInit();
+			internalSet(str.begin(), str.end());
+		}
+		String(String&& str)
+		{
+			internalInit();
+			swap(str);
+		}
+
+		~String() { internalFree(); }
 
 		// Custom interfaces.
 		String& Printf(const char* fmt, ...);
@@ -79,21 +104,24 @@ namespace Core
 		String& Append(const char* str);
 
 		// STL compatible interfaces.
-		void clear() { data_.clear(); }
-		const char* c_str() const { return data_.data(); }
-		i32 size() const { return data_.size() > 0 ? data_.size() - 1 : 0; }
-		char* data() { return data_.data(); }
-		const char* data() const { return data_.data(); }
-
-		void reserve(index_type capacity) { data_.reserve(capacity); }
-		void swap(String& other) { data_.swap(other.data_); }
-		void resize(index_type size)
+		void clear() { internalSetSize(0); }
+		const char* c_str() const { return data(); }
+		i32 size() const { return isLocal() ? getTag() : heap_.size_; }
+		index_type capacity() const { return isLocal() ? LOCAL_CAPACITY : heap_.capacity_; }
+		bool empty() const { return size() == 0; }
+		char* data() { return isLocal() ? local_ : heap_.data_; }
+		const char* data() const { return isLocal() ? local_ : heap_.data_; }
+
+		void reserve(index_type capacity);
+		void swap(String& other)
 		{
-			data_.resize(size + 1);
-			data_.back() = '\0';
+			char temp[STORAGE_SIZE];
+			memcpy(temp, local_, STORAGE_SIZE);
+			memcpy(local_, other.local_, STORAGE_SIZE);
+			memcpy(other.local_, temp, STORAGE_SIZE);
 		}
-
-		void shrink_to_fit() { data_.shrink_to_fit(); }
+		void resize(index_type size);
+		void shrink_to_fit();
 
 		index_type find(const char* str, index_type subPos = 0) const;
 		index_type find(const String& str, index_type subPos = 0) const { return find(str.c_str(), subPos); }
@@ -101,13 +129,17 @@ namespace Core
 		String substr(index_type start, index_type len) const;
 		String replace(const char* search, const char* replacement) const;
 
-		iterator begin() { return data_.begin(); }
-		const_iterator begin() const { return data_.begin(); }
+		iterator begin() { return data(); }
+		const_iterator begin() const { return data(); }
 
-		iterator end() { return data_.end() - 1; }
-		const_iterator end() const { return data_.end() - 1; }
+		iterator end() { return data() + size(); }
+		const_iterator end() const { return data() + size(); }
 
-		char operator[](index_type idx) const { return data_[idx]; }
+		char operator[](index_type idx) const
+		{
+			DBG_ASSERT_MSG(idx >= 0 && idx <= size(), "Index out of bounds. (%u, size %u)", idx, size());
+			return data()[idx];
+		}
 
 		// cstring versions.
 		void append(const char* str) { internalAppend(str); }
@@ -122,11 +154,11 @@ namespace Core
 		bool operator>=(const char* str) const { return internalCompare(str) >= 0; }
 
 		// String versions.
-		void append(const String& str) { internalAppend(str.c_str()); }
+		void append(const String& str) { internalReplace(size(), str.data(), str.size()); }
 		int compare(const String& str) const { return internalCompare(str.c_str()); }
 
 		String& operator=(const char* str) { return internalSet(str); }
-		String& operator=(const String& str) { return internalSet(str.c_str()); }
+		String& operator=(const String& str) { return internalSet(str.begin(), str.end()); }
 		String& operator=(String&& str)
 		{
 			swap(str);
@@ -134,22 +166,61 @@ namespace Core
 		}
 
 		String& operator+=(const char* str) { return internalAppend(str); }
-		String& operator+=(const String& str) { return internalAppend(str.c_str()); }
+		String& operator+=(const String& str) { return internalReplace(size(), str.data(), str.size()); }
 
-		bool operator==(const String& str) const { return internalCompare(str.c_str()) == 0; }
-		bool operator!=(const String& str) const { return internalCompare(str.c_str()) != 0; }
+		bool operator==(const String& str) const
+		{
+			return size() == str.size() && memcmp(data(), str.data(), size()) == 0;
+		}
+		bool operator!=(const String& str) const { return !(*this == str); }
 		bool operator<(const String& str) const { return internalCompare(str.c_str()) < 0; }
 		bool operator>(const String& str) const { return internalCompare(str.c_str()) > 0; }
 		bool operator<=(const String& str) const { return internalCompare(str.c_str()) <= 0; }
 		bool operator>=(const String& str) const { return internalCompare(str.c_str()) >= 0; }
 
 	private:
-		String& internalRemoveNullTerminator(bool forceRemove = true);
+		/// Set in the last byte of storage when allocated, otherwise it holds the inline size.
+		static const u8 HEAP_FLAG = 0x80;
+
+		struct HeapStorage
+		{
+			char* data_;
+			index_type size_;
+			index_type capacity_;
+		};
+		static_assert(sizeof(HeapStorage) < STORAGE_SIZE, "Heap storage must not overlap last byte.");
+		static_assert(LOCAL_CAPACITY < HEAP_FLAG, "Inline size must not overlap HEAP_FLAG.");
+
+		u8 getTag() const { return (u8)local_[STORAGE_SIZE - 1]; }
+		bool isLocal() const { return (getTag() & HEAP_FLAG) == 0; }
+
+		void internalInit()
+		{
+			local_[0] = '\0';
+			local_[STORAGE_SIZE - 1] = 0;
+		}
+
+		void internalSetSize(index_type size)
+		{
+			DBG_ASSERT(size >= 0 && size <= capacity());
+			if(isLocal())
+				local_[STORAGE_SIZE - 1] = (char)size;
+			else
+				heap_.size_ = size;
+			data()[size] = '\0';
+		}
+
+		void internalFree();
 		String& internalSet(const char* begin, const char* end = nullptr);
 		String& internalAppend(const char* str, index_type subPos = 0, index_type subLen = npos);
+		String& internalReplace(index_type pos, const char* str, index_type len);
 		int internalCompare(const char* str) const;
 
-		storage_type data_;
+		union
+		{
+			HeapStorage heap_;
+			char local_[STORAGE_SIZE];
+		};
 	};
 
 	class CORE_DLL StringView
@@ -219,7 +290,34 @@ namespace Core
 	inline bool operator<=(const String& str, const StringView& view) { return view > str; }
 	inline bool operator>=(const String& str, const StringView& view) { return view < str; }
 
+	/**
+	 * Hash string contents with HashFNV1a, matching Hash(u64, const char*).
+	 * These values are stable, so are safe to store, but containers don't use them: see Hasher below.
+	 */
 	CORE_DLL u64 Hash(u64 input, const String& string);
 	CORE_DLL u64 Hash(u64 input, const StringView& string);
 
+	/**
+	 * Hashers for containers, using the faster HashWyhash.
+	 * Containers only keep hashes in memory, so these don't match Hash above and must not be stored.
+	 */
+	template<>
+	class Hasher<String>
+	{
+	public:
+		u64 operator()(u64 input, const String& data) const { return HashWyhash(input, data.data(), data.size()); }
+	};
+
+	template<>
+	class Hasher<StringView>
+	{
+	public:
+		u64 operator()(u64 input, const StringView& data) const
+		{
+			return HashWyhash(input, data.begin(), data.size());
+		}
+	};
+
 } // end namespace Core
+
+DECLARE_TRIVIALLY_RELOCATABLE(Core::String);
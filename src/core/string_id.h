@@ -0,0 +1,66 @@
+#pragma once
+
+#include "core/dll.h"
+#include "core/types.h"
+#include "core/hash.h"
+#include "core/string.h"
+
+namespace Core
+{
+	/**
+	 * Interned string identifier.
+	 * Strings are interned into a global table once, after which comparison and hashing are O(1).
+	 * Interned strings are never freed, so this is intended for names from a bounded set such as
+	 * resource paths, shader and binding names, not arbitrary runtime strings.
+	 * Interning is lock-free and thread safe. Empty strings are the invalid (default) id.
+	 */
+	class CORE_DLL StringID
+	{
+	public:
+		StringID() = default;
+		explicit StringID(const char* str);
+		StringID(const char* begin, const char* end);
+		explicit StringID(const StringView& str)
+		    : StringID(str.begin(), str.end())
+		{
+		}
+		explicit StringID(const String& str)
+		    : StringID(str.begin(), str.end())
+		{
+		}
+
+		/**
+		 * Find existing id for string without interning it.
+		 * Useful for lookups by name, as a name that was never interned can't match anything.
+		 * @return Id, invalid if string isn't interned.
+		 */
+		static StringID Find(const char* str);
+		static StringID Find(const char* begin, const char* end);
+
+		const char* c_str() const { return entry_ ? entry_->str_ : ""; }
+		i32 size() const { return entry_ ? entry_->size_ : 0; }
+		u64 GetHash() const { return entry_ ? entry_->hash_ : 0; }
+
+		explicit operator bool() const { return entry_ != nullptr; }
+
+		bool operator==(const StringID& other) const { return entry_ == other.entry_; }
+		bool operator!=(const StringID& other) const { return entry_ != other.entry_; }
+		/// Ordering is consistent within a process run, but not alphabetical.
+		bool operator<(const StringID& other) const { return entry_ < other.entry_; }
+
+		/// Interned string. Internal use.
+		struct Entry
+		{
+			Entry* next_;
+			u64 hash_;
+			i32 size_;
+			char str_[1];
+		};
+
+	private:
+		const Entry* entry_ = nullptr;
+	};
+
+	inline u64 Hash(u64 input, const StringID& id) { return HashMix64(input, id.GetHash()); }
+
+} // namespace Core
@@ -2,13 +2,22 @@
 #include "core/misc.h"
 
 #include "core/allocator.h"
+#include "core/allocator_pool.h"
 #include "core/allocator_tlsf.h"
+#include "core/allocator_thread_cache.h"
+#include "core/allocator_proxy_thread_safe.h"
 #include "core/allocator_virtual.h"
+#include "core/arena_allocator.h"
+#include "core/circular_allocator.h"
 #include "core/allocator_proxy_tracker.h"
+#include "core/concurrency.h"
 #include "core/external_allocator.h"
+#include "core/file.h"
+#include "core/frame_allocator.h"
 #include "core/random.h"
 #include "core/string.h"
 #include "core/timer.h"
+#include "core/vector.h"
 #include "math/vec4.h"
 
 #include "catch.hpp"
@@ -29,6 +38,33 @@ TEST_CASE("allocator-tests-allocator-virtual")
 
 		virtAlloc.Deallocate(mem);
 	}
+
+	SECTION("aligned")
+	{
+		for(i64 align = 4096; align <= 1024 * 1024; align *= 4)
+		{
+			u8* mem = (u8*)virtAlloc.Allocate(size, align);
+			REQUIRE(mem);
+			REQUIRE(((i64)mem & (align - 1)) == 0);
+			REQUIRE(virtAlloc.OwnAllocation(mem));
+			REQUIRE(virtAlloc.GetAllocationSize(mem) >= size);
+			memset(mem, 0xff, size);
+			virtAlloc.Deallocate(mem);
+		}
+	}
+
+	SECTION("huge-pages")
+	{
+		const i64 hugeSize = Core::AllocatorVirtual::HUGE_PAGE_SIZE * 4;
+		u8* mem = (u8*)virtAlloc.Allocate(hugeSize, 4096);
+		REQUIRE(mem);
+#if PLATFORM_LINUX || PLATFORM_ANDROID
+		// Only aligned where transparent huge pages are available.
+		REQUIRE(((i64)mem & (Core::AllocatorVirtual::HUGE_PAGE_SIZE - 1)) == 0);
+#endif
+		memset(mem, 0xff, hugeSize);
+		virtAlloc.Deallocate(mem);
+	}
 }
 
 TEST_CASE("allocator-tests-allocator-tlsf")
@@ -149,6 +185,655 @@ TEST_CASE("allocator-tests-allocator-general")
 	}
 }
 
+TEST_CASE("allocator-tests-tracker-sampling")
+{
+	Core::AllocatorVirtual virtAlloc(false);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+
+	const i64 sampleInterval = 4 * 1024;
+	Core::AllocatorProxyTracker trackerAlloc(tsAlloc, "Sampled", sampleInterval);
+
+	const i32 numAllocs = 16384;
+	const i64 allocSize = 256;
+	const i64 totalSize = numAllocs * allocSize;
+
+	Core::Vector<void*> allocs;
+	allocs.resize(numAllocs);
+	for(auto& alloc : allocs)
+	{
+		alloc = trackerAlloc.Allocate(allocSize, 16);
+		REQUIRE(alloc);
+	}
+
+	// ~1000 samples should give an estimate well within 25%.
+	Core::AllocatorStats stats = trackerAlloc.GetStats();
+	REQUIRE(stats.numAllocations_ > (numAllocs * 3) / 4);
+	REQUIRE(stats.numAllocations_ < (numAllocs * 5) / 4);
+	REQUIRE(stats.usage_ > (totalSize * 3) / 4);
+	REQUIRE(stats.usage_ < (totalSize * 5) / 4);
+
+	{
+		// Written to memory so the test leaves no files behind.
+		Core::Vector<char> profile;
+		profile.resize(1024 * 1024);
+		Core::File file(profile.data(), profile.size(), Core::FileFlags::WRITE);
+		REQUIRE(trackerAlloc.WriteHeapProfile(file));
+		REQUIRE(file.Tell() > 0);
+		REQUIRE(strncmp(profile.data(), "# Heap profile: Sampled", 23) == 0);
+	}
+
+	for(auto* alloc : allocs)
+		trackerAlloc.Deallocate(alloc);
+
+	stats = trackerAlloc.GetStats();
+	REQUIRE(stats.numAllocations_ == 0);
+	REQUIRE(stats.usage_ == 0);
+	REQUIRE(stats.peakUsage_ > (totalSize * 3) / 4);
+}
+
+TEST_CASE("allocator-tests-thread-cache")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorThreadCache tcAlloc(tsAlloc);
+
+	Core::Random rng;
+	Core::Array<u8*, 256> allocs = {};
+	Core::Array<i64, 256> sizes = {};
+	for(i32 iter = 0; iter < 16; ++iter)
+	{
+		for(i32 i = 0; i < allocs.size(); ++i)
+		{
+			// Mostly small, some large and over-aligned to pass through to the parent.
+			const i64 maxSize = (i % 16) == 0 ? 64 * 1024 : Core::AllocatorThreadCache::MAX_SMALL_SIZE;
+			const i64 align = (i % 32) == 1 ? 256 : 16;
+			sizes[i] = (i64)((u32)rng.Generate() % (u32)maxSize);
+
+			allocs[i] = (u8*)tcAlloc.Allocate(sizes[i], align);
+			REQUIRE(allocs[i]);
+			REQUIRE(((i64)allocs[i] & (align - 1)) == 0);
+			REQUIRE(tcAlloc.OwnAllocation(allocs[i]));
+			REQUIRE(tcAlloc.GetAllocationSize(allocs[i]) >= sizes[i]);
+			memset(allocs[i], (u8)i, sizes[i]);
+		}
+
+		for(i32 i = 0; i < allocs.size(); ++i)
+		{
+			for(i64 j = 0; j < sizes[i]; ++j)
+				REQUIRE(allocs[i][j] == (u8)i);
+			tcAlloc.Deallocate(allocs[i]);
+		}
+	}
+
+	tcAlloc.FlushThreadCache();
+	REQUIRE(tlsfAlloc.CheckIntegrity());
+}
+
+TEST_CASE("allocator-tests-thread-cache-release")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorProxyTracker trackerAlloc(tsAlloc, "Spans");
+	Core::AllocatorThreadCache tcAlloc(trackerAlloc);
+
+	const i32 numAllocs = 64 * 1024;
+	const i64 allocSize = 128;
+	const i64 baseUsage = trackerAlloc.GetStats().usage_;
+
+	Core::Vector<void*> allocs;
+	allocs.resize(numAllocs);
+	for(i32 iter = 0; iter < 2; ++iter)
+	{
+		for(auto& alloc : allocs)
+		{
+			alloc = tcAlloc.Allocate(allocSize, 16);
+			REQUIRE(alloc);
+		}
+		REQUIRE(trackerAlloc.GetStats().usage_ - baseUsage >= numAllocs * allocSize);
+
+		for(auto* alloc : allocs)
+			tcAlloc.Deallocate(alloc);
+		tcAlloc.FlushThreadCache();
+
+		// Empty spans go back to the parent, other than a spare region, span map leaf and thread cache.
+		REQUIRE(trackerAlloc.GetStats().usage_ - baseUsage < 2 * 1024 * 1024);
+	}
+	REQUIRE(tlsfAlloc.CheckIntegrity());
+}
+
+namespace
+{
+	struct CrossThreadTestData
+	{
+		Core::IAllocator* allocator_ = nullptr;
+		i64 minSize_ = 0;
+		i64 maxSize_ = 0;
+		i64 align_ = 0;
+		Core::Array<void*, 4096> allocs_ = {};
+
+		i64 GetSize(i32 idx) const { return Core::Min(minSize_ + (idx % 64) * 16, maxSize_); }
+	};
+
+	/**
+	 * Allocate on one thread, free on another, then reuse on this one.
+	 */
+	void RunCrossThreadTest(Core::IAllocator& allocator, i64 minSize, i64 maxSize, i64 align)
+	{
+		CrossThreadTestData testData;
+		testData.allocator_ = &allocator;
+		testData.minSize_ = minSize;
+		testData.maxSize_ = maxSize;
+		testData.align_ = align;
+
+		for(i32 iter = 0; iter < 4; ++iter)
+		{
+			Core::Thread allocThread(
+			    [](void* userData) -> int {
+				    auto* testData = static_cast<CrossThreadTestData*>(userData);
+				    for(i32 i = 0; i < testData->allocs_.size(); ++i)
+				    {
+					    const i64 size = testData->GetSize(i);
+					    testData->allocs_[i] = testData->allocator_->Allocate(size, testData->align_);
+					    memset(testData->allocs_[i], 0xaa, size);
+				    }
+				    return 0;
+			    },
+			    &testData);
+			allocThread.Join();
+
+			Core::Thread freeThread(
+			    [](void* userData) -> int {
+				    auto* testData = static_cast<CrossThreadTestData*>(userData);
+				    for(auto*& alloc : testData->allocs_)
+				    {
+					    testData->allocator_->Deallocate(alloc);
+					    alloc = nullptr;
+				    }
+				    return 0;
+			    },
+			    &testData);
+			freeThread.Join();
+		}
+
+		void* mem = allocator.Allocate(minSize, align);
+		REQUIRE(mem);
+		allocator.Deallocate(mem);
+	}
+}
+
+TEST_CASE("allocator-tests-thread-cache-cross-thread")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorThreadCache tcAlloc(tsAlloc);
+
+	RunCrossThreadTest(tcAlloc, 16, 1024, 16);
+}
+
+namespace
+{
+	struct AllocatorBenchmarkData
+	{
+		static const i32 NUM_ITERATIONS = 256;
+		static const i32 NUM_LIVE_ALLOCS = 128;
+
+		Core::IAllocator* allocator_ = nullptr;
+		i32 seed_ = 0;
+		i64 minSize_ = 0;
+		i64 maxSize_ = 0;
+		i64 align_ = 0;
+	};
+
+	/**
+	 * Simulates building temporary containers: bursts of small allocations freed in a different order.
+	 */
+	int AllocatorBenchmarkThread(void* userData)
+	{
+		static const i32 NUM_LIVE_ALLOCS = AllocatorBenchmarkData::NUM_LIVE_ALLOCS;
+
+		auto* data = static_cast<AllocatorBenchmarkData*>(userData);
+		Core::Random rng(data->seed_);
+		Core::Array<void*, NUM_LIVE_ALLOCS> allocs = {};
+		for(i32 iter = 0; iter < AllocatorBenchmarkData::NUM_ITERATIONS; ++iter)
+		{
+			for(auto*& alloc : allocs)
+			{
+				const u32 sizeRange = (u32)(data->maxSize_ - data->minSize_ + 1);
+				const i64 size = data->minSize_ + (i64)((u32)rng.Generate() % sizeRange);
+				alloc = data->allocator_->Allocate(size, data->align_);
+			}
+			for(i32 i = 0; i < NUM_LIVE_ALLOCS; ++i)
+				data->allocator_->Deallocate(allocs[(i * 37) % NUM_LIVE_ALLOCS]);
+		}
+		return 0;
+	}
+
+	/**
+	 * Run AllocatorBenchmarkThread on @a numThreads threads at once, with sizes in [minSize, maxSize].
+	 * @return Time taken in seconds.
+	 */
+	f64 RunAllocatorBenchmark(Core::IAllocator& allocator, i32 numThreads, i64 minSize, i64 maxSize, i64 align)
+	{
+		Core::Array<AllocatorBenchmarkData, 64> datas;
+		Core::Array<Core::Thread, 64> threads;
+		DBG_ASSERT(numThreads <= threads.size());
+
+		Core::Timer timer;
+		timer.Mark();
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			datas[i].allocator_ = &allocator;
+			datas[i].seed_ = i + 1;
+			datas[i].minSize_ = minSize;
+			datas[i].maxSize_ = maxSize;
+			datas[i].align_ = align;
+			threads[i] = Core::Thread(AllocatorBenchmarkThread, &datas[i]);
+		}
+		for(i32 i = 0; i < numThreads; ++i)
+			threads[i].Join();
+		return timer.GetTime();
+	}
+}
+
+TEST_CASE("allocator-tests-thread-cache-benchmark")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorThreadCache tcAlloc(tsAlloc);
+
+	const i32 maxThreads = Core::Min(Core::Max(4, Core::GetNumLogicalCores()), 64);
+	for(i32 numThreads = 1; numThreads <= maxThreads; ++numThreads)
+	{
+		const f64 lockedTime = RunAllocatorBenchmark(tsAlloc, numThreads, 8, 519, 16);
+		const f64 cachedTime = RunAllocatorBenchmark(tcAlloc, numThreads, 8, 519, 16);
+		Core::Log("Thread cache benchmark (%i threads): Locked TLSF: %f ms, Thread cache: %f ms (%.2fx)\n", numThreads,
+		    lockedTime * 1000.0, cachedTime * 1000.0, lockedTime / cachedTime);
+	}
+}
+
+TEST_CASE("allocator-tests-tracker-sampling-benchmark")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorThreadCache tcAlloc(tsAlloc);
+	// Same configuration as the default general allocator in release.
+	Core::AllocatorProxyTracker sampledAlloc(tcAlloc, "Sampled", 512 * 1024);
+
+	// Target is under 2% overhead over the untracked allocator.
+	const i32 maxThreads = Core::Min(Core::Max(4, Core::GetNumLogicalCores()), 64);
+	for(i32 numThreads = 1; numThreads <= maxThreads; ++numThreads)
+	{
+		const f64 untrackedTime = RunAllocatorBenchmark(tcAlloc, numThreads, 8, 519, 16);
+		const f64 sampledTime = RunAllocatorBenchmark(sampledAlloc, numThreads, 8, 519, 16);
+		Core::Log("Sampling tracker benchmark (%i threads): Untracked: %f ms, Sampled: %f ms (%.2f%% overhead)\n",
+		    numThreads, untrackedTime * 1000.0, sampledTime * 1000.0, (sampledTime / untrackedTime - 1.0) * 100.0);
+	}
+}
+
+namespace
+{
+	struct PoolTestObject
+	{
+		PoolTestObject(i32 value)
+		    : value_(value)
+		{
+		}
+		i32 value_ = 0;
+		u8 data_[52];
+	};
+}
+
+TEST_CASE("allocator-tests-pool")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+
+	SECTION("st")
+	{
+		Core::PoolAllocator<PoolTestObject> pool(4096, tsAlloc);
+
+		Core::Array<PoolTestObject*, 1024> objs = {};
+		for(i32 i = 0; i < objs.size(); ++i)
+		{
+			objs[i] = pool.New(i);
+			REQUIRE(objs[i]);
+			REQUIRE(((i64)objs[i] & (alignof(PoolTestObject) - 1)) == 0);
+			REQUIRE(pool.GetAllocator().OwnAllocation(objs[i]));
+			REQUIRE(pool.GetAllocator().GetAllocationSize(objs[i]) == sizeof(PoolTestObject));
+		}
+
+		auto stats = pool.GetStats();
+		REQUIRE(stats.numAllocations_ == objs.size());
+		REQUIRE(stats.usage_ >= (i64)(objs.size() * sizeof(PoolTestObject)));
+		REQUIRE(stats.peakUsage_ >= stats.usage_);
+
+		for(i32 i = 0; i < objs.size(); ++i)
+		{
+			REQUIRE(objs[i]->value_ == i);
+			pool.Delete(objs[i]);
+		}
+
+		stats = pool.GetStats();
+		REQUIRE(stats.usage_ == 0);
+		REQUIRE(stats.peakUsage_ >= (i64)(objs.size() * sizeof(PoolTestObject)));
+
+		// Freed objects are reused.
+		auto* obj = pool.New(0);
+		REQUIRE(obj);
+		bool isReused = false;
+		for(auto* freedObj : objs)
+			isReused |= (obj == freedObj);
+		REQUIRE(isReused);
+		pool.Delete(obj);
+		REQUIRE(pool.GetStats().peakUsage_ == stats.peakUsage_);
+
+		pool.GetAllocator().FlushThreadMagazine();
+	}
+
+	SECTION("cross-thread")
+	{
+		Core::AllocatorProxyTracker trackerAlloc(tsAlloc, "Slabs");
+		Core::AllocatorPool pool(sizeof(PoolTestObject), alignof(PoolTestObject), 4096, trackerAlloc);
+		RunCrossThreadTest(pool, sizeof(PoolTestObject), sizeof(PoolTestObject), alignof(PoolTestObject));
+		REQUIRE(pool.GetStats().usage_ == 0);
+
+		// Objects freed on another thread are reused rather than allocating new slabs each iteration.
+		REQUIRE(trackerAlloc.GetStats().usage_ < 2 * 4096 * (i64)sizeof(PoolTestObject));
+	}
+
+	SECTION("mt")
+	{
+		Core::AllocatorPool pool(sizeof(PoolTestObject), alignof(PoolTestObject), 4096, tsAlloc);
+		const i32 numThreads = Core::Min(Core::Max(4, Core::GetNumLogicalCores()), 64);
+		RunAllocatorBenchmark(
+		    pool, numThreads, sizeof(PoolTestObject), sizeof(PoolTestObject), alignof(PoolTestObject));
+		REQUIRE(pool.GetStats().usage_ == 0);
+		REQUIRE(pool.GetStats().numAllocations_ ==
+		        numThreads * AllocatorBenchmarkData::NUM_ITERATIONS * AllocatorBenchmarkData::NUM_LIVE_ALLOCS);
+	}
+}
+
+TEST_CASE("allocator-tests-pool-benchmark")
+{
+	Core::AllocatorVirtual virtAlloc(true);
+	Core::AllocatorTLSF tlsfAlloc(virtAlloc, 1024 * 1024);
+	Core::AllocatorProxyThreadSafe tsAlloc(tlsfAlloc);
+	Core::AllocatorPool pool(sizeof(PoolTestObject), alignof(PoolTestObject), 64 * 1024, tsAlloc);
+
+	const i32 maxThreads = Core::Min(Core::Max(4, Core::GetNumLogicalCores()), 64);
+	for(i32 numThreads = 1; numThreads <= maxThreads; ++numThreads)
+	{
+		const i64 size = sizeof(PoolTestObject);
+		const i64 align = alignof(PoolTestObject);
+		const f64 lockedTime = RunAllocatorBenchmark(tsAlloc, numThreads, size, size, align);
+		const f64 poolTime = RunAllocatorBenchmark(pool, numThreads, size, size, align);
+		Core::Log("Pool benchmark (%i threads): Locked TLSF: %f ms, Pool: %f ms (%.2fx)\n", numThreads,
+		    lockedTime * 1000.0, poolTime * 1000.0, lockedTime / poolTime);
+	}
+}
+
+namespace
+{
+	/**
+	 * Per thread data for testing allocators shared between threads for a frame.
+	 * Each thread fills its allocations with its own tag, so overlapping allocations fail Check.
+	 */
+	template<typename ALLOCATOR>
+	struct SharedAllocatorTestData
+	{
+		static const i32 NUM_ALLOCS = 2048;
+
+		ALLOCATOR* allocator_ = nullptr;
+		u8 tag_ = 0;
+		bool success_ = true;
+		Core::Array<u8*, NUM_ALLOCS> allocs_ = {};
+
+		static i32 GetSize(i32 idx) { return 1 + ((idx * 7) % 256); }
+
+		static int ThreadEntry(void* userData)
+		{
+			auto* data = static_cast<SharedAllocatorTestData*>(userData);
+			for(i32 i = 0; i < NUM_ALLOCS; ++i)
+			{
+				const i32 size = GetSize(i);
+				data->allocs_[i] = (u8*)data->allocator_->Allocate(size);
+				if(data->allocs_[i] == nullptr || ((i64)data->allocs_[i] & (PLATFORM_ALIGNMENT - 1)) != 0)
+					data->success_ = false;
+				else
+					memset(data->allocs_[i], data->tag_, size);
+			}
+			return 0;
+		}
+
+		bool Check() const
+		{
+			for(i32 i = 0; i < NUM_ALLOCS; ++i)
+				for(i32 j = 0; allocs_[i] && j < GetSize(i); ++j)
+					if(allocs_[i][j] != tag_)
+						return false;
+			return success_;
+		}
+	};
+
+	/**
+	 * Run a thread per entry in @a datas allocating from @a allocator, tagged from @a firstTag, and wait for them.
+	 */
+	template<typename ALLOCATOR>
+	void RunSharedAllocatorTestThreads(
+	    ALLOCATOR& allocator, SharedAllocatorTestData<ALLOCATOR>* datas, i32 numThreads, i32 firstTag)
+	{
+		Core::Array<Core::Thread, 64> threads;
+		DBG_ASSERT(numThreads <= threads.size());
+		for(i32 i = 0; i < numThreads; ++i)
+		{
+			datas[i].allocator_ = &allocator;
+			datas[i].tag_ = (u8)(firstTag + i);
+			datas[i].success_ = true;
+			threads[i] = Core::Thread(SharedAllocatorTestData<ALLOCATOR>::ThreadEntry, &datas[i]);
+		}
+		for(i32 i = 0; i < numThreads; ++i)
+			threads[i].Join();
+	}
+}
+
+TEST_CASE("allocator-tests-arena")
+{
+	static const i32 CHUNK_SIZE = 16 * 1024;
+
+	SECTION("alloc")
+	{
+		Core::ScopedArena arena(CHUNK_SIZE);
+		REQUIRE(arena.GetNumChunks() == 0);
+
+		auto* mem = (u8*)arena.Allocate(16);
+		REQUIRE(mem);
+		REQUIRE(arena.GetNumChunks() == 1);
+
+		auto* aligned = (u8*)arena.Allocate(64, 256);
+		REQUIRE(aligned);
+		REQUIRE(((i64)aligned & 255) == 0);
+
+		for(i32 i = 0; i < 64; ++i)
+			REQUIRE(arena.Allocate(1024));
+		REQUIRE(arena.GetNumChunks() > 1);
+
+		// Large allocations get a dedicated chunk.
+		const i32 numChunks = arena.GetNumChunks();
+		auto* large = (u8*)arena.Allocate(CHUNK_SIZE * 4);
+		REQUIRE(large);
+		memset(large, 0, CHUNK_SIZE * 4);
+		REQUIRE(arena.GetNumChunks() == numChunks + 1);
+		REQUIRE(arena.GetUsedBytes() >= CHUNK_SIZE * 4 + 64 * 1024);
+
+		arena.Reset();
+		REQUIRE(arena.GetNumChunks() == 1);
+		REQUIRE(arena.GetUsedBytes() == 0);
+		REQUIRE(arena.Allocate(1024));
+		REQUIRE(arena.GetNumChunks() == 1);
+	}
+
+	SECTION("containers")
+	{
+		Core::ScopedArena arena(CHUNK_SIZE);
+
+		Core::Vector<i32, Core::ArenaAllocator> vec(arena);
+		for(i32 i = 0; i < 10000; ++i)
+			vec.push_back(i);
+		for(i32 i = 0; i < 10000; ++i)
+			REQUIRE(vec[i] == i);
+
+		// Copies share the arena.
+		Core::Vector<i32, Core::ArenaAllocator> vecCopy(vec);
+		REQUIRE(vecCopy.size() == vec.size());
+		vecCopy = Core::Vector<i32, Core::ArenaAllocator>(arena);
+		REQUIRE(vecCopy.size() == 0);
+
+		REQUIRE(arena.GetUsedBytes() > 10000 * sizeof(i32));
+
+		// Assigning within an arena reuses storage, assigning across arenas adopts the other arena.
+		Core::Vector<i32, Core::ArenaAllocator> vecSmall(arena);
+		vecSmall.resize(16, 1);
+		const i64 usedBytes = arena.GetUsedBytes();
+		vec = vecSmall;
+		REQUIRE(vec.size() == 16);
+		REQUIRE(arena.GetUsedBytes() == usedBytes);
+
+		Core::ScopedArena otherArena(CHUNK_SIZE);
+		Core::Vector<i32, Core::ArenaAllocator> otherVec(otherArena);
+		otherVec.resize(16, 2);
+		vec = otherVec;
+		REQUIRE(vec[0] == 2);
+		vec.resize(10000, 3);
+		REQUIRE(arena.GetUsedBytes() == usedBytes);
+		REQUIRE(otherArena.GetUsedBytes() > 10000 * sizeof(i32));
+
+		// No arena falls back to the general allocator.
+		Core::Vector<i32, Core::ArenaAllocator> generalVec;
+		generalVec.resize(1000, 1);
+		REQUIRE(generalVec.size() == 1000);
+	}
+}
+
+TEST_CASE("allocator-tests-frame-allocator")
+{
+	static const i32 CHUNK_SIZE = 16 * 1024;
+	Core::FrameAllocator allocator(CHUNK_SIZE);
+
+	SECTION("st")
+	{
+		u8* mem = allocator.Allocate<u8>(16);
+		REQUIRE(mem);
+		REQUIRE(allocator.GetNumUsedChunks() == 1);
+
+		// Aligned.
+		auto* aligned = (u8*)allocator.Allocate(64, 256);
+		REQUIRE(aligned);
+		REQUIRE(((i64)aligned & 255) == 0);
+
+		// Grows past a single chunk.
+		for(i32 i = 0; i < 64; ++i)
+			REQUIRE(allocator.Allocate(1024));
+		REQUIRE(allocator.GetNumUsedChunks() > 1);
+
+		// Large allocations get a dedicated chunk.
+		u8* large = allocator.Allocate<u8>(CHUNK_SIZE * 4);
+		REQUIRE(large);
+		memset(large, 0, CHUNK_SIZE * 4);
+
+		// Chunks are reused after reset, dedicated ones are freed.
+		const i32 numChunks = allocator.GetNumChunks();
+		allocator.Reset();
+		REQUIRE(allocator.GetNumUsedChunks() == 0);
+		REQUIRE(allocator.GetNumChunks() == numChunks - 1);
+		for(i32 i = 0; i < 64; ++i)
+			REQUIRE(allocator.Allocate(1024));
+		REQUIRE(allocator.GetNumChunks() == numChunks - 1);
+	}
+
+	SECTION("mt")
+	{
+		static const i32 NUM_THREADS = 8;
+		static const i32 NUM_FRAMES = 4;
+		for(i32 frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			Core::Array<SharedAllocatorTestData<Core::FrameAllocator>, NUM_THREADS> datas;
+			RunSharedAllocatorTestThreads(allocator, datas.data(), NUM_THREADS, 1);
+			for(const auto& data : datas)
+				REQUIRE(data.Check());
+			allocator.Reset();
+		}
+	}
+}
+
+TEST_CASE("allocator-tests-circular")
+{
+	SECTION("st")
+	{
+		Core::CircularAllocator allocator(1024, 16);
+
+		u8* a = allocator.Allocate<u8>(512);
+		u8* b = allocator.Allocate<u8>(250);
+		REQUIRE(a);
+		REQUIRE(b == a + 512);
+		REQUIRE(allocator.GetUsedBytes() == 768);
+
+		// Full until released.
+		REQUIRE(allocator.Allocate(512) == nullptr);
+		allocator.Release(allocator.GetMarker());
+		REQUIRE(allocator.GetUsedBytes() == 0);
+
+		// Wraps to the start, skipping the end as padding.
+		u8* c = allocator.Allocate<u8>(512);
+		REQUIRE(c == a);
+		REQUIRE(allocator.GetUsedBytes() == 768);
+
+		// Older markers are ignored.
+		const auto marker = allocator.GetMarker();
+		REQUIRE(allocator.Allocate(256));
+		allocator.Release(allocator.GetMarker());
+		allocator.Release(marker);
+		REQUIRE(allocator.GetUsedBytes() == 0);
+	}
+
+	SECTION("mt")
+	{
+		static const i32 NUM_THREADS = 8;
+		static const i32 NUM_FRAMES = 16;
+		static const i32 FRAME_LATENCY = 2;
+
+		Core::CircularAllocator allocator(8 * 1024 * 1024);
+
+		Core::Array<Core::CircularAllocator::Marker, FRAME_LATENCY> markers = {};
+		Core::Vector<SharedAllocatorTestData<Core::CircularAllocator>> datas;
+		datas.resize(NUM_THREADS * FRAME_LATENCY);
+		for(i32 frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			const i32 frameIdx = frame % FRAME_LATENCY;
+
+			// Wait for oldest frame to complete.
+			allocator.Release(markers[frameIdx]);
+
+			const i32 firstIdx = frameIdx * NUM_THREADS;
+			RunSharedAllocatorTestThreads(allocator, &datas[firstIdx], NUM_THREADS, firstIdx + 1);
+			markers[frameIdx] = allocator.GetMarker();
+
+			// All frames in flight should be untouched by each other.
+			for(const auto& data : datas)
+				REQUIRE(data.Check());
+		}
+
+		for(const auto marker : markers)
+			allocator.Release(marker);
+		REQUIRE(allocator.GetUsedBytes() == 0);
+	}
+}
 
 TEST_CASE("allocator-tests-etlsf-small")
 {
@@ -190,3 +875,169 @@ TEST_CASE("allocator-tests-etlsf-small")
 	REQUIRE(alloc4.offset_ >= 0);
 	REQUIRE(alloc4.size_ == MAX_SIZE);
 }
+
+TEST_CASE("allocator-tests-etlsf-compaction")
+{
+	const i32 MAX_SIZE = 4 * 1024 * 1024;
+	const i32 BLOCK_SIZE = 64 * 1024;
+	Core::ExternalAllocator allocator(MAX_SIZE, 0xffff);
+
+	// Shadow of external memory, to check moves preserve contents.
+	Core::Vector<u8> memory;
+	memory.resize(MAX_SIZE, 0);
+	Core::Vector<u16> ids;
+
+	const auto fillAlloc = [&](u16 id) {
+		auto alloc = allocator.GetAlloc(id);
+		memset(memory.data() + alloc.offset_, (u8)id, alloc.size_);
+	};
+
+	const auto checkAllocs = [&]() {
+		for(u16 id : ids)
+		{
+			auto alloc = allocator.GetAlloc(id);
+			REQUIRE(alloc);
+			for(i32 i = 0; i < alloc.size_; ++i)
+				if(memory[alloc.offset_ + i] != (u8)id)
+					return false;
+		}
+		return true;
+	};
+
+	const auto applyMoves = [&](const Core::Vector<Core::ExternalMove>& moves) {
+		for(const auto& move : moves)
+			memmove(memory.data() + move.dstOffset_, memory.data() + move.srcOffset_, move.size_);
+		allocator.ApplyCompaction(moves);
+	};
+
+	SECTION("checkerboard")
+	{
+		for(i32 i = 0; i < MAX_SIZE / BLOCK_SIZE; ++i)
+		{
+			u16 id = allocator.AllocRange(BLOCK_SIZE);
+			REQUIRE(id);
+			fillAlloc(id);
+			ids.push_back(id);
+		}
+
+		// Free every other block.
+		Core::Vector<u16> allIds = ids;
+		ids.clear();
+		for(i32 i = 0; i < allIds.size(); ++i)
+		{
+			if(i & 1)
+				ids.push_back(allIds[i]);
+			else
+				allocator.FreeRange(allIds[i]);
+		}
+
+		// Half is free, but nothing larger than a block fits.
+		auto stats = allocator.GetStats();
+		REQUIRE(stats.size_ == MAX_SIZE);
+		REQUIRE(stats.freeSize_ == MAX_SIZE / 2);
+		REQUIRE(stats.largestFreeRange_ == BLOCK_SIZE);
+		REQUIRE(stats.numAllocs_ == ids.size());
+		REQUIRE(stats.fragmentation_ > 0.9f);
+		REQUIRE(!allocator.GetAlloc(allocator.AllocRange(BLOCK_SIZE * 4)));
+
+		// Partial compaction only moves enough to fit the request, here emptying 4 adjacent blocks.
+		auto moves = allocator.PlanCompaction(BLOCK_SIZE * 4);
+		REQUIRE(moves.size() == 2);
+		applyMoves(moves);
+		REQUIRE(checkAllocs());
+		REQUIRE(allocator.GetStats().largestFreeRange_ >= BLOCK_SIZE * 4);
+
+		u16 id = allocator.AllocRange(BLOCK_SIZE * 4);
+		REQUIRE(allocator.GetAlloc(id));
+		allocator.FreeRange(id);
+
+		// Full compaction leaves one free range.
+		moves = allocator.PlanCompaction();
+		applyMoves(moves);
+		REQUIRE(checkAllocs());
+		stats = allocator.GetStats();
+		REQUIRE(stats.numFreeRanges_ == 1);
+		REQUIRE(stats.largestFreeRange_ == MAX_SIZE / 2);
+		REQUIRE(stats.fragmentation_ == 0.0f);
+
+		// Nothing left to do.
+		REQUIRE(allocator.PlanCompaction().size() == 0);
+	}
+
+	SECTION("cheapest-window")
+	{
+		// [F1][A:100][F1][B:1][F2], where only moving B into the first free block is needed.
+		const i32 UNIT_SIZE = Core::ExternalAllocator::SIZE_ALIGNMENT;
+		Core::ExternalAllocator smallAllocator(UNIT_SIZE * 105, 16);
+		const u16 free0 = smallAllocator.AllocRange(UNIT_SIZE);
+		const u16 idA = smallAllocator.AllocRange(UNIT_SIZE * 100);
+		const u16 free1 = smallAllocator.AllocRange(UNIT_SIZE);
+		const u16 idB = smallAllocator.AllocRange(UNIT_SIZE);
+		REQUIRE(smallAllocator.GetAlloc(idB).offset_ == UNIT_SIZE * 102);
+		smallAllocator.FreeRange(free0);
+		smallAllocator.FreeRange(free1);
+		REQUIRE(smallAllocator.GetStats().largestFreeRange_ == UNIT_SIZE * 2);
+
+		auto moves = smallAllocator.PlanCompaction(UNIT_SIZE * 4);
+		REQUIRE(moves.size() == 1);
+		REQUIRE(moves[0].id_ == idB);
+		REQUIRE(moves[0].dstOffset_ == 0);
+		smallAllocator.ApplyCompaction(moves);
+		REQUIRE(smallAllocator.GetAlloc(idB).offset_ == 0);
+		REQUIRE(smallAllocator.GetAlloc(idA).offset_ == UNIT_SIZE);
+		REQUIRE(smallAllocator.GetStats().largestFreeRange_ == UNIT_SIZE * 4);
+		REQUIRE(smallAllocator.GetAlloc(smallAllocator.AllocRange(UNIT_SIZE * 4)));
+	}
+
+	SECTION("stress")
+	{
+		Core::Random rng;
+		for(i32 cycle = 0; cycle < 32; ++cycle)
+		{
+			// Fill until failure with random sizes, then free a random half.
+			for(;;)
+			{
+				const i32 size =
+				    Core::PotRoundUp(1 + (i32)((u32)rng.Generate() % BLOCK_SIZE), Core::ExternalAllocator::SIZE_ALIGNMENT);
+				u16 id = allocator.AllocRange(size);
+				if(!allocator.GetAlloc(id))
+					break;
+				fillAlloc(id);
+				ids.push_back(id);
+			}
+
+			for(i32 i = 0; i < ids.size();)
+			{
+				if(rng.Generate() & 1)
+				{
+					allocator.FreeRange(ids[i]);
+					ids[i] = ids.back();
+					ids.pop_back();
+				}
+				else
+				{
+					++i;
+				}
+			}
+
+			// Ask for more than the largest free range, up to all of the free space.
+			const auto freeStats = allocator.GetStats();
+			const i32 requiredSize =
+			    (rng.Generate() % 2) ? Core::Min(freeStats.largestFreeRange_ * 2, freeStats.freeSize_) : 0;
+			applyMoves(allocator.PlanCompaction(requiredSize));
+			REQUIRE(checkAllocs());
+
+			auto stats = allocator.GetStats();
+			REQUIRE(stats.size_ == MAX_SIZE);
+			REQUIRE(stats.numAllocs_ == ids.size());
+			if(requiredSize == 0)
+				REQUIRE(stats.numFreeRanges_ == 1);
+			else
+				REQUIRE(stats.largestFreeRange_ >= requiredSize);
+		}
+
+		for(u16 id : ids)
+			allocator.FreeRange(id);
+		REQUIRE(allocator.GetStats().largestFreeRange_ == MAX_SIZE);
+	}
+}
@@ -1,4 +1,7 @@
 #include "core/concurrency.h"
+#include "core/misc.h"
+#include "core/mpmc_bounded_queue.h"
+#include "core/timer.h"
 #include "core/vector.h"
 
 #include "catch.hpp"
@@ -383,6 +386,84 @@ TEST_CASE("concurrency-tests-fiber")
 	REQUIRE(sharedData.exited_ == sharedData.fibers_.size());
 }
 
+TEST_CASE("concurrency-tests-fiber-switch-latency")
+{
+	Fiber primaryFiber(Fiber::THIS_THREAD);
+
+	struct SharedData
+	{
+		Fiber* returnFiber_ = nullptr;
+		i32 numSwitches_ = 0;
+		bool exiting_ = false;
+	};
+
+	auto fiberFunc = [](void* inData) -> void {
+		auto* data = reinterpret_cast<SharedData*>(inData);
+		while(!data->exiting_)
+		{
+			data->numSwitches_++;
+			data->returnFiber_->SwitchTo();
+		}
+	};
+
+	static const i32 NUM_ROUND_TRIPS = 1000000;
+
+	SharedData sharedData;
+	sharedData.returnFiber_ = &primaryFiber;
+	Fiber fiber(fiberFunc, &sharedData);
+
+	Timer timer;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_ROUND_TRIPS; ++i)
+		fiber.SwitchTo();
+	const f64 time = timer.GetTime();
+
+	// Allow fiber to exit.
+	sharedData.exiting_ = true;
+	fiber.SwitchTo();
+
+	REQUIRE(sharedData.numSwitches_ == NUM_ROUND_TRIPS);
+	Core::Log("Fiber switch: %.2fns per switch (%i round trips in %.2fms)\n",
+	    (time * 1000000000.0) / (f64)(NUM_ROUND_TRIPS * 2), NUM_ROUND_TRIPS, time * 1000.0);
+}
+
+TEST_CASE("concurrency-tests-fiber-stack-usage")
+{
+	Fiber primaryFiber(Fiber::THIS_THREAD);
+	REQUIRE(primaryFiber.GetPeakStackUsage() == 0);
+
+	static const i32 STACK_SIZE = 256 * 1024;
+	static const i32 STACK_USED = 32 * 1024;
+
+	struct SharedData
+	{
+		Fiber* returnFiber_ = nullptr;
+	};
+
+	auto fiberFunc = [](void* inData) -> void {
+		auto* data = reinterpret_cast<SharedData*>(inData);
+		volatile u8 buffer[STACK_USED];
+		for(i32 i = 0; i < STACK_USED; ++i)
+			buffer[i] = 0xff;
+		data->returnFiber_->SwitchTo();
+	};
+
+	SharedData sharedData;
+	sharedData.returnFiber_ = &primaryFiber;
+	Fiber fiber(fiberFunc, &sharedData, STACK_SIZE);
+	const i32 initialUsage = fiber.GetPeakStackUsage();
+	REQUIRE(initialUsage < STACK_USED);
+
+	fiber.SwitchTo();
+	const i32 peakUsage = fiber.GetPeakStackUsage();
+	REQUIRE(peakUsage >= STACK_USED);
+	REQUIRE(peakUsage <= STACK_SIZE);
+	Core::Log("Fiber stack usage: %i bytes peak of %i bytes\n", peakUsage, STACK_SIZE);
+
+	// Allow fiber to exit.
+	fiber.SwitchTo();
+}
+
 TEST_CASE("concurrency-tests-sem")
 {
 	SECTION("st-default")
@@ -458,6 +539,383 @@ TEST_CASE("concurrency-tests-mutex")
 		mutex.Unlock();
 		mutex.Unlock();
 	}
+
+	SECTION("mt-contended")
+	{
+		struct SharedData
+		{
+			Mutex mutex_;
+			i64 value_ = 0;
+		};
+
+		static const i32 NUM_THREADS = 4;
+		static const i32 NUM_ITERATIONS = 100000;
+
+		SharedData sharedData;
+		auto threadFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			{
+				ScopedMutex lock(data->mutex_);
+				data->value_++;
+			}
+			return 0;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < NUM_THREADS; ++i)
+			threads.emplace_back(threadFunc, &sharedData);
+		for(auto& thread : threads)
+			thread.Join();
+
+		REQUIRE(sharedData.value_ == NUM_THREADS * NUM_ITERATIONS);
+	}
+}
+
+TEST_CASE("concurrency-tests-rwlock")
+{
+	SECTION("st")
+	{
+		RWLock lock;
+		lock.BeginRead();
+		lock.BeginRead();
+		lock.EndRead();
+		lock.EndRead();
+		lock.BeginWrite();
+		lock.EndWrite();
+	}
+
+	SECTION("mt-contended")
+	{
+		struct SharedData
+		{
+			RWLock lock_;
+			i64 valueA_ = 0;
+			i64 valueB_ = 0;
+		};
+
+		static const i32 NUM_THREADS = 4;
+		static const i32 NUM_ITERATIONS = 100000;
+
+		SharedData sharedData;
+		auto threadFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			i32 numMismatches = 0;
+			for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			{
+				if((i % 8) == 0)
+				{
+					ScopedWriteLock lock(data->lock_);
+					data->valueA_++;
+					data->valueB_++;
+				}
+				else
+				{
+					ScopedReadLock lock(data->lock_);
+					if(data->valueA_ != data->valueB_)
+						++numMismatches;
+				}
+			}
+			return numMismatches;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < NUM_THREADS; ++i)
+			threads.emplace_back(threadFunc, &sharedData);
+		for(auto& thread : threads)
+			REQUIRE(thread.Join() == 0);
+
+		REQUIRE(sharedData.valueA_ == NUM_THREADS * (NUM_ITERATIONS / 8));
+	}
+
+	SECTION("mt-parking")
+	{
+		// Hold locks long enough, with more threads than cores, that waiters park instead of spinning.
+		// A lost wakeup leaves a thread parked forever, hanging the test.
+		struct SharedData
+		{
+			RWLock lock_;
+			volatile i32 numReaders_ = 0;
+			volatile i32 numWriters_ = 0;
+			i32 numErrors_ = 0;
+			i64 value_ = 0;
+		};
+
+		static const i32 NUM_READERS = 6;
+		static const i32 NUM_WRITERS = 3;
+		static const i32 NUM_ITERATIONS = 20000;
+		static const i32 HOLD_SPINS = 16;
+
+		SharedData sharedData;
+		auto readerFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			{
+				data->lock_.BeginRead();
+				AtomicInc(&data->numReaders_);
+				for(i32 spin = 0; spin < HOLD_SPINS; ++spin)
+				{
+					if(data->numWriters_ != 0)
+						AtomicInc(&data->numErrors_);
+					YieldCPU();
+				}
+				AtomicDec(&data->numReaders_);
+				data->lock_.EndRead();
+			}
+			return 0;
+		};
+
+		auto writerFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+			{
+				data->lock_.BeginWrite();
+				if(AtomicInc(&data->numWriters_) != 1 || data->numReaders_ != 0)
+					AtomicInc(&data->numErrors_);
+				for(i32 spin = 0; spin < HOLD_SPINS; ++spin)
+					YieldCPU();
+				data->value_++;
+				AtomicDec(&data->numWriters_);
+				data->lock_.EndWrite();
+			}
+			return 0;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < NUM_READERS; ++i)
+			threads.emplace_back(readerFunc, &sharedData);
+		for(i32 i = 0; i < NUM_WRITERS; ++i)
+			threads.emplace_back(writerFunc, &sharedData);
+		for(auto& thread : threads)
+			thread.Join();
+
+		REQUIRE(sharedData.numErrors_ == 0);
+		REQUIRE(sharedData.value_ == NUM_WRITERS * NUM_ITERATIONS);
+	}
+}
+
+TEST_CASE("concurrency-tests-eventcount")
+{
+	SECTION("st")
+	{
+		EventCount eventCount;
+		eventCount.PrepareWait();
+		eventCount.CancelWait();
+		eventCount.Notify(1);
+		eventCount.NotifyAll();
+
+		// Notified between prepare and cancel, cancel must consume the signal.
+		eventCount.PrepareWait();
+		eventCount.Notify(1);
+		eventCount.CancelWait();
+	}
+
+	SECTION("mt-producer-consumer")
+	{
+		struct SharedData
+		{
+			EventCount eventCount_;
+			volatile i32 numItems_ = 0;
+			volatile i32 numConsumed_ = 0;
+			volatile i32 done_ = 0;
+
+			bool TryConsume()
+			{
+				i32 numItems = AtomicCmpExchg(&numItems_, 0, 0);
+				while(numItems > 0)
+				{
+					const i32 oldNumItems = AtomicCmpExchg(&numItems_, numItems - 1, numItems);
+					if(oldNumItems == numItems)
+						return true;
+					numItems = oldNumItems;
+				}
+				return false;
+			}
+		};
+
+		static const i32 NUM_THREADS = 4;
+		static const i32 NUM_ITEMS = 100000;
+
+		SharedData sharedData;
+		auto threadFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			for(;;)
+			{
+				if(data->TryConsume())
+				{
+					AtomicInc(&data->numConsumed_);
+					continue;
+				}
+				if(AtomicCmpExchg(&data->done_, 0, 0))
+					break;
+
+				data->eventCount_.PrepareWait();
+				if(data->numItems_ > 0 || data->done_)
+					data->eventCount_.CancelWait();
+				else
+					data->eventCount_.Wait();
+			}
+			return 0;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < NUM_THREADS; ++i)
+			threads.emplace_back(threadFunc, &sharedData);
+
+		for(i32 i = 0; i < NUM_ITEMS; ++i)
+		{
+			AtomicInc(&sharedData.numItems_);
+			sharedData.eventCount_.Notify(1);
+		}
+
+		while(sharedData.numConsumed_ < NUM_ITEMS)
+			SwitchThread();
+		AtomicExchg(&sharedData.done_, 1);
+		sharedData.eventCount_.NotifyAll();
+
+		for(auto& thread : threads)
+			thread.Join();
+		REQUIRE(sharedData.numConsumed_ == NUM_ITEMS);
+	}
+}
+
+TEST_CASE("concurrency-tests-mpmc-bounded-queue-bulk")
+{
+	SECTION("st")
+	{
+		MPMCBoundedQueue<i32> queue(8);
+		i32 items[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+		i32 outItems[16] = {};
+
+		REQUIRE(queue.DequeueBulk(outItems, 16) == 0);
+		REQUIRE(queue.EnqueueBulk(items, 5) == 5);
+		REQUIRE(queue.EnqueueBulk(items + 5, 5) == 3);
+		REQUIRE(queue.EnqueueBulk(items, 1) == 0);
+
+		REQUIRE(queue.DequeueBulk(outItems, 2) == 2);
+		REQUIRE(outItems[0] == 0);
+		REQUIRE(outItems[1] == 1);
+
+		// Wraps around the end of the buffer.
+		REQUIRE(queue.EnqueueBulk(items + 8, 4) == 2);
+		REQUIRE(queue.DequeueBulk(outItems, 16) == 8);
+		for(i32 i = 0; i < 8; ++i)
+			REQUIRE(outItems[i] == i + 2);
+
+		// Mixed with single item operations.
+		REQUIRE(queue.Enqueue(items[3]));
+		REQUIRE(queue.EnqueueBulk(items, 3) == 3);
+		i32 item = -1;
+		REQUIRE(queue.Dequeue(item));
+		REQUIRE(item == 3);
+		REQUIRE(queue.DequeueBulk(outItems, 16) == 3);
+		REQUIRE(outItems[2] == 2);
+	}
+
+	SECTION("mt-producer-consumer")
+	{
+		static const i32 NUM_PRODUCERS = 2;
+		static const i32 NUM_CONSUMERS = 2;
+		static const i32 NUM_ITEMS_PER_PRODUCER = 100000;
+		static const i32 BATCH_SIZE = 13;
+
+		struct SharedData
+		{
+			MPMCBoundedQueue<i32> queue_ = MPMCBoundedQueue<i32>(256);
+			volatile i32 nextProducer_ = 0;
+			volatile i32 numConsumed_ = 0;
+			Vector<i32> seen_;
+			SpinLock seenLock_;
+		};
+
+		SharedData sharedData;
+		sharedData.seen_.resize(NUM_PRODUCERS * NUM_ITEMS_PER_PRODUCER, 0);
+
+		auto producerFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			const i32 base = (AtomicInc(&data->nextProducer_) - 1) * NUM_ITEMS_PER_PRODUCER;
+			i32 items[BATCH_SIZE];
+			i32 numProduced = 0;
+			while(numProduced < NUM_ITEMS_PER_PRODUCER)
+			{
+				const i32 numItems = Min(BATCH_SIZE, NUM_ITEMS_PER_PRODUCER - numProduced);
+				for(i32 i = 0; i < numItems; ++i)
+					items[i] = base + numProduced + i;
+				i32 numQueued = 0;
+				while(numQueued < numItems)
+				{
+					const i32 numEnqueued = data->queue_.EnqueueBulk(items + numQueued, numItems - numQueued);
+					if(numEnqueued == 0)
+						SwitchThread();
+					numQueued += numEnqueued;
+				}
+				numProduced += numItems;
+			}
+			return 0;
+		};
+
+		auto consumerFunc = [](void* inData) -> int {
+			auto* data = reinterpret_cast<SharedData*>(inData);
+			i32 items[BATCH_SIZE];
+			while(AtomicCmpExchg(&data->numConsumed_, 0, 0) < NUM_PRODUCERS * NUM_ITEMS_PER_PRODUCER)
+			{
+				const i32 numItems = data->queue_.DequeueBulk(items, BATCH_SIZE);
+				if(numItems == 0)
+				{
+					SwitchThread();
+					continue;
+				}
+				ScopedSpinLock lock(data->seenLock_);
+				for(i32 i = 0; i < numItems; ++i)
+					data->seen_[items[i]]++;
+				AtomicAdd(&data->numConsumed_, numItems);
+			}
+			return 0;
+		};
+
+		Vector<Thread> threads;
+		for(i32 i = 0; i < NUM_CONSUMERS; ++i)
+			threads.emplace_back(consumerFunc, &sharedData);
+		for(i32 i = 0; i < NUM_PRODUCERS; ++i)
+			threads.emplace_back(producerFunc, &sharedData);
+		for(auto& thread : threads)
+			thread.Join();
+
+		REQUIRE(sharedData.numConsumed_ == NUM_PRODUCERS * NUM_ITEMS_PER_PRODUCER);
+		for(i32 seen : sharedData.seen_)
+			REQUIRE(seen == 1);
+	}
+
+	SECTION("benchmark")
+	{
+		static const i32 NUM_ITEMS = 4096;
+		static const i32 NUM_ROUNDS = 100;
+		MPMCBoundedQueue<i32> queue(NUM_ITEMS);
+		Vector<i32> items;
+		items.resize(NUM_ITEMS, 0);
+
+		Timer timer;
+		timer.Mark();
+		for(i32 round = 0; round < NUM_ROUNDS; ++round)
+		{
+			for(i32 i = 0; i < NUM_ITEMS; ++i)
+				queue.Enqueue(items[i]);
+			for(i32 i = 0; i < NUM_ITEMS; ++i)
+				queue.Dequeue(items[i]);
+		}
+		const f64 singleTime = timer.GetTime();
+
+		timer.Mark();
+		for(i32 round = 0; round < NUM_ROUNDS; ++round)
+		{
+			REQUIRE(queue.EnqueueBulk(items.data(), NUM_ITEMS) == NUM_ITEMS);
+			REQUIRE(queue.DequeueBulk(items.data(), NUM_ITEMS) == NUM_ITEMS);
+		}
+		const f64 bulkTime = timer.GetTime();
+
+		Core::Log("MPMCBoundedQueue %i items: single %.2fus, bulk %.2fus per round trip\n", NUM_ITEMS,
+		    (singleTime * 1000000.0) / (f64)NUM_ROUNDS, (bulkTime * 1000000.0) / (f64)NUM_ROUNDS);
+	}
 }
 
 TEST_CASE("concurrency-tests-tls")
@@ -516,3 +974,40 @@ TEST_CASE("concurrency-tests-tls")
 	REQUIRE(thread2.Join());
 	REQUIRE(thread3.Join());
 }
+
+TEST_CASE("concurrency-tests-fls")
+{
+	i32 value = 0;
+
+	// Freed slots are reused, without exposing values set through the previous owner.
+	for(i32 idx = 0; idx < 1024; ++idx)
+	{
+		FLS fls;
+		REQUIRE(fls);
+		REQUIRE(fls.Get() == nullptr);
+		REQUIRE(fls.Set(&value));
+		REQUIRE(fls.Get() == &value);
+	}
+
+	// Exhausting all slots fails gracefully in release builds.
+#if defined(_RELEASE)
+	Vector<FLS*> allFls;
+	for(;;)
+	{
+		FLS* fls = new FLS();
+		if(!*fls)
+		{
+			REQUIRE(!fls->Set(&value));
+			REQUIRE(fls->Get() == nullptr);
+			delete fls;
+			break;
+		}
+		allFls.push_back(fls);
+	}
+	REQUIRE(allFls.size() > 0);
+	for(FLS* fls : allFls)
+		delete fls;
+	FLS fls;
+	REQUIRE(fls);
+#endif
+}
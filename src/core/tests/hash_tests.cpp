@@ -0,0 +1,185 @@
+#include "core/hash.h"
+#include "core/debug.h"
+#include "core/random.h"
+#include "core/set.h"
+#include "core/timer.h"
+#include "core/uuid.h"
+#include "core/vector.h"
+
+#include "catch.hpp"
+
+#include <cstring>
+
+TEST_CASE("hash-tests-crc32c")
+{
+	const char* check = "123456789";
+	REQUIRE(Core::HashCRC32C(0, check, strlen(check)) == 0xe3069283);
+	REQUIRE(Core::HashCRC32C(0, "", 0) == 0);
+	REQUIRE(Core::Detail::HashCRC32CSoftware(0, check, strlen(check)) == 0xe3069283);
+	if(Core::Detail::HasHashCRC32CHardware())
+		REQUIRE(Core::Detail::HashCRC32CHardware(0, check, strlen(check)) == 0xe3069283);
+
+	// Chaining must match hashing in one go, for all sizes and alignments.
+	Core::Vector<u8> data;
+	data.resize(256);
+	Core::Random rng;
+	for(auto& d : data)
+		d = (u8)rng.Generate();
+
+	for(i32 offset = 0; offset < 8; ++offset)
+	{
+		for(i32 size = 0; size < 128; ++size)
+		{
+			const u8* begin = data.data() + offset;
+			const u32 whole = Core::HashCRC32C(0, begin, size);
+			const i32 split = size / 3;
+			const u32 chained = Core::HashCRC32C(Core::HashCRC32C(0, begin, split), begin + split, size - split);
+			REQUIRE(whole == chained);
+
+			// Software and hardware paths must agree.
+			REQUIRE(Core::Detail::HashCRC32CSoftware(0, begin, size) == whole);
+			if(Core::Detail::HasHashCRC32CHardware())
+				REQUIRE(Core::Detail::HashCRC32CHardware(0, begin, size) == whole);
+		}
+	}
+}
+
+TEST_CASE("hash-tests-wyhash")
+{
+	// Reference vectors, seeded with their index.
+	const char* messages[] = {"", "a", "abc", "message digest", "abcdefghijklmnopqrstuvwxyz",
+	    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789",
+	    "12345678901234567890123456789012345678901234567890123456789012345678901234567890"};
+	const u64 expected[] = {0x93228a4de0eec5a2ull, 0xc5bac3db178713c4ull, 0xa97f2f7b1d9b3314ull, 0x786d1f1df3801df4ull,
+	    0xdca5a8138ad37c87ull, 0xb9e734f117cfaf70ull, 0x6cc5eab49a92d617ull};
+
+	for(i32 idx = 0; idx < 7; ++idx)
+		REQUIRE(Core::HashWyhash(idx, messages[idx], strlen(messages[idx])) == expected[idx]);
+}
+
+TEST_CASE("hash-tests-hasher")
+{
+	// Sequential keys should spread over both the low and high bits used by Map.
+	const i32 NUM_KEYS = 64 * 1024;
+	Core::Set<u32> lowBits;
+	Core::Set<u32> highBits;
+	Core::Hasher<i32> hasher;
+	for(i32 idx = 0; idx < NUM_KEYS; ++idx)
+	{
+		const u64 hash = hasher(0, idx);
+		lowBits.insert((u32)(hash & 0xffff));
+		highBits.insert((u32)(hash >> 48));
+	}
+
+	// Random hashes would fill ~63% of the buckets.
+	REQUIRE(lowBits.size() > (NUM_KEYS / 2));
+	REQUIRE(highBits.size() > (NUM_KEYS / 2));
+
+	// Pointer and C string hashers.
+	i32 values[2] = {};
+	Core::Hasher<i32*> ptrHasher;
+	REQUIRE(ptrHasher(0, &values[0]) != ptrHasher(0, &values[1]));
+	Core::Hasher<const char*> strHasher;
+	Core::Hasher<char*> mutableStrHasher;
+	char str[] = "hash";
+	char otherStr[] = "hash";
+	REQUIRE(strHasher(0, str) == strHasher(0, "hash"));
+	REQUIRE(mutableStrHasher(0, str) == mutableStrHasher(0, otherStr));
+	REQUIRE(mutableStrHasher(0, str) == strHasher(0, "hash"));
+}
+
+namespace
+{
+	template<typename FUNC>
+	f64 BenchmarkHash(const char* name, i64 bytesPerIteration, i32 numIterations, FUNC&& func)
+	{
+		Core::Timer timer;
+		timer.Mark();
+		u64 result = 0;
+		for(i32 idx = 0; idx < numIterations; ++idx)
+			result += func(idx);
+		const f64 time = timer.GetTime();
+
+		const f64 bytesPerSecond = ((f64)bytesPerIteration * numIterations) / time;
+		Core::Log("- %24s: %9.2f MB/s, %6.2f ns/hash (%llx)\n", name, bytesPerSecond / (1024.0 * 1024.0),
+		    (time * 1000000000.0) / numIterations, result);
+		return time;
+	}
+}
+
+TEST_CASE("hash-tests-bench")
+{
+	Core::Random rng;
+
+	// Short keys, as used for names and map keys.
+	for(i32 keySize : {4, 8, 16, 32})
+	{
+		const i32 NUM_KEYS = 1024;
+		Core::Vector<u8> keys;
+		keys.resize(NUM_KEYS * keySize);
+		for(auto& k : keys)
+			k = (u8)rng.Generate();
+
+		const i32 NUM_ITERATIONS = 1024 * 1024;
+		Core::Log("Short keys, %i bytes:\n", keySize);
+		auto key = [&](i32 idx) { return keys.data() + (idx & (NUM_KEYS - 1)) * keySize; };
+		const f64 fnvTime = BenchmarkHash("HashFNV1a", keySize, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashFNV1a(0, key(idx), keySize); });
+		BenchmarkHash("HashCRC32", keySize, NUM_ITERATIONS, [&](i32 idx) { return Core::HashCRC32(0, key(idx), keySize); });
+		BenchmarkHash(
+		    "HashCRC32C", keySize, NUM_ITERATIONS, [&](i32 idx) { return Core::HashCRC32C(0, key(idx), keySize); });
+		const f64 wyTime = BenchmarkHash("HashWyhash", keySize, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashWyhash(0, key(idx), keySize); });
+		Core::Log("- HashWyhash vs HashFNV1a: %.2fx\n", fnvTime / wyTime);
+	}
+
+	// Long blobs, as used for resource data and descriptors.
+	{
+		const i32 BLOB_SIZE = 1024 * 1024;
+		Core::Vector<u8> blob;
+		blob.resize(BLOB_SIZE);
+		for(auto& b : blob)
+			b = (u8)rng.Generate();
+
+		const i32 NUM_ITERATIONS = 16;
+		Core::Log("Blobs, %i bytes:\n", BLOB_SIZE);
+		const f64 fnvTime = BenchmarkHash("HashFNV1a", BLOB_SIZE, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashFNV1a(idx, blob.data(), BLOB_SIZE); });
+		BenchmarkHash("HashCRC32", BLOB_SIZE, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashCRC32(idx, blob.data(), BLOB_SIZE); });
+		BenchmarkHash("HashCRC32C", BLOB_SIZE, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashCRC32C(idx, blob.data(), BLOB_SIZE); });
+		const f64 wyTime = BenchmarkHash("HashWyhash", BLOB_SIZE, NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::HashWyhash(idx, blob.data(), BLOB_SIZE); });
+		Core::Log("- HashWyhash vs HashFNV1a: %.2fx\n", fnvTime / wyTime);
+	}
+
+	// UUIDs, as used for resource lookups.
+	{
+		const i32 NUM_UUIDS = 1024;
+		Core::Vector<Core::UUID> uuids;
+		for(i32 idx = 0; idx < NUM_UUIDS; ++idx)
+			uuids.emplace_back(rng, 0);
+
+		const i32 NUM_ITERATIONS = 1024 * 1024;
+		Core::Log("UUIDs:\n");
+		const f64 hashTime = BenchmarkHash("Hash", sizeof(Core::UUID), NUM_ITERATIONS,
+		    [&](i32 idx) { return Core::Hash(0, uuids[idx & (NUM_UUIDS - 1)]); });
+		Core::Hasher<Core::UUID> hasher;
+		const f64 hasherTime = BenchmarkHash("Hasher<UUID>", sizeof(Core::UUID), NUM_ITERATIONS,
+		    [&](i32 idx) { return hasher(0, uuids[idx & (NUM_UUIDS - 1)]); });
+		Core::Log("- Hasher<UUID> vs Hash: %.2fx\n", hashTime / hasherTime);
+	}
+
+	// Integer keys.
+	{
+		const i32 NUM_ITERATIONS = 16 * 1024 * 1024;
+		Core::Log("Integers:\n");
+		const f64 hashTime =
+		    BenchmarkHash("Hash", sizeof(i32), NUM_ITERATIONS, [&](i32 idx) { return Core::Hash(0, idx); });
+		Core::Hasher<i32> hasher;
+		const f64 hasherTime =
+		    BenchmarkHash("Hasher<i32>", sizeof(i32), NUM_ITERATIONS, [&](i32 idx) { return hasher(0, idx); });
+		Core::Log("- Hasher<i32> vs Hash: %.2fx\n", hashTime / hasherTime);
+	}
+}
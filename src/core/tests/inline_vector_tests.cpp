@@ -0,0 +1,188 @@
+#include "core/inline_vector.h"
+
+#include "catch.hpp"
+
+#include <string>
+
+using namespace Core;
+
+namespace
+{
+	struct AllocatorTest : public Core::ContainerAllocator
+	{
+		static i32 numAllocs_;
+
+		void* Allocate(i64 bytes, i64 align)
+		{
+			numAllocs_++;
+			return Core::ContainerAllocator::Allocate(bytes, align);
+		}
+
+		void Deallocate(void* mem)
+		{
+			if(mem)
+				numAllocs_--;
+			Core::ContainerAllocator::Deallocate(mem);
+		}
+	};
+
+	i32 AllocatorTest::numAllocs_ = 0;
+
+	struct CtorDtorTest
+	{
+		static i32 numAllocs_;
+		CtorDtorTest(i32 value = -1)
+		    : value_(value)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(const CtorDtorTest& other)
+		    : value_(other.value_)
+		{
+			numAllocs_++;
+		}
+		CtorDtorTest(CtorDtorTest&& other)
+		    : value_(other.value_)
+		{
+			other.value_ = -1;
+			numAllocs_++;
+		}
+		~CtorDtorTest()
+		{
+			--numAllocs_;
+			value_ = -2;
+		}
+		CtorDtorTest& operator=(const CtorDtorTest& other) = default;
+		CtorDtorTest& operator=(CtorDtorTest&& other)
+		{
+			std::swap(other.value_, value_);
+			return *this;
+		}
+
+		operator i32() const { return value_; }
+
+		i32 value_ = -1;
+	};
+
+	i32 CtorDtorTest::numAllocs_ = 0;
+
+	template<typename TYPE>
+	TYPE IdxToVal(i32 idx);
+
+	template<>
+	i32 IdxToVal<i32>(i32 idx)
+	{
+		return idx;
+	}
+
+	template<>
+	std::string IdxToVal<std::string>(i32 idx)
+	{
+		// Long enough to not fit std::string's local buffer.
+		return std::to_string(idx) + " is the value of this string";
+	}
+
+	template<>
+	CtorDtorTest IdxToVal<CtorDtorTest>(i32 idx)
+	{
+		return CtorDtorTest(idx);
+	}
+
+	template<typename TYPE, i32 INLINE_SIZE>
+	void InlineVectorTest(i32 numElements)
+	{
+		using TestVector = InlineVector<TYPE, INLINE_SIZE, AllocatorTest>;
+		{
+			TestVector vec;
+			REQUIRE(vec.empty());
+			REQUIRE(vec.isInline());
+			REQUIRE(vec.capacity() == INLINE_SIZE);
+
+			for(i32 idx = 0; idx < numElements; ++idx)
+				vec.push_back(IdxToVal<TYPE>(idx));
+
+			REQUIRE(vec.size() == numElements);
+			REQUIRE(vec.isInline() == (numElements <= INLINE_SIZE));
+			REQUIRE(AllocatorTest::numAllocs_ == (vec.isInline() ? 0 : 1));
+			for(i32 idx = 0; idx < numElements; ++idx)
+				REQUIRE(vec[idx] == IdxToVal<TYPE>(idx));
+
+			// Copy.
+			TestVector vecCopy(vec);
+			REQUIRE(vecCopy.size() == numElements);
+			for(i32 idx = 0; idx < numElements; ++idx)
+				REQUIRE(vecCopy[idx] == IdxToVal<TYPE>(idx));
+
+			// Move.
+			TestVector vecMove(std::move(vecCopy));
+			REQUIRE(vecCopy.size() == 0);
+			REQUIRE(vecCopy.isInline());
+			REQUIRE(vecMove.size() == numElements);
+			for(i32 idx = 0; idx < numElements; ++idx)
+				REQUIRE(vecMove[idx] == IdxToVal<TYPE>(idx));
+
+			// Move assign over existing elements.
+			vecCopy.push_back(IdxToVal<TYPE>(-1));
+			vecCopy = std::move(vecMove);
+			REQUIRE(vecCopy.size() == numElements);
+			for(i32 idx = 0; idx < numElements; ++idx)
+				REQUIRE(vecCopy[idx] == IdxToVal<TYPE>(idx));
+
+			// Erase odd elements.
+			for(i32 idx = numElements - 1; idx >= 0; --idx)
+				if(idx & 1)
+					vec.erase(vec.begin() + idx);
+			REQUIRE(vec.size() == (numElements + 1) / 2);
+			for(i32 idx = 0; idx < vec.size(); ++idx)
+				REQUIRE(vec[idx] == IdxToVal<TYPE>(idx * 2));
+
+			// Insert them back.
+			for(i32 idx = 1; idx < numElements; idx += 2)
+				vec.insert(vec.begin() + idx, IdxToVal<TYPE>(idx));
+			REQUIRE(vec.size() == numElements);
+			for(i32 idx = 0; idx < numElements; ++idx)
+				REQUIRE(vec[idx] == IdxToVal<TYPE>(idx));
+
+			// Resize down and back up.
+			vec.resize(numElements / 2);
+			REQUIRE(vec.size() == numElements / 2);
+			vec.resize(numElements, IdxToVal<TYPE>(-1));
+			REQUIRE(vec.size() == numElements);
+			for(i32 idx = numElements / 2; idx < numElements; ++idx)
+				REQUIRE(vec[idx] == IdxToVal<TYPE>(-1));
+		}
+		REQUIRE(AllocatorTest::numAllocs_ == 0);
+	}
+}
+
+TEST_CASE("inline-vector-tests")
+{
+	SECTION("trivial")
+	{
+		InlineVectorTest<i32, 1>(0);
+		InlineVectorTest<i32, 1>(1);
+		InlineVectorTest<i32, 1>(2);
+		InlineVectorTest<i32, 8>(8);
+		InlineVectorTest<i32, 8>(9);
+		InlineVectorTest<i32, 8>(100);
+	}
+
+	SECTION("non-trivial")
+	{
+		InlineVectorTest<std::string, 1>(0);
+		InlineVectorTest<std::string, 1>(1);
+		InlineVectorTest<std::string, 1>(2);
+		InlineVectorTest<std::string, 8>(8);
+		InlineVectorTest<std::string, 8>(9);
+		InlineVectorTest<std::string, 8>(100);
+	}
+
+	SECTION("ctor-dtor")
+	{
+		InlineVectorTest<CtorDtorTest, 1>(0);
+		InlineVectorTest<CtorDtorTest, 1>(1);
+		InlineVectorTest<CtorDtorTest, 8>(8);
+		InlineVectorTest<CtorDtorTest, 8>(100);
+		REQUIRE(CtorDtorTest::numAllocs_ == 0);
+	}
+}
@@ -1,4 +1,5 @@
 #include "core/map.h"
+#include "core/misc.h"
 #include "core/string.h"
 #include "core/timer.h"
 
@@ -391,6 +392,61 @@ TEST_CASE("map-tests-bad-hash")
 	}
 }
 
+TEST_CASE("map-tests-churn")
+{
+	// Erased slots are reused, and reclaimed by rehashing without growing.
+	Core::Map<u32, u32> map;
+	const u32 WINDOW = 1000;
+	for(u32 i = 0; i < WINDOW * 64; ++i)
+	{
+		map.insert(i, i * 2);
+		if(i >= WINDOW)
+			REQUIRE(map.erase(i - WINDOW));
+		REQUIRE(map.size() == Core::Min(i + 1, WINDOW));
+	}
+
+	for(u32 i = 0; i < WINDOW * 64; ++i)
+	{
+		auto* found = map.find(i);
+		if(i >= (WINDOW * 63))
+		{
+			REQUIRE(found);
+			REQUIRE(*found == i * 2);
+		}
+		else
+			REQUIRE(!found);
+	}
+
+	i32 total = 0;
+	for(auto pair : map)
+	{
+		REQUIRE(pair.value == pair.key * 2);
+		++total;
+	}
+	REQUIRE(total == WINDOW);
+
+	// Copies and moves.
+	Core::Map<u32, u32> copied(map);
+	REQUIRE(copied.size() == WINDOW);
+	Core::Map<u32, u32> moved(std::move(copied));
+	REQUIRE(moved.size() == WINDOW);
+	REQUIRE(*moved.find(WINDOW * 63) == WINDOW * 126);
+	REQUIRE(!copied.find(WINDOW * 63));
+	const auto& self = moved;
+	moved = self;
+	REQUIRE(moved.size() == WINDOW);
+	REQUIRE(*moved.find(WINDOW * 63) == WINDOW * 126);
+	copied.insert(1, 2);
+	REQUIRE(*copied.find(1) == 2);
+
+	map.clear();
+	REQUIRE(map.empty());
+	for(auto pair : map)
+		REQUIRE(false);
+	map.insert(1, 2);
+	REQUIRE(*map.find(1) == 2);
+}
+
 TEST_CASE("map-tests-bench")
 {
 	const i32 NUM_ITERATIONS = 32;
@@ -583,4 +639,91 @@ TEST_CASE("map-tests-bench")
 			}
 		}
 	}
-}
\ No newline at end of file
+}
+
+TEST_CASE("map-tests-bench-ops")
+{
+	// Keys are generated up front, so only map operations are timed.
+	const auto runBench = [](i32 numValues, i32 numIterations) {
+		Core::Log("<u32, u32> x %i\n", numValues);
+		Core::Vector<u32> keys;
+		Core::Vector<u32> missKeys;
+		for(i32 i = 0; i < numValues; ++i)
+		{
+			keys.push_back(Core::HashCRC32(0, &i, sizeof(i)));
+			const i32 j = i + numValues;
+			missKeys.push_back(Core::HashCRC32(0, &j, sizeof(j)));
+		}
+
+		Core::Map<u32, u32> mapA;
+		std::unordered_map<u32, u32> mapB;
+		u64 total = 0;
+
+		{
+			ScopedTimer timer("-           Core::Map insert");
+			for(i32 j = 0; j < numIterations; ++j)
+			{
+				mapA = Core::Map<u32, u32>();
+				for(u32 key : keys)
+					mapA.insert(key, key);
+			}
+		}
+
+		{
+			ScopedTimer timer("-  std::unordered_map insert");
+			for(i32 j = 0; j < numIterations; ++j)
+			{
+				mapB = std::unordered_map<u32, u32>();
+				for(u32 key : keys)
+					mapB.insert(std::make_pair(key, key));
+			}
+		}
+
+		{
+			ScopedTimer timer("-           Core::Map find hit");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(u32 key : keys)
+					total += *mapA.find(key);
+		}
+
+		{
+			ScopedTimer timer("-  std::unordered_map find hit");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(u32 key : keys)
+					total += mapB.find(key)->second;
+		}
+
+		{
+			ScopedTimer timer("-           Core::Map find miss");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(u32 key : missKeys)
+					total += mapA.find(key) != nullptr;
+		}
+
+		{
+			ScopedTimer timer("-  std::unordered_map find miss");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(u32 key : missKeys)
+					total += mapB.find(key) != mapB.end();
+		}
+
+		{
+			ScopedTimer timer("-           Core::Map iterate");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(auto pair : mapA)
+					total += pair.value;
+		}
+
+		{
+			ScopedTimer timer("-  std::unordered_map iterate");
+			for(i32 j = 0; j < numIterations; ++j)
+				for(const auto& pair : mapB)
+					total += pair.second;
+		}
+
+		REQUIRE(total > 0);
+	};
+
+	runBench(1024, 256);
+	runBench(256 * 1024, 4);
+}
@@ -1,5 +1,8 @@
 #include "core/string.h"
+#include "core/string_id.h"
+#include "core/concurrency.h"
 #include "core/hash.h"
+#include "core/vector.h"
 
 #include "catch.hpp"
 
@@ -123,3 +126,173 @@ TEST_CASE("stringview-test-basic")
 	REQUIRE(view == inStr);
 	REQUIRE(str == view);
 }
+
+TEST_CASE("string-test-sso")
+{
+	REQUIRE(sizeof(Core::String) == Core::String::STORAGE_SIZE);
+
+	// Grow one character at a time across the inline capacity.
+	Core::String str1;
+	std::string str1_ref;
+	REQUIRE(str1.c_str() != nullptr);
+	REQUIRE(str1 == "");
+	for(i32 idx = 0; idx < Core::String::LOCAL_CAPACITY * 4; ++idx)
+	{
+		const char c[] = {(char)('a' + (idx % 26)), '\0'};
+		str1 += c;
+		str1_ref += c;
+		REQUIRE(str1.size() == str1_ref.size());
+		REQUIRE(str1.capacity() >= str1.size());
+		REQUIRE(str1 == str1_ref.c_str());
+	}
+
+	SECTION("copy-move")
+	{
+		for(i32 size : {0, 1, Core::String::LOCAL_CAPACITY, Core::String::LOCAL_CAPACITY + 1, 80})
+		{
+			const std::string ref = str1_ref.substr(0, size);
+			Core::String str2(ref.c_str());
+			REQUIRE(str2.capacity() == (size <= Core::String::LOCAL_CAPACITY ? Core::String::LOCAL_CAPACITY : size));
+
+			Core::String str3(str2);
+			REQUIRE(str3 == ref.c_str());
+
+			Core::String str4(std::move(str3));
+			REQUIRE(str4 == ref.c_str());
+			REQUIRE(str3.size() == 0);
+
+			str3 = str4;
+			REQUIRE(str3 == str4);
+
+			str3 = "short";
+			str3 = std::move(str4);
+			REQUIRE(str3 == ref.c_str());
+			REQUIRE(str4 == "short");
+		}
+	}
+
+	SECTION("self-append")
+	{
+		Core::String str2 = "0123456789";
+		str2 += str2;
+		REQUIRE(str2 == "01234567890123456789");
+		str2 += str2;
+		REQUIRE(str2 == "0123456789012345678901234567890123456789");
+		str2 = str2.c_str() + 30;
+		REQUIRE(str2 == "0123456789");
+	}
+
+	SECTION("resize-shrink")
+	{
+		Core::String str2 = "Hello";
+		str2.resize(40);
+		REQUIRE(str2.size() == 40);
+		REQUIRE(str2 == "Hello");
+		REQUIRE(str2[39] == '\0');
+
+		str2.resize(5);
+		str2.shrink_to_fit();
+		REQUIRE(str2.capacity() == Core::String::LOCAL_CAPACITY);
+		REQUIRE(str2 == "Hello");
+
+		str2.reserve(100);
+		REQUIRE(str2.capacity() >= 100);
+		REQUIRE(str2 == "Hello");
+		str2.clear();
+		REQUIRE(str2.size() == 0);
+		REQUIRE(str2 == "");
+	}
+
+	SECTION("substr-replace")
+	{
+		Core::String str2 = "shaders/default.esf";
+		REQUIRE(str2.substr(8, 7) == "default");
+		REQUIRE(str2.replace("default", "a_much_longer_shader_name") == "shaders/a_much_longer_shader_name.esf");
+		REQUIRE(str2.find("default") == 8);
+	}
+}
+
+TEST_CASE("stringid-test-basic")
+{
+	Core::StringID id0;
+	REQUIRE(!id0);
+	REQUIRE(id0.size() == 0);
+	REQUIRE(strcmp(id0.c_str(), "") == 0);
+	REQUIRE(id0 == Core::StringID(""));
+
+	REQUIRE(!Core::StringID::Find("stringid-test-basic/never-interned"));
+
+	Core::StringID id1("stringid-test-basic/name");
+	Core::StringID id2(Core::String("stringid-test-basic/name"));
+	Core::StringID id3(Core::StringView("stringid-test-basic/name/sub"));
+	REQUIRE(id1);
+	REQUIRE(id1 == id2);
+	REQUIRE(id1 != id3);
+	REQUIRE(id1.c_str() == id2.c_str());
+	REQUIRE(strcmp(id1.c_str(), "stringid-test-basic/name") == 0);
+	REQUIRE(id1.size() == (i32)strlen("stringid-test-basic/name"));
+	REQUIRE(Core::Hash(0, id1) == Core::Hash(0, id2));
+	REQUIRE(Core::Hash(0, id1) != Core::Hash(0, id3));
+
+	REQUIRE(Core::StringID::Find("stringid-test-basic/name") == id1);
+
+	// Partial string.
+	const char* str = "stringid-test-basic/name/sub";
+	REQUIRE(Core::StringID(str, str + 24) == id1);
+	REQUIRE(Core::StringID::Find(str, str + 24) == id1);
+
+	// Intern table storage is permanent, so must not show up as general allocations.
+	Core::Vector<char> longStr;
+	longStr.resize(128 * 1024, 'a');
+	const i64 numAllocations = Core::GeneralAllocator().GetStats().numAllocations_;
+	Core::StringID longId(longStr.data(), longStr.data() + longStr.size());
+	REQUIRE(longId.size() == longStr.size());
+	REQUIRE(Core::GeneralAllocator().GetStats().numAllocations_ == numAllocations);
+}
+
+namespace
+{
+	struct StringIDThreadData
+	{
+		i32 threadIdx_ = 0;
+		Core::Array<Core::StringID, 4096> ids_;
+	};
+
+	int StringIDThread(void* userData)
+	{
+		auto* data = static_cast<StringIDThreadData*>(userData);
+		// All threads intern the same strings in different orders.
+		for(i32 i = 0; i < data->ids_.size(); ++i)
+		{
+			const i32 idx = (i * 7 + data->threadIdx_ * 1021) % data->ids_.size();
+			Core::Array<char, 64> buffer;
+			sprintf_s(buffer.data(), buffer.size(), "stringid-test-mt/%i", idx);
+			data->ids_[idx] = Core::StringID(buffer.data());
+		}
+		return 0;
+	}
+}
+
+TEST_CASE("stringid-test-mt")
+{
+	const i32 NUM_THREADS = 8;
+	Core::Array<StringIDThreadData, NUM_THREADS> datas;
+	Core::Array<Core::Thread, NUM_THREADS> threads;
+	for(i32 i = 0; i < NUM_THREADS; ++i)
+	{
+		datas[i].threadIdx_ = i;
+		threads[i] = Core::Thread(StringIDThread, &datas[i]);
+	}
+	for(i32 i = 0; i < NUM_THREADS; ++i)
+		threads[i].Join();
+
+	for(i32 idx = 0; idx < datas[0].ids_.size(); ++idx)
+	{
+		Core::Array<char, 64> buffer;
+		sprintf_s(buffer.data(), buffer.size(), "stringid-test-mt/%i", idx);
+		const Core::StringID id = datas[0].ids_[idx];
+		REQUIRE(strcmp(id.c_str(), buffer.data()) == 0);
+		for(i32 i = 1; i < NUM_THREADS; ++i)
+			REQUIRE(datas[i].ids_[idx] == id);
+	}
+}
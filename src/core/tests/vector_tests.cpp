@@ -5,6 +5,13 @@
 
 using namespace Core;
 
+namespace
+{
+	struct RelocateTest;
+}
+
+DECLARE_TRIVIALLY_RELOCATABLE(RelocateTest);
+
 namespace
 {
 	struct CtorDtorTest
@@ -45,6 +52,46 @@ namespace
 
 	i32 CtorDtorTest::numAllocs_ = 0;
 
+	struct RelocateTest
+	{
+		static i32 numAllocs_;
+		static i32 numMoves_;
+		RelocateTest(i32 value = -1)
+		    : value_(new i32(value))
+		{
+			numAllocs_++;
+		}
+		RelocateTest(const RelocateTest& other)
+		    : value_(new i32(*other.value_))
+		{
+			numAllocs_++;
+		}
+		RelocateTest(RelocateTest&& other)
+		{
+			std::swap(other.value_, value_);
+			numAllocs_++;
+			numMoves_++;
+		}
+		~RelocateTest()
+		{
+			--numAllocs_;
+			delete value_;
+		}
+		RelocateTest& operator=(RelocateTest&& other)
+		{
+			std::swap(other.value_, value_);
+			numMoves_++;
+			return *this;
+		}
+
+		operator i32() const { return value_ ? *value_ : -2; }
+
+		i32* value_ = nullptr;
+	};
+
+	i32 RelocateTest::numAllocs_ = 0;
+	i32 RelocateTest::numMoves_ = 0;
+
 	struct AllocatorTest : public Core::ContainerAllocator
 	{
 		static i64 numBytes_;
@@ -283,6 +330,33 @@ namespace
 		}
 	}
 
+	template<typename TYPE, index_type ARRAY_SIZE>
+	void VectorTestInsert(TYPE(IdxToVal)(index_type))
+	{
+		Vector<TYPE> TestArray;
+
+		// Insert odd values at the end, then even values in between them.
+		for(index_type Idx = 1; Idx < ARRAY_SIZE; Idx += 2)
+			TestArray.insert(TestArray.end(), IdxToVal(Idx));
+		for(index_type Idx = 0; Idx < ARRAY_SIZE; Idx += 2)
+		{
+			auto It = TestArray.insert(TestArray.begin() + Idx, IdxToVal(Idx));
+			REQUIRE(*It == IdxToVal(Idx));
+		}
+
+		REQUIRE(TestArray.size() == ARRAY_SIZE);
+		bool Success = true;
+		for(index_type Idx = 0; Idx < ARRAY_SIZE; ++Idx)
+			Success &= (TestArray[Idx] == IdxToVal(Idx));
+		REQUIRE(Success);
+
+		// Insert copy of an existing element at the front.
+		TestArray.insert(TestArray.begin(), TestArray.back());
+		REQUIRE(TestArray.size() == ARRAY_SIZE + 1);
+		REQUIRE(TestArray.front() == IdxToVal(ARRAY_SIZE - 1));
+		REQUIRE(TestArray[1] == IdxToVal(0));
+	}
+
 	index_type IdxToVal_index_type(index_type Idx) { return Idx; }
 
 	std::string IdxToVal_string(index_type Idx)
@@ -429,6 +503,24 @@ TEST_CASE("vector-tests-operator-assignment")
 		VectorTestOperatorAssignment<std::string, 0xff>(IdxToVal_string);
 		VectorTestOperatorAssignment<std::string, 0x100>(IdxToVal_string);
 	}
+
+	SECTION("reuse-storage")
+	{
+		Vector<std::string> large;
+		large.resize(0x100, "large");
+		Vector<std::string> small;
+		small.resize(0x10, "small");
+
+		// Assigning a smaller vector keeps existing storage.
+		const auto* data = large.data();
+		const auto capacity = large.capacity();
+		large = small;
+		REQUIRE(large.data() == data);
+		REQUIRE(large.capacity() == capacity);
+		REQUIRE(large.size() == small.size());
+		for(const auto& str : large)
+			REQUIRE(str == "small");
+	}
 }
 
 TEST_CASE("vector-tests-copy")
@@ -526,6 +618,85 @@ TEST_CASE("vector-tests-erase")
 	}
 }
 
+TEST_CASE("vector-tests-insert")
+{
+	SECTION("trivial")
+	{
+		VectorTestInsert<index_type, 0x1>(IdxToVal_index_type);
+		VectorTestInsert<index_type, 0x2>(IdxToVal_index_type);
+		VectorTestInsert<index_type, 0xff>(IdxToVal_index_type);
+		VectorTestInsert<index_type, 0x100>(IdxToVal_index_type);
+	}
+
+	SECTION("non-trivial")
+	{
+		VectorTestInsert<std::string, 0x1>(IdxToVal_string);
+		VectorTestInsert<std::string, 0x2>(IdxToVal_string);
+		VectorTestInsert<std::string, 0xff>(IdxToVal_string);
+		VectorTestInsert<std::string, 0x100>(IdxToVal_string);
+	}
+}
+
+TEST_CASE("vector-tests-relocatable")
+{
+	using TestVector = Core::Vector<RelocateTest>;
+	static_assert(Core::IsTriviallyRelocatable<i32>::value, "Trivially copyable types should be relocatable.");
+	static_assert(Core::IsTriviallyRelocatable<RelocateTest>::value, "Declared type should be relocatable.");
+	static_assert(Core::IsTriviallyRelocatable<TestVector>::value, "Vector should be relocatable.");
+	static_assert(!Core::IsTriviallyRelocatable<std::string>::value, "std::string may point into itself.");
+
+	RelocateTest::numMoves_ = 0;
+
+	SECTION("push_back")
+	{
+		{
+			TestVector vec;
+			for(i32 i = 0; i < 200; ++i)
+				vec.emplace_back(i);
+			REQUIRE(RelocateTest::numAllocs_ == 200);
+			REQUIRE(RelocateTest::numMoves_ == 0);
+			for(i32 i = 0; i < 200; ++i)
+				REQUIRE(vec[i] == i);
+		}
+		REQUIRE(RelocateTest::numAllocs_ == 0);
+	}
+
+	SECTION("insert-erase")
+	{
+		{
+			TestVector vec;
+			for(i32 i = 0; i < 100; ++i)
+				vec.emplace(vec.begin(), i);
+			REQUIRE(RelocateTest::numAllocs_ == 100);
+			for(i32 i = 0; i < 100; ++i)
+				REQUIRE(vec[i] == 99 - i);
+
+			while(vec.size() > 1)
+				vec.erase(vec.begin() + (vec.size() / 2));
+			REQUIRE(RelocateTest::numAllocs_ == 1);
+			REQUIRE(vec[0] == 99);
+		}
+		REQUIRE(RelocateTest::numAllocs_ == 0);
+	}
+
+	SECTION("vector-of-vectors")
+	{
+		{
+			Core::Vector<TestVector> vecs;
+			for(i32 i = 0; i < 100; ++i)
+			{
+				vecs.emplace_back();
+				vecs.back().emplace_back(i);
+			}
+			REQUIRE(RelocateTest::numAllocs_ == 100);
+			REQUIRE(RelocateTest::numMoves_ == 0);
+			for(i32 i = 0; i < 100; ++i)
+				REQUIRE(vecs[i][0] == i);
+		}
+		REQUIRE(RelocateTest::numAllocs_ == 0);
+	}
+}
+
 TEST_CASE("vector-tests-ctor-dtor-test")
 {
 	using TestVector = Core::Vector<CtorDtorTest>;
@@ -3,6 +3,7 @@
 #include "core/portability.h"
 
 #include <cstdint>
+#include <type_traits>
 
 typedef std::uint64_t u64;
 typedef std::uint32_t u32;
@@ -32,4 +33,31 @@ typedef wchar_t wchar;
 
 namespace Core
 {
-}
+	/**
+	 * Trivially relocatable trait.
+	 * Types for which this is true can be moved to a new address with memcpy/memmove, leaving the
+	 * source memory to be released without calling its destructor. Containers use this to avoid
+	 * constructing and destructing elements one by one when they grow or shift.
+	 * This holds for all trivially copyable types, and also for most types that own heap memory,
+	 * as long as they don't point into themselves. Those should be declared using
+	 * DECLARE_TRIVIALLY_RELOCATABLE.
+	 */
+	template<typename TYPE>
+	struct IsTriviallyRelocatable
+	{
+		static const bool value = std::is_trivially_copyable<TYPE>::value;
+	};
+} // namespace Core
+
+/**
+ * Declare type as trivially relocatable. Must be used from the global namespace.
+ */
+#define DECLARE_TRIVIALLY_RELOCATABLE(_Type)                                                                           \
+	namespace Core                                                                                                     \
+	{                                                                                                                  \
+		template<>                                                                                                     \
+		struct IsTriviallyRelocatable<_Type>                                                                           \
+		{                                                                                                              \
+			static const bool value = true;                                                                            \
+		};                                                                                                             \
+	}
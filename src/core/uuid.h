@@ -2,6 +2,7 @@
 
 #include "core/types.h"
 #include "core/dll.h"
+#include "core/hash.h"
 
 namespace Core
 {
@@ -61,5 +62,15 @@ namespace Core
 	 */
 	CORE_DLL u64 Hash(u64 input, const UUID& data);
 
+	/**
+	 * Hasher for containers, using the faster HashWyhash.
+	 */
+	template<>
+	class Hasher<UUID>
+	{
+	public:
+		u64 operator()(u64 input, const UUID& data) const { return HashWyhash(input, &data, sizeof(data)); }
+	};
+
 
 } // namespace Core
@@ -5,12 +5,15 @@
 #include "core/array_view.h"
 #include "core/debug.h"
 
+#include <cstring>
 #include <utility>
 
 namespace Core
 {
 	/**
 	 * Vector of elements.
+	 * Elements of trivially relocatable types (see IsTriviallyRelocatable) are moved with memcpy/memmove
+	 * when growing, inserting or erasing, rather than constructed and destructed one by one.
 	 */
 	template<typename TYPE, typename ALLOCATOR = ContainerAllocator>
 	class Vector
@@ -24,7 +27,7 @@ namespace Core
 
 		Vector() = default;
 
-		Vector(ALLOCATOR& allocator)
+		Vector(const ALLOCATOR& allocator)
 		    : allocator_(allocator)
 		{
 		}
@@ -45,12 +48,19 @@ namespace Core
 
 		Vector& operator=(const Vector& other)
 		{
-			allocator_ = other.allocator_;
-			if(other.size_ != size_)
-				internalResize(other.size_);
+			if(this == &other)
+				return *this;
 
-			// destruct
+			// destruct, keeping storage if the other allocator can free it.
 			destruct(data_, data_ + size_);
+			size_ = 0;
+			if(allocator_ != other.allocator_)
+			{
+				internalResize(0);
+				allocator_ = other.allocator_;
+			}
+			if(capacity_ < other.size_)
+				internalResize(other.size_);
 
 			// reconstruct
 			size_ = other.size_;
@@ -104,10 +114,19 @@ namespace Core
 		iterator erase(iterator it)
 		{
 			DBG_ASSERT_MSG(it >= begin() && it < end(), "Invalid iterator.");
-			for(iterator dstIt = it, srcIt = it + 1; srcIt != end(); ++dstIt, ++srcIt)
-				*dstIt = std::move(*srcIt);
-			--size_;
-			destruct(data_ + size_);
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				destruct(it);
+				memmove((void*)it, (const void*)(it + 1), (end() - (it + 1)) * sizeof(TYPE));
+				--size_;
+			}
+			else
+			{
+				for(iterator dstIt = it, srcIt = it + 1; srcIt != end(); ++dstIt, ++srcIt)
+					*dstIt = std::move(*srcIt);
+				--size_;
+				destruct(data_ + size_);
+			}
 			return it;
 		}
 
@@ -136,6 +155,39 @@ namespace Core
 			return (data_ + size_++);
 		}
 
+		template<class... VAL_TYPE>
+		iterator emplace(const_iterator pos, VAL_TYPE&&... value)
+		{
+			DBG_ASSERT_MSG(pos >= begin() && pos <= end(), "Invalid iterator.");
+			const index_type idx = (index_type)(pos - begin());
+			if(idx == size_)
+				return emplace_back(std::forward<VAL_TYPE>(value)...);
+
+			// Construct first, value may reference an element that is about to move.
+			TYPE newValue(std::forward<VAL_TYPE>(value)...);
+			if(capacity_ < (size_ + 1))
+				internalResize(getGrowCapacity(capacity_));
+
+			iterator it = data_ + idx;
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				memmove((void*)(it + 1), (const void*)it, (size_ - idx) * sizeof(TYPE));
+				new(it) TYPE(std::move(newValue));
+			}
+			else
+			{
+				new(data_ + size_) TYPE(std::move(data_[size_ - 1]));
+				for(iterator dstIt = data_ + size_ - 1; dstIt != it; --dstIt)
+					*dstIt = std::move(*(dstIt - 1));
+				*it = std::move(newValue);
+			}
+			++size_;
+			return it;
+		}
+
+		iterator insert(const_iterator pos, const TYPE& value) { return emplace(pos, value); }
+		iterator insert(const_iterator pos, TYPE&& value) { return emplace(pos, std::move(value)); }
+
 		iterator insert(const_iterator begin, const_iterator end)
 		{
 			i32 numValues = (i32)(end - begin);
@@ -238,6 +290,21 @@ namespace Core
 			return dest;
 		}
 
+		/// Move [first, last) into uninitialized memory at dest, leaving the source destructed.
+		static void relocate(iterator first, iterator last, iterator dest)
+		{
+			if(IsTriviallyRelocatable<TYPE>::value)
+			{
+				if(first != last)
+					memcpy((void*)dest, (const void*)first, (last - first) * sizeof(TYPE));
+			}
+			else
+			{
+				uninitialized_move(first, last, dest);
+				destruct(first, last);
+			}
+		}
+
 		static void destruct(iterator first) { first->~TYPE(); }
 
 		static void destruct(iterator first, iterator last)
@@ -254,8 +321,7 @@ namespace Core
 			{
 				newData = static_cast<TYPE*>(allocator_.Allocate(newCapacity * sizeof(TYPE), alignof(TYPE)));
 				DBG_ASSERT_MSG(newData, "Unable to allocate for resize.");
-				uninitialized_move(data_, data_ + copySize, newData);
-				destruct(data_, data_ + copySize);
+				relocate(data_, data_ + copySize, newData);
 			}
 
 			// destruct trailing elements.
@@ -277,4 +343,11 @@ namespace Core
 
 		ALLOCATOR allocator_;
 	};
+
+	/// Vectors only point to their heap allocation, so can be relocated if their allocator can.
+	template<typename TYPE, typename ALLOCATOR>
+	struct IsTriviallyRelocatable<Vector<TYPE, ALLOCATOR>>
+	{
+		static const bool value = IsTriviallyRelocatable<ALLOCATOR>::value;
+	};
 } // namespace Core
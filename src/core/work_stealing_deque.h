@@ -0,0 +1,136 @@
+#pragma once
+
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+#include <utility>
+
+namespace Core
+{
+	/**
+	 * Bounded single-producer/multi-consumer work stealing deque.
+	 * Based upon "Dynamic Circular Work-Stealing Deque" (Chase & Lev, 2005), and the memory
+	 * ordering described in "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al, 2013).
+	 * The owning thread pushes and pops from the bottom, any other thread can steal from the top.
+	 * Unlike the original this does not grow, Push will fail when full.
+	 */
+	template<typename TYPE>
+	class WorkStealingDeque
+	{
+	public:
+		WorkStealingDeque() = default;
+		WorkStealingDeque(i32 size)
+		    : buffer_(new TYPE[size])
+		    , bufferMask_(size - 1)
+		{
+			DBG_ASSERT((size >= 2) && ((size & (size - 1)) == 0));
+			Core::Barrier();
+		}
+		WorkStealingDeque(WorkStealingDeque&& other)
+		{
+			using std::swap;
+			swap(buffer_, other.buffer_);
+			swap(bufferMask_, other.bufferMask_);
+			swap(top_, other.top_);
+			swap(bottom_, other.bottom_);
+		}
+		WorkStealingDeque& operator=(WorkStealingDeque&& other)
+		{
+			using std::swap;
+			swap(buffer_, other.buffer_);
+			swap(bufferMask_, other.bufferMask_);
+			swap(top_, other.top_);
+			swap(bottom_, other.bottom_);
+			return *this;
+		}
+
+		~WorkStealingDeque() { delete[] buffer_; }
+
+		/**
+		 * Push data onto bottom of deque.
+		 * Must only be called from the owning thread.
+		 * @return Successfully pushed.
+		 */
+		bool Push(const TYPE& data)
+		{
+			const i64 bottom = bottom_;
+			const i64 top = Core::AtomicCmpExchgAcq(&top_, 0, 0);
+			if((bottom - top) > bufferMask_)
+				return false;
+
+			buffer_[bottom & bufferMask_] = data;
+			Core::Barrier();
+			bottom_ = bottom + 1;
+			return true;
+		}
+
+		/**
+		 * Pop data from bottom of deque.
+		 * Must only be called from the owning thread.
+		 * @return Successfully popped.
+		 */
+		bool Pop(TYPE& data)
+		{
+			const i64 bottom = bottom_ - 1;
+			Core::AtomicExchg(&bottom_, bottom);
+			const i64 top = Core::AtomicCmpExchg(&top_, 0, 0);
+			if(top > bottom)
+			{
+				// Empty.
+				bottom_ = bottom + 1;
+				return false;
+			}
+
+			data = buffer_[bottom & bufferMask_];
+			if(top != bottom)
+				return true;
+
+			// Last element, race any thieves for it.
+			const bool success = Core::AtomicCmpExchg(&top_, top + 1, top) == top;
+			bottom_ = bottom + 1;
+			return success;
+		}
+
+		/**
+		 * Steal data from top of deque.
+		 * Can be called from any thread.
+		 * @return Successfully stolen. May fail spuriously if contended.
+		 */
+		bool Steal(TYPE& data)
+		{
+			const i64 top = Core::AtomicCmpExchgAcq(&top_, 0, 0);
+			Core::Barrier();
+			const i64 bottom = Core::AtomicCmpExchgAcq(&bottom_, 0, 0);
+			if(top >= bottom)
+				return false;
+
+			// Copy out before claiming, if the claim fails the copy is discarded.
+			data = buffer_[top & bufferMask_];
+			return Core::AtomicCmpExchg(&top_, top + 1, top) == top;
+		}
+
+		/**
+		 * @return Approximate number of elements in deque.
+		 */
+		i32 Size() const
+		{
+			const i64 size = bottom_ - top_;
+			return size > 0 ? (i32)size : 0;
+		}
+
+	private:
+		typedef char CacheLinePad[CACHE_LINE_SIZE];
+
+		CacheLinePad pad0_ = {0};
+		TYPE* buffer_ = nullptr;
+		i64 bufferMask_ = 0;
+		CacheLinePad pad1_ = {0};
+		volatile i64 top_ = 0;
+		CacheLinePad pad2_ = {0};
+		volatile i64 bottom_ = 0;
+		CacheLinePad pad3_ = {0};
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		void operator=(const WorkStealingDeque&) = delete;
+	};
+} // namespace Core
@@ -1,6 +1,7 @@
 #include "graphics/model.h"
 #include "graphics/converters/import_model.h"
 #include "graphics/private/model_impl.h"
+#include "core/arena_allocator.h"
 #include "core/concurrency.h"
 #include "core/file.h"
 #include "core/half.h"
@@ -605,9 +606,12 @@ namespace
 		{
 			aabb.Empty();
 
+			// Temporary data is only needed whilst serialising this mesh.
+			Core::ScopedArena arena(1024 * 1024);
+
 			// Build blend weights and indices.
-			Core::Vector<Math::Vec4> blendWeights;
-			Core::Vector<Math::Vec4> blendIndices;
+			Core::Vector<Math::Vec4, Core::ArenaAllocator> blendWeights(arena);
+			Core::Vector<Math::Vec4, Core::ArenaAllocator> blendIndices(arena);
 
 			const i32 numBoneVectors = Core::PotRoundUp(metaData_.maxBoneInfluences_, 4) / 4;
 			if(mesh->HasBones())
@@ -662,10 +666,11 @@ namespace
 				const i32 stride = GPU::GetStride(elements, numElements, vtxStreamIdx);
 				if(stride > 0)
 				{
-					Core::Vector<u8> vertexData(stride * mesh->mNumVertices, 0);
-					Core::Vector<Core::StreamDesc> inStreamDescs;
-					Core::Vector<Core::StreamDesc> outStreamDescs;
-					Core::Vector<i32> numComponents;
+					Core::Vector<u8, Core::ArenaAllocator> vertexData(arena);
+					Core::Vector<Core::StreamDesc, Core::ArenaAllocator> inStreamDescs(arena);
+					Core::Vector<Core::StreamDesc, Core::ArenaAllocator> outStreamDescs(arena);
+					Core::Vector<i32, Core::ArenaAllocator> numComponents(arena);
+					vertexData.resize(stride * mesh->mNumVertices, 0);
 					for(i32 elementIdx = 0; elementIdx < numElements; ++elementIdx)
 					{
 						const auto& element(elements[elementIdx]);
@@ -1,5 +1,6 @@
 #include "graphics/shader.h"
 #include "resource/converter.h"
+#include "core/arena_allocator.h"
 #include "core/array.h"
 #include "core/debug.h"
 #include "core/enum.h"
@@ -73,7 +74,10 @@ namespace
 			Core::File shaderFile(sourceFile, Core::FileFlags::DEFAULT_READ, pathResolver);
 			if(shaderFile)
 			{
-				Core::Vector<char> shaderSource;
+				// Temporary data is only needed for the duration of the conversion.
+				Core::ScopedArena arena(256 * 1024);
+
+				Core::Vector<char, Core::ArenaAllocator> shaderSource(arena);
 				shaderSource.resize((i32)shaderFile.Size() + 1, '\0');
 				shaderFile.Read(shaderSource.data(), shaderFile.Size());
 
@@ -309,7 +313,7 @@ namespace
 				for(const auto& compile : compileOutput)
 					AddBindings(compile.samplers_, samplers);
 
-				Core::Vector<Graphics::ShaderBindingHeader> outBindingHeaders;
+				Core::Vector<Graphics::ShaderBindingHeader, Core::ArenaAllocator> outBindingHeaders(arena);
 				outBindingHeaders.reserve(cbvs.size() + srvs.size() + uavs.size() + samplers.size());
 
 				const auto PopulateOutBindingHeaders = [&outBindingHeaders](
@@ -337,8 +341,8 @@ namespace
 				};
 
 				const auto& inBindingSets = backendMetadata.GetBindingSets();
-				Core::Vector<Graphics::ShaderBindingSetHeader> outBindingSets;
-				Core::Vector<i32> outBindingSetMapping;
+				Core::Vector<Graphics::ShaderBindingSetHeader, Core::ArenaAllocator> outBindingSets(arena);
+				Core::Vector<i32, Core::ArenaAllocator> outBindingSetMapping(arena);
 				outBindingSets.reserve(inBindingSets.size());
 				for(i32 idx = 0; idx < inBindingSets.size(); ++idx)
 				{
@@ -411,7 +415,7 @@ namespace
 
 				// Setup data ready to serialize.
 
-				Core::Vector<Graphics::ShaderSamplerStateHeader> outSamplerStateHeaders;
+				Core::Vector<Graphics::ShaderSamplerStateHeader, Core::ArenaAllocator> outSamplerStateHeaders(arena);
 				outSamplerStateHeaders.reserve(samplerStates.size());
 				for(const auto& samplerState : samplerStates)
 				{
@@ -421,7 +425,7 @@ namespace
 					outSamplerStateHeaders.emplace_back(outSamplerState);
 				}
 
-				Core::Vector<Graphics::ShaderBytecodeHeader> outBytecodeHeaders;
+				Core::Vector<Graphics::ShaderBytecodeHeader, Core::ArenaAllocator> outBytecodeHeaders(arena);
 				i32 bytecodeOffset = 0;
 				for(const auto& compile : compileOutput)
 				{
@@ -434,7 +438,7 @@ namespace
 					outBytecodeHeaders.push_back(bytecodeHeader);
 				};
 
-				Core::Vector<Graphics::ShaderTechniqueHeader> outTechniqueHeaders;
+				Core::Vector<Graphics::ShaderTechniqueHeader, Core::ArenaAllocator> outTechniqueHeaders(arena);
 
 				for(i32 techIdx = 0; techIdx < techniques.size(); ++techIdx)
 				{
@@ -3,7 +3,8 @@
 #include "graphics/private/render_pass_impl.h"
 
 #include "core/concurrency.h"
-#include "core/linear_allocator.h"
+#include "core/frame_allocator.h"
+#include "core/inline_vector.h"
 #include "core/misc.h"
 #include "core/set.h"
 #include "core/string.h"
@@ -35,8 +36,8 @@ namespace
 
 namespace Graphics
 {
-	// Memory for to be allocated from the render graph at runtime.
-	static constexpr i32 MAX_FRAME_DATA = 1024 * 1024;
+	// Size of each chunk of memory allocated from the render graph at runtime.
+	static constexpr i32 FRAME_DATA_CHUNK_SIZE = 256 * 1024;
 
 	struct RenderPassEntry
 	{
@@ -69,7 +70,7 @@ namespace Graphics
 		Core::Vector<RenderPassEntry*> executeRenderPasses_;
 
 		// Frame data for allocation.
-		Core::LinearAllocator frameAllocator_;
+		Core::FrameAllocator frameAllocator_;
 
 		// Command lists.
 		Core::Vector<GPU::CommandList> cmdLists_;
@@ -78,8 +79,8 @@ namespace Graphics
 		// Error handling.
 		volatile i32 compilationFailures_ = 0;
 
-		RenderGraphImpl(i32 frameAllocatorSize)
-		    : frameAllocator_(frameAllocatorSize)
+		RenderGraphImpl(i32 frameAllocatorChunkSize)
+		    : frameAllocator_(frameAllocatorChunkSize)
 		{
 		}
 
@@ -561,7 +562,7 @@ namespace Graphics
 	}
 
 
-	RenderGraph::RenderGraph() { impl_ = new RenderGraphImpl(MAX_FRAME_DATA); }
+	RenderGraph::RenderGraph() { impl_ = new RenderGraphImpl(FRAME_DATA_CHUNK_SIZE); }
 
 	RenderGraph::~RenderGraph()
 	{
@@ -638,9 +639,7 @@ namespace Graphics
 
 		// Add finalRes to outputs to start traversal.
 		const i32 MAX_OUTPUTS = Core::Max(GPU::MAX_UAV_BINDINGS, GPU::MAX_BOUND_RTVS);
-		Core::Vector<RenderGraphResource> outputs;
-		outputs.reserve(MAX_OUTPUTS);
-
+		Core::InlineVector<RenderGraphResource, MAX_OUTPUTS> outputs;
 		outputs.push_back(finalRes);
 
 		// From finalRes, work backwards and push all render passes that are required onto the stack.
@@ -671,6 +670,9 @@ namespace Graphics
 		}
 
 
+		// Per-pass temporaries are kept on the stack up to this many passes.
+		const i32 MAX_INLINE_PASSES = 64;
+
 		// Create more command lists as required.
 		const i32 numPasses = impl_->executeRenderPasses_.size();
 		if(impl_->cmdLists_.size() < numPasses)
@@ -724,7 +726,7 @@ namespace Graphics
 
 #else
 		// Setup job to execute & compile all command lists.
-		Core::Vector<Job::JobDesc> jobDescs;
+		Core::InlineVector<Job::JobDesc, MAX_INLINE_PASSES> jobDescs;
 		jobDescs.resize(numPasses);
 
 		for(i32 idx = 0; idx < numPasses; ++idx)
@@ -788,7 +790,7 @@ namespace Graphics
 		}
 		else
 		{
-			Core::Vector<GPU::Handle> cmdLists;
+			Core::InlineVector<GPU::Handle, MAX_INLINE_PASSES> cmdLists;
 			jobDescs.resize(numPasses);
 			for(i32 idx = 0; idx < numPasses; ++idx)
 			{
@@ -8,6 +8,7 @@
 #include "core/file.h"
 #include "core/hash.h"
 #include "core/misc.h"
+#include "core/string_id.h"
 #include "gpu/enum.h"
 #include "gpu/manager.h"
 #include "serialization/serializer.h"
@@ -258,12 +259,16 @@ namespace Graphics
 					if(it == bindingSetHeaders_.end())
 					{
 						bindingSetHeaders_.push_back(bindingSetHeader);
+						bindingSetNames_.emplace_back(bindingSetHeader.name_);
 
 						const auto* handleBegin = impl->bindingHeaders_.data() + handleOffset;
 						const auto* handleEnd = handleBegin + numHandles;
 
 						BindingSetHandles handles;
 						handles.headers_.insert(handleBegin, handleEnd);
+						handles.names_.reserve(numHandles);
+						for(const auto& header : handles.headers_)
+							handles.names_.emplace_back(header.name_);
 						bindingSetHandles_.emplace_back(std::move(handles));
 					}
 
@@ -325,10 +330,14 @@ namespace Graphics
 
 		i32 FindBindingSetIdx(const char* name)
 		{
-			for(i32 idx = 0; idx < bindingSetHeaders_.size(); ++idx)
+			// Names that were never interned can't belong to any binding set.
+			const Core::StringID nameId = Core::StringID::Find(name);
+			if(!nameId)
+				return -1;
+
+			for(i32 idx = 0; idx < bindingSetNames_.size(); ++idx)
 			{
-				const auto& bindingSetHeader = bindingSetHeaders_[idx];
-				if(strcmp(name, bindingSetHeader.name_) == 0)
+				if(bindingSetNames_[idx] == nameId)
 				{
 					return idx;
 				}
@@ -351,10 +360,14 @@ namespace Graphics
 
 		Core::RWLock rwLock_;
 		Core::Vector<ShaderBindingSetHeader> bindingSetHeaders_;
+		/// Interned names of bindingSetHeaders_, for lookup by name.
+		Core::Vector<Core::StringID> bindingSetNames_;
 
 		struct BindingSetHandles
 		{
 			Core::Vector<ShaderBindingHeader> headers_;
+			/// Interned names of headers_.
+			Core::Vector<Core::StringID> names_;
 		};
 
 		Core::Vector<BindingSetHandles> bindingSetHandles_;
@@ -582,16 +595,18 @@ namespace Graphics
 	{
 		DBG_ASSERT(impl_);
 		auto* factory = Shader::GetFactory();
+		const Core::StringID nameId = Core::StringID::Find(name);
+		if(!nameId)
+			return (ShaderBindingHandle)ShaderBindingFlags::INVALID;
+
 		if(auto readLock = Core::ScopedReadLock(factory->rwLock_))
 		{
 			const auto& handles = factory->bindingSetHandles_[impl_->idx_];
 
-			auto it = std::find_if(handles.headers_.begin(), handles.headers_.end(),
-			    [name](const ShaderBindingHeader& a) { return strcmp(name, a.name_) == 0; });
-
-			if(it != handles.headers_.end())
+			auto it = std::find(handles.names_.begin(), handles.names_.end(), nameId);
+			if(it != handles.names_.end())
 			{
-				return it->handle_;
+				return handles.headers_[(i32)(it - handles.names_.begin())].handle_;
 			}
 		}
 		return (ShaderBindingHandle)ShaderBindingFlags::INVALID;
@@ -1,5 +1,6 @@
 #pragma once
 #include "core/hash.h"
+#include "core/inline_vector.h"
 #include "core/set.h"
 #include "core/string.h"
 #include "core/vector.h"
@@ -206,8 +207,11 @@ namespace Graphics
 		{
 		}
 
+		/// Most frames have few binding sets, keep them inline to avoid allocating per context.
+		static const i32 MAX_INLINE_BINDING_SETS = 32;
+
 		GPU::CommandList& cmdList_;
-		Core::Vector<ShaderBindingSetImpl*> bindingSets_;
+		Core::InlineVector<ShaderBindingSetImpl*, MAX_INLINE_BINDING_SETS> bindingSets_;
 
 #if !defined(_RELEASE)
 		struct Callstack
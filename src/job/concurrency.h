@@ -1,6 +1,7 @@
 #pragma once
 
 #include "job/dll.h"
+#include "job/types.h"
 #include "core/concurrency.h"
 
 #include <utility>
@@ -45,8 +46,103 @@ namespace Job
 		SpinLock& spinLock_;
 	};
 
+	/**
+	 * Mutex that parks the calling job when contended.
+	 * Rather than spinning, a contended job's fiber is parked on the mutex and its worker is free to
+	 * run other jobs. On unlock, ownership is handed directly to the longest waiting job, which is then
+	 * resumed. Can also be used outside of jobs, where contended callers will yield their thread.
+	 * Not recursive. Can be unlocked from a different job to the one that locked it.
+	 */
+	class JOB_DLL Mutex final
+	{
+	public:
+		Mutex();
+		~Mutex();
+
+		void Lock();
+		bool TryLock();
+		void Unlock();
+
+	private:
+		friend class ConditionVariable;
+
+		Mutex(const Mutex&) = delete;
+		Mutex& operator=(const Mutex&) = delete;
+
+		static bool OnPark(Fiber* fiber, void* data);
+
+		volatile i32 locked_ = 0;
+		/// Lock for waiters list.
+		Core::SpinLock waitersLock_;
+		/// Waiters, in order of arrival.
+		struct WaitNode* waitersHead_ = nullptr;
+		struct WaitNode* waitersTail_ = nullptr;
+	};
+
+	/**
+	 * Scoped mutex to auto lock/unlock.
+	 */
+	class JOB_DLL ScopedMutex final
+	{
+	public:
+		ScopedMutex(Mutex& mutex)
+		    : mutex_(mutex)
+		{
+			mutex_.Lock();
+		}
+
+		~ScopedMutex() { mutex_.Unlock(); }
+
+	private:
+		ScopedMutex(const ScopedMutex&) = delete;
+		ScopedMutex(ScopedMutex&&) = delete;
+
+		Mutex& mutex_;
+	};
+
+	/**
+	 * Condition variable for use with Mutex.
+	 * Waiting jobs are parked, freeing their worker to run other jobs until notified.
+	 */
+	class JOB_DLL ConditionVariable final
+	{
+	public:
+		ConditionVariable();
+		~ConditionVariable();
+
+		/**
+		 * Unlock @a mutex and wait until notified, then lock @a mutex again before returning.
+		 * May wake spuriously, so the condition should always be checked in a loop.
+		 * @pre @a mutex is locked by the caller.
+		 */
+		void Wait(Mutex& mutex);
+
+		/**
+		 * Wake one waiter.
+		 */
+		void NotifyOne();
+
+		/**
+		 * Wake all waiters.
+		 */
+		void NotifyAll();
+
+	private:
+		ConditionVariable(const ConditionVariable&) = delete;
+		ConditionVariable& operator=(const ConditionVariable&) = delete;
+
+		static bool OnPark(Fiber* fiber, void* data);
+
+		/// Lock for waiters list.
+		Core::SpinLock waitersLock_;
+		/// Waiters, in order of arrival.
+		struct WaitNode* waitersHead_ = nullptr;
+		struct WaitNode* waitersTail_ = nullptr;
+	};
+
 	/**
 	 * Read/write lock.
+	 * Contended readers and writers are parked rather than spinning.
 	 */
 	class JOB_DLL RWLock final
 	{
@@ -77,8 +173,8 @@ namespace Job
 	private:
 		RWLock(const RWLock&) = delete;
 
-		SpinLock rMutex_;
-		SpinLock gMutex_;
+		Mutex rMutex_;
+		Mutex gMutex_;
 		volatile i32 readCount_ = 0;
 	};
 
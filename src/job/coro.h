@@ -0,0 +1,316 @@
+#pragma once
+
+#include "job/dll.h"
+#include "job/manager.h"
+#include "job/types.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+#include <utility>
+
+/// Coroutines require C++20 support from the compiler.
+#if defined(__cpp_impl_coroutine)
+#define JOB_CORO_ENABLED (1)
+#else
+#define JOB_CORO_ENABLED (0)
+#endif
+
+namespace Job
+{
+	/**
+	 * Pooled allocator for coroutine frames.
+	 * Frames are bucketed into power of 2 size classes, each with a lock-free free list, so
+	 * starting a coroutine rarely touches the general allocator.
+	 */
+	class JOB_DLL CoroFrameAllocator final
+	{
+	public:
+		/// Largest frame size that is pooled, larger frames are allocated directly.
+		static const i32 MAX_POOLED_SIZE = 4096;
+
+		static void* Allocate(i64 size);
+		static void Deallocate(void* mem, i64 size);
+
+	private:
+		CoroFrameAllocator() = delete;
+		~CoroFrameAllocator() = delete;
+	};
+} // namespace Job
+
+#if JOB_CORO_ENABLED
+#include <coroutine>
+
+namespace Job
+{
+	template<typename TYPE>
+	class Coro;
+
+	namespace Detail
+	{
+		/// Job entry point that resumes a coroutine, passed as the job data.
+		JOB_DLL void ResumeCoroJob(i32 param, void* data);
+
+		class CoroPromiseBase
+		{
+		public:
+			static void* operator new(size_t size) { return CoroFrameAllocator::Allocate((i64)size); }
+			static void operator delete(void* mem, size_t size) { CoroFrameAllocator::Deallocate(mem, (i64)size); }
+
+			/// Coroutines start suspended, and are started by Coro::Run or by being awaited.
+			std::suspend_always initial_suspend() noexcept { return {}; }
+
+			/// On completion, transfer straight to the awaiting coroutine if there is one.
+			struct FinalAwaiter
+			{
+				bool await_ready() noexcept { return false; }
+
+				template<typename PROMISE>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<PROMISE> handle) noexcept
+				{
+					auto& promise = handle.promise();
+					std::coroutine_handle<> continuation = promise.continuation_;
+					// Once flagged as done the owner may destroy the frame, unless it is blocked in Wait.
+					if(Core::AtomicExchg(&promise.state_, STATE_DONE) == STATE_WAITING)
+						Manager::DecrementCounter(promise.waitCounter_);
+					if(continuation)
+						return continuation;
+					return std::noop_coroutine();
+				}
+
+				void await_resume() noexcept {}
+			};
+
+			FinalAwaiter final_suspend() noexcept { return {}; }
+
+			void unhandled_exception() { DBG_ASSERT_MSG(false, "Unhandled exception in coroutine."); }
+
+			static const i32 STATE_RUNNING = 0;
+			static const i32 STATE_WAITING = 1;
+			static const i32 STATE_DONE = 2;
+
+			std::coroutine_handle<> continuation_;
+			volatile i32 state_ = STATE_RUNNING;
+			/// Counter Coro::Wait is blocked on, decremented on completion if state_ is STATE_WAITING.
+			Counter* waitCounter_ = nullptr;
+		};
+
+		template<typename TYPE>
+		class CoroPromise final : public CoroPromiseBase
+		{
+		public:
+			Coro<TYPE> get_return_object();
+
+			void return_value(TYPE value) { value_ = std::move(value); }
+
+			TYPE value_ = TYPE();
+		};
+
+		template<>
+		class CoroPromise<void> final : public CoroPromiseBase
+		{
+		public:
+			Coro<void> get_return_object();
+
+			void return_void() {}
+		};
+	} // namespace Detail
+
+	/**
+	 * Coroutine that runs on the job manager.
+	 * Awaiting a counter, another coroutine, or rescheduling suspends the coroutine without holding
+	 * onto a fiber, so any number can be waiting at once. Resuming is done by running a job, so
+	 * the coroutine may continue on any worker.
+	 * Coroutines are lazy, and only start when run or awaited. The Coro owns the coroutine frame,
+	 * and must outlive it completing.
+	 * Awaiting another coroutine transfers to it directly. Compilers that don't turn this into a
+	 * tail call (e.g. unoptimised GCC) use fiber stack for each transfer within a single job.
+	 */
+	template<typename TYPE = void>
+	class Coro final
+	{
+	public:
+		using promise_type = Detail::CoroPromise<TYPE>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Coro() = default;
+		explicit Coro(Handle handle)
+		    : handle_(handle)
+		{
+		}
+
+		Coro(Coro&& other) { std::swap(handle_, other.handle_); }
+		Coro& operator=(Coro&& other)
+		{
+			std::swap(handle_, other.handle_);
+			return *this;
+		}
+
+		~Coro()
+		{
+			if(handle_)
+				handle_.destroy();
+		}
+
+		/**
+		 * Start coroutine as a job.
+		 * @param prio Priority to run at.
+		 * @param name Name of job.
+		 */
+		void Run(Priority prio = Priority::NORMAL, const char* name = "coro")
+		{
+			DBG_ASSERT(handle_);
+			JobDesc jobDesc;
+			jobDesc.func_ = Detail::ResumeCoroJob;
+			jobDesc.prio_ = prio;
+			jobDesc.data_ = handle_.address();
+			jobDesc.name_ = name;
+			Manager::RunJobs(&jobDesc, 1);
+		}
+
+		/**
+		 * @return Has coroutine completed?
+		 */
+		bool IsDone() const { return handle_ && handle_.promise().state_ == promise_type::STATE_DONE; }
+
+		/**
+		 * Wait for coroutine to complete.
+		 * When called from a job, the job is parked until the coroutine completes.
+		 * @pre No other thread or job is waiting on this coroutine.
+		 */
+		void Wait()
+		{
+			DBG_ASSERT(handle_);
+			if(IsDone())
+				return;
+
+			auto& promise = handle_.promise();
+			Counter* counter = Manager::AllocCounter(1);
+			promise.waitCounter_ = counter;
+			// If the coroutine completed in the meantime, nothing will decrement the counter.
+			if(Core::AtomicCmpExchg(&promise.state_, promise_type::STATE_WAITING, promise_type::STATE_RUNNING) !=
+			    promise_type::STATE_RUNNING)
+				Manager::DecrementCounter(counter);
+			Manager::WaitForCounter(counter, 0);
+		}
+
+		/**
+		 * @return Result of coroutine.
+		 * @pre IsDone().
+		 */
+		decltype(auto) GetResult()
+		{
+			DBG_ASSERT(IsDone());
+			if constexpr(!std::is_void<TYPE>::value)
+				return (handle_.promise().value_);
+		}
+
+		/// Awaiting a coroutine starts it, and resumes the awaiter once it completes.
+		bool await_ready() const noexcept { return false; }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			handle_.promise().continuation_ = awaiting;
+			return handle_;
+		}
+
+		TYPE await_resume()
+		{
+			if constexpr(!std::is_void<TYPE>::value)
+				return std::move(handle_.promise().value_);
+		}
+
+	private:
+		Coro(const Coro&) = delete;
+		Coro& operator=(const Coro&) = delete;
+
+		Handle handle_;
+	};
+
+	namespace Detail
+	{
+		template<typename TYPE>
+		inline Coro<TYPE> CoroPromise<TYPE>::get_return_object()
+		{
+			return Coro<TYPE>(Coro<TYPE>::Handle::from_promise(*this));
+		}
+
+		inline Coro<void> CoroPromise<void>::get_return_object()
+		{
+			return Coro<void>(Coro<void>::Handle::from_promise(*this));
+		}
+	} // namespace Detail
+
+	/**
+	 * Awaitable that resumes the coroutine once a counter reaches a value.
+	 * Like WaitForCounter, the counter is released and set to nullptr when waiting for zero.
+	 */
+	class CounterAwaiter final
+	{
+	public:
+		CounterAwaiter(Counter*& counter, i32 value)
+		    : counter_(counter)
+		    , value_(value)
+		{
+		}
+
+		bool await_ready() const { return counter_ == nullptr || Manager::GetCounterValue(counter_) <= value_; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			continuation_.jobDesc_.func_ = Detail::ResumeCoroJob;
+			continuation_.jobDesc_.data_ = handle.address();
+			continuation_.jobDesc_.name_ = "coroCounter";
+			// May resume on another worker before this returns, so nothing can be touched after.
+			Manager::RunJobOnCounter(counter_, value_, &continuation_);
+		}
+
+		void await_resume() { Manager::WaitForCounter(counter_, value_); }
+
+	private:
+		Counter*& counter_;
+		i32 value_ = 0;
+		CounterContinuation continuation_;
+	};
+
+	/**
+	 * Await counter reaching @a value.
+	 */
+	inline CounterAwaiter WaitFor(Counter*& counter, i32 value = 0) { return CounterAwaiter(counter, value); }
+
+	/**
+	 * Awaitable that reschedules the coroutine as a new job.
+	 * Lets other jobs run, or changes the priority the coroutine continues at.
+	 */
+	class ScheduleAwaiter final
+	{
+	public:
+		ScheduleAwaiter(Priority prio)
+		    : prio_(prio)
+		{
+		}
+
+		bool await_ready() const { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			jobDesc_.func_ = Detail::ResumeCoroJob;
+			jobDesc_.prio_ = prio_;
+			jobDesc_.data_ = handle.address();
+			jobDesc_.name_ = "coroSchedule";
+			Manager::RunJobs(&jobDesc_, 1);
+		}
+
+		void await_resume() {}
+
+	private:
+		Priority prio_ = Priority::NORMAL;
+		JobDesc jobDesc_;
+	};
+
+	/**
+	 * Await being rescheduled as a new job at @a prio.
+	 */
+	inline ScheduleAwaiter Schedule(Priority prio = Priority::NORMAL) { return ScheduleAwaiter(prio); }
+
+} // namespace Job
+#endif // JOB_CORO_ENABLED
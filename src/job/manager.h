@@ -18,8 +18,10 @@ namespace Job
 		 * @param numWorkers Number of workers to create.
 		 * @param numFibers Number of fibers to allocate.
 		 * @param fiberStackSize Stack size for each fiber.
+		 * @param workStealing Keep jobs submitted from jobs on the worker's own queue, for idle workers
+		 * to steal. Otherwise all jobs go through the global queue.
 		 */
-		static void Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize);
+		static void Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize, bool workStealing = true);
 
 		/**
 		 * Shutdown job manager.
@@ -31,13 +33,19 @@ namespace Job
 		 */
 		static bool IsInitialized();
 
+		/**
+		 * @return Number of workers.
+		 */
+		static i32 GetNumWorkers();
+
 		/**
 		 * Run jobs.
 		 * @param jobDescs Jobs to run.
 		 * @param numJobDesc Number of jobs to run.
-		 * @param counter Counter for how many jobs are currently pending completion.
+		 * Counters are pooled. If every counter is in use, this waits for one to be released.
+		 * @param counter Counter for how many jobs are currently pending completion. Left as nullptr if
+		 * there are no jobs to run.
 		 * @pre jobDescs != nullptr.
-		 * @pre numJobDesc > 0.
 		 */
 		static void RunJobs(JobDesc* jobDescs, i32 numJobDesc, Counter** counter = nullptr);
 
@@ -49,6 +57,33 @@ namespace Job
 		 */
 		static void WaitForCounter(Counter*& counter, i32 value);
 
+		/**
+		 * Run a job once counter reaches a value, rather than waiting for it.
+		 * Nothing is blocked in the meantime. If the value has already been reached, the job is run immediately.
+		 * Unlike WaitForCounter, this never releases the counter.
+		 * @param counter Counter to wait on.
+		 * @param value Value to wait for.
+		 * @param continuation Job to run. Must remain valid until the job has been scheduled.
+		 * @pre counter != nullptr.
+		 */
+		static void RunJobOnCounter(Counter* counter, i32 value, CounterContinuation* continuation);
+
+		/**
+		 * Allocate a counter that is decremented by DecrementCounter, rather than by jobs completing.
+		 * Useful for waiting on work that schedules its own jobs, such as a task graph.
+		 * Release it with WaitForCounter(counter, 0) as with counters from RunJobs.
+		 * If every counter is in use, this waits for one to be released.
+		 * @param value Initial value.
+		 */
+		static Counter* AllocCounter(i32 value);
+
+		/**
+		 * Decrement a counter from AllocCounter, resuming waiters whose value has been reached.
+		 * The counter may be released by a waiter as soon as this reaches zero.
+		 * @pre Counter value is greater than zero.
+		 */
+		static void DecrementCounter(Counter* counter);
+
 		/**
 		 * @return Counter value.
 		 */
@@ -59,6 +94,31 @@ namespace Job
 		 */
 		static void YieldCPU();
 
+		/**
+		 * Park calling job, freeing its worker to run other jobs until the fiber is resumed.
+		 * This is the building block for job synchronization primitives. @a parkFunc is called
+		 * from the worker after the fiber has switched out, so it can't miss a resume.
+		 * @param parkFunc Function to call once switched out.
+		 * @param userData User data to pass to @a parkFunc.
+		 * @return false if not called from a job, in which case nothing is done.
+		 */
+		static bool ParkFiber(ParkFunc parkFunc, void* userData);
+
+		/**
+		 * Resume a fiber parked by ParkFiber.
+		 * @pre @a fiber was parked.
+		 */
+		static void ResumeFiber(Fiber* fiber);
+
+		/**
+		 * Get peak stack usage of each fiber, to help tune the stack size passed to Initialize.
+		 * Fibers are scanned whilst running, so this is approximate and not cheap.
+		 * @param outPeakUsage Output peak stack usage in bytes, one per fiber. nullptr to query fiber count.
+		 * @param maxFibers Maximum number of fibers to output.
+		 * @return Number of fibers output, or total number of fibers if @a outPeakUsage is nullptr.
+		 */
+		static i32 GetFiberStackUsage(i32* outPeakUsage, i32 maxFibers);
+
 		/**
 		 * Begin profiling.
 		 * This will allow profile entries to be gathered for scheduled jobs.
@@ -67,6 +127,8 @@ namespace Job
 
 		/**
 		 * End profiling.
+		 * Each worker records into its own ring buffer, so only the most recent entries per worker are kept.
+		 * The first entry output is a marker spanning the whole profile, with a worker index of -1.
 		 * @param profilerEntries Pointer to array of profiler entries.
 		 * @param maxProfilerEntries Maximum number of profiler entries to output.
 		 * @return Number of profile entries.
@@ -80,9 +142,9 @@ namespace Job
 		class Scoped
 		{
 		public:
-			Scoped(i32 numWorkers, i32 numFibers, i32 fiberStackSize)
+			Scoped(i32 numWorkers, i32 numFibers, i32 fiberStackSize, bool workStealing = true)
 			{
-				Initialize(numWorkers, numFibers, fiberStackSize);
+				Initialize(numWorkers, numFibers, fiberStackSize, workStealing);
 			}
 			~Scoped() { Finalize(); }
 		};
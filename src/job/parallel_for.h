@@ -0,0 +1,30 @@
+#pragma once
+
+#include "job/dll.h"
+#include "job/types.h"
+#include "core/function.h"
+
+namespace Job
+{
+	/// Parallel for function alias. Called with a [begin, end) sub-range to process.
+	using ParallelForFunction = Core::Function<void(i32, i32), 64>;
+
+	/**
+	 * Run @a fn over the range [@a begin, @a end) across all workers, and wait for completion.
+	 * Rather than scheduling a job per element, one job per worker is scheduled and each claims
+	 * chunks from a shared cursor. Chunks are sized proportional to the remaining work (guided
+	 * scheduling), starting large to keep overhead low and shrinking to @a minGrain toward the
+	 * end to balance load across workers. The calling thread participates in the work.
+	 * @param begin First element.
+	 * @param end One past the last element.
+	 * @param minGrain Minimum number of elements to pass to @a fn at once (except for the final chunk).
+	 * @param fn Function to call for each chunk.
+	 * @param prio Priority to run jobs at.
+	 * @param name Name of jobs for profiling.
+	 * @pre begin <= end.
+	 * @pre minGrain > 0.
+	 */
+	JOB_DLL void ParallelFor(i32 begin, i32 end, i32 minGrain, const ParallelForFunction& fn,
+	    Priority prio = Priority::NORMAL, const char* name = "parallelFor");
+
+} // namespace Job
@@ -27,6 +27,196 @@ namespace Job
 	}
 
 
+	namespace
+	{
+		/// Number of times to try to take a contended mutex before parking.
+		static const i32 MUTEX_SPIN_COUNT = 64;
+	}
+
+	/**
+	 * Waiter on a Mutex or ConditionVariable. Lives on the waiter's stack.
+	 */
+	struct WaitNode
+	{
+		WaitNode* next_ = nullptr;
+		/// Fiber to resume, nullptr if waiting outside of a job.
+		Fiber* fiber_ = nullptr;
+		/// Set once woken when waiting outside of a job.
+		volatile i32 signalled_ = 0;
+		/// Mutex being waited on, or to unlock once parked on a condition variable.
+		Mutex* mutex_ = nullptr;
+		ConditionVariable* cv_ = nullptr;
+	};
+
+	namespace
+	{
+		void PushWaiter(WaitNode*& head, WaitNode*& tail, WaitNode* node)
+		{
+			node->next_ = nullptr;
+			if(tail)
+				tail->next_ = node;
+			else
+				head = node;
+			tail = node;
+		}
+
+		WaitNode* PopWaiter(WaitNode*& head, WaitNode*& tail)
+		{
+			WaitNode* node = head;
+			if(node)
+			{
+				head = node->next_;
+				if(head == nullptr)
+					tail = nullptr;
+			}
+			return node;
+		}
+
+		void WakeWaiter(WaitNode* node)
+		{
+			// Node lives on the waiter's stack, so must not be touched once woken.
+			if(Fiber* fiber = node->fiber_)
+				Manager::ResumeFiber(fiber);
+			else
+				Core::AtomicExchg(&node->signalled_, 1);
+		}
+
+		void WaitForSignal(WaitNode* node)
+		{
+			while(Core::AtomicCmpExchgAcq(&node->signalled_, 0, 0) == 0)
+				Core::SwitchThread();
+		}
+	}
+
+	Mutex::Mutex() {}
+
+	Mutex::~Mutex()
+	{
+		DBG_ASSERT(locked_ == 0);
+		DBG_ASSERT(waitersHead_ == nullptr);
+	}
+
+	void Mutex::Lock()
+	{
+		for(i32 idx = 0; idx < MUTEX_SPIN_COUNT; ++idx)
+		{
+			if(TryLock())
+				return;
+			Core::YieldCPU();
+		}
+
+		// Ownership is handed to us by Unlock, so once this returns we hold the lock.
+		WaitNode node;
+		node.mutex_ = this;
+		if(!Manager::IsInitialized() || !Manager::ParkFiber(OnPark, &node))
+		{
+			{
+				Core::ScopedSpinLock lock(waitersLock_);
+				if(TryLock())
+					return;
+				PushWaiter(waitersHead_, waitersTail_, &node);
+			}
+			WaitForSignal(&node);
+		}
+	}
+
+	bool Mutex::TryLock() { return (Core::AtomicCmpExchgAcq(&locked_, 1, 0) == 0); }
+
+	void Mutex::Unlock()
+	{
+		WaitNode* node = nullptr;
+		{
+			Core::ScopedSpinLock lock(waitersLock_);
+			node = PopWaiter(waitersHead_, waitersTail_);
+			if(node == nullptr)
+			{
+				i32 locked = Core::AtomicExchg(&locked_, 0);
+				DBG_ASSERT(locked == 1);
+			}
+		}
+
+		// Hand ownership straight to the waiter, leaving the mutex locked.
+		if(node)
+			WakeWaiter(node);
+	}
+
+	bool Mutex::OnPark(Fiber* fiber, void* data)
+	{
+		auto* node = reinterpret_cast<WaitNode*>(data);
+		Mutex* mutex = node->mutex_;
+		node->fiber_ = fiber;
+
+		// Unlock may have happened since deciding to park, in which case take the lock and carry on.
+		Core::ScopedSpinLock lock(mutex->waitersLock_);
+		if(mutex->TryLock())
+			return false;
+		PushWaiter(mutex->waitersHead_, mutex->waitersTail_, node);
+		return true;
+	}
+
+	ConditionVariable::ConditionVariable() {}
+
+	ConditionVariable::~ConditionVariable() { DBG_ASSERT(waitersHead_ == nullptr); }
+
+	void ConditionVariable::Wait(Mutex& mutex)
+	{
+		WaitNode node;
+		node.mutex_ = &mutex;
+		node.cv_ = this;
+		if(!Manager::IsInitialized() || !Manager::ParkFiber(OnPark, &node))
+		{
+			{
+				Core::ScopedSpinLock lock(waitersLock_);
+				PushWaiter(waitersHead_, waitersTail_, &node);
+			}
+			mutex.Unlock();
+			WaitForSignal(&node);
+		}
+		mutex.Lock();
+	}
+
+	void ConditionVariable::NotifyOne()
+	{
+		WaitNode* node = nullptr;
+		{
+			Core::ScopedSpinLock lock(waitersLock_);
+			node = PopWaiter(waitersHead_, waitersTail_);
+		}
+		if(node)
+			WakeWaiter(node);
+	}
+
+	void ConditionVariable::NotifyAll()
+	{
+		WaitNode* nodes = nullptr;
+		{
+			Core::ScopedSpinLock lock(waitersLock_);
+			nodes = waitersHead_;
+			waitersHead_ = nullptr;
+			waitersTail_ = nullptr;
+		}
+		while(WaitNode* node = nodes)
+		{
+			nodes = node->next_;
+			WakeWaiter(node);
+		}
+	}
+
+	bool ConditionVariable::OnPark(Fiber* fiber, void* data)
+	{
+		auto* node = reinterpret_cast<WaitNode*>(data);
+		node->fiber_ = fiber;
+
+		// Mutex is held until we're on the waiters list, so a notify made under it can't be missed.
+		Mutex* mutex = node->mutex_;
+		{
+			Core::ScopedSpinLock lock(node->cv_->waitersLock_);
+			PushWaiter(node->cv_->waitersHead_, node->cv_->waitersTail_, node);
+		}
+		mutex->Unlock();
+		return true;
+	}
+
 	RWLock::RWLock() {}
 
 	RWLock::~RWLock()
@@ -41,7 +231,7 @@ namespace Job
 
 	void RWLock::BeginRead()
 	{
-		ScopedSpinLock lock(rMutex_);
+		ScopedMutex lock(rMutex_);
 		if(Core::AtomicInc(&readCount_) == 1)
 		{
 			gMutex_.Lock();
@@ -50,7 +240,7 @@ namespace Job
 
 	void RWLock::EndRead()
 	{
-		ScopedSpinLock lock(rMutex_);
+		ScopedMutex lock(rMutex_);
 		if(Core::AtomicDec(&readCount_) == 0)
 		{
 			gMutex_.Unlock();
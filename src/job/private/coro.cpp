@@ -0,0 +1,86 @@
+#include "job/coro.h"
+#include "core/allocator.h"
+#include "core/array.h"
+#include "core/misc.h"
+#include "core/mpmc_bounded_queue.h"
+
+namespace Job
+{
+	namespace
+	{
+		/// Smallest size class.
+		static const i32 MIN_POOLED_SIZE = 64;
+		/// Number of size classes, doubling from MIN_POOLED_SIZE up to MAX_POOLED_SIZE.
+		static const i32 NUM_SIZE_CLASSES = 7;
+		/// Maximum number of free frames kept per size class.
+		static const i32 MAX_FREE_FRAMES = 256;
+		/// Frame alignment, matching what operator new would give.
+		static const i64 FRAME_ALIGNMENT = 16;
+
+		struct CoroFramePool
+		{
+			CoroFramePool()
+			{
+				for(auto& freeFrames : freeFrames_)
+					freeFrames = Core::MPMCBoundedQueue<void*>(MAX_FREE_FRAMES);
+			}
+
+			~CoroFramePool()
+			{
+				void* mem = nullptr;
+				for(auto& freeFrames : freeFrames_)
+					while(freeFrames.Dequeue(mem))
+						Core::GeneralAllocator().Deallocate(mem);
+			}
+
+			Core::Array<Core::MPMCBoundedQueue<void*>, NUM_SIZE_CLASSES> freeFrames_;
+		};
+
+		CoroFramePool& GetCoroFramePool()
+		{
+			static CoroFramePool pool;
+			return pool;
+		}
+
+		i32 GetSizeClass(i64 size)
+		{
+			i32 sizeClass = 0;
+			while((MIN_POOLED_SIZE << sizeClass) < size)
+				++sizeClass;
+			return sizeClass;
+		}
+	}
+
+	static_assert((MIN_POOLED_SIZE << (NUM_SIZE_CLASSES - 1)) == CoroFrameAllocator::MAX_POOLED_SIZE,
+	    "Size classes must cover up to MAX_POOLED_SIZE.");
+
+	void* CoroFrameAllocator::Allocate(i64 size)
+	{
+		if(size > MAX_POOLED_SIZE)
+			return Core::GeneralAllocator().Allocate(size, FRAME_ALIGNMENT);
+
+		const i32 sizeClass = GetSizeClass(size);
+		void* mem = nullptr;
+		if(GetCoroFramePool().freeFrames_[sizeClass].Dequeue(mem))
+			return mem;
+		return Core::GeneralAllocator().Allocate(MIN_POOLED_SIZE << sizeClass, FRAME_ALIGNMENT);
+	}
+
+	void CoroFrameAllocator::Deallocate(void* mem, i64 size)
+	{
+		if(mem == nullptr)
+			return;
+
+		if(size <= MAX_POOLED_SIZE && GetCoroFramePool().freeFrames_[GetSizeClass(size)].Enqueue(mem))
+			return;
+		Core::GeneralAllocator().Deallocate(mem);
+	}
+
+#if JOB_CORO_ENABLED
+	namespace Detail
+	{
+		void ResumeCoroJob(i32 param, void* data) { std::coroutine_handle<>::from_address(data).resume(); }
+	} // namespace Detail
+#endif // JOB_CORO_ENABLED
+
+} // namespace Job
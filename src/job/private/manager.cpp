@@ -2,9 +2,11 @@
 #include "core/concurrency.h"
 #include "core/misc.h"
 #include "core/mpmc_bounded_queue.h"
+#include "core/random.h"
 #include "core/string.h"
 #include "core/timer.h"
 #include "core/vector.h"
+#include "core/work_stealing_deque.h"
 
 #include "Remotery.h"
 
@@ -15,16 +17,60 @@
 
 namespace Job
 {
-	// 100ms semaphore timeout.
-	static const i32 WORKER_SEMAPHORE_TIMEOUT = 100;
+	// Number of times an idle worker will check for work before sleeping.
+	static const i32 WORKER_IDLE_SPIN_COUNT = 256;
+
+	// Size of each worker's local job queues.
+	static const i32 WORKER_JOB_QUEUE_SIZE = 1024;
+
+	// Maximum number of jobs a worker takes from the global queue at once.
+	static const i32 WORKER_JOB_BATCH_SIZE = 8;
+
+	// Counters are allocated in blocks of this size.
+	static const i32 COUNTER_BLOCK_SIZE = 256;
+	static const i32 MAX_COUNTER_BLOCKS = 256;
+
+#if ENABLE_JOB_PROFILER
+	// Size of each worker's profiler ring buffer. Must be a power of 2.
+	static const i32 WORKER_PROFILER_ENTRIES = 16384;
+
+	/**
+	 * Profiler entry as recorded by a worker.
+	 * Only the raw name pointer is stored, formatting is deferred until EndProfiling.
+	 */
+	struct WorkerProfilerEntry final
+	{
+		const char* name_ = nullptr;
+		i32 param_ = 0;
+		i32 jobIdx_ = -1;
+		f64 startTime_ = 0.0;
+		f64 endTime_ = 0.0;
+	};
+#endif // ENABLE_JOB_PROFILER
 
 	/**
 	 * Counter internal details.
+	 * Counters live in blocks owned by the manager, and are recycled through a lock-free free list.
+	 * Their memory stays valid until the manager is finalized.
 	 */
 	struct Counter final
 	{
 		/// Counter value. Decreases as job completes.
 		volatile i32 value_ = 0;
+		/// References held. One for the in flight jobs, one for the caller of RunJobs if it requested the counter.
+		volatile i32 refs_ = 0;
+		/// Number of fibers in waiters_. Checked without the lock after decrementing value_.
+		volatile i32 numWaiters_ = 0;
+		/// Lock for waiters_.
+		Core::SpinLock waitersLock_;
+		/// Intrusive list of fibers waiting on this counter, linked by Fiber::nextWaiter_.
+		class Fiber* waiters_ = nullptr;
+		/// Jobs to run once the counter reaches their value.
+		CounterContinuation* continuations_ = nullptr;
+		/// Index in pool.
+		i32 idx_ = -1;
+		/// Next free counter index + 1, 0 if none.
+		i32 nextFree_ = 0;
 
 		Counter() = default;
 		Counter(const Counter&) = delete;
@@ -38,11 +84,13 @@ namespace Job
 	{
 		/// Worker pool.
 		Core::Vector<class Worker*> workers_;
+		/// All fibers, for telemetry.
+		Core::Vector<class Fiber*> fibers_;
 		/// Free fibers.
 		Core::MPMCBoundedQueue<class Fiber*> freeFibers_;
-		/// Waiting fibers.
+		/// Fibers that have yielded or finished waiting, and are ready to resume.
 		Core::Array<Core::MPMCBoundedQueue<class Fiber*>, (i32)Priority::MAX> waitingFibers_;
-		/// Jobs.
+		/// Jobs submitted from outside of workers, or when a worker's local queue is full.
 		Core::Array<Core::MPMCBoundedQueue<JobDesc>, (i32)Priority::MAX> pendingJobs_;
 		/// Out of fibers counter.
 		volatile i32 outOfFibers_ = 0;
@@ -56,37 +104,52 @@ namespace Job
 #endif
 		/// Fiber stack size.
 		i32 fiberStackSize_ = 0;
+		/// Number of times an idle worker will check for work before sleeping.
+		i32 idleSpinCount_ = 0;
+		/// Do workers keep jobs submitted from jobs locally, stealing from each other when idle?
+		bool workStealing_ = true;
 		/// Are we exiting?
 		bool exiting_ = false;
 		/// How many jobs are in flight.
 		volatile i32 jobCount_ = 0;
 
+		/// Counter blocks.
+		Core::Array<Counter*, MAX_COUNTER_BLOCKS> counterBlocks_;
+		/// Number of counter blocks allocated.
+		volatile i32 numCounterBlocks_ = 0;
+		/// Lock for allocating counter blocks.
+		Core::SpinLock counterBlocksLock_;
+		/// Free counter list head. Low 32 bits are counter index + 1, high 32 bits a tag to avoid ABA.
+		volatile i64 freeCounters_ = 0;
+
 #if ENABLE_JOB_PROFILER
 		/// Is job profiling enabled?
 		volatile i32 profilerEnabled_ = 0;
 		/// Is job profliing running?
 		volatile i32 profilerRunning_ = 0;
-		/// Entry index.
-		volatile i32 profilerEntryIdx_ = 0;
 		/// Job index.
 		volatile i32 profilerJobIdx_ = 0;
-
-		struct PaddedProfilerEntry
-		{
-			ProfilerEntry data_;
-
-			// Pad up to at least the size of a cache line to avoid false sharing when writing the entries.
-			u8 padding_[CACHE_LINE_SIZE];
-		};
-
-		Core::Vector<PaddedProfilerEntry> profilerEntries_;
+		/// Time profiling began.
+		f64 profilerStartTime_ = 0.0;
 #endif // ENABLE_JOB_PROFILER
 
-		/// Semaphore for workers to wait on.
-		Core::Semaphore scheduleSem_ = Core::Semaphore(0, 65536);
+		/// Event count for idle workers to sleep on. Notified once per job or fiber made ready.
+		Core::EventCount workerEvent_ = Core::EventCount("Job Worker Event");
 
-		bool GetFiber(Fiber** outFiber);
+		bool GetJob(class Worker* worker, i32 prio, JobDesc& outJob);
+		bool GetFiber(class Worker* worker, Fiber** outFiber);
 		void ReleaseFiber(Fiber* fiber, bool complete);
+		void ResumeFiber(Fiber* fiber);
+
+		Counter* GetCounter(i32 idx) { return &counterBlocks_[idx / COUNTER_BLOCK_SIZE][idx % COUNTER_BLOCK_SIZE]; }
+		Counter* AllocCounter(i32 value, i32 refs);
+		bool GrowCounters();
+		void PushFreeCounters(Counter* first, Counter* last);
+		void ReleaseCounter(Counter* counter);
+		void DecrementCounter(Counter* counter);
+		void AddCounterWaiter(Fiber* fiber);
+		void ParkFiber(Fiber* fiber);
+		void EndProfilerEntry(class Worker* worker);
 	};
 
 	ManagerImpl* impl_ = nullptr;
@@ -112,13 +175,11 @@ namespace Job
 				// Execute job.
 				fiber->job_.func_(fiber->job_.param_, fiber->job_.data_);
 
+				// Publish profile before the counter, so it's complete once the counter is.
+				fiber->manager_->EndProfilerEntry(fiber->worker_);
+
 				// Tick counter down.
-				u32 counter = Core::AtomicDec(&fiber->job_.counter_->value_);
-				if(counter == 0)
-				{
-					if(fiber->job_.freeCounter_)
-						delete fiber->job_.counter_;
-				}
+				fiber->manager_->DecrementCounter(fiber->job_.counter_);
 
 				fiber->job_.func_ = nullptr;
 
@@ -157,6 +218,17 @@ namespace Job
 		JobDesc job_;
 		bool exiting_ = false;
 		bool exited_ = false;
+
+		/// Counter to wait on once switched out, set by WaitForCounter.
+		Counter* waitCounter_ = nullptr;
+		/// Value to wait for waitCounter_ to reach.
+		i32 waitValue_ = 0;
+		/// Next fiber waiting on the same counter.
+		Fiber* nextWaiter_ = nullptr;
+
+		/// Function to call once switched out, set by ParkFiber.
+		ParkFunc parkFunc_ = nullptr;
+		void* parkData_ = nullptr;
 	};
 
 
@@ -166,14 +238,25 @@ namespace Job
 		Worker(ManagerImpl* manager, i32 idx)
 		    : manager_(manager)
 		    , idx_(idx)
+		    , random_(idx + 1)
+		{
+			if(manager_->workStealing_)
+				for(auto& localJobs : localJobs_)
+					localJobs = Core::WorkStealingDeque<JobDesc>(WORKER_JOB_QUEUE_SIZE);
+#if ENABLE_JOB_PROFILER
+			profilerEntries_.resize(WORKER_PROFILER_ENTRIES);
+#endif
+		}
+
+		void Start()
 		{
 			// Create thread.
-			auto debugName = Core::String().Printf("Job Worker Thread %i", idx);
+			auto debugName = Core::String().Printf("Job Worker Thread %i", idx_);
 			thread_ = Core::Thread(ThreadEntryPoint, this, Core::Thread::DEFAULT_STACK_SIZE, debugName.c_str());
 
 			// Set thread affinity to physical cores.
 			const i32 numPhysCores = Core::GetNumPhysicalCores();
-			if(u64 mask = Core::GetPhysicalCoreAffinityMask(idx) % numPhysCores)
+			if(u64 mask = Core::GetPhysicalCoreAffinityMask(idx_) % numPhysCores)
 				thread_.SetAffinity(mask);
 		}
 
@@ -195,62 +278,69 @@ namespace Job
 
 			ManagerImpl* manager = worker->manager_;
 
-#if ENABLE_JOB_PROFILER
-			ProfilerEntry profilerEntry;
-			i32 profilerEntryIdx = -1;
-#endif
-
 			// Grab fiber from manager to execute.
 			Job::Fiber* jobFiber = nullptr;
-			while(manager->GetFiber(&jobFiber))
+			i32 idleSpinCount = 0;
+			for(;;)
 			{
-				if(jobFiber)
+				bool running = manager->GetFiber(worker, &jobFiber);
+				if(!jobFiber && running)
 				{
-#if ENABLE_JOB_PROFILER
-					if(impl_->profilerRunning_)
+					// Spin for a while in case more work turns up soon.
+					if(idleSpinCount++ < manager->idleSpinCount_)
 					{
-						profilerEntryIdx = Core::AtomicInc(&impl_->profilerEntryIdx_) - 1;
-						if(profilerEntryIdx >= impl_->profilerEntries_.size())
-							profilerEntryIdx = -1;
+						Core::YieldCPU();
+						continue;
 					}
+					idleSpinCount = 0;
 
-					if(profilerEntryIdx >= 0)
+					// Register as sleeping before checking one last time, so any work submitted after is guaranteed to wake us.
+					manager->workerEvent_.PrepareWait();
+					running = manager->GetFiber(worker, &jobFiber);
+					if(!jobFiber && running)
 					{
-						profilerEntry.workerIdx_ = worker->idx_;
-						profilerEntry.jobIdx_ = jobFiber->job_.idx_;
-						profilerEntry.startTime_ = Core::Timer::GetAbsoluteTime();
-						profilerEntry.name_[0] = '\0';
-						sprintf_s(profilerEntry.name_.data(), profilerEntry.name_.size(), "%s (%i)",
-						    jobFiber->job_.name_, jobFiber->job_.param_);
-						profilerEntry.param_ = jobFiber->job_.param_;
+						manager->workerEvent_.Wait();
+						continue;
 					}
-#endif // ENABLE_JOB_PROFILER
+					manager->workerEvent_.CancelWait();
+				}
 
-					// Reset moveToWaiting_.
-					Core::AtomicExchg(&worker->moveToWaiting_, 0);
-					jobFiber->SwitchTo(worker, &workerFiber);
+				if(!running)
+					break;
+
+				idleSpinCount = 0;
 
 #if ENABLE_JOB_PROFILER
-					if(profilerEntryIdx >= 0)
-					{
-						profilerEntry.endTime_ = Core::Timer::GetAbsoluteTime();
-						manager->profilerEntries_[profilerEntryIdx].data_ = profilerEntry;
-					}
+				if(manager->profilerRunning_)
+				{
+					// Write directly into the next slot, it isn't visible to EndProfiling until published.
+					auto* profilerEntry =
+					    &worker->profilerEntries_[worker->profilerEntryIdx_ & (WORKER_PROFILER_ENTRIES - 1)];
+					profilerEntry->name_ = jobFiber->job_.name_;
+					profilerEntry->param_ = jobFiber->job_.param_;
+					profilerEntry->jobIdx_ = jobFiber->job_.idx_;
+					profilerEntry->startTime_ = Core::Timer::GetAbsoluteTime();
+					worker->profilerEntry_ = profilerEntry;
+				}
 #endif // ENABLE_JOB_PROFILER
 
-					// Reset moveToWaiting, if it was set, move fiber to waiting.
-					bool complete = !Core::AtomicExchg(&worker->moveToWaiting_, 0);
-					DBG_ASSERT(jobFiber->job_.func_ || complete);
-					complete |= jobFiber->job_.func_ == nullptr;
-					manager->ReleaseFiber(jobFiber, complete);
-				}
+				// Reset moveToWaiting_.
+				Core::AtomicExchg(&worker->moveToWaiting_, 0);
+				jobFiber->SwitchTo(worker, &workerFiber);
+
+				// Completed jobs publish their own entry, this covers jobs that yielded or are waiting.
+				manager->EndProfilerEntry(worker);
+
+				// Reset moveToWaiting, if it was set, move fiber to waiting.
+				bool complete = !Core::AtomicExchg(&worker->moveToWaiting_, 0);
+				DBG_ASSERT(jobFiber->job_.func_ || complete);
+				complete |= jobFiber->job_.func_ == nullptr;
+				if(!complete && jobFiber->waitCounter_)
+					manager->AddCounterWaiter(jobFiber);
+				else if(!complete && jobFiber->parkFunc_)
+					manager->ParkFiber(jobFiber);
 				else
-				{
-					manager->scheduleSem_.Wait(WORKER_SEMAPHORE_TIMEOUT);
-				}
-#if ENABLE_JOB_PROFILER
-				profilerEntryIdx = -1;
-#endif
+					manager->ReleaseFiber(jobFiber, complete);
 			}
 			while(!worker->exiting_)
 				Core::SwitchThread();
@@ -258,15 +348,88 @@ namespace Job
 			return 0;
 		}
 
+		/**
+		 * @return Worker the calling job is running on, nullptr if not called from a job.
+		 */
+		static Worker* GetCurrentWorker()
+		{
+			if(auto* callingFiber = Core::Fiber::GetCurrentFiber())
+				return reinterpret_cast<Fiber*>(callingFiber->GetUserData())->worker_;
+			return nullptr;
+		}
+
 		ManagerImpl* manager_ = nullptr;
 		i32 idx_ = -1;
 		Core::Thread thread_;
 		volatile i32 moveToWaiting_ = 0;
 		bool exiting_ = false;
 		bool exited_ = false;
+
+		/// Random number generator for picking victims to steal from.
+		Core::Random random_;
+		/// Jobs submitted from jobs running on this worker. Only this worker pushes & pops, others steal.
+		/// Only allocated when work stealing is enabled.
+		Core::Array<Core::WorkStealingDeque<JobDesc>, (i32)Priority::MAX> localJobs_;
+#if ENABLE_JOB_PROFILER
+		/// Profiler ring buffer. Only written by this worker, oldest entries are overwritten when full.
+		Core::Vector<WorkerProfilerEntry> profilerEntries_;
+		/// Number of entries written. Only incremented by this worker, once an entry is complete.
+		volatile i32 profilerEntryIdx_ = 0;
+		/// Value of profilerEntryIdx_ when profiling began.
+		i32 profilerBeginIdx_ = 0;
+		/// Entry for the job currently running, until published.
+		WorkerProfilerEntry* profilerEntry_ = nullptr;
+#endif
 	};
 
-	bool ManagerImpl::GetFiber(Fiber** outFiber)
+	void ManagerImpl::EndProfilerEntry(Worker* worker)
+	{
+#if ENABLE_JOB_PROFILER
+		if(WorkerProfilerEntry* profilerEntry = worker->profilerEntry_)
+		{
+			profilerEntry->endTime_ = Core::Timer::GetAbsoluteTime();
+			worker->profilerEntry_ = nullptr;
+			Core::AtomicIncRel(&worker->profilerEntryIdx_);
+		}
+#endif // ENABLE_JOB_PROFILER
+	}
+
+	bool ManagerImpl::GetJob(Worker* worker, i32 prio, JobDesc& outJob)
+	{
+		if(!workStealing_)
+			return pendingJobs_[prio].Dequeue(outJob);
+
+		// Most recently pushed local job first, it's most likely to still be in cache.
+		if(worker->localJobs_[prio].Pop(outJob))
+			return true;
+
+		// Take a batch from the global queue, keeping the rest locally where other workers can steal them.
+		// The local queue is empty at this point, so there is always room.
+		JobDesc jobDescs[WORKER_JOB_BATCH_SIZE];
+		const i32 numJobDescs = pendingJobs_[prio].DequeueBulk(jobDescs, WORKER_JOB_BATCH_SIZE);
+		if(numJobDescs > 0)
+		{
+			i32 numPushed = 1;
+			while(numPushed < numJobDescs && worker->localJobs_[prio].Push(jobDescs[numPushed]))
+				++numPushed;
+			DBG_ASSERT(numPushed == numJobDescs);
+			outJob = jobDescs[0];
+			return true;
+		}
+
+		// Steal from other workers, starting at a random victim to spread contention.
+		const i32 numWorkers = workers_.size();
+		const i32 firstVictim = (i32)((u32)worker->random_.Generate() % (u32)numWorkers);
+		for(i32 idx = 0; idx < numWorkers; ++idx)
+		{
+			Worker* victim = workers_[(firstVictim + idx) % numWorkers];
+			if(victim != worker && victim->localJobs_[prio].Steal(outJob))
+				return true;
+		}
+		return false;
+	}
+
+	bool ManagerImpl::GetFiber(Worker* worker, Fiber** outFiber)
 	{
 		Fiber* fiber = nullptr;
 		*outFiber = nullptr;
@@ -274,7 +437,7 @@ namespace Job
 		for(i32 prio = 0; prio < (i32)Priority::MAX; ++prio)
 		{
 			JobDesc job;
-			if(pendingJobs_[prio].Dequeue(job))
+			if(GetJob(worker, prio, job))
 			{
 #ifdef DEBUG
 				Core::AtomicDec(&numPendingJobs_);
@@ -385,14 +548,220 @@ namespace Job
 #endif
 				Core::SwitchThread();
 			}
+			workerEvent_.Notify(1);
 #ifdef DEBUG
-			impl_->scheduleSem_.Signal(1);
 			Core::AtomicInc(&numWaitingFibers_);
 #endif
 		}
 	}
 
-	void Manager::Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize)
+	void ManagerImpl::ResumeFiber(Fiber* fiber)
+	{
+		const i32 prio = (i32)fiber->job_.prio_;
+		while(!waitingFibers_[prio].Enqueue(fiber))
+		{
+#if VERBOSE_LOGGING >= 1
+			Core::Log("Unable to enqueue waiting fiber.\n");
+#endif
+			Core::SwitchThread();
+		}
+		workerEvent_.Notify(1);
+#ifdef DEBUG
+		Core::AtomicInc(&numWaitingFibers_);
+#endif
+	}
+
+	Counter* ManagerImpl::AllocCounter(i32 value, i32 refs)
+	{
+		i64 head = Core::AtomicCmpExchgAcq(&freeCounters_, 0, 0);
+		for(;;)
+		{
+			const i32 idx = (i32)(head & 0xffffffff) - 1;
+			if(idx < 0)
+			{
+				// If the pool can't grow, wait for a counter to be released.
+				if(!GrowCounters())
+				{
+#if VERBOSE_LOGGING >= 1
+					Core::Log("Out of job counters, waiting for one to be released.\n");
+#endif
+					Manager::YieldCPU();
+				}
+				head = Core::AtomicCmpExchgAcq(&freeCounters_, 0, 0);
+				continue;
+			}
+
+			// If another thread pops this counter first nextFree_ may be stale, but the tag will cause the exchange to fail.
+			Counter* counter = GetCounter(idx);
+			const i64 newHead = (((head >> 32) + 1) << 32) | (i64)(u32)counter->nextFree_;
+			const i64 oldHead = Core::AtomicCmpExchgAcq(&freeCounters_, newHead, head);
+			if(oldHead == head)
+			{
+				DBG_ASSERT(counter->refs_ == 0);
+				DBG_ASSERT(counter->numWaiters_ == 0);
+				counter->value_ = value;
+				counter->refs_ = refs;
+				return counter;
+			}
+			head = oldHead;
+		}
+	}
+
+	bool ManagerImpl::GrowCounters()
+	{
+		Core::ScopedSpinLock lock(counterBlocksLock_);
+
+		// Another thread may have already grown the pool.
+		if((Core::AtomicCmpExchgAcq(&freeCounters_, 0, 0) & 0xffffffff) != 0)
+			return true;
+
+		// Every counter is in use. Likely counters requested from RunJobs aren't being waited on.
+		const i32 blockIdx = numCounterBlocks_;
+		if(blockIdx >= MAX_COUNTER_BLOCKS)
+			return false;
+
+		Counter* block = new Counter[COUNTER_BLOCK_SIZE];
+		for(i32 idx = 0; idx < COUNTER_BLOCK_SIZE; ++idx)
+		{
+			block[idx].idx_ = (blockIdx * COUNTER_BLOCK_SIZE) + idx;
+			block[idx].nextFree_ = block[idx].idx_ + 2;
+		}
+		counterBlocks_[blockIdx] = block;
+		Core::AtomicInc(&numCounterBlocks_);
+
+		PushFreeCounters(&block[0], &block[COUNTER_BLOCK_SIZE - 1]);
+		return true;
+	}
+
+	void ManagerImpl::PushFreeCounters(Counter* first, Counter* last)
+	{
+		i64 head = Core::AtomicCmpExchgAcq(&freeCounters_, 0, 0);
+		for(;;)
+		{
+			last->nextFree_ = (i32)(head & 0xffffffff);
+			const i64 newHead = (((head >> 32) + 1) << 32) | (i64)(first->idx_ + 1);
+			const i64 oldHead = Core::AtomicCmpExchgRel(&freeCounters_, newHead, head);
+			if(oldHead == head)
+				break;
+			head = oldHead;
+		}
+	}
+
+	void ManagerImpl::ReleaseCounter(Counter* counter)
+	{
+		const i32 refs = Core::AtomicDec(&counter->refs_);
+		DBG_ASSERT(refs >= 0);
+		if(refs == 0)
+		{
+			DBG_ASSERT(counter->value_ == 0);
+			PushFreeCounters(counter, counter);
+		}
+	}
+
+	void ManagerImpl::DecrementCounter(Counter* counter)
+	{
+		const i32 value = Core::AtomicDec(&counter->value_);
+		DBG_ASSERT(value >= 0);
+
+		// Full barrier from the decrement pairs with the one in AddCounterWaiter, so either we see
+		// the waiter, or the waiter sees the new value.
+		if(Core::AtomicCmpExchg(&counter->numWaiters_, 0, 0) > 0)
+		{
+			// Unlink waiters that are satisfied by the new value, and resume them once the lock
+			// is released, as once they resume they may release the counter.
+			Fiber* resumeFibers = nullptr;
+			CounterContinuation* runContinuations = nullptr;
+			{
+				Core::ScopedSpinLock lock(counter->waitersLock_);
+				const i32 currValue = counter->value_;
+				Fiber** prevNext = &counter->waiters_;
+				while(Fiber* fiber = *prevNext)
+				{
+					if(currValue <= fiber->waitValue_)
+					{
+						*prevNext = fiber->nextWaiter_;
+						fiber->nextWaiter_ = resumeFibers;
+						resumeFibers = fiber;
+						Core::AtomicDec(&counter->numWaiters_);
+					}
+					else
+					{
+						prevNext = &fiber->nextWaiter_;
+					}
+				}
+
+				CounterContinuation** prevNextContinuation = &counter->continuations_;
+				while(CounterContinuation* continuation = *prevNextContinuation)
+				{
+					if(currValue <= continuation->value_)
+					{
+						*prevNextContinuation = continuation->next_;
+						continuation->next_ = runContinuations;
+						runContinuations = continuation;
+						Core::AtomicDec(&counter->numWaiters_);
+					}
+					else
+					{
+						prevNextContinuation = &continuation->next_;
+					}
+				}
+			}
+
+			// Continuation may be freed as soon as its job runs.
+			while(CounterContinuation* continuation = runContinuations)
+			{
+				runContinuations = continuation->next_;
+				continuation->next_ = nullptr;
+				Manager::RunJobs(&continuation->jobDesc_, 1);
+			}
+
+			while(Fiber* fiber = resumeFibers)
+			{
+				resumeFibers = fiber->nextWaiter_;
+				fiber->nextWaiter_ = nullptr;
+				ResumeFiber(fiber);
+			}
+		}
+
+		// The last job drops the jobs' reference.
+		if(value == 0)
+			ReleaseCounter(counter);
+	}
+
+	void ManagerImpl::AddCounterWaiter(Fiber* fiber)
+	{
+		// Fiber has fully switched out, so it's safe for another worker to resume it from here on.
+		Counter* counter = fiber->waitCounter_;
+		fiber->waitCounter_ = nullptr;
+
+		{
+			Core::ScopedSpinLock lock(counter->waitersLock_);
+			Core::AtomicInc(&counter->numWaiters_);
+			if(counter->value_ > fiber->waitValue_)
+			{
+				fiber->nextWaiter_ = counter->waiters_;
+				counter->waiters_ = fiber;
+				return;
+			}
+			Core::AtomicDec(&counter->numWaiters_);
+		}
+
+		// Already reached the value.
+		ResumeFiber(fiber);
+	}
+
+	void ManagerImpl::ParkFiber(Fiber* fiber)
+	{
+		// Fiber has fully switched out, so it's safe for another worker to resume it from here on.
+		ParkFunc parkFunc = fiber->parkFunc_;
+		void* parkData = fiber->parkData_;
+		fiber->parkFunc_ = nullptr;
+		fiber->parkData_ = nullptr;
+		if(!parkFunc(fiber, parkData))
+			ResumeFiber(fiber);
+	}
+
+	void Manager::Initialize(i32 numWorkers, i32 numFibers, i32 fiberStackSize, bool workStealing)
 	{
 		DBG_ASSERT(impl_ == nullptr);
 		DBG_ASSERT(numWorkers > 0);
@@ -401,23 +770,32 @@ namespace Job
 
 		impl_ = new ManagerImpl();
 		impl_->workers_.reserve(numWorkers);
-		impl_->freeFibers_ = Core::MPMCBoundedQueue<class Fiber*>(numFibers);
+		// Queues must be a power of 2 in size, but any number of fibers is allowed.
+		const i32 queueSize = (i32)Core::PotNext((u32)Core::Max(numFibers, 2));
+		impl_->freeFibers_ = Core::MPMCBoundedQueue<class Fiber*>(queueSize);
 		for(auto& waitingFibers : impl_->waitingFibers_)
-			waitingFibers = Core::MPMCBoundedQueue<class Fiber*>(numFibers);
+			waitingFibers = Core::MPMCBoundedQueue<class Fiber*>(queueSize);
 		for(auto& pendingJobs : impl_->pendingJobs_)
-			pendingJobs = Core::MPMCBoundedQueue<JobDesc>(numFibers);
+			pendingJobs = Core::MPMCBoundedQueue<JobDesc>(queueSize);
 		impl_->fiberStackSize_ = fiberStackSize;
-#if ENABLE_JOB_PROFILER
-		impl_->profilerEntries_.resize(65536);
-#endif
+		// Only spin when idle if there are spare cores, otherwise we are taking time from threads with work to do.
+		impl_->idleSpinCount_ = (numWorkers < Core::GetNumLogicalCores()) ? WORKER_IDLE_SPIN_COUNT : 0;
+		impl_->workStealing_ = workStealing;
 
 		for(i32 i = 0; i < numWorkers; ++i)
 		{
 			impl_->workers_.emplace_back(new Worker(impl_, i));
 		}
+		// Start workers once all exist, as they will steal from each other.
+		for(auto* worker : impl_->workers_)
+		{
+			worker->Start();
+		}
+		impl_->fibers_.reserve(numFibers);
 		for(i32 i = 0; i < numFibers; ++i)
 		{
-			bool retVal = impl_->freeFibers_.Enqueue(new Fiber(impl_));
+			impl_->fibers_.push_back(new Fiber(impl_));
+			bool retVal = impl_->freeFibers_.Enqueue(impl_->fibers_.back());
 #ifdef DEBUG
 			Core::AtomicInc(&impl_->numFreeFibers_);
 #endif
@@ -429,10 +807,6 @@ namespace Job
 	{
 		DBG_ASSERT(impl_);
 
-		impl_->exiting_ = true;
-		Core::Barrier();
-		impl_->scheduleSem_.Signal(impl_->workers_.size());
-
 		// Wait for jobs to complete, and exit all fibers.
 		{
 			Core::Fiber exitFiber(Core::Fiber::THIS_THREAD, "Job Manager Deletion Fiber");
@@ -441,6 +815,11 @@ namespace Job
 			while(impl_->jobCount_ > 0)
 				Core::SwitchThread();
 
+			// Only flag exiting once all jobs are complete, so workers are still around to resume waiting fibers.
+			impl_->exiting_ = true;
+			Core::Barrier();
+			impl_->workerEvent_.NotifyAll();
+
 			Fiber* fiber = nullptr;
 			for(auto& waitingFibers : impl_->waitingFibers_)
 				DBG_ASSERT(!waitingFibers.Dequeue(fiber));
@@ -454,31 +833,45 @@ namespace Job
 				delete fiber;
 			}
 
-			// Ensure all threads exit.
+			// Ensure all threads exit before deleting any, as they may still try to steal from each other.
 			for(auto* worker : impl_->workers_)
 			{
 				worker->exiting_ = true;
 				worker->thread_.Join();
 				DBG_ASSERT(worker->exited_);
+			}
+			for(auto* worker : impl_->workers_)
+			{
 				delete worker;
 			}
 		}
+		for(i32 idx = 0; idx < impl_->numCounterBlocks_; ++idx)
+		{
+			delete[] impl_->counterBlocks_[idx];
+		}
 		delete impl_;
 		impl_ = nullptr;
 	}
 
 	bool Manager::IsInitialized() { return !!impl_; }
 
+	i32 Manager::GetNumWorkers()
+	{
+		DBG_ASSERT(IsInitialized());
+		return impl_->workers_.size();
+	}
+
 	void Manager::RunJobs(JobDesc* jobDescs, i32 numJobDesc, Counter** counter)
 	{
 		DBG_ASSERT(IsInitialized());
 		DBG_ASSERT(counter == nullptr || *counter == nullptr);
 
-		const bool jobShouldFreeCounter = (counter == nullptr);
+		// Nothing to run, so nothing to wait on.
+		if(numJobDesc <= 0)
+			return;
 
-		// Setup counter.
-		auto* localCounter = new Counter();
-		localCounter->value_ = numJobDesc;
+		// Setup counter, with an extra reference if the caller wants it.
+		auto* localCounter = impl_->AllocCounter(numJobDesc, counter ? 2 : 1);
 
 		Core::AtomicAdd(&impl_->jobCount_, numJobDesc);
 
@@ -490,40 +883,75 @@ namespace Job
 		double nextLogTime = startTime + LOG_TIME_THRESHOLD;
 #endif
 
+		// If called from a job, push to the local queue of the worker it's running on.
+		Worker* localWorker = impl_->workStealing_ ? Worker::GetCurrentWorker() : nullptr;
+
+#if ENABLE_JOB_PROFILER
+		const i32 baseJobIdx =
+		    impl_->profilerRunning_ ? Core::AtomicAdd(&impl_->profilerJobIdx_, numJobDesc) - numJobDesc : -1;
+#endif
+
 		for(i32 i = 0; i < numJobDesc; ++i)
 		{
 			DBG_ASSERT(jobDescs[i].counter_ == nullptr);
 			jobDescs[i].counter_ = localCounter;
-			jobDescs[i].freeCounter_ = jobShouldFreeCounter;
 
 #if ENABLE_JOB_PROFILER
-			if(impl_->profilerRunning_)
-				jobDescs[i].idx_ = Core::AtomicInc(&impl_->profilerJobIdx_) - 1;
+			if(baseJobIdx >= 0)
+				jobDescs[i].idx_ = baseJobIdx + i;
 #endif
-			const auto& jobDesc = jobDescs[i];
-			auto& pendingJobs = impl_->pendingJobs_[(i32)jobDesc.prio_];
+		}
 
-			while(!pendingJobs.Enqueue(jobDescs[i]))
+		i32 jobIdx = 0;
+		while(jobIdx < numJobDesc)
+		{
+			const Priority prio = jobDescs[jobIdx].prio_;
+
+			if(localWorker && localWorker->localJobs_[(i32)prio].Push(jobDescs[jobIdx]))
 			{
-#if VERBOSE_LOGGING >= 1
-				double time = Core::Timer::GetAbsoluteTime();
-				if((time - startTime) > LOG_TIME_THRESHOLD)
-				{
-					if(time > nextLogTime)
-					{
-						Core::Log("Unable to enqueue job, waiting for free  (Total time waiting: %f ms)\n",
-						    (time - startTime) * 1000.0);
-						nextLogTime = time + LOG_TIME_REPEAT;
-					}
-				}
+				++jobIdx;
+				impl_->workerEvent_.Notify(1);
+#ifdef DEBUG
+				Core::AtomicInc(&impl_->numPendingJobs_);
 #endif
-				YieldCPU();
+				continue;
 			}
-			impl_->scheduleSem_.Signal(1);
+			// Local queue is full, don't try it again for the rest of the batch.
+			localWorker = nullptr;
 
+			// Queue run of jobs with the same priority in one go.
+			i32 runEnd = jobIdx + 1;
+			while(runEnd < numJobDesc && jobDescs[runEnd].prio_ == prio)
+				++runEnd;
+
+			const i32 numEnqueued = impl_->pendingJobs_[(i32)prio].EnqueueBulk(&jobDescs[jobIdx], runEnd - jobIdx);
+			if(numEnqueued > 0)
+			{
+				jobIdx += numEnqueued;
+				impl_->workerEvent_.Notify(numEnqueued);
 #ifdef DEBUG
-			Core::AtomicInc(&impl_->numPendingJobs_);
+				Core::AtomicAdd(&impl_->numPendingJobs_, numEnqueued);
 #endif
+				continue;
+			}
+
+#if VERBOSE_LOGGING >= 1
+			double time = Core::Timer::GetAbsoluteTime();
+			if((time - startTime) > LOG_TIME_THRESHOLD)
+			{
+				if(time > nextLogTime)
+				{
+					Core::Log("Unable to enqueue job, waiting for free  (Total time waiting: %f ms)\n",
+					    (time - startTime) * 1000.0);
+					nextLogTime = time + LOG_TIME_REPEAT;
+				}
+			}
+#endif
+			YieldCPU();
+
+			// Yielding may have resumed us on a different worker.
+			if(impl_->workStealing_)
+				localWorker = Worker::GetCurrentWorker();
 		}
 
 		// If counter is requests, store it.
@@ -538,21 +966,78 @@ namespace Job
 		DBG_ASSERT(IsInitialized());
 		if(counter)
 		{
-			while(counter->value_ > value)
+			if(counter->value_ > value)
 			{
-				YieldCPU();
+				auto* callingFiber = Core::Fiber::GetCurrentFiber();
+				if(callingFiber)
+				{
+					// Switch back to worker, which will add us to the counter's waiters. The final
+					// decrement that reaches the value will resume us.
+					auto* fiber = reinterpret_cast<Fiber*>(callingFiber->GetUserData());
+					DBG_ASSERT(fiber->worker_);
+					DBG_ASSERT(fiber->workerFiber_);
+					fiber->waitCounter_ = counter;
+					fiber->waitValue_ = value;
+					Core::AtomicExchg(&fiber->worker_->moveToWaiting_, 1);
+					fiber->workerFiber_->SwitchTo();
+					DBG_ASSERT(counter->value_ <= value);
+				}
+				else
+				{
+					while(counter->value_ > value)
+						Core::SwitchThread();
+				}
 			}
 
-			// Free counter.
-			// TODO: Keep a pool of these?
+			// Release our reference to the counter.
 			if(value == 0)
 			{
-				delete counter;
+				impl_->ReleaseCounter(counter);
 				counter = nullptr;
 			}
 		}
 	}
 
+	Counter* Manager::AllocCounter(i32 value)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(value >= 0);
+
+		// As with RunJobs, one reference is dropped by the final decrement, and one by the caller.
+		return impl_->AllocCounter(value, value > 0 ? 2 : 1);
+	}
+
+	void Manager::DecrementCounter(Counter* counter)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(counter);
+		impl_->DecrementCounter(counter);
+	}
+
+	void Manager::RunJobOnCounter(Counter* counter, i32 value, CounterContinuation* continuation)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(counter);
+		DBG_ASSERT(continuation);
+
+		// Same protocol as AddCounterWaiter, the final decrement will see us or we'll see it.
+		{
+			Core::ScopedSpinLock lock(counter->waitersLock_);
+			Core::AtomicInc(&counter->numWaiters_);
+			if(counter->value_ > value)
+			{
+				continuation->value_ = value;
+				continuation->next_ = counter->continuations_;
+				counter->continuations_ = continuation;
+				return;
+			}
+			Core::AtomicDec(&counter->numWaiters_);
+		}
+
+		// Already reached the value.
+		RunJobs(&continuation->jobDesc_, 1);
+	}
+
 	i32 Manager::GetCounterValue(Counter* counter)
 	{
 		if(counter)
@@ -587,6 +1072,45 @@ namespace Job
 		}
 	}
 
+	bool Manager::ParkFiber(ParkFunc parkFunc, void* userData)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(parkFunc);
+
+		auto* callingFiber = Core::Fiber::GetCurrentFiber();
+		if(callingFiber == nullptr)
+			return false;
+
+		// Switch back to worker, which will call parkFunc.
+		auto* fiber = reinterpret_cast<Fiber*>(callingFiber->GetUserData());
+		DBG_ASSERT(fiber->worker_);
+		DBG_ASSERT(fiber->workerFiber_);
+		fiber->parkFunc_ = parkFunc;
+		fiber->parkData_ = userData;
+		Core::AtomicExchg(&fiber->worker_->moveToWaiting_, 1);
+		fiber->workerFiber_->SwitchTo();
+		return true;
+	}
+
+	void Manager::ResumeFiber(Fiber* fiber)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(fiber);
+		impl_->ResumeFiber(fiber);
+	}
+
+	i32 Manager::GetFiberStackUsage(i32* outPeakUsage, i32 maxFibers)
+	{
+		DBG_ASSERT(IsInitialized());
+		if(outPeakUsage == nullptr)
+			return impl_->fibers_.size();
+
+		const i32 numFibers = Core::Min(impl_->fibers_.size(), maxFibers);
+		for(i32 idx = 0; idx < numFibers; ++idx)
+			outPeakUsage[idx] = impl_->fibers_[idx]->fiber_.GetPeakStackUsage();
+		return numFibers;
+	}
+
 	void Manager::BeginProfiling()
 	{
 #if ENABLE_JOB_PROFILER
@@ -597,20 +1121,14 @@ namespace Job
 		if(wasEnabled == 1)
 			return;
 
-		// Reset profiler entry index. It should already be 0 by this point, but confirm it.
-		i32 idx = Core::AtomicExchgAcq(&impl_->profilerEntryIdx_, 0);
-		DBG_ASSERT(idx == 0);
-
 		// Reset job index.
 		Core::AtomicExchgAcq(&impl_->profilerJobIdx_, 0);
 
-		// Add begin marker.
-		idx = Core::AtomicInc(&impl_->profilerEntryIdx_) - 1;
-		DBG_ASSERT(idx == 0);
+		// Mark where each worker's ring buffer starts, rather than resetting indices owned by the workers.
+		for(auto* worker : impl_->workers_)
+			worker->profilerBeginIdx_ = Core::AtomicCmpExchgAcq(&worker->profilerEntryIdx_, 0, 0);
 
-		auto& entry = impl_->profilerEntries_[0].data_;
-		strcpy_s(entry.name_.data(), entry.name_.size(), "Profile");
-		entry.startTime_ = Core::Timer::GetAbsoluteTime();
+		impl_->profilerStartTime_ = Core::Timer::GetAbsoluteTime();
 
 		// Enable running.
 		i32 wasRunning = Core::AtomicExchgAcq(&impl_->profilerRunning_, 1);
@@ -629,20 +1147,35 @@ namespace Job
 		if(wasRunning == 0)
 			return 0;
 
-		// End time marker.
-		auto& entry = impl_->profilerEntries_[0].data_;
-		entry.endTime_ = Core::Timer::GetAbsoluteTime();
+		i32 numProfilerEntries = 0;
+		if(maxProfilerEntries > 0)
+		{
+			// Begin/end marker.
+			auto& marker = profilerEntries[numProfilerEntries++];
+			marker = ProfilerEntry();
+			strcpy_s(marker.name_.data(), marker.name_.size(), "Profile");
+			marker.startTime_ = impl_->profilerStartTime_;
+			marker.endTime_ = Core::Timer::GetAbsoluteTime();
+		}
 
-		i32 numProfilerEntries = Core::AtomicExchgAcq(&impl_->profilerEntryIdx_, 0);
-		numProfilerEntries = Core::Min(numProfilerEntries, impl_->profilerEntries_.size());
-		numProfilerEntries = Core::Min(numProfilerEntries, maxProfilerEntries);
-		for(i32 idx = 0; idx < numProfilerEntries; ++idx)
+		for(auto* worker : impl_->workers_)
 		{
-			profilerEntries[idx] = impl_->profilerEntries_[idx].data_;
-			if(idx != 0 && profilerEntries[idx].workerIdx_ == -1)
+			// A worker may have started a job just before running was cleared. Its entry is written into the slot
+			// after the last published one, so skip the oldest slot to never read one still being written.
+			const i32 endIdx = Core::AtomicCmpExchgAcq(&worker->profilerEntryIdx_, 0, 0);
+			const i32 numWritten = (i32)((u32)endIdx - (u32)worker->profilerBeginIdx_);
+			const i32 numEntries = Core::Min(numWritten, WORKER_PROFILER_ENTRIES - 1);
+			for(i32 idx = endIdx - numEntries; idx != endIdx && numProfilerEntries < maxProfilerEntries; ++idx)
 			{
-				numProfilerEntries = idx;
-				break;
+				const auto& workerEntry = worker->profilerEntries_[idx & (WORKER_PROFILER_ENTRIES - 1)];
+				auto& entry = profilerEntries[numProfilerEntries++];
+				sprintf_s(entry.name_.data(), entry.name_.size(), "%s (%i)",
+				    workerEntry.name_ ? workerEntry.name_ : "<unnamed>", workerEntry.param_);
+				entry.param_ = workerEntry.param_;
+				entry.workerIdx_ = worker->idx_;
+				entry.jobIdx_ = workerEntry.jobIdx_;
+				entry.startTime_ = workerEntry.startTime_;
+				entry.endTime_ = workerEntry.endTime_;
 			}
 		}
 
@@ -656,5 +1189,4 @@ namespace Job
 #endif
 	}
 
-
 } // namespace Job
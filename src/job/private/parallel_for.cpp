@@ -0,0 +1,98 @@
+#include "job/parallel_for.h"
+#include "job/manager.h"
+#include "core/concurrency.h"
+#include "core/misc.h"
+#include "core/vector.h"
+
+namespace Job
+{
+	namespace
+	{
+		struct ParallelForState
+		{
+			/// Next element to hand out.
+			volatile i32 next_ = 0;
+			i32 end_ = 0;
+			i32 minGrain_ = 0;
+			/// Divides remaining elements to determine next chunk size.
+			i32 chunkDivisor_ = 0;
+			const ParallelForFunction* fn_ = nullptr;
+
+			/**
+			 * Claim next chunk of work.
+			 * @return false if there is no work left.
+			 */
+			bool ClaimChunk(i32& outBegin, i32& outEnd)
+			{
+				i32 next = Core::AtomicCmpExchgAcq(&next_, 0, 0);
+				while(next < end_)
+				{
+					const i32 remaining = end_ - next;
+					const i32 chunkSize = Core::Min(Core::Max(remaining / chunkDivisor_, minGrain_), remaining);
+					const i32 oldNext = Core::AtomicCmpExchgAcq(&next_, next + chunkSize, next);
+					if(oldNext == next)
+					{
+						outBegin = next;
+						outEnd = next + chunkSize;
+						return true;
+					}
+					next = oldNext;
+				}
+				return false;
+			}
+
+			void Run()
+			{
+				i32 chunkBegin = 0;
+				i32 chunkEnd = 0;
+				while(ClaimChunk(chunkBegin, chunkEnd))
+					(*fn_)(chunkBegin, chunkEnd);
+			}
+		};
+	}
+
+	void ParallelFor(i32 begin, i32 end, i32 minGrain, const ParallelForFunction& fn, Priority prio, const char* name)
+	{
+		DBG_ASSERT(Manager::IsInitialized());
+		DBG_ASSERT(begin <= end);
+		DBG_ASSERT(minGrain > 0);
+
+		const i32 numElements = end - begin;
+		if(numElements == 0)
+			return;
+
+		// Not worth scheduling anything if it fits in one chunk.
+		const i32 maxChunks = (numElements + minGrain - 1) / minGrain;
+		const i32 numHelpers = Core::Min(Manager::GetNumWorkers(), maxChunks - 1);
+		if(numHelpers <= 0)
+		{
+			fn(begin, end);
+			return;
+		}
+
+		ParallelForState state;
+		state.next_ = begin;
+		state.end_ = end;
+		state.minGrain_ = minGrain;
+		state.chunkDivisor_ = (numHelpers + 1) * 2;
+		state.fn_ = &fn;
+
+		Core::Vector<JobDesc> jobDescs;
+		jobDescs.resize(numHelpers);
+		for(auto& jobDesc : jobDescs)
+		{
+			jobDesc.func_ = [](i32 param, void* data) { reinterpret_cast<ParallelForState*>(data)->Run(); };
+			jobDesc.prio_ = prio;
+			jobDesc.data_ = &state;
+			jobDesc.name_ = name;
+		}
+
+		Counter* counter = nullptr;
+		Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+
+		// Help out, then wait for any chunks still in flight.
+		state.Run();
+		Manager::WaitForCounter(counter, 0);
+	}
+
+} // namespace Job
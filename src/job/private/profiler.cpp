@@ -0,0 +1,80 @@
+#include "job/profiler.h"
+#include "core/debug.h"
+#include "core/file.h"
+#include "core/misc.h"
+
+namespace Job
+{
+	namespace
+	{
+		void AppendEscaped(Core::String& outJson, const char* str)
+		{
+			// Control characters are replaced with spaces, so escaping at most doubles the length.
+			char escaped[sizeof(ProfilerEntry::name_) * 2];
+			i32 length = 0;
+			for(const char* c = str; *c != '\0' && length < (i32)sizeof(escaped) - 2; ++c)
+			{
+				if(*c == '"' || *c == '\\')
+					escaped[length++] = '\\';
+				escaped[length++] = ((u8)*c < 0x20) ? ' ' : *c;
+			}
+			escaped[length] = '\0';
+			outJson.Append(escaped);
+		}
+	}
+
+	void WriteChromeTrace(Core::String& outJson, const ProfilerEntry* profilerEntries, i32 numProfilerEntries)
+	{
+		DBG_ASSERT(profilerEntries || numProfilerEntries == 0);
+
+		f64 baseTime = 0.0;
+		i32 numWorkers = 0;
+		bool first = true;
+		for(i32 idx = 0; idx < numProfilerEntries; ++idx)
+		{
+			const auto& entry = profilerEntries[idx];
+			if(entry.workerIdx_ < 0)
+				continue;
+			baseTime = first ? entry.startTime_ : Core::Min(baseTime, entry.startTime_);
+			numWorkers = Core::Max(numWorkers, entry.workerIdx_ + 1);
+			first = false;
+		}
+
+		outJson.Append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+		outJson.Append("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Job Manager\"}}");
+		for(i32 workerIdx = 0; workerIdx < numWorkers; ++workerIdx)
+		{
+			outJson.Appendf(",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%i,"
+			                "\"args\":{\"name\":\"Job Worker %i\"}}",
+			    workerIdx, workerIdx);
+		}
+
+		for(i32 idx = 0; idx < numProfilerEntries; ++idx)
+		{
+			const auto& entry = profilerEntries[idx];
+			if(entry.workerIdx_ < 0)
+				continue;
+
+			outJson.Append(",\n{\"name\":\"");
+			AppendEscaped(outJson, entry.name_.data());
+			outJson.Appendf("\",\"cat\":\"job\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":0,\"tid\":%i,"
+			                "\"args\":{\"param\":%i,\"jobIdx\":%i}}",
+			    (entry.startTime_ - baseTime) * 1000000.0, (entry.endTime_ - entry.startTime_) * 1000000.0,
+			    entry.workerIdx_, entry.param_, entry.jobIdx_);
+		}
+		outJson.Append("\n]}\n");
+	}
+
+	bool WriteChromeTrace(const char* path, const ProfilerEntry* profilerEntries, i32 numProfilerEntries)
+	{
+		DBG_ASSERT(path);
+		Core::String json;
+		WriteChromeTrace(json, profilerEntries, numProfilerEntries);
+
+		Core::File file(path, Core::FileFlags::DEFAULT_WRITE);
+		if(!file)
+			return false;
+		return file.Write(json.c_str(), json.size()) == json.size();
+	}
+
+} // namespace Job
@@ -0,0 +1,192 @@
+#include "job/task.h"
+#include "job/manager.h"
+#include "core/concurrency.h"
+#include "core/debug.h"
+
+namespace Job
+{
+	Task::Task(const char* name, Priority prio)
+	    : name_(name)
+	    , prio_(prio)
+	{
+	}
+
+	Task::~Task() { DBG_ASSERT(graph_ == nullptr || !graph_->IsRunning()); }
+
+	FunctionTask::FunctionTask(const char* name, TaskFunction onWorkFn, Priority prio)
+	    : Task(name, prio)
+	    , onWorkFn_(onWorkFn)
+	{
+	}
+
+	FunctionTask::~FunctionTask() {}
+
+	void FunctionTask::OnWork() { onWorkFn_(); }
+
+	TaskGraph::TaskGraph(const char* name)
+	    : name_(name)
+	{
+	}
+
+	TaskGraph::~TaskGraph()
+	{
+		DBG_ASSERT(!IsRunning());
+		if(counter_)
+			Manager::WaitForCounter(counter_, 0);
+		for(auto* task : tasks_)
+		{
+			task->graph_ = nullptr;
+			task->idx_ = -1;
+		}
+	}
+
+	void TaskGraph::AddTask(Task* task)
+	{
+		DBG_ASSERT(!IsRunning());
+		DBG_ASSERT(task);
+		DBG_ASSERT(task->graph_ == nullptr);
+		task->graph_ = this;
+		task->idx_ = tasks_.size();
+		tasks_.push_back(task);
+		compiled_ = false;
+	}
+
+	void TaskGraph::AddDependency(Task* before, Task* after)
+	{
+		DBG_ASSERT(!IsRunning());
+		DBG_ASSERT(before && before->graph_ == this);
+		DBG_ASSERT(after && after->graph_ == this);
+		DBG_ASSERT(before != after);
+		Dependency dependency;
+		dependency.before_ = before->idx_;
+		dependency.after_ = after->idx_;
+		dependencies_.push_back(dependency);
+		compiled_ = false;
+	}
+
+	bool TaskGraph::Compile()
+	{
+		DBG_ASSERT(!IsRunning());
+		const i32 numTasks = tasks_.size();
+
+		// Bucket dependencies by predecessor into a flat successor list.
+		successorOffsets_.clear();
+		successorOffsets_.resize(numTasks + 1, 0);
+		numPredecessors_.clear();
+		numPredecessors_.resize(numTasks, 0);
+		for(const auto& dependency : dependencies_)
+		{
+			successorOffsets_[dependency.before_ + 1]++;
+			numPredecessors_[dependency.after_]++;
+		}
+		for(i32 idx = 0; idx < numTasks; ++idx)
+			successorOffsets_[idx + 1] += successorOffsets_[idx];
+
+		Core::Vector<i32> insertOffsets(successorOffsets_);
+		successors_.clear();
+		successors_.resize(dependencies_.size(), -1);
+		for(const auto& dependency : dependencies_)
+			successors_[insertOffsets[dependency.before_]++] = dependency.after_;
+
+		roots_.clear();
+		for(i32 idx = 0; idx < numTasks; ++idx)
+			if(numPredecessors_[idx] == 0)
+				roots_.push_back(idx);
+
+		// Walk graph in dependency order to detect cycles, any task not reached is in or after one.
+		Core::Vector<i32> pending(numPredecessors_);
+		Core::Vector<i32> ready(roots_);
+		i32 numReached = 0;
+		while(ready.size() > 0)
+		{
+			const i32 idx = ready.back();
+			ready.pop_back();
+			++numReached;
+			for(i32 succIdx = successorOffsets_[idx]; succIdx < successorOffsets_[idx + 1]; ++succIdx)
+				if(--pending[successors_[succIdx]] == 0)
+					ready.push_back(successors_[succIdx]);
+		}
+
+		pendingPredecessors_.clear();
+		pendingPredecessors_.resize(numTasks, 0);
+		compiled_ = (numReached == numTasks);
+		return compiled_;
+	}
+
+	void TaskGraph::Run()
+	{
+		DBG_ASSERT(Manager::IsInitialized());
+		DBG_ASSERT(compiled_);
+		DBG_ASSERT(!IsRunning());
+
+		// Release counter from a previous run that wasn't waited on.
+		if(counter_)
+			Manager::WaitForCounter(counter_, 0);
+
+		if(tasks_.size() == 0)
+			return;
+
+		for(i32 idx = 0; idx < tasks_.size(); ++idx)
+			pendingPredecessors_[idx] = numPredecessors_[idx];
+		counter_ = Manager::AllocCounter(tasks_.size());
+
+		Core::Vector<JobDesc> jobDescs;
+		jobDescs.reserve(roots_.size());
+		for(i32 idx : roots_)
+		{
+			JobDesc jobDesc;
+			jobDesc.func_ = TaskEntryPoint;
+			jobDesc.prio_ = tasks_[idx]->prio_;
+			jobDesc.param_ = idx;
+			jobDesc.data_ = this;
+			jobDesc.name_ = tasks_[idx]->name_;
+			jobDescs.push_back(jobDesc);
+		}
+		Manager::RunJobs(jobDescs.data(), jobDescs.size());
+	}
+
+	void TaskGraph::Wait()
+	{
+		if(counter_)
+			Manager::WaitForCounter(counter_, 0);
+	}
+
+	bool TaskGraph::IsRunning() const { return Manager::GetCounterValue(counter_) > 0; }
+
+	void TaskGraph::TaskEntryPoint(i32 param, void* data)
+	{
+		auto* graph = reinterpret_cast<TaskGraph*>(data);
+		graph->tasks_[param]->OnWork();
+
+		// Schedule successors that are now ready, in batches to reduce calls into the manager.
+		static const i32 MAX_BATCH_SIZE = 32;
+		JobDesc jobDescs[MAX_BATCH_SIZE];
+		i32 numJobDescs = 0;
+		for(i32 succIdx = graph->successorOffsets_[param]; succIdx < graph->successorOffsets_[param + 1]; ++succIdx)
+		{
+			const i32 idx = graph->successors_[succIdx];
+			if(Core::AtomicDec(&graph->pendingPredecessors_[idx]) == 0)
+			{
+				JobDesc& jobDesc = jobDescs[numJobDescs++];
+				jobDesc = JobDesc();
+				jobDesc.func_ = TaskEntryPoint;
+				jobDesc.prio_ = graph->tasks_[idx]->prio_;
+				jobDesc.param_ = idx;
+				jobDesc.data_ = graph;
+				jobDesc.name_ = graph->tasks_[idx]->name_;
+
+				if(numJobDescs == MAX_BATCH_SIZE)
+				{
+					Manager::RunJobs(jobDescs, numJobDescs);
+					numJobDescs = 0;
+				}
+			}
+		}
+		if(numJobDescs > 0)
+			Manager::RunJobs(jobDescs, numJobDescs);
+
+		// Graph may be destroyed by a waiter as soon as this reaches zero, so it must be the last access.
+		Manager::DecrementCounter(graph->counter_);
+	}
+
+} // namespace Job
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "job/dll.h"
+#include "job/types.h"
+#include "core/string.h"
+
+namespace Job
+{
+	/**
+	 * Write profiler entries in the Chrome trace event JSON format.
+	 * The result can be loaded into chrome://tracing or Perfetto, with a track per worker.
+	 * Times are in microseconds relative to the earliest entry. Entries without a worker,
+	 * such as the marker from Manager::EndProfiling, are skipped.
+	 * @param outJson String to append JSON to.
+	 * @param profilerEntries Entries gathered by Manager::EndProfiling.
+	 * @param numProfilerEntries Number of entries.
+	 */
+	JOB_DLL void WriteChromeTrace(Core::String& outJson, const ProfilerEntry* profilerEntries, i32 numProfilerEntries);
+
+	/**
+	 * Write profiler entries in the Chrome trace event JSON format to a file.
+	 * @param path Path of file to write.
+	 * @param profilerEntries Entries gathered by Manager::EndProfiling.
+	 * @param numProfilerEntries Number of entries.
+	 * @return Successfully written.
+	 */
+	JOB_DLL bool WriteChromeTrace(const char* path, const ProfilerEntry* profilerEntries, i32 numProfilerEntries);
+
+} // namespace Job
@@ -2,17 +2,145 @@
 
 #include "job/dll.h"
 #include "job/types.h"
+#include "core/function.h"
+#include "core/vector.h"
 
 namespace Job
 {
 	/**
-	 * 
+	 * Task to be executed as part of a TaskGraph.
+	 * Tasks are not owned by the graph, and must outlive it.
 	 */
-	class Task
+	class JOB_DLL Task
 	{
 	public:
-		Task();
+		Task(const char* name, Priority prio = Priority::NORMAL);
 		virtual ~Task();
+
+		/**
+		 * Called when task should do its work.
+		 * All predecessors will have completed before this is called.
+		 */
+		virtual void OnWork() = 0;
+
+		/**
+		 * @return Task name.
+		 */
+		const char* GetName() const { return name_; }
+
+	private:
+		friend class TaskGraph;
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		const char* name_ = nullptr;
+		Priority prio_ = Priority::NORMAL;
+		/// Owning graph.
+		class TaskGraph* graph_ = nullptr;
+		/// Index within owning graph.
+		i32 idx_ = -1;
+	};
+
+	/// Task function alias.
+	using TaskFunction = Core::Function<void(), 64>;
+
+	/**
+	 * Task that calls a function.
+	 */
+	class JOB_DLL FunctionTask : public Task
+	{
+	public:
+		FunctionTask(const char* name, TaskFunction onWorkFn, Priority prio = Priority::NORMAL);
+		virtual ~FunctionTask();
+
+		void OnWork() override;
+
+	private:
+		TaskFunction onWorkFn_;
+	};
+
+	/**
+	 * Graph of tasks with dependencies between them.
+	 * Tasks and dependencies are declared once, then the graph is compiled and can be run repeatedly.
+	 * A task is scheduled once all of its predecessors have completed, by the job that completes
+	 * the last of them, so no fibers are left waiting on dependencies.
+	 */
+	class JOB_DLL TaskGraph final
+	{
+	public:
+		TaskGraph(const char* name = "taskGraph");
+		~TaskGraph();
+
+		/**
+		 * Add task to graph.
+		 * @pre Graph is not running.
+		 * @pre @a task is not in a graph.
+		 */
+		void AddTask(Task* task);
+
+		/**
+		 * Add dependency so that @a after will not start until @a before has completed.
+		 * @pre Graph is not running.
+		 * @pre Both tasks are in this graph.
+		 */
+		void AddDependency(Task* before, Task* after);
+
+		/**
+		 * Compile graph ready to run.
+		 * Must be called after adding tasks or dependencies, and before running.
+		 * @return false if the graph contains a cycle.
+		 */
+		bool Compile();
+
+		/**
+		 * Run graph.
+		 * Tasks without predecessors are scheduled immediately.
+		 * @pre Graph is compiled.
+		 * @pre Graph is not running.
+		 */
+		void Run();
+
+		/**
+		 * Wait for graph to complete.
+		 * When called from a job, the job is parked until the last task completes.
+		 */
+		void Wait();
+
+		/**
+		 * @return Is graph running?
+		 */
+		bool IsRunning() const;
+
+	private:
+		TaskGraph(const TaskGraph&) = delete;
+		TaskGraph& operator=(const TaskGraph&) = delete;
+
+		static void TaskEntryPoint(i32 param, void* data);
+
+		struct Dependency
+		{
+			i32 before_ = -1;
+			i32 after_ = -1;
+		};
+
+		const char* name_ = nullptr;
+		Core::Vector<Task*> tasks_;
+		Core::Vector<Dependency> dependencies_;
+		bool compiled_ = false;
+
+		/// Compiled. Successors of task i are successors_[successorOffsets_[i]..successorOffsets_[i+1]).
+		Core::Vector<i32> successorOffsets_;
+		Core::Vector<i32> successors_;
+		/// Compiled. Number of predecessors for each task.
+		Core::Vector<i32> numPredecessors_;
+		/// Compiled. Tasks with no predecessors.
+		Core::Vector<i32> roots_;
+
+		/// Running. Number of predecessors yet to complete for each task.
+		Core::Vector<i32> pendingPredecessors_;
+		/// Running. Number of tasks yet to complete. Held until waited on, or the next run.
+		Counter* counter_ = nullptr;
 	};
 
 } // namespace Job
@@ -0,0 +1,139 @@
+#include "catch.hpp"
+
+#include "core/concurrency.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/coro.h"
+#include "job/function_job.h"
+#include "job/manager.h"
+
+TEST_CASE("coro-tests-enabled")
+{
+	// Older toolchains compile coroutines out, so the remaining tests are skipped.
+#if JOB_CORO_ENABLED
+	SUCCEED();
+#else
+	WARN("Coroutines are not supported by this compiler, skipping coroutine tests.");
+#endif // JOB_CORO_ENABLED
+}
+
+#if JOB_CORO_ENABLED
+
+using namespace Core;
+
+namespace
+{
+	static const i32 MAX_FIBERS = 128;
+	// Unoptimised builds nest a stack frame for each coroutine transfer.
+	static const i32 FIBER_STACK_SIZE = 256 * 1024;
+
+	Job::Coro<i32> CoroAdd(i32 a, i32 b) { co_return a + b; }
+
+	Job::Coro<i32> CoroFib(i32 n)
+	{
+		if(n < 2)
+			co_return n;
+		i32 a = co_await CoroFib(n - 1);
+		i32 b = co_await CoroFib(n - 2);
+		co_return a + b;
+	}
+
+	Job::Coro<> CoroWaitForJobs(volatile i32* numCompleted, i32 numJobs)
+	{
+		Job::FunctionJob job("coroJob", [numCompleted](i32) { Core::AtomicInc(numCompleted); });
+		Job::Counter* counter = nullptr;
+		job.RunMultiple(Job::Priority::NORMAL, 0, numJobs - 1, &counter);
+		co_await Job::WaitFor(counter);
+		DBG_ASSERT(counter == nullptr);
+	}
+
+	Job::Coro<> CoroYield(volatile i32* numCompleted, i32 numYields)
+	{
+		for(i32 i = 0; i < numYields; ++i)
+			co_await Job::Schedule(Job::Priority::LOW);
+		Core::AtomicInc(numCompleted);
+	}
+}
+
+TEST_CASE("coro-tests-return-value")
+{
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	auto coro = CoroAdd(1, 2);
+	REQUIRE(!coro.IsDone());
+	coro.Run();
+	coro.Wait();
+	REQUIRE(coro.IsDone());
+	REQUIRE(coro.GetResult() == 3);
+}
+
+TEST_CASE("coro-tests-nested")
+{
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	auto coro = CoroFib(8);
+	coro.Run();
+	coro.Wait();
+	REQUIRE(coro.GetResult() == 21);
+}
+
+TEST_CASE("coro-tests-wait-from-job")
+{
+	static const i32 NUM_YIELDS = 100;
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	// Waiting parks the job rather than holding onto its worker.
+	volatile i32 numCompleted = 0;
+	volatile i32 waitedDone = 0;
+	Job::FunctionJob job("waitJob", [&numCompleted, &waitedDone](i32) {
+		auto coro = CoroYield(&numCompleted, NUM_YIELDS);
+		coro.Run();
+		coro.Wait();
+		waitedDone = coro.IsDone() ? 1 : 0;
+	});
+	Job::Counter* counter = nullptr;
+	job.RunSingle(Job::Priority::HIGH, 0, &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+	REQUIRE(numCompleted == 1);
+	REQUIRE(waitedDone == 1);
+}
+
+TEST_CASE("coro-tests-counter")
+{
+	static const i32 NUM_JOBS = 100;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 numCompleted = 0;
+	auto coro = CoroWaitForJobs(&numCompleted, NUM_JOBS);
+	coro.Run();
+	coro.Wait();
+	REQUIRE(numCompleted == NUM_JOBS);
+}
+
+TEST_CASE("coro-tests-many")
+{
+	// Far more coroutines waiting than there are fibers to hold them.
+	static const i32 NUM_CORO_FIBERS = 8;
+	static const i32 NUM_COROS = 10000;
+	static const i32 NUM_YIELDS = 4;
+	Job::Manager::Scoped manager(4, NUM_CORO_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 numCompleted = 0;
+	Core::Vector<Job::Coro<>> coros;
+	coros.reserve(NUM_COROS);
+
+	Timer timer;
+	timer.Mark();
+	for(i32 i = 0; i < NUM_COROS; ++i)
+	{
+		coros.emplace_back(CoroYield(&numCompleted, NUM_YIELDS));
+		coros.back().Run();
+	}
+	for(auto& coro : coros)
+		coro.Wait();
+	double time = timer.GetTime();
+	REQUIRE(numCompleted == NUM_COROS);
+	Core::Log("\"coro-tests-many\" %i coroutines, %i yields each: %f ms\n", NUM_COROS, NUM_YIELDS, time * 1000.0);
+}
+
+#endif // JOB_CORO_ENABLED
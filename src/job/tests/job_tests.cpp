@@ -3,12 +3,15 @@
 #include "catch.hpp"
 
 #include "core/concurrency.h"
+#include "core/misc.h"
 #include "core/timer.h"
 #include "core/vector.h"
 #include "job/basic_job.h"
 #include "job/concurrency.h"
 #include "job/function_job.h"
 #include "job/manager.h"
+#include "job/parallel_for.h"
+#include "job/profiler.h"
 
 using namespace Core;
 
@@ -174,6 +177,13 @@ TEST_CASE("job-tests-run-job-100-mt-8")
 	RunJobTest(100, "job-tests-run-job-100-mt-8");
 }
 
+TEST_CASE("job-tests-run-job-100-mt-4-non-pot-fibers")
+{
+	// Fiber counts needn't be a power of 2, e.g. the job benchmark's minimum.
+	Job::Manager::Scoped manager(4, 144, FIBER_STACK_SIZE);
+	RunJobTest(100, "job-tests-run-job-100-mt-4-non-pot-fibers");
+}
+
 TEST_CASE("job-tests-run-job-1000-st-1")
 {
 	Job::Manager::Scoped manager(1, MAX_FIBERS, FIBER_STACK_SIZE);
@@ -258,6 +268,441 @@ TEST_CASE("job-tests-run-job-recursive-3-mt-8")
 	RunJobTest2(100, "job-tests-run-job-recursive-100-mt-8");
 }
 
+TEST_CASE("job-tests-scaling")
+{
+	// Fork-join fan out, each job submits its children from within a worker.
+	// Runs with and without work stealing, taking the best of a few runs of each to reduce noise.
+	static const i32 NUM_PARENT_JOBS = 64;
+	static const i32 NUM_CHILD_JOBS = 64;
+	static const i32 NUM_RUNS = 3;
+	static volatile i32 numChildJobsRun = 0;
+
+	auto runScaling = [](i32 numWorkers, bool workStealing) {
+		Job::Manager::Scoped manager(numWorkers, MAX_FIBERS, FIBER_STACK_SIZE, workStealing);
+
+		double bestTime = 0.0;
+		for(i32 run = 0; run < NUM_RUNS; ++run)
+		{
+			Core::Vector<Job::JobDesc> jobDescs;
+			jobDescs.reserve(NUM_PARENT_JOBS);
+			for(i32 i = 0; i < NUM_PARENT_JOBS; ++i)
+			{
+				Job::JobDesc jobDesc;
+				jobDesc.func_ = [](i32 param, void* data) {
+					Job::JobDesc childJobDescs[NUM_CHILD_JOBS];
+					for(auto& childJobDesc : childJobDescs)
+					{
+						childJobDesc.func_ = [](i32 param, void* data) {
+							CalculatePrimes(100);
+							Core::AtomicInc(&numChildJobsRun);
+						};
+						childJobDesc.name_ = "scalingChildJob";
+					}
+					Job::Counter* counter = nullptr;
+					Job::Manager::RunJobs(childJobDescs, NUM_CHILD_JOBS, &counter);
+					Job::Manager::WaitForCounter(counter, 0);
+				};
+				jobDesc.name_ = "scalingParentJob";
+				jobDescs.push_back(jobDesc);
+			}
+
+			numChildJobsRun = 0;
+			Job::Counter* counter = nullptr;
+			Timer timer;
+			timer.Mark();
+			Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+			Job::Manager::WaitForCounter(counter, 0);
+			double time = timer.GetTime();
+			REQUIRE(numChildJobsRun == NUM_PARENT_JOBS * NUM_CHILD_JOBS);
+			bestTime = run == 0 ? time : Core::Min(bestTime, time);
+		}
+
+		const i32 numJobs = NUM_PARENT_JOBS * (NUM_CHILD_JOBS + 1);
+		Core::Log("\"job-tests-scaling\" %i workers, work stealing %s: %f ms (%f jobs/s)\n", numWorkers,
+		    workStealing ? "on" : "off", bestTime * 1000.0, (double)numJobs / bestTime);
+		return bestTime;
+	};
+
+	const i32 maxWorkers = Core::Max(Core::GetNumLogicalCores(), 1);
+	double singleWorkerTime = 0.0;
+	for(i32 numWorkers = 1;; numWorkers = Core::Min(numWorkers * 2, maxWorkers))
+	{
+		const double globalTime = runScaling(numWorkers, false);
+		const double stealingTime = runScaling(numWorkers, true);
+
+		// Stealing should never be a significant regression over the global queue.
+		REQUIRE(stealingTime < globalTime * 1.5);
+
+		if(numWorkers == 1)
+			singleWorkerTime = stealingTime;
+		if(numWorkers == maxWorkers)
+		{
+			// With spare cores, more workers should get through the fan out faster than one.
+			if(maxWorkers > 1)
+				REQUIRE(stealingTime < singleWorkerTime);
+			break;
+		}
+	}
+}
+
+TEST_CASE("job-tests-counter-pool")
+{
+	// Hold more counters than fit in a single pool block.
+	static const i32 NUM_BATCHES = 1000;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 numCompleted = 0;
+	Core::Vector<Job::Counter*> counters;
+	counters.resize(NUM_BATCHES, nullptr);
+	for(i32 i = 0; i < NUM_BATCHES; ++i)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) { Core::AtomicInc((volatile i32*)data); };
+		jobDesc.data_ = (void*)&numCompleted;
+		jobDesc.name_ = "counterPoolJob";
+		Job::Manager::RunJobs(&jobDesc, 1, &counters[i]);
+	}
+
+	for(auto*& counter : counters)
+	{
+		Job::Manager::WaitForCounter(counter, 0);
+		REQUIRE(counter == nullptr);
+	}
+	REQUIRE(numCompleted == NUM_BATCHES);
+
+	// No jobs, no counter.
+	Job::Counter* counter = nullptr;
+	Job::JobDesc jobDesc;
+	Job::Manager::RunJobs(&jobDesc, 0, &counter);
+	REQUIRE(counter == nullptr);
+	Job::Manager::WaitForCounter(counter, 0);
+}
+
+TEST_CASE("job-tests-fiber-stack-usage")
+{
+	static const i32 STACK_USED = 4 * 1024;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Core::Vector<i32> peakUsage;
+	peakUsage.resize(Job::Manager::GetFiberStackUsage(nullptr, 0), 0);
+	REQUIRE(peakUsage.size() == MAX_FIBERS);
+
+	Core::Vector<Job::JobDesc> jobDescs;
+	for(i32 i = 0; i < MAX_FIBERS; ++i)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {
+			volatile u8 buffer[STACK_USED];
+			for(i32 idx = 0; idx < STACK_USED; ++idx)
+				buffer[idx] = (u8)(param | 1);
+		};
+		jobDesc.param_ = i;
+		jobDesc.name_ = "stackUsageJob";
+		jobDescs.push_back(jobDesc);
+	}
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+
+	REQUIRE(Job::Manager::GetFiberStackUsage(peakUsage.data(), peakUsage.size()) == MAX_FIBERS);
+	i32 maxUsage = 0;
+	i64 totalUsage = 0;
+	for(i32 usage : peakUsage)
+	{
+		REQUIRE(usage <= FIBER_STACK_SIZE);
+		maxUsage = Core::Max(maxUsage, usage);
+		totalUsage += usage;
+	}
+	REQUIRE(maxUsage >= STACK_USED);
+	Core::Log("\"job-tests-fiber-stack-usage\" %i fibers: %i bytes max, %i bytes avg of %i bytes\n", MAX_FIBERS,
+	    maxUsage, (i32)(totalUsage / MAX_FIBERS), FIBER_STACK_SIZE);
+}
+
+TEST_CASE("job-tests-wait-for-counter-value")
+{
+	static const i32 NUM_JOBS = 100;
+	static const i32 WAIT_VALUE = NUM_JOBS / 2;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	struct WaitData
+	{
+		Job::Counter* counter_ = nullptr;
+		i32 observedValue_ = -1;
+	};
+	WaitData waitData;
+
+	Core::Vector<Job::JobDesc> jobDescs;
+	jobDescs.resize(NUM_JOBS);
+	for(auto& jobDesc : jobDescs)
+	{
+		jobDesc.func_ = [](i32 param, void* data) { CalculatePrimes(10); };
+		jobDesc.name_ = "waitForCounterValueJob";
+	}
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &waitData.counter_);
+
+	// Wait for partial completion from within a job, then the rest from outside.
+	Job::JobDesc waitJobDesc;
+	waitJobDesc.func_ = [](i32 param, void* data) {
+		auto* waitData = reinterpret_cast<WaitData*>(data);
+		Job::Manager::WaitForCounter(waitData->counter_, WAIT_VALUE);
+		waitData->observedValue_ = Job::Manager::GetCounterValue(waitData->counter_);
+	};
+	waitJobDesc.data_ = &waitData;
+	waitJobDesc.name_ = "waitForCounterValueWaitJob";
+	Job::Counter* waitCounter = nullptr;
+	Job::Manager::RunJobs(&waitJobDesc, 1, &waitCounter);
+	Job::Manager::WaitForCounter(waitCounter, 0);
+
+	REQUIRE(waitData.observedValue_ >= 0);
+	REQUIRE(waitData.observedValue_ <= WAIT_VALUE);
+	Job::Manager::WaitForCounter(waitData.counter_, 0);
+	REQUIRE(waitData.counter_ == nullptr);
+}
+
+TEST_CASE("job-tests-latency-submit-to-start")
+{
+	// Time from RunJobs to the job starting, with workers given time to go to sleep in between.
+	static const i32 NUM_ITERATIONS = 100;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	double totalLatency = 0.0;
+	double maxLatency = 0.0;
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		Core::Sleep(0.002);
+
+		volatile double startTime = 0.0;
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) { *(volatile double*)data = Core::Timer::GetAbsoluteTime(); };
+		jobDesc.data_ = (void*)&startTime;
+		jobDesc.name_ = "latencyJob";
+
+		Job::Counter* counter = nullptr;
+		const double submitTime = Core::Timer::GetAbsoluteTime();
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+
+		const double latency = startTime - submitTime;
+		REQUIRE(latency >= 0.0);
+		totalLatency += latency;
+		maxLatency = Core::Max(maxLatency, latency);
+	}
+
+	Core::Log("\"job-tests-latency-submit-to-start\"\n");
+	Core::Log("\tAvg: %f ms, Max: %f ms\n", totalLatency * 1000.0 / (double)NUM_ITERATIONS, maxLatency * 1000.0);
+}
+
+TEST_CASE("job-tests-latency-wake-to-resume")
+{
+	// Time from a counter reaching zero to the fiber waiting on it resuming.
+	static const i32 NUM_ITERATIONS = 100;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	struct LatencyData
+	{
+		volatile double completeTime_ = 0.0;
+		volatile double resumeTime_ = 0.0;
+	};
+
+	double totalLatency = 0.0;
+	double maxLatency = 0.0;
+	for(i32 i = 0; i < NUM_ITERATIONS; ++i)
+	{
+		LatencyData latencyData;
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {
+			auto* latencyData = reinterpret_cast<LatencyData*>(data);
+
+			Job::JobDesc childJobDesc;
+			childJobDesc.func_ = [](i32 param, void* data) {
+				Core::Sleep(0.002);
+				reinterpret_cast<LatencyData*>(data)->completeTime_ = Core::Timer::GetAbsoluteTime();
+			};
+			childJobDesc.data_ = data;
+			childJobDesc.name_ = "latencyChildJob";
+
+			Job::Counter* counter = nullptr;
+			Job::Manager::RunJobs(&childJobDesc, 1, &counter);
+			Job::Manager::WaitForCounter(counter, 0);
+			latencyData->resumeTime_ = Core::Timer::GetAbsoluteTime();
+		};
+		jobDesc.data_ = &latencyData;
+		jobDesc.name_ = "latencyParentJob";
+
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+
+		const double latency = latencyData.resumeTime_ - latencyData.completeTime_;
+		REQUIRE(latency >= 0.0);
+		totalLatency += latency;
+		maxLatency = Core::Max(maxLatency, latency);
+	}
+
+	Core::Log("\"job-tests-latency-wake-to-resume\"\n");
+	Core::Log("\tAvg: %f ms, Max: %f ms\n", totalLatency * 1000.0 / (double)NUM_ITERATIONS, maxLatency * 1000.0);
+}
+
+TEST_CASE("job-tests-profiler")
+{
+	static const i32 NUM_JOBS = 256;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Core::Vector<Job::JobDesc> jobDescs;
+	for(i32 i = 0; i < NUM_JOBS; ++i)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {};
+		jobDesc.param_ = i;
+		jobDesc.name_ = "profiled\"Job";
+		jobDescs.push_back(jobDesc);
+	}
+
+	Job::Manager::BeginProfiling();
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+
+	Core::Vector<Job::ProfilerEntry> profilerEntries;
+	profilerEntries.resize(NUM_JOBS * 2);
+	const i32 numProfilerEntries = Job::Manager::EndProfiling(profilerEntries.data(), profilerEntries.size());
+
+	// Marker followed by one entry per job. Entries are published before a job's counter is decremented,
+	// so all are visible once the counter has been waited on.
+	REQUIRE(numProfilerEntries == NUM_JOBS + 1);
+	REQUIRE(profilerEntries[0].workerIdx_ == -1);
+	Core::Vector<i32> jobSeen;
+	jobSeen.resize(NUM_JOBS, 0);
+	for(i32 idx = 1; idx < numProfilerEntries; ++idx)
+	{
+		const auto& entry = profilerEntries[idx];
+		REQUIRE(entry.workerIdx_ >= 0);
+		REQUIRE(entry.workerIdx_ < 4);
+		REQUIRE(entry.jobIdx_ == entry.param_);
+		REQUIRE(entry.startTime_ >= profilerEntries[0].startTime_);
+		REQUIRE(entry.endTime_ >= entry.startTime_);
+		jobSeen[entry.param_]++;
+
+		char expectedName[64];
+		sprintf_s(expectedName, sizeof(expectedName), "profiled\"Job (%i)", entry.param_);
+		REQUIRE(strcmp(entry.name_.data(), expectedName) == 0);
+	}
+	for(i32 seen : jobSeen)
+		REQUIRE(seen == 1);
+
+	Core::String json;
+	Job::WriteChromeTrace(json, profilerEntries.data(), numProfilerEntries);
+	REQUIRE(strstr(json.c_str(), "\"traceEvents\"") != nullptr);
+	REQUIRE(strstr(json.c_str(), "\"name\":\"profiled\\\"Job (0)\"") != nullptr);
+	i32 numEvents = 0;
+	for(const char* event = strstr(json.c_str(), "\"ph\":\"X\""); event; event = strstr(event + 1, "\"ph\":\"X\""))
+		++numEvents;
+	REQUIRE(numEvents == NUM_JOBS);
+
+	// Profiling again should only contain the new jobs.
+	for(auto& jobDesc : jobDescs)
+		jobDesc.counter_ = nullptr;
+	Job::Manager::BeginProfiling();
+	Job::Manager::RunJobs(jobDescs.data(), 1, &counter);
+	Job::Manager::WaitForCounter(counter, 0);
+	REQUIRE(Job::Manager::EndProfiling(profilerEntries.data(), profilerEntries.size()) == 2);
+}
+
+TEST_CASE("job-tests-parallel-for")
+{
+	static const i32 NUM_ELEMENTS = 100000;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Core::Vector<i32> visited;
+	visited.resize(NUM_ELEMENTS, 0);
+
+	SECTION("empty")
+	{
+		Job::ParallelFor(0, 0, 1, [&](i32 begin, i32 end) { REQUIRE(false); });
+	}
+
+	SECTION("single-chunk")
+	{
+		Job::ParallelFor(0, NUM_ELEMENTS, NUM_ELEMENTS, [&](i32 begin, i32 end) {
+			for(i32 i = begin; i < end; ++i)
+				Core::AtomicInc(&visited[i]);
+		});
+		for(i32 i = 0; i < NUM_ELEMENTS; ++i)
+			REQUIRE(visited[i] == 1);
+	}
+
+	SECTION("min-grain-1")
+	{
+		Job::ParallelFor(0, NUM_ELEMENTS, 1, [&](i32 begin, i32 end) {
+			for(i32 i = begin; i < end; ++i)
+				Core::AtomicInc(&visited[i]);
+		});
+		for(i32 i = 0; i < NUM_ELEMENTS; ++i)
+			REQUIRE(visited[i] == 1);
+	}
+
+	SECTION("offset-range")
+	{
+		Job::ParallelFor(-NUM_ELEMENTS / 2, NUM_ELEMENTS / 2, 64, [&](i32 begin, i32 end) {
+			for(i32 i = begin; i < end; ++i)
+				Core::AtomicInc(&visited[i + NUM_ELEMENTS / 2]);
+		});
+		for(i32 i = 0; i < NUM_ELEMENTS; ++i)
+			REQUIRE(visited[i] == 1);
+	}
+
+	SECTION("nested")
+	{
+		Job::ParallelFor(0, 100, 1, [&](i32 outerBegin, i32 outerEnd) {
+			for(i32 j = outerBegin; j < outerEnd; ++j)
+			{
+				Job::ParallelFor(j * 1000, (j + 1) * 1000, 100, [&](i32 begin, i32 end) {
+					for(i32 i = begin; i < end; ++i)
+						Core::AtomicInc(&visited[i]);
+				});
+			}
+		});
+		for(i32 i = 0; i < NUM_ELEMENTS; ++i)
+			REQUIRE(visited[i] == 1);
+	}
+}
+
+TEST_CASE("job-tests-parallel-for-vs-run-multiple")
+{
+	// Compare per-element jobs against ranges for a cheap loop body.
+	static const i32 NUM_ELEMENTS = 100000;
+
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	Core::Vector<i32> data;
+	data.resize(NUM_ELEMENTS, 0);
+
+	Timer timer;
+	{
+		Job::FunctionJob job("runMultiple", [&data](i32 param) { data[param] = param; });
+		Job::Counter* counter = nullptr;
+		timer.Mark();
+		job.RunMultiple(Job::Priority::NORMAL, 0, NUM_ELEMENTS - 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+	}
+	double runMultipleTime = timer.GetTime();
+
+	timer.Mark();
+	Job::ParallelFor(0, NUM_ELEMENTS, 256, [&data](i32 begin, i32 end) {
+		for(i32 i = begin; i < end; ++i)
+			data[i] = -i;
+	});
+	double parallelForTime = timer.GetTime();
+
+	for(i32 i = 0; i < NUM_ELEMENTS; ++i)
+		REQUIRE(data[i] == -i);
+
+	Core::Log("\"job-tests-parallel-for-vs-run-multiple\" %i elements\n", NUM_ELEMENTS);
+	Core::Log("\tRunMultiple: %f ms\n", runMultipleTime * 1000.0);
+	Core::Log("\tParallelFor: %f ms\n", parallelForTime * 1000.0);
+}
+
 TEST_CASE("job-tests-spinlock")
 {
 	Job::SpinLock spinLock;
@@ -278,6 +723,200 @@ TEST_CASE("job-tests-spinlock")
 	spinLock.Unlock();
 }
 
+TEST_CASE("job-tests-mutex")
+{
+	Job::Mutex mutex;
+	REQUIRE(mutex.TryLock());
+	REQUIRE(!mutex.TryLock());
+	mutex.Unlock();
+
+	// More jobs than workers, so parked jobs must be resumed for this to complete.
+	static const i32 NUM_JOBS = 64;
+	static const i32 NUM_ITERATIONS = 1000;
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	struct MutexTestData
+	{
+		Job::Mutex mutex_;
+		i32 value_ = 0;
+	};
+	MutexTestData data;
+
+	Core::Vector<Job::JobDesc> jobDescs;
+	for(i32 i = 0; i < NUM_JOBS; ++i)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {
+			auto* testData = reinterpret_cast<MutexTestData*>(data);
+			for(i32 idx = 0; idx < NUM_ITERATIONS; ++idx)
+			{
+				Job::ScopedMutex lock(testData->mutex_);
+				const i32 value = testData->value_;
+				if((idx % 16) == 0)
+					Job::Manager::YieldCPU();
+				testData->value_ = value + 1;
+			}
+		};
+		jobDesc.data_ = &data;
+		jobDesc.name_ = "mutexJob";
+		jobDescs.push_back(jobDesc);
+	}
+
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+
+	// Contend from outside of a job too.
+	for(i32 idx = 0; idx < NUM_ITERATIONS; ++idx)
+	{
+		Job::ScopedMutex lock(data.mutex_);
+		data.value_++;
+	}
+
+	Job::Manager::WaitForCounter(counter, 0);
+	REQUIRE(data.value_ == (NUM_JOBS + 1) * NUM_ITERATIONS);
+}
+
+TEST_CASE("job-tests-condition-variable")
+{
+	// More consumers than workers, so they must park while waiting.
+	static const i32 NUM_CONSUMERS = 32;
+	static const i32 NUM_ITEMS = 10000;
+	Job::Manager::Scoped manager(2, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	struct CVTestData
+	{
+		Job::Mutex mutex_;
+		Job::ConditionVariable cv_;
+		Core::Vector<i32> items_;
+		bool done_ = false;
+		volatile i32 sum_ = 0;
+		volatile i32 numConsumed_ = 0;
+	};
+	CVTestData data;
+
+	Core::Vector<Job::JobDesc> jobDescs;
+	for(i32 i = 0; i < NUM_CONSUMERS; ++i)
+	{
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32 param, void* data) {
+			auto* testData = reinterpret_cast<CVTestData*>(data);
+			Job::ScopedMutex lock(testData->mutex_);
+			for(;;)
+			{
+				while(testData->items_.size() == 0 && !testData->done_)
+					testData->cv_.Wait(testData->mutex_);
+				if(testData->items_.size() == 0)
+					break;
+				Core::AtomicAdd(&testData->sum_, testData->items_.back());
+				Core::AtomicInc(&testData->numConsumed_);
+				testData->items_.pop_back();
+			}
+		};
+		jobDesc.data_ = &data;
+		jobDesc.name_ = "consumerJob";
+		jobDescs.push_back(jobDesc);
+	}
+
+	Job::Counter* counter = nullptr;
+	Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+
+	i32 expectedSum = 0;
+	for(i32 idx = 0; idx < NUM_ITEMS; ++idx)
+	{
+		Job::ScopedMutex lock(data.mutex_);
+		data.items_.push_back(idx);
+		expectedSum += idx;
+		data.cv_.NotifyOne();
+	}
+	{
+		Job::ScopedMutex lock(data.mutex_);
+		data.done_ = true;
+		data.cv_.NotifyAll();
+	}
+
+	Job::Manager::WaitForCounter(counter, 0);
+	REQUIRE(data.numConsumed_ == NUM_ITEMS);
+	REQUIRE(data.sum_ == expectedSum);
+}
+
+namespace
+{
+	template<typename LOCK, typename SCOPED_LOCK>
+	double RunLockContention(i32 numWorkers, i32 numJobs, i32 numIterations, i32 numBackgroundJobs)
+	{
+		Job::Manager::Scoped manager(numWorkers, MAX_FIBERS, FIBER_STACK_SIZE);
+
+		struct ContentionData
+		{
+			LOCK lock_;
+			volatile i32 value_ = 0;
+			i32 numIterations_ = 0;
+		};
+		ContentionData data;
+		data.numIterations_ = numIterations;
+
+		// Contending jobs do a little work inside the lock, background jobs only need a worker to run on.
+		Core::Vector<Job::JobDesc> jobDescs;
+		for(i32 i = 0; i < numJobs + numBackgroundJobs; ++i)
+		{
+			Job::JobDesc jobDesc;
+			if(i < numJobs)
+			{
+				jobDesc.func_ = [](i32 param, void* data) {
+					auto* contentionData = reinterpret_cast<ContentionData*>(data);
+					for(i32 idx = 0; idx < contentionData->numIterations_; ++idx)
+					{
+						SCOPED_LOCK lock(contentionData->lock_);
+						for(i32 work = 0; work < 256; ++work)
+							contentionData->value_++;
+					}
+				};
+			}
+			else
+			{
+				jobDesc.func_ = [](i32 param, void* data) {
+					volatile i32 value = 0;
+					for(i32 work = 0; work < 256 * 64; ++work)
+						value++;
+				};
+			}
+			jobDesc.data_ = &data;
+			jobDesc.name_ = "contentionJob";
+			jobDescs.push_back(jobDesc);
+		}
+
+		Timer timer;
+		timer.Mark();
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(jobDescs.data(), jobDescs.size(), &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		const double time = timer.GetTime();
+		REQUIRE(data.value_ == numJobs * numIterations * 256);
+		return time;
+	}
+}
+
+TEST_CASE("job-tests-mutex-contention")
+{
+	static const i32 NUM_JOBS = 32;
+	static const i32 NUM_ITERATIONS = 100;
+	static const i32 NUM_BACKGROUND_JOBS = 64;
+	const i32 numWorkers = Core::Max(2, Core::GetNumLogicalCores());
+
+	const double spinLockTime =
+	    RunLockContention<Job::SpinLock, Job::ScopedSpinLock>(numWorkers, NUM_JOBS, NUM_ITERATIONS, NUM_BACKGROUND_JOBS);
+	const double mutexTime =
+	    RunLockContention<Job::Mutex, Job::ScopedMutex>(numWorkers, NUM_JOBS, NUM_ITERATIONS, NUM_BACKGROUND_JOBS);
+	const double rwLockTime =
+	    RunLockContention<Job::RWLock, Job::ScopedWriteLock>(numWorkers, NUM_JOBS, NUM_ITERATIONS, NUM_BACKGROUND_JOBS);
+
+	Core::Log("\"job-tests-mutex-contention\" %i workers, %i jobs x %i locks, %i background jobs\n", numWorkers,
+	    NUM_JOBS, NUM_ITERATIONS, NUM_BACKGROUND_JOBS);
+	Core::Log("\tSpinLock: %f ms\n", spinLockTime * 1000.0);
+	Core::Log("\tMutex: %f ms\n", mutexTime * 1000.0);
+	Core::Log("\tRWLock (write): %f ms\n", rwLockTime * 1000.0);
+}
+
 TEST_CASE("job-tests-3-jobs")
 {
 	Job::Manager::Scoped manager(8, MAX_FIBERS, FIBER_STACK_SIZE);
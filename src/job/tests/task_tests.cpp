@@ -0,0 +1,195 @@
+#include "catch.hpp"
+
+#include "core/concurrency.h"
+#include "core/timer.h"
+#include "core/vector.h"
+#include "job/manager.h"
+#include "job/task.h"
+
+using namespace Core;
+
+namespace
+{
+	static const i32 MAX_FIBERS = 128;
+	static const i32 FIBER_STACK_SIZE = 16 * 1024;
+
+	/**
+	 * Records the order tasks complete in.
+	 */
+	class OrderTask : public Job::Task
+	{
+	public:
+		OrderTask(volatile i32* order)
+		    : Job::Task("orderTask")
+		    , order_(order)
+		{
+		}
+
+		void OnWork() override { completed_ = Core::AtomicInc(order_); }
+
+		volatile i32* order_ = nullptr;
+		i32 completed_ = 0;
+	};
+}
+
+TEST_CASE("task-tests-empty")
+{
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+	Job::TaskGraph graph;
+	REQUIRE(graph.Compile());
+	graph.Run();
+	graph.Wait();
+	REQUIRE(!graph.IsRunning());
+}
+
+TEST_CASE("task-tests-chain")
+{
+	static const i32 NUM_TASKS = 64;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 order = 0;
+	Core::Vector<OrderTask*> tasks;
+	{
+		// Tasks must outlive the graph.
+		Job::TaskGraph graph;
+		for(i32 i = 0; i < NUM_TASKS; ++i)
+		{
+			tasks.push_back(new OrderTask(&order));
+			graph.AddTask(tasks.back());
+			if(i > 0)
+				graph.AddDependency(tasks[i - 1], tasks[i]);
+		}
+		REQUIRE(graph.Compile());
+
+		graph.Run();
+		graph.Wait();
+		for(i32 i = 0; i < NUM_TASKS; ++i)
+			REQUIRE(tasks[i]->completed_ == i + 1);
+	}
+
+	for(auto* task : tasks)
+		delete task;
+}
+
+TEST_CASE("task-tests-diamond")
+{
+	static const i32 NUM_MIDDLE_TASKS = 100;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 order = 0;
+	OrderTask first(&order);
+	OrderTask last(&order);
+	Core::Vector<OrderTask*> middle;
+	{
+		Job::TaskGraph graph;
+		graph.AddTask(&first);
+		graph.AddTask(&last);
+		for(i32 i = 0; i < NUM_MIDDLE_TASKS; ++i)
+		{
+			middle.push_back(new OrderTask(&order));
+			graph.AddTask(middle.back());
+			graph.AddDependency(&first, middle.back());
+			graph.AddDependency(middle.back(), &last);
+		}
+		REQUIRE(graph.Compile());
+
+		graph.Run();
+		graph.Wait();
+		REQUIRE(first.completed_ == 1);
+		for(auto* task : middle)
+			REQUIRE((task->completed_ > 1 && task->completed_ < NUM_MIDDLE_TASKS + 2));
+		REQUIRE(last.completed_ == NUM_MIDDLE_TASKS + 2);
+	}
+
+	for(auto* task : middle)
+		delete task;
+}
+
+TEST_CASE("task-tests-cycle")
+{
+	Job::Manager::Scoped manager(1, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	volatile i32 order = 0;
+	OrderTask a(&order);
+	OrderTask b(&order);
+	OrderTask c(&order);
+
+	Job::TaskGraph graph;
+	graph.AddTask(&a);
+	graph.AddTask(&b);
+	graph.AddTask(&c);
+	graph.AddDependency(&a, &b);
+	graph.AddDependency(&b, &c);
+	REQUIRE(graph.Compile());
+	graph.AddDependency(&c, &b);
+	REQUIRE(!graph.Compile());
+}
+
+TEST_CASE("task-tests-reuse")
+{
+	static const i32 NUM_FRAMES = 100;
+	static const i32 NUM_LAYERS = 8;
+	static const i32 NUM_TASKS_PER_LAYER = 16;
+	Job::Manager::Scoped manager(4, MAX_FIBERS, FIBER_STACK_SIZE);
+
+	// Layered graph, each task depends on every task in the layer before it.
+	volatile i32 numCompleted = 0;
+	Core::Vector<Job::FunctionTask*> tasks;
+	{
+		Job::TaskGraph graph;
+		for(i32 layer = 0; layer < NUM_LAYERS; ++layer)
+		{
+			for(i32 i = 0; i < NUM_TASKS_PER_LAYER; ++i)
+			{
+				auto* task =
+				    new Job::FunctionTask("layerTask", [&numCompleted]() { Core::AtomicInc(&numCompleted); });
+				tasks.push_back(task);
+				graph.AddTask(task);
+				if(layer > 0)
+					for(i32 j = 0; j < NUM_TASKS_PER_LAYER; ++j)
+						graph.AddDependency(tasks[(layer - 1) * NUM_TASKS_PER_LAYER + j], task);
+			}
+		}
+		REQUIRE(graph.Compile());
+
+		Timer timer;
+		timer.Mark();
+		for(i32 frame = 0; frame < NUM_FRAMES; ++frame)
+		{
+			graph.Run();
+			graph.Wait();
+			REQUIRE(numCompleted == (frame + 1) * NUM_LAYERS * NUM_TASKS_PER_LAYER);
+		}
+		double time = timer.GetTime();
+		Core::Log("\"task-tests-reuse\" %i frames of %i tasks: %f ms (%f ms. avg)\n", NUM_FRAMES,
+		    NUM_LAYERS * NUM_TASKS_PER_LAYER, time * 1000.0, time * 1000.0 / (double)NUM_FRAMES);
+
+		// Waiting from a job parks it on the graph's counter, rather than spinning on its worker.
+		struct WaitData
+		{
+			Job::TaskGraph* graph_ = nullptr;
+			i32 numCompleted_ = 0;
+			volatile i32* numCompletedPtr_ = nullptr;
+		};
+		WaitData waitData;
+		waitData.graph_ = &graph;
+		waitData.numCompletedPtr_ = &numCompleted;
+
+		Job::JobDesc jobDesc;
+		jobDesc.func_ = [](i32, void* data) {
+			auto* waitData = reinterpret_cast<WaitData*>(data);
+			waitData->graph_->Run();
+			waitData->graph_->Wait();
+			waitData->numCompleted_ = *waitData->numCompletedPtr_;
+		};
+		jobDesc.data_ = &waitData;
+		jobDesc.name_ = "waitForGraph";
+		Job::Counter* counter = nullptr;
+		Job::Manager::RunJobs(&jobDesc, 1, &counter);
+		Job::Manager::WaitForCounter(counter, 0);
+		REQUIRE(waitData.numCompleted_ == (NUM_FRAMES + 1) * NUM_LAYERS * NUM_TASKS_PER_LAYER);
+	}
+
+	for(auto* task : tasks)
+		delete task;
+}
@@ -45,8 +45,6 @@ namespace Job
 		struct Counter* counter_ = nullptr;
 		/// Internal use. Do not use.
 		i32 idx_ = -1;
-		/// Internal use. Do not use.
-		bool freeCounter_ = false;
 	};
 
 	/**
@@ -54,6 +52,33 @@ namespace Job
 	 */
 	struct Counter;
 
+	/**
+	 * Job to run once a counter reaches a value, see Manager::RunJobOnCounter.
+	 * Owned by the caller, and must remain valid until the job has been scheduled.
+	 */
+	struct CounterContinuation final
+	{
+		/// Job to run.
+		JobDesc jobDesc_;
+
+		/// Internal use. Do not use.
+		i32 value_ = 0;
+		/// Internal use. Do not use.
+		CounterContinuation* next_ = nullptr;
+	};
+
+	/**
+	 * Fiber a job runs on. Opaque outside of the manager.
+	 */
+	class Fiber;
+
+	/**
+	 * Park function, called by a worker once the parking fiber has fully switched out.
+	 * Return true if the fiber was parked, and will later be passed to Manager::ResumeFiber.
+	 * Return false to resume it immediately.
+	 */
+	typedef bool (*ParkFunc)(Fiber*, void*);
+
 	/**
 	 * Profiler entry data.
 	 */
@@ -4,6 +4,7 @@
 #include "resource/dll.h"
 #include "resource/types.h"
 #include "job/concurrency.h"
+#include "job/coro.h"
 
 namespace Core
 {
@@ -140,6 +141,15 @@ namespace Resource
 		 */
 		static Result ReadFileData(Core::File& file, i64 offset, i64 size, void* dest, AsyncResult* result = nullptr);
 
+		/**
+		 * Read file data asynchronously for several reads, queuing them together.
+		 * @param reads Reads to perform, each with its own async result.
+		 * @param numReads Number of reads.
+		 * @return PENDING.
+		 * @pre Each read has a file valid for reading, offset >= 0, size > 0, dest and result != nullptr.
+		 */
+		static Result ReadFileData(const FileReadDesc* reads, i32 numReads);
+
 		/**
 		 * Write file data either synchronously or asynchronously.
 		 * @param file File to write to.
@@ -168,4 +178,48 @@ namespace Resource
 		~Manager() = delete;
 	};
 
+#if JOB_CORO_ENABLED
+	/**
+	 * Awaitable that resumes the coroutine once async file IO completes.
+	 * The IO thread runs a job to resume it, so nothing is polled in the meantime.
+	 */
+	class AsyncResultAwaiter final
+	{
+	public:
+		AsyncResultAwaiter(AsyncResult& result)
+		    : result_(result)
+		{
+		}
+
+		bool await_ready() const { return result_.IsComplete(); }
+
+		bool await_suspend(std::coroutine_handle<> handle)
+		{
+			DBG_ASSERT(result_.result_ != Result::INITIAL);
+			jobDesc_.func_ = Job::Detail::ResumeCoroJob;
+			jobDesc_.data_ = handle.address();
+			jobDesc_.name_ = "resourceAwait";
+			result_.completionJob_ = &jobDesc_;
+			// If IO has completed in the meantime, carry on without suspending.
+			// Otherwise may resume on another worker before this returns, so nothing can be touched after.
+			return Core::AtomicCmpExchg(&result_.awaitState_, AsyncResult::AWAIT_WAITING, AsyncResult::AWAIT_NONE) ==
+			       AsyncResult::AWAIT_NONE;
+		}
+
+		Result await_resume() const { return result_.finalResult_; }
+
+	private:
+		AsyncResult& result_;
+		Job::JobDesc jobDesc_;
+	};
+
+	/**
+	 * Await async file IO from a coroutine.
+	 * Only one coroutine may await each result.
+	 * @param result Async result passed to ReadFileData or WriteFileData.
+	 * @return Final result.
+	 */
+	inline AsyncResultAwaiter Await(AsyncResult& result) { return AsyncResultAwaiter(result); }
+#endif // JOB_CORO_ENABLED
+
 } // namespace Plugin
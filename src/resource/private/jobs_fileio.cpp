@@ -2,9 +2,26 @@
 #include "core/concurrency.h"
 #include "core/debug.h"
 #include "core/misc.h"
+#include "job/manager.h"
 
 namespace Resource
 {
+	void FileIOJob::Complete(Result result)
+	{
+		// Hand over to an awaiting coroutine first. It won't resume until the job below is run, so the
+		// result remains valid until then. Otherwise result_ is the last access, as the owner may be
+		// polling IsComplete and free it straight after.
+		result_->finalResult_ = result;
+		Job::JobDesc completionJob;
+		const bool isAwaited =
+		    Core::AtomicExchg(&result_->awaitState_, AsyncResult::AWAIT_COMPLETE) == AsyncResult::AWAIT_WAITING;
+		if(isAwaited)
+			completionJob = *result_->completionJob_;
+		Core::AtomicExchg((volatile i32*)&result_->result_, (i32)result);
+		if(isAwaited)
+			Job::Manager::RunJobs(&completionJob, 1);
+	}
+
 	Result FileIOJob::DoRead()
 	{
 		DBG_ASSERT(file_);
@@ -42,7 +59,7 @@ namespace Resource
 			result = Result::SUCCESS;
 		if(result_)
 		{
-			Core::AtomicExchg((volatile i32*)&result_->result_, (i32)result);
+			Complete(result);
 		}
 		return result;
 	}
@@ -82,7 +99,7 @@ namespace Resource
 			result = Result::SUCCESS;
 		if(result_)
 		{
-			Core::AtomicExchg((volatile i32*)&result_->result_, (i32)result);
+			Complete(result);
 		}
 		return result;
 	}
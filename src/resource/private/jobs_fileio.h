@@ -17,6 +17,9 @@ namespace Resource
 
 		Result DoRead();
 		Result DoWrite();
+
+		/// Set final result, resuming anything awaiting it.
+		void Complete(Result result);
 	};
 
 } // namespace Resource
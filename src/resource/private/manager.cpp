@@ -9,6 +9,7 @@
 #include "resource/private/path_resolver.h"
 #include "resource/private/jobs_fileio.h"
 
+#include "core/allocator_pool.h"
 #include "core/array.h"
 #include "core/concurrency.h"
 #include "core/file.h"
@@ -107,12 +108,12 @@ namespace Core
 {
 	u64 Hash(u64 input, const Core::Pair<Core::UUID, Core::UUID>& pair)
 	{
-		return HashFNV1a(input, &pair, sizeof(pair));
+		return HashWyhash(input, &pair, sizeof(pair));
 	}
 
 	u64 Hash(u64 input, Resource::ResourceEntry* resourceEntry)
 	{
-		return HashFNV1a(input, &resourceEntry, sizeof(resourceEntry));
+		return HashMix64(input, (u64)(uintptr_t)resourceEntry);
 	}
 } // namespace Core
 
@@ -154,6 +155,8 @@ namespace Resource
 	{
 		static const i32 MAX_READ_JOBS = 128;
 		static const i32 MAX_WRITE_JOBS = 128;
+		/// Maximum number of IO jobs to take from or add to a queue at once.
+		static const i32 IO_JOB_BATCH_SIZE = 16;
 
 		/// Is resource manager active? true from initialize, false at finalize.
 		bool isActive_ = false;
@@ -199,6 +202,10 @@ namespace Resource
 		ResourceList releasedResourceList_;
 		Job::RWLock resourceRWLock_;
 
+		/// Pools for objects created and destroyed frequently whilst loading.
+		Core::PoolAllocator<ResourceEntry> resourceEntryPool_;
+		Core::PoolAllocator<ResourceLoadJob> loadJobPool_;
+
 		// Read/write lock used to allow reloading logic to wait until it's safe,
 		// and to be blocked whilst everything is ticking.
 		Job::RWLock reloadRWLock_;
@@ -241,7 +248,7 @@ namespace Resource
 			if(it == resourceList_.end())
 			{
 				// Add resource to db.
-				entry = new ResourceEntry();
+				entry = resourceEntryPool_.New();
 				entry->sourceFile_ = sourceFile;
 				entry->convertedFile_ = convertedFile;
 				entry->name_ = name;
@@ -318,7 +325,7 @@ namespace Resource
 				if(auto factory = GetFactory(entry->type_))
 				{
 					bool retVal = factory->DestroyResource(factoryContext, &entry->resource_, entry->type_);
-					delete entry;
+					resourceEntryPool_.Delete(entry);
 					DBG_ASSERT(retVal);
 				}
 			}
@@ -379,14 +386,11 @@ namespace Resource
 			ProcessReleasedResources();
 
 			// TODO: Mark jobs as cancelled.
-			while(readJobs_.Enqueue(FileIOJob()) == false)
-				Job::Manager::YieldCPU();
-			readJobSem_.Signal(1);
+			const FileIOJob exitJob;
+			QueueIOJobs(readJobs_, readJobSem_, &exitJob, 1);
 			readThread_.Join();
 
-			while(writeJobs_.Enqueue(FileIOJob()) == false)
-				Job::Manager::YieldCPU();
-			writeJobSem_.Signal(1);
+			QueueIOJobs(writeJobs_, writeJobSem_, &exitJob, 1);
 			writeThread_.Join();
 
 			timestampJobSem_.Signal(1);
@@ -396,22 +400,49 @@ namespace Resource
 			database_ = nullptr;
 		}
 
+		/**
+		 * Queue IO jobs with as few bulk enqueues as possible, yielding while the queue is full.
+		 * The IO thread is signalled for each run of jobs queued, so it can start on them straight away.
+		 */
+		static void QueueIOJobs(
+		    Core::MPMCBoundedQueue<FileIOJob>& queue, Core::Semaphore& sem, const FileIOJob* ioJobs, i32 numIOJobs)
+		{
+			while(numIOJobs > 0)
+			{
+				const i32 numQueued = queue.EnqueueBulk(ioJobs, numIOJobs);
+				if(numQueued > 0)
+				{
+					sem.Signal(numQueued);
+					ioJobs += numQueued;
+					numIOJobs -= numQueued;
+				}
+				else
+				{
+					Job::Manager::YieldCPU();
+				}
+			}
+		}
+
 		static int ReadIOThread(void* userData)
 		{
 			auto* impl = reinterpret_cast<ManagerImpl*>(userData);
 
-			FileIOJob ioJob;
+			// Drain as many jobs as are ready on each wake. Signals for jobs already handled will wake with nothing to do.
+			FileIOJob ioJobs[IO_JOB_BATCH_SIZE];
 			for(;;)
 			{
 				impl->readJobSem_.Wait();
 				rmt_ScopedCPUSample(ResourceReadIO, RMTSF_None);
 
-				if(impl->readJobs_.Dequeue(ioJob))
+				while(i32 numIOJobs = impl->readJobs_.DequeueBulk(ioJobs, IO_JOB_BATCH_SIZE))
 				{
-					if(ioJob.file_ != nullptr)
-						ioJob.DoRead();
-					else
-						return 0;
+					for(i32 idx = 0; idx < numIOJobs; ++idx)
+					{
+						if(ioJobs[idx].file_ != nullptr)
+							ioJobs[idx].DoRead();
+						else
+							return 0;
+					}
 				}
 			}
 		}
@@ -420,18 +451,22 @@ namespace Resource
 		{
 			auto* impl = reinterpret_cast<ManagerImpl*>(userData);
 
-			FileIOJob ioJob;
+			// Drain as many jobs as are ready on each wake. Signals for jobs already handled will wake with nothing to do.
+			FileIOJob ioJobs[IO_JOB_BATCH_SIZE];
 			for(;;)
 			{
 				impl->writeJobSem_.Wait();
 				rmt_ScopedCPUSample(ResourceWriteIO, RMTSF_None);
 
-				if(impl->writeJobs_.Dequeue(ioJob))
+				while(i32 numIOJobs = impl->writeJobs_.DequeueBulk(ioJobs, IO_JOB_BATCH_SIZE))
 				{
-					if(ioJob.file_ != nullptr)
-						ioJob.DoWrite();
-					else
-						return 0;
+					for(i32 idx = 0; idx < numIOJobs; ++idx)
+					{
+						if(ioJobs[idx].file_ != nullptr)
+							ioJobs[idx].DoWrite();
+						else
+							return 0;
+					}
 				}
 			}
 		}
@@ -488,7 +523,7 @@ namespace Resource
 									    entry, entry->type_, entry->sourceFile_.c_str(), entry->convertedFile_.c_str());
 
 									// Setup load job to chain.
-									convertJob->loadJob_ = new ResourceLoadJob(
+									convertJob->loadJob_ = impl->loadJobPool_.New(
 									    factory, entry, entry->type_, entry->sourceFile_.c_str(), Core::File());
 
 									convertJob->RunSingle(Job::Priority::LOW, 0);
@@ -531,7 +566,7 @@ namespace Resource
 		Core::AtomicInc(&impl_->pendingResourceJobs_);
 	}
 
-	ResourceLoadJob::~ResourceLoadJob() { Core::AtomicDec(&impl_->pendingResourceJobs_); }
+	ResourceLoadJob::~ResourceLoadJob() {}
 
 	void ResourceLoadJob::OnWork(i32 param)
 	{
@@ -564,7 +599,10 @@ namespace Resource
 	void ResourceLoadJob::OnCompleted()
 	{
 		impl_->ReleaseResourceEntry(entry_);
-		delete this;
+
+		// Only signal completion once returned to the pool, so the pool can't be destroyed whilst in use.
+		impl_->loadJobPool_.Delete(this);
+		Core::AtomicDec(&impl_->pendingResourceJobs_);
 	}
 
 	ResourceConvertJob::ResourceConvertJob(
@@ -743,13 +781,13 @@ namespace Resource
 						auto* convertJob = new ResourceConvertJob(entry, type, name, convertedPath.data());
 
 						// Setup load job to chain.
-						convertJob->loadJob_ = new ResourceLoadJob(factory, entry, type, fileName.data(), Core::File());
+						convertJob->loadJob_ = impl_->loadJobPool_.New(factory, entry, type, fileName.data(), Core::File());
 
 						convertJob->RunSingle(Job::Priority::LOW, 0);
 					}
 					else
 					{
-						auto* jobData = new ResourceLoadJob(factory, entry, type, fileName.data(),
+						auto* jobData = impl_->loadJobPool_.New(factory, entry, type, fileName.data(),
 						    Core::File(convertedPath.data(), Core::FileFlags::DEFAULT_READ));
 
 						jobData->RunSingle(Job::Priority::LOW, 0);
@@ -881,8 +919,7 @@ namespace Resource
 		if(result)
 		{
 			Core::AtomicAddAcq(&result->workRemaining_, size);
-			impl_->readJobs_.Enqueue(job);
-			impl_->readJobSem_.Signal(1);
+			impl_->QueueIOJobs(impl_->readJobs_, impl_->readJobSem_, &job, 1);
 		}
 		else
 		{
@@ -891,6 +928,42 @@ namespace Resource
 		return outResult;
 	}
 
+	Result Manager::ReadFileData(const FileReadDesc* reads, i32 numReads)
+	{
+		DBG_ASSERT(IsInitialized());
+		DBG_ASSERT(reads != nullptr);
+		DBG_ASSERT(numReads > 0);
+
+		FileIOJob jobs[ManagerImpl::IO_JOB_BATCH_SIZE];
+		for(i32 firstRead = 0; firstRead < numReads; firstRead += ManagerImpl::IO_JOB_BATCH_SIZE)
+		{
+			const i32 numJobs = Core::Min(numReads - firstRead, ManagerImpl::IO_JOB_BATCH_SIZE);
+			for(i32 idx = 0; idx < numJobs; ++idx)
+			{
+				const FileReadDesc& read = reads[firstRead + idx];
+				DBG_ASSERT(read.file_ != nullptr);
+				DBG_ASSERT(Core::ContainsAllFlags(read.file_->GetFlags(), Core::FileFlags::DEFAULT_READ));
+				DBG_ASSERT(read.offset_ >= 0);
+				DBG_ASSERT(read.size_ > 0);
+				DBG_ASSERT(read.dest_ != nullptr);
+				DBG_ASSERT(read.result_ != nullptr);
+
+				auto oldResult = (Result)Core::AtomicExchg((volatile i32*)&read.result_->result_, (i32)Result::PENDING);
+				DBG_ASSERT(oldResult == Result::INITIAL);
+				Core::AtomicAddAcq(&read.result_->workRemaining_, read.size_);
+
+				FileIOJob& job = jobs[idx];
+				job.file_ = read.file_;
+				job.offset_ = read.offset_;
+				job.size_ = read.size_;
+				job.addr_ = read.dest_;
+				job.result_ = read.result_;
+			}
+			impl_->QueueIOJobs(impl_->readJobs_, impl_->readJobSem_, jobs, numJobs);
+		}
+		return Result::PENDING;
+	}
+
 	Result Manager::WriteFileData(Core::File& file, i64 size, void* src, AsyncResult* result)
 	{
 		DBG_ASSERT(IsInitialized());
@@ -916,8 +989,7 @@ namespace Resource
 		if(result)
 		{
 			Core::AtomicAddAcq(&result->workRemaining_, size);
-			impl_->writeJobs_.Enqueue(job);
-			impl_->writeJobSem_.Signal(1);
+			impl_->QueueIOJobs(impl_->writeJobs_, impl_->writeJobSem_, &job, 1);
 		}
 		else
 		{
@@ -1,11 +1,13 @@
 #include "catch.hpp"
 
+#include "core/array.h"
 #include "core/debug.h"
 #include "core/file.h"
 #include "core/random.h"
 #include "core/timer.h"
 #include "core/vector.h"
 #include "core/os.h"
+#include "job/coro.h"
 #include "job/manager.h"
 #include "plugin/manager.h"
 #include "resource/manager.h"
@@ -49,6 +51,15 @@ namespace
 
 		void GetMetaData(MetaDataCb callback, void* metaData) override {}
 	};
+
+#if JOB_CORO_ENABLED
+	Job::Coro<Resource::Result> CoroReadFile(Core::File& file, Core::Vector<u8>& buffer)
+	{
+		Resource::AsyncResult result;
+		Resource::Manager::ReadFileData(file, 0, buffer.size(), buffer.data(), &result);
+		co_return co_await Resource::Await(result);
+	}
+#endif // JOB_CORO_ENABLED
 }
 
 TEST_CASE("resource-tests-file-io")
@@ -116,6 +127,54 @@ TEST_CASE("resource-tests-file-io")
 		REQUIRE(memcmp(outBuffer.data(), inBuffer.data(), TEST_BUFFER_SIZE) == 0);
 	}
 
+	// Check reading in many pieces at once, more than fit in the read queue.
+	{
+		auto file = Core::File(testFileName, Core::FileFlags::READ);
+		REQUIRE(file);
+
+		static const i32 NUM_READS = 512;
+		static const i64 READ_SIZE = TEST_BUFFER_SIZE / NUM_READS;
+		Core::Vector<u8> inBuffer;
+		inBuffer.resize(TEST_BUFFER_SIZE);
+		Core::Array<Resource::AsyncResult, NUM_READS> results;
+		Core::Array<Resource::FileReadDesc, NUM_READS> reads;
+		for(i32 i = 0; i < NUM_READS; ++i)
+		{
+			reads[i].file_ = &file;
+			reads[i].offset_ = i * READ_SIZE;
+			reads[i].size_ = READ_SIZE;
+			reads[i].dest_ = inBuffer.data() + i * READ_SIZE;
+			reads[i].result_ = &results[i];
+		}
+
+		REQUIRE(Resource::Manager::ReadFileData(reads.data(), reads.size()) == Resource::Result::PENDING);
+		for(const auto& result : results)
+		{
+			while(!result.IsComplete())
+				Job::Manager::YieldCPU();
+			REQUIRE(result.result_ == Resource::Result::SUCCESS);
+		}
+		REQUIRE(memcmp(outBuffer.data(), inBuffer.data(), TEST_BUFFER_SIZE) == 0);
+	}
+
+#if JOB_CORO_ENABLED
+	// Check awaiting from a coroutine.
+	{
+		auto file = Core::File(testFileName, Core::FileFlags::READ);
+		REQUIRE(file);
+
+		Core::Vector<u8> inBuffer;
+		inBuffer.resize(TEST_BUFFER_SIZE);
+
+		auto coro = CoroReadFile(file, inBuffer);
+		coro.Run();
+		coro.Wait();
+
+		REQUIRE(coro.GetResult() == Resource::Result::SUCCESS);
+		REQUIRE(memcmp(outBuffer.data(), inBuffer.data(), TEST_BUFFER_SIZE) == 0);
+	}
+#endif // JOB_CORO_ENABLED
+
 // Check failure.
 // NOTE: It will assert internally anyway.
 #if 0
@@ -1,6 +1,12 @@
 #pragma once
 
 #include "core/types.h"
+#include "job/types.h"
+
+namespace Core
+{
+	class File;
+} // namespace Core
 
 namespace Resource
 {
@@ -23,6 +29,17 @@ namespace Resource
 		/// Result.
 		volatile Result result_ = Result::INITIAL;
 
+		/// Internal use. Do not use.
+		static const i32 AWAIT_NONE = 0;
+		static const i32 AWAIT_WAITING = 1;
+		static const i32 AWAIT_COMPLETE = 2;
+		/// Internal use. Do not use. Final result, set before awaitState_ becomes AWAIT_COMPLETE.
+		Result finalResult_ = Result::INITIAL;
+		/// Internal use. Do not use. Job to run on completion, set by Resource::Await.
+		Job::JobDesc* completionJob_ = nullptr;
+		/// Internal use. Do not use.
+		volatile i32 awaitState_ = AWAIT_NONE;
+
 		AsyncResult() = default;
 		AsyncResult(const AsyncResult&) = delete;
 
@@ -30,4 +47,21 @@ namespace Resource
 		bool IsComplete() const { return result_ == Result::SUCCESS || result_ == Result::FAILURE; }
 	};
 
+	/**
+	 * Asynchronous file read, for submitting several to Manager::ReadFileData at once.
+	 */
+	struct FileReadDesc final
+	{
+		/// File to read from.
+		Core::File* file_ = nullptr;
+		/// Offset to read from.
+		i64 offset_ = 0;
+		/// Size to read.
+		i64 size_ = 0;
+		/// Destination address.
+		void* dest_ = nullptr;
+		/// Async result.
+		AsyncResult* result_ = nullptr;
+	};
+
 } // namespace Resource